@@ -2,6 +2,8 @@
 #include <ctime>
 #include <iostream>
 #include <random>
+#include <stdexcept>
+#include "CheckedArray.hpp"
 
 int main() {
     // random number generator 
@@ -9,23 +11,24 @@ int main() {
     std::uniform_int_distribution<int> dist(0, RAND_MAX);
 
     // make an array with 100000 elements, fill with 1's
-    int *pArr = new int[100000];
-    for(int i = 0; i < 100000; i++) {
-        pArr[i] = 1;
-    }
+    CheckedArray<int> arr(100000, 1);
 
-    // overwrite the array values
-    for(int i = 0; i <= 100000; i++) {
-        pArr[i] = dist(prng);
+    // overwrite the array values; with a raw array, the last pass of this
+    // loop writes past the end, but in a debug build CheckedArray catches it
+    try {
+        for(int i = 0; i <= 100000; i++) {
+            arr[i] = dist(prng);
 
-        // every so often report how we're doing
-        if(i % 10000 == 0) {
-            std::cout << "Overwriting element " << i << std::endl;
+            // every so often report how we're doing
+            if(i % 10000 == 0) {
+                std::cout << "Overwriting element " << i << std::endl;
+            }
         }
+    } catch(std::out_of_range oor) {
+        std::cout << "Caught: " << oor.what() << std::endl;
     }
 
-    // free memory used by the array
-    delete [] pArr;
+    // the array frees its own memory
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,429 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <doctest.h>
+
+/*-----------------------------------------------------------------------------
+ * bounds checking policies
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Bounds checking policy that checks every index.
+ */
+struct BoundsChecked {
+    /**
+     * @brief Check one index.
+     *
+     * @param idx Index to check.
+     * @param n Number of elements.
+     * @param where Name of the calling function, for the error message.
+     *
+     * @throws std::out_of_range if idx is not less than n.
+     */
+    static void check(size_t idx, size_t n, const char *where) {
+        if(idx >= n) {
+            throw std::out_of_range(std::string("index out of range in ") +
+                where);
+        }
+    }
+};
+
+/**
+ * @brief Bounds checking policy that checks nothing.
+ *
+ * check() is empty, so an indexing operator using this policy compiles to
+ * the same code as indexing a raw pointer.
+ */
+struct BoundsUnchecked {
+    static void check(size_t, size_t, const char *) { }
+};
+
+/**
+ * @brief Default bounds checking policy: every index is checked in debug
+ * builds, and nothing is checked in release builds, which are the ones
+ * compiled with -DNDEBUG.
+ */
+#ifdef NDEBUG
+typedef BoundsUnchecked DefaultBounds;
+#else
+typedef BoundsChecked DefaultBounds;
+#endif
+
+/**
+ * Helper function to check that [first, first + count) lies within n
+ * elements, whatever the policy; a view is checked once, when it is made.
+ */
+inline void checkRange(size_t first, size_t count, size_t n,
+    const char *where) {
+    if(first > n || count > n - first) {
+        throw std::out_of_range(std::string("range out of range in ") + where);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief CMP 246 Module 1 view of part of an array.
+ *
+ * A span refers to count contiguous elements owned by somebody else, and is
+ * only valid while they are. Its range is checked once, when it is made, so
+ * a loop over begin() and end() runs on plain pointers, with no check per
+ * element, and vectorizes like a loop over a raw array.
+ */
+template <class T, class Bounds = DefaultBounds> class ArraySpan {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * @param pFirst Pointer to the first element.
+     * @param count Number of elements.
+     */
+    ArraySpan(T *pFirst, size_t count) : pFirst(pFirst), count(count) { }
+
+    /**
+     * @brief Get span size.
+     *
+     * @return The number of elements in the span.
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @brief Accessor for the elements.
+     *
+     * @return Pointer to the first of size() contiguous elements.
+     */
+    T *data() const { return pFirst; }
+
+    /**
+     * @brief Iterator to the first element.
+     */
+    T *begin() const { return pFirst; }
+
+    /**
+     * @brief Iterator one past the last element.
+     */
+    T *end() const { return pFirst + count; }
+
+    /**
+     * @brief Element access, checked according to the policy.
+     *
+     * @param idx Index of the element.
+     *
+     * @throws std::out_of_range if the policy checks indexes and idx is past
+     * the end of the span.
+     *
+     * @return Reference to element idx.
+     */
+    T &operator[](size_t idx) const {
+        Bounds::check(idx, count, "ArraySpan::operator[]()");
+        return pFirst[idx];
+    }
+
+    /**
+     * @brief Part of this span.
+     *
+     * @param first Index of the first element of the part.
+     * @param n Number of elements in the part.
+     *
+     * @throws std::out_of_range if the part does not lie within the span,
+     * whatever the policy.
+     *
+     * @return Span of elements first to first + n - 1.
+     */
+    ArraySpan subspan(size_t first, size_t n) const {
+        checkRange(first, n, count, "ArraySpan::subspan()");
+        return ArraySpan(pFirst + first, n);
+    }
+
+private:
+    /**
+     * Pointer to the first element.
+     */
+    T *pFirst;
+
+    /**
+     * Number of elements.
+     */
+    size_t count;
+};
+
+/**
+ * @brief CMP 246 Module 1 bounds-checked array.
+ *
+ * This class owns a fixed number of contiguous elements, like the raw
+ * new int[100000] in ArrayBounds.cpp, but its indexing operator checks each
+ * index according to the Bounds policy. With the default policy, an index
+ * past the end throws std::out_of_range in debug builds, and costs nothing
+ * in release builds. at() always checks, whatever the policy. Hot loops
+ * should run over span() or begin() and end(), which are checked once.
+ */
+template <class T, class Bounds = DefaultBounds> class CheckedArray {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * Create an array of n value-initialized elements, so numbers are zero.
+     *
+     * @param n Number of elements.
+     */
+    explicit CheckedArray(size_t n = 0u) : pArr(new T[n]()), count(n) { }
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * @param n Number of elements.
+     * @param value Value for every element.
+     */
+    CheckedArray(size_t n, const T &value) : pArr(new T[n]), count(n) {
+        for(size_t i = 0u; i < n; i++) {
+            pArr[i] = value;
+        }
+    }
+
+    /**
+     * @brief Copy constructor.
+     *
+     * @param other Array to copy.
+     */
+    CheckedArray(const CheckedArray &other) : pArr(new T[other.count]),
+        count(other.count) {
+        for(size_t i = 0u; i < count; i++) {
+            pArr[i] = other.pArr[i];
+        }
+    }
+
+    /**
+     * @brief Move constructor.
+     *
+     * @param other Array to take the elements from; it is left empty.
+     */
+    CheckedArray(CheckedArray &&other) : pArr(other.pArr), count(other.count) {
+        other.pArr = nullptr;
+        other.count = 0u;
+    }
+
+    /**
+     * @brief Assignment operator, by copy or by move.
+     *
+     * @param other Array to take the elements from.
+     *
+     * @return This array.
+     */
+    CheckedArray &operator=(CheckedArray other) {
+        std::swap(pArr, other.pArr);
+        std::swap(count, other.count);
+        return *this;
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~CheckedArray() { delete [] pArr; }
+
+    /**
+     * @brief Get array size.
+     *
+     * @return The number of elements in the array.
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @brief Accessor for the elements.
+     *
+     * @return Pointer to the first of size() contiguous elements.
+     */
+    T *data() { return pArr; }
+
+    /**
+     * @brief Accessor for the elements.
+     *
+     * @return Pointer to the first of size() contiguous elements.
+     */
+    const T *data() const { return pArr; }
+
+    /**
+     * @brief Iterator to the first element.
+     */
+    T *begin() { return pArr; }
+    const T *begin() const { return pArr; }
+
+    /**
+     * @brief Iterator one past the last element.
+     */
+    T *end() { return pArr + count; }
+    const T *end() const { return pArr + count; }
+
+    /**
+     * @brief Element access, checked according to the policy.
+     *
+     * @param idx Index of the element.
+     *
+     * @throws std::out_of_range if the policy checks indexes and idx is past
+     * the end of the array.
+     *
+     * @return Reference to element idx.
+     */
+    T &operator[](size_t idx) {
+        Bounds::check(idx, count, "CheckedArray::operator[]()");
+        return pArr[idx];
+    }
+
+    const T &operator[](size_t idx) const {
+        Bounds::check(idx, count, "CheckedArray::operator[]()");
+        return pArr[idx];
+    }
+
+    /**
+     * @brief Element access, always checked.
+     *
+     * @param idx Index of the element.
+     *
+     * @throws std::out_of_range if idx is past the end of the array.
+     *
+     * @return Reference to element idx.
+     */
+    T &at(size_t idx) {
+        BoundsChecked::check(idx, count, "CheckedArray::at()");
+        return pArr[idx];
+    }
+
+    const T &at(size_t idx) const {
+        BoundsChecked::check(idx, count, "CheckedArray::at()");
+        return pArr[idx];
+    }
+
+    /**
+     * @brief View of the whole array.
+     */
+    ArraySpan<T, Bounds> span() { return ArraySpan<T, Bounds>(pArr, count); }
+
+    ArraySpan<const T, Bounds> span() const {
+        return ArraySpan<const T, Bounds>(pArr, count);
+    }
+
+    /**
+     * @brief View of part of the array.
+     *
+     * @param first Index of the first element of the part.
+     * @param n Number of elements in the part.
+     *
+     * @throws std::out_of_range if the part does not lie within the array,
+     * whatever the policy.
+     *
+     * @return Span of elements first to first + n - 1.
+     */
+    ArraySpan<T, Bounds> span(size_t first, size_t n) {
+        checkRange(first, n, count, "CheckedArray::span()");
+        return ArraySpan<T, Bounds>(pArr + first, n);
+    }
+
+    ArraySpan<const T, Bounds> span(size_t first, size_t n) const {
+        checkRange(first, n, count, "CheckedArray::span()");
+        return ArraySpan<const T, Bounds>(pArr + first, n);
+    }
+
+private:
+    /**
+     * Pointer to the elements.
+     */
+    T *pArr;
+
+    /**
+     * Number of elements.
+     */
+    size_t count;
+};
+
+// doctest unit tests for CheckedArray and ArraySpan
+TEST_CASE("testing CheckedArray") {
+    CheckedArray<int, BoundsChecked> arr(5u);
+    CHECK(arr.size() == 5u);
+    CHECK(arr[4] == 0);
+    for(size_t i = 0u; i < arr.size(); i++) {
+        arr[i] = int(i) * 10;
+    }
+    CHECK(arr.at(3) == 30);
+    CHECK(arr.data()[2] == 20);
+
+    // copies are deep, moves leave the source empty
+    CheckedArray<int, BoundsChecked> copy(arr);
+    copy[0] = -1;
+    CHECK(arr[0] == 0);
+    CheckedArray<int, BoundsChecked> moved(std::move(copy));
+    CHECK(moved[0] == -1);
+    CHECK(copy.size() == 0u);
+    copy = arr;
+    CHECK(copy[4] == 40);
+
+    // the checked policy catches the off-by-one from ArrayBounds.cpp
+    bool flag = true;
+    try {
+        arr[5] = 1;     // should throw an exception
+        flag = false;   // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+
+    // at() checks even without the checked policy
+    CheckedArray<double, BoundsUnchecked> fast(3u, 1.5);
+    CHECK(fast[2] == 1.5);
+    flag = true;
+    try {
+        fast.at(3);     // should throw an exception
+        flag = false;   // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+}
+
+TEST_CASE("testing ArraySpan") {
+    CheckedArray<int, BoundsChecked> arr(10u, 1);
+    int total = 0;
+    for(int x : arr.span()) {
+        total += x;
+    }
+    CHECK(total == 10);
+
+    // views write through to the array
+    ArraySpan<int, BoundsChecked> part = arr.span(2u, 3u);
+    CHECK(part.size() == 3u);
+    for(int &x : part) {
+        x = 7;
+    }
+    part[0] = 5;
+    CHECK(arr[1] == 1);
+    CHECK(arr[2] == 5);
+    CHECK(arr[4] == 7);
+    CHECK(arr[5] == 1);
+    CHECK(part.subspan(1u, 2u)[1] == 7);
+    CHECK(arr.span(10u, 0u).size() == 0u);
+
+    // views are checked when they are made, whatever the policy
+    const CheckedArray<int, BoundsUnchecked> fast(4u);
+    bool flag = true;
+    try {
+        fast.span(3u, 2u);  // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        part[3];            // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        part.subspan(4u, 0u);  // should throw an exception
+        flag = false;          // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+}
@@ -0,0 +1,108 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "CheckedArray.hpp"
+
+typedef CheckedArray<float, BoundsChecked> DebugArray;
+typedef CheckedArray<float, BoundsUnchecked> ReleaseArray;
+
+/*
+ * The same loop, y[i] += a * x[i], written four ways. Each is kept out of
+ * line so that the timings compare the loops themselves.
+ */
+
+__attribute__((noinline))
+void axpyRaw(float a, const float *x, float *y, size_t n) {
+    for(size_t i = 0u; i < n; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+__attribute__((noinline))
+void axpyRelease(float a, const ReleaseArray &x, ReleaseArray &y) {
+    for(size_t i = 0u; i < y.size(); i++) {
+        y[i] += a * x[i];
+    }
+}
+
+__attribute__((noinline))
+void axpyDebug(float a, const DebugArray &x, DebugArray &y) {
+    for(size_t i = 0u; i < y.size(); i++) {
+        y[i] += a * x[i];
+    }
+}
+
+__attribute__((noinline))
+void axpySpan(float a, ArraySpan<const float, BoundsChecked> x,
+    ArraySpan<float, BoundsChecked> y) {
+    const float *px = x.begin();
+    for(float &v : y) {
+        v += a * *px++;
+    }
+}
+
+/**
+ * Helper function to run a loop enough times to process about 2^30
+ * elements, and return the time per element in ns.
+ */
+template <class F>
+double nsPerElement(size_t n, F loop) {
+    size_t reps = (size_t(1u) << 30) / n + 1u;
+    auto start = std::chrono::steady_clock::now();
+    for(size_t r = 0u; r < reps; r++) {
+        loop();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() /
+        (double(n) * reps);
+}
+
+/**
+ * @brief Benchmark for CheckedArray.
+ *
+ * This program times y[i] += a * x[i] on a raw array, on a CheckedArray
+ * with and without per-element checks, and on spans of a checked array,
+ * for arrays sized for L1 and for L2. Without checks, and through spans,
+ * the loop should run as fast as on the raw array.
+ */
+int main() {
+    const size_t sizes[] = { 2048u, 65536u };
+    float sink = 0.0f;
+
+    for(size_t s = 0u; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        float *pX = new float[n], *pY = new float[n];
+        DebugArray dx(n, 1.0f), dy(n, 2.0f);
+        ReleaseArray rx(n, 1.0f), ry(n, 2.0f);
+        for(size_t i = 0u; i < n; i++) {
+            pX[i] = 1.0f;
+            pY[i] = 2.0f;
+        }
+
+        // a tiny multiplier keeps the values finite over all the passes
+        const float a = 1e-9f;
+        double raw = nsPerElement(n, [&]() { axpyRaw(a, pX, pY, n); });
+        double release = nsPerElement(n, [&]() { axpyRelease(a, rx, ry); });
+        double debug = nsPerElement(n, [&]() { axpyDebug(a, dx, dy); });
+        const DebugArray &cdx = dx;
+        double span = nsPerElement(n, [&]() {
+            axpySpan(a, cdx.span(), dy.span());
+        });
+        sink += pY[n - 1u] + ry[n - 1u] + dy[n - 1u];
+
+        std::cout << n << " floats:" << std::endl;
+        std::cout << "  raw pointer      " << raw << " ns/element" << std::endl;
+        std::cout << "  unchecked []     " << release << " ns/element ("
+            << release / raw << "x raw)" << std::endl;
+        std::cout << "  checked []       " << debug << " ns/element ("
+            << debug / raw << "x raw)" << std::endl;
+        std::cout << "  checked span     " << span << " ns/element ("
+            << span / raw << "x raw)" << std::endl;
+
+        delete [] pX;
+        delete [] pY;
+    }
+    std::cout << "checksum " << sink << std::endl;
+
+    return EXIT_SUCCESS;
+}
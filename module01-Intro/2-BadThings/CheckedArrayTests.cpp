@@ -0,0 +1,4 @@
+// phantom C++ file for CheckedArray unit testing. This file only includes the
+// CheckedArray header; doctest generates the testing program based on unit
+// tests written alongside the code in the header file
+#include "CheckedArray.hpp"
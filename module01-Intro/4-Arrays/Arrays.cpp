@@ -1,26 +1,17 @@
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
-#include <random>
-
-int sum(int* pArr, int n) {
-    int s = 0;
-    for(int i = 0; i < n; i++) {
-        s += pArr[i];
-    }
-
-    return s;
-}
+#include "Reduce.hpp"
+#include "Rng.hpp"
 
 int main() {
     // random number generator 
-    std::mt19937 prng(time(0));
-    std::uniform_int_distribution<int> dist(0, 100);
+    Xoshiro256ss prng(time(0));
 
     // make an array with 100000 elements, fill with random values
     int *pArr = new int[100000];
     for(int i = 0; i < 100000; i++) {
-        pArr[i] = dist(prng);
+        pArr[i] = int(uniformBelow(prng, 101));
     }
 
     // output the sum
@@ -30,4 +21,4 @@ int main() {
     delete [] pArr;
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
\ No newline at end of file
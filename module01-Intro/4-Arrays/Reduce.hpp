@@ -0,0 +1,717 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <doctest.h>
+
+/*-----------------------------------------------------------------------------
+ * declarations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Ways to add up floating point values.
+ *
+ * Both modes accumulate in double precision, in many independent lanes.
+ * SUM_FAST adds each value straight into its lane. SUM_KAHAN also carries
+ * the rounding error of each addition in a second set of lanes (Kahan
+ * summation), so the result is nearly independent of the number of values,
+ * at about half the speed when the data is in cache.
+ */
+enum Summation {
+    SUM_FAST,
+    SUM_KAHAN
+};
+
+/**
+ * @brief Smallest and largest values of an array.
+ */
+template <class T> struct Range {
+    /** Smallest value. */
+    T min;
+
+    /** Largest value. */
+    T max;
+};
+
+/**
+ * @brief Count, mean, and variance of an array.
+ */
+struct Moments {
+    /** Number of values. */
+    size_t count;
+
+    /** Mean of the values. */
+    double mean;
+
+    /** Sample variance of the values, with count - 1 degrees of freedom. */
+    double variance;
+};
+
+/**
+ * @brief Sum of an array of ints.
+ *
+ * Add the values with 64-bit accumulators, which cannot overflow for any
+ * array that fits in memory.
+ *
+ * @param pArr Pointer to the values.
+ * @param n Number of values.
+ * @param numThreads Number of threads to use, or 0 to use one thread for
+ * arrays that fit in cache and one thread per hardware core for larger ones.
+ *
+ * @return Sum of the values.
+ */
+int64_t sum(const int *pArr, size_t n, unsigned numThreads = 0u);
+
+/**
+ * @brief Sum of an array of floating point values.
+ *
+ * @param pArr Pointer to the values.
+ * @param n Number of values.
+ * @param mode SUM_FAST or SUM_KAHAN.
+ * @param numThreads Number of threads to use, or 0 to use one thread for
+ * arrays that fit in cache and one thread per hardware core for larger ones.
+ *
+ * @return Sum of the values.
+ */
+template <class T>
+double sum(const T *pArr, size_t n, Summation mode = SUM_FAST,
+    unsigned numThreads = 0u);
+
+/**
+ * @brief Dot product of two arrays of floating point values.
+ *
+ * @param pA Pointer to the first array.
+ * @param pB Pointer to the second array.
+ * @param n Number of values in each array.
+ * @param mode SUM_FAST or SUM_KAHAN.
+ * @param numThreads Number of threads to use, or 0 to use one thread for
+ * arrays that fit in cache and one thread per hardware core for larger ones.
+ *
+ * @return Sum of pA[i] * pB[i].
+ */
+template <class T>
+double dot(const T *pA, const T *pB, size_t n, Summation mode = SUM_FAST,
+    unsigned numThreads = 0u);
+
+/**
+ * @brief Smallest and largest values of an array.
+ *
+ * Works on int, float, and double arrays. NaNs are not supported.
+ *
+ * @param pArr Pointer to the values.
+ * @param n Number of values.
+ * @param numThreads Number of threads to use, or 0 to use one thread for
+ * arrays that fit in cache and one thread per hardware core for larger ones.
+ *
+ * @return Smallest and largest values.
+ *
+ * @throws std::invalid_argument if n is zero.
+ */
+template <class T>
+Range<T> minMax(const T *pArr, size_t n, unsigned numThreads = 0u);
+
+/**
+ * @brief Mean and variance of an array.
+ *
+ * Works on int, float, and double arrays. The array is processed in
+ * blocks; each block's sums are taken relative to its first value, which
+ * avoids the cancellation of the textbook sum of squares formula, and the
+ * blocks are merged with Chan's parallel update.
+ *
+ * @param pArr Pointer to the values.
+ * @param n Number of values.
+ * @param numThreads Number of threads to use, or 0 to use one thread for
+ * arrays that fit in cache and one thread per hardware core for larger ones.
+ *
+ * @return Count, mean, and sample variance; the variance is zero for fewer
+ * than two values, and the mean is zero for none.
+ */
+template <class T>
+Moments moments(const T *pArr, size_t n, unsigned numThreads = 0u);
+
+/*-----------------------------------------------------------------------------
+ * kernels
+ *
+ * The kernels are written with GCC vector types, so each line of a lane
+ * body is one vector instruction: 64-byte vectors map to one AVX-512
+ * register, two AVX2 registers, or four SSE registers. Each kernel keeps
+ * ACCUMULATORS independent vectors of partial results, so consecutive
+ * additions do not wait on each other. The lane bodies are inline
+ * templates; the int, float, and double versions are compiled for
+ * AVX-512, AVX2, and baseline processors, and the best one is picked when
+ * the program starts.
+ *---------------------------------------------------------------------------*/
+
+/** Eight doubles. */
+typedef double Doubles __attribute__((vector_size(64)));
+
+/** Eight 64-bit ints. */
+typedef int64_t Longs __attribute__((vector_size(64)));
+
+/** Eight floats. */
+typedef float Floats8 __attribute__((vector_size(32)));
+
+/** Eight ints. */
+typedef int Ints8 __attribute__((vector_size(32)));
+
+/** 64 bytes of any element type. */
+template <class T> struct Vector {
+    typedef T type __attribute__((vector_size(64)));
+};
+
+/** Number of independent vector accumulators in each kernel. */
+const size_t ACCUMULATORS = 4u;
+
+/** Number of values each kernel consumes per pass: four vectors of eight. */
+const size_t LANES = 8u * ACCUMULATORS;
+
+/*
+ * The helpers below are always inlined, so that they are compiled for the
+ * instruction set of each kernel, and they pass vectors by reference, since
+ * passing them by value would depend on the instruction set.
+ */
+
+/**
+ * Helper function to load a vector from a possibly unaligned address.
+ */
+template <class V, class T>
+__attribute__((always_inline)) inline void loadVector(V &v, const T *p) {
+    std::memcpy(&v, p, sizeof(v));
+}
+
+/**
+ * Helper functions to load eight values widened to doubles.
+ */
+__attribute__((always_inline)) inline void loadDoubles(Doubles &v,
+    const double *p) {
+    loadVector(v, p);
+}
+
+__attribute__((always_inline)) inline void loadDoubles(Doubles &v,
+    const float *p) {
+    Floats8 f;
+    loadVector(f, p);
+    v = __builtin_convertvector(f, Doubles);
+}
+
+__attribute__((always_inline)) inline void loadDoubles(Doubles &v,
+    const int *p) {
+    Ints8 x;
+    loadVector(x, p);
+    v = __builtin_convertvector(x, Doubles);
+}
+
+/**
+ * Helper function for Kahan's update of a sum s and compensation c.
+ */
+template <class V>
+__attribute__((always_inline)) inline void kahanAdd(V &s, V &c, const V &x) {
+    V y = x - c;
+    V t = s + y;
+    c = (t - s) - y;
+    s = t;
+}
+
+/**
+ * Helper function for the integer sum kernel, with 64-bit lanes.
+ */
+__attribute__((always_inline))
+inline int64_t sumIntLanes(const int *__restrict p, size_t n) {
+    Longs acc[ACCUMULATORS] = { };
+    size_t i = 0u;
+    for(; i + LANES <= n; i += LANES) {
+        for(size_t k = 0u; k < ACCUMULATORS; k++) {
+            Ints8 x;
+            loadVector(x, p + i + 8u * k);
+            acc[k] += __builtin_convertvector(x, Longs);
+        }
+    }
+
+    int64_t total = 0;
+    for(; i < n; i++) {
+        total += p[i];
+    }
+    for(size_t k = 0u; k < ACCUMULATORS; k++) {
+        for(size_t l = 0u; l < 8u; l++) {
+            total += acc[k][l];
+        }
+    }
+    return total;
+}
+
+/**
+ * Helper function for the floating point sum kernels, with double lanes.
+ */
+template <class T>
+__attribute__((always_inline))
+inline double sumLanes(const T *__restrict p, size_t n, Summation mode) {
+    Doubles s[ACCUMULATORS] = { }, c[ACCUMULATORS] = { };
+    size_t i = 0u;
+    if(mode == SUM_KAHAN) {
+        for(; i + LANES <= n; i += LANES) {
+            for(size_t k = 0u; k < ACCUMULATORS; k++) {
+                Doubles x;
+                loadDoubles(x, p + i + 8u * k);
+                kahanAdd(s[k], c[k], x);
+            }
+        }
+    } else {
+        for(; i + LANES <= n; i += LANES) {
+            for(size_t k = 0u; k < ACCUMULATORS; k++) {
+                Doubles x;
+                loadDoubles(x, p + i + 8u * k);
+                s[k] += x;
+            }
+        }
+    }
+
+    // the lanes and the tail, compensated in either mode
+    double total = 0.0, comp = 0.0;
+    for(size_t k = 0u; k < ACCUMULATORS; k++) {
+        for(size_t l = 0u; l < 8u; l++) {
+            kahanAdd(total, comp, s[k][l]);
+            kahanAdd(total, comp, -c[k][l]);
+        }
+    }
+    for(; i < n; i++) {
+        kahanAdd(total, comp, double(p[i]));
+    }
+    return total;
+}
+
+/**
+ * Helper function for the dot product kernels, with double lanes.
+ */
+template <class T>
+__attribute__((always_inline))
+inline double dotLanes(const T *__restrict a, const T *__restrict b,
+    size_t n, Summation mode) {
+    Doubles s[ACCUMULATORS] = { }, c[ACCUMULATORS] = { };
+    size_t i = 0u;
+    if(mode == SUM_KAHAN) {
+        for(; i + LANES <= n; i += LANES) {
+            for(size_t k = 0u; k < ACCUMULATORS; k++) {
+                Doubles x, y;
+                loadDoubles(x, a + i + 8u * k);
+                loadDoubles(y, b + i + 8u * k);
+                kahanAdd(s[k], c[k], Doubles(x * y));
+            }
+        }
+    } else {
+        for(; i + LANES <= n; i += LANES) {
+            for(size_t k = 0u; k < ACCUMULATORS; k++) {
+                Doubles x, y;
+                loadDoubles(x, a + i + 8u * k);
+                loadDoubles(y, b + i + 8u * k);
+                s[k] += x * y;
+            }
+        }
+    }
+
+    double total = 0.0, comp = 0.0;
+    for(size_t k = 0u; k < ACCUMULATORS; k++) {
+        for(size_t l = 0u; l < 8u; l++) {
+            kahanAdd(total, comp, s[k][l]);
+            kahanAdd(total, comp, -c[k][l]);
+        }
+    }
+    for(; i < n; i++) {
+        kahanAdd(total, comp, double(a[i]) * double(b[i]));
+    }
+    return total;
+}
+
+/**
+ * Helper function for the min/max kernels, in the element type; n must be
+ * at least 1.
+ */
+template <class T>
+__attribute__((always_inline))
+inline Range<T> minMaxLanes(const T *__restrict p, size_t n) {
+    typedef typename Vector<T>::type V;
+    const size_t WIDTH = sizeof(V) / sizeof(T);
+    Range<T> r = { p[0], p[0] };
+    size_t i = 0u;
+    if(n >= 2u * WIDTH) {
+        V lo0, lo1;
+        loadVector(lo0, p);
+        loadVector(lo1, p + WIDTH);
+        V hi0 = lo0, hi1 = lo1;
+        for(i = 2u * WIDTH; i + 2u * WIDTH <= n; i += 2u * WIDTH) {
+            V x0, x1;
+            loadVector(x0, p + i);
+            loadVector(x1, p + i + WIDTH);
+            lo0 = x0 < lo0 ? x0 : lo0;
+            lo1 = x1 < lo1 ? x1 : lo1;
+            hi0 = x0 > hi0 ? x0 : hi0;
+            hi1 = x1 > hi1 ? x1 : hi1;
+        }
+        lo0 = lo1 < lo0 ? lo1 : lo0;
+        hi0 = hi1 > hi0 ? hi1 : hi0;
+        for(size_t l = 0u; l < WIDTH; l++) {
+            r.min = lo0[l] < r.min ? lo0[l] : r.min;
+            r.max = hi0[l] > r.max ? hi0[l] : r.max;
+        }
+    }
+    for(; i < n; i++) {
+        r.min = p[i] < r.min ? p[i] : r.min;
+        r.max = p[i] > r.max ? p[i] : r.max;
+    }
+    return r;
+}
+
+/**
+ * Helper function for the moment kernels: the count, mean, and sum of
+ * squared deviations of a block, from sums taken relative to its first
+ * value; n must be at least 1.
+ */
+template <class T>
+__attribute__((always_inline))
+inline Moments shiftedLanes(const T *__restrict p, size_t n) {
+    double shift = double(p[0]);
+    Doubles shiftV = shift - Doubles();
+    Doubles s[ACCUMULATORS] = { }, s2[ACCUMULATORS] = { };
+    size_t i = 0u;
+    for(; i + LANES <= n; i += LANES) {
+        for(size_t k = 0u; k < ACCUMULATORS; k++) {
+            Doubles d;
+            loadDoubles(d, p + i + 8u * k);
+            d -= shiftV;
+            s[k] += d;
+            s2[k] += d * d;
+        }
+    }
+
+    double sum = 0.0, sumSq = 0.0;
+    for(size_t k = 0u; k < ACCUMULATORS; k++) {
+        for(size_t l = 0u; l < 8u; l++) {
+            sum += s[k][l];
+            sumSq += s2[k][l];
+        }
+    }
+    for(; i < n; i++) {
+        double d = double(p[i]) - shift;
+        sum += d;
+        sumSq += d * d;
+    }
+
+    // variance holds the sum of squared deviations until the very end
+    Moments m = { n, shift + sum / n, sumSq - sum * sum / n };
+    return m;
+}
+
+/*
+ * The kernels are static rather than inline, since target_clones functions
+ * can't be inline; every translation unit that includes this header gets its
+ * own clones, and unused ones draw no warning.
+ */
+
+__attribute__((target_clones("avx512f", "avx2", "default"), unused))
+static int64_t sumKernel(const int *p, size_t n) {
+    return sumIntLanes(p, n);
+}
+
+__attribute__((target_clones("avx512f", "avx2", "default"), unused))
+static double sumKernel(const float *p, size_t n, Summation mode) {
+    return sumLanes(p, n, mode);
+}
+
+__attribute__((target_clones("avx512f", "avx2", "default"), unused))
+static double sumKernel(const double *p, size_t n, Summation mode) {
+    return sumLanes(p, n, mode);
+}
+
+__attribute__((target_clones("avx512f", "avx2", "default"), unused))
+static double dotKernel(const float *a, const float *b, size_t n,
+    Summation mode) {
+    return dotLanes(a, b, n, mode);
+}
+
+__attribute__((target_clones("avx512f", "avx2", "default"), unused))
+static double dotKernel(const double *a, const double *b, size_t n,
+    Summation mode) {
+    return dotLanes(a, b, n, mode);
+}
+
+__attribute__((target_clones("avx512f", "avx2", "default"), unused))
+static Range<int> minMaxKernel(const int *p, size_t n) {
+    return minMaxLanes(p, n);
+}
+
+__attribute__((target_clones("avx512f", "avx2", "default"), unused))
+static Range<float> minMaxKernel(const float *p, size_t n) {
+    return minMaxLanes(p, n);
+}
+
+__attribute__((target_clones("avx512f", "avx2", "default"), unused))
+static Range<double> minMaxKernel(const double *p, size_t n) {
+    return minMaxLanes(p, n);
+}
+
+__attribute__((target_clones("avx512f", "avx2", "default"), unused))
+static Moments shiftedKernel(const int *p, size_t n) {
+    return shiftedLanes(p, n);
+}
+
+__attribute__((target_clones("avx512f", "avx2", "default"), unused))
+static Moments shiftedKernel(const float *p, size_t n) {
+    return shiftedLanes(p, n);
+}
+
+__attribute__((target_clones("avx512f", "avx2", "default"), unused))
+static Moments shiftedKernel(const double *p, size_t n) {
+    return shiftedLanes(p, n);
+}
+
+/*-----------------------------------------------------------------------------
+ * function implementations
+ *---------------------------------------------------------------------------*/
+
+/** Arrays larger than this many bytes are reduced on every core. */
+const size_t PARALLEL_BYTES = size_t(8u) << 20;
+
+/**
+ * Helper function to split the range from 0 to n over threads, reduce each
+ * thread's share with kernel(first, last), and fold the partial results
+ * together in thread order with combine(a, b). With numThreads of 0, one
+ * thread is used unless the array is larger than PARALLEL_BYTES.
+ */
+template <class R, class K, class C>
+R reduceParallel(size_t n, size_t bytes, unsigned numThreads, K kernel,
+    C combine) {
+    if(numThreads == 0u) {
+        numThreads = bytes > PARALLEL_BYTES ?
+            std::thread::hardware_concurrency() : 1u;
+    }
+    if(numThreads == 0u) {
+        numThreads = 1u;
+    }
+    if(numThreads == 1u || n < numThreads) {
+        return kernel(size_t(0u), n);
+    }
+
+    // each thread writes only its own partial result
+    std::vector<R> partial(numThreads);
+    std::vector<std::thread> threads;
+    size_t slice = n / numThreads;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        size_t first = t * slice;
+        size_t last = (t == numThreads - 1u) ? n : first + slice;
+        threads.push_back(std::thread([&partial, &kernel, t, first, last]() {
+            partial[t] = kernel(first, last);
+        }));
+    }
+    threads[0].join();
+    R result = partial[0];
+    for(unsigned t = 1u; t < numThreads; t++) {
+        threads[t].join();
+        result = combine(result, partial[t]);
+    }
+
+    return result;
+}
+
+/**
+ * Helper function to merge the moments of two blocks with Chan's update;
+ * the variance field holds the sum of squared deviations.
+ */
+inline Moments mergeMoments(const Moments &a, const Moments &b) {
+    if(a.count == 0u) {
+        return b;
+    }
+    if(b.count == 0u) {
+        return a;
+    }
+    size_t count = a.count + b.count;
+    double delta = b.mean - a.mean;
+    Moments m = { count, a.mean + delta * b.count / count,
+        a.variance + b.variance + delta * delta * a.count / count * b.count };
+    return m;
+}
+
+/*
+ * Integer sum.
+ */
+inline int64_t sum(const int *pArr, size_t n, unsigned numThreads) {
+    return reduceParallel<int64_t>(n, n * sizeof(int), numThreads,
+        [pArr](size_t first, size_t last) {
+            return sumKernel(pArr + first, last - first);
+        }, [](int64_t a, int64_t b) { return a + b; });
+}
+
+/*
+ * Floating point sum.
+ */
+template <class T>
+double sum(const T *pArr, size_t n, Summation mode, unsigned numThreads) {
+    return reduceParallel<double>(n, n * sizeof(T), numThreads,
+        [pArr, mode](size_t first, size_t last) {
+            return sumKernel(pArr + first, last - first, mode);
+        }, [](double a, double b) { return a + b; });
+}
+
+/*
+ * Dot product.
+ */
+template <class T>
+double dot(const T *pA, const T *pB, size_t n, Summation mode,
+    unsigned numThreads) {
+    return reduceParallel<double>(n, 2u * n * sizeof(T), numThreads,
+        [pA, pB, mode](size_t first, size_t last) {
+            return dotKernel(pA + first, pB + first, last - first, mode);
+        }, [](double a, double b) { return a + b; });
+}
+
+/*
+ * Smallest and largest values.
+ */
+template <class T>
+Range<T> minMax(const T *pArr, size_t n, unsigned numThreads) {
+    if(n == 0u) {
+        throw std::invalid_argument("empty array in minMax()");
+    }
+
+    return reduceParallel<Range<T> >(n, n * sizeof(T), numThreads,
+        [pArr](size_t first, size_t last) {
+            return minMaxKernel(pArr + first, last - first);
+        }, [](const Range<T> &a, const Range<T> &b) {
+            Range<T> r = { b.min < a.min ? b.min : a.min,
+                b.max > a.max ? b.max : a.max };
+            return r;
+        });
+}
+
+/*
+ * Mean and variance, block by block.
+ */
+template <class T>
+Moments moments(const T *pArr, size_t n, unsigned numThreads) {
+    // 4096 values per block keeps each block's shift close to its values
+    const size_t BLOCK = 4096u;
+    Moments m = reduceParallel<Moments>(n, n * sizeof(T), numThreads,
+        [pArr](size_t first, size_t last) {
+            Moments acc = { 0u, 0.0, 0.0 };
+            for(size_t i = first; i < last; i += BLOCK) {
+                size_t count = last - i < BLOCK ? last - i : BLOCK;
+                acc = mergeMoments(acc, shiftedKernel(pArr + i, count));
+            }
+            return acc;
+        }, mergeMoments);
+
+    m.variance = m.count > 1u ? m.variance / (m.count - 1u) : 0.0;
+    return m;
+}
+
+// doctest unit tests for the reductions
+TEST_CASE("testing sum") {
+    // large enough to overflow an int accumulator, with a ragged tail
+    std::vector<int> big(1000003u, 2000000000);
+    CHECK(sum(big.data(), big.size()) == int64_t(2000000000) * 1000003);
+    CHECK(sum(big.data(), big.size(), 3u) == int64_t(2000000000) * 1000003);
+    big[17] = -5;
+    CHECK(sum(big.data(), 20u) == int64_t(2000000000) * 19 - 5);
+    CHECK(sum(big.data(), 0u) == 0);
+
+    std::vector<double> d(1001u);
+    for(size_t i = 0u; i < d.size(); i++) {
+        d[i] = double(i);
+    }
+    CHECK(sum(d.data(), d.size()) == 500500.0);
+    CHECK(sum(d.data(), d.size(), SUM_KAHAN, 4u) == 500500.0);
+
+    // 0.1 can't be represented exactly; Kahan summation keeps the error of
+    // ten million of them at the level of a single rounding
+    std::vector<float> tenths(10000000u, 0.1f);
+    double exact = 10000000.0 * double(0.1f);
+    double fast = sum(tenths.data(), tenths.size(), SUM_FAST, 1u);
+    double kahan = sum(tenths.data(), tenths.size(), SUM_KAHAN, 1u);
+    CHECK(std::fabs(kahan - exact) <= std::fabs(fast - exact));
+    CHECK(std::fabs(kahan - exact) < 1e-8);
+    CHECK(sum(tenths.data(), tenths.size(), SUM_KAHAN, 3u) ==
+        doctest::Approx(exact).epsilon(1e-14));
+}
+
+TEST_CASE("testing dot") {
+    std::vector<float> a(1000u), b(1000u);
+    double expect = 0.0;
+    for(size_t i = 0u; i < a.size(); i++) {
+        a[i] = float(i % 7) - 3.0f;
+        b[i] = float(i % 5) * 0.5f;
+        expect += double(a[i]) * b[i];
+    }
+    CHECK(dot(a.data(), b.data(), a.size()) == doctest::Approx(expect));
+    CHECK(dot(a.data(), b.data(), a.size(), SUM_KAHAN, 3u) ==
+        doctest::Approx(expect));
+
+    std::vector<double> c(33u, 2.0);
+    CHECK(dot(c.data(), c.data(), c.size()) == 132.0);
+}
+
+TEST_CASE("testing minMax") {
+    std::vector<int> v(1000u);
+    for(size_t i = 0u; i < v.size(); i++) {
+        v[i] = int((i * 7919u) % 1000u) - 500;
+    }
+    Range<int> r = minMax(v.data(), v.size());
+    CHECK(r.min == -500);
+    CHECK(r.max == 499);
+    r = minMax(v.data(), v.size(), 4u);
+    CHECK(r.min == -500);
+    CHECK(r.max == 499);
+
+    // a single value, and extremes in the ragged tail
+    double one = 3.5;
+    Range<double> rd = minMax(&one, 1u);
+    CHECK(rd.min == 3.5);
+    CHECK(rd.max == 3.5);
+    std::vector<float> f(35u, 1.0f);
+    f[34] = -2.0f;
+    f[33] = 9.0f;
+    Range<float> rf = minMax(f.data(), f.size());
+    CHECK(rf.min == -2.0f);
+    CHECK(rf.max == 9.0f);
+
+    // check exception handling
+    bool flag = true;
+    try {
+        minMax(v.data(), 0u);   // should throw an exception
+        flag = false;           // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+}
+
+TEST_CASE("testing moments") {
+    std::vector<int> v(10001u);
+    for(size_t i = 0u; i < v.size(); i++) {
+        v[i] = int(i);
+    }
+    Moments m = moments(v.data(), v.size());
+    CHECK(m.count == 10001u);
+    CHECK(m.mean == doctest::Approx(5000.0));
+    CHECK(m.variance == doctest::Approx(10001.0 * 10002.0 / 12.0));
+    Moments m3 = moments(v.data(), v.size(), 3u);
+    CHECK(m3.mean == doctest::Approx(m.mean));
+    CHECK(m3.variance == doctest::Approx(m.variance));
+
+    // a huge offset does not swamp a small spread
+    std::vector<double> d(100000u);
+    for(size_t i = 0u; i < d.size(); i++) {
+        d[i] = 1.0e9 + (i % 2 == 0 ? 1.0 : -1.0);
+    }
+    Moments md = moments(d.data(), d.size());
+    CHECK(md.mean == doctest::Approx(1.0e9));
+    CHECK(md.variance == doctest::Approx(1.0).epsilon(1e-4));
+
+    float two[] = { 1.0f, 3.0f };
+    Moments mf = moments(two, 2u);
+    CHECK(mf.mean == 2.0);
+    CHECK(mf.variance == 2.0);
+    CHECK(moments(two, 1u).variance == 0.0);
+    CHECK(moments(two, 0u).count == 0u);
+}
@@ -0,0 +1,105 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "Reduce.hpp"
+#include "Rng.hpp"
+
+/**
+ * Original scalar sum loop from Arrays.cpp, with a 64-bit accumulator so
+ * that summing a large array cannot overflow.
+ */
+int64_t naiveSum(const int *pArr, int n) {
+    int64_t s = 0;
+    for(int i = 0; i < n; i++) {
+        s += pArr[i];
+    }
+
+    return s;
+}
+
+/**
+ * Helper function to run a reduction enough times to touch about 2 GB and
+ * return its rate in GB/s. The results are added to sink, so the compiler
+ * can't drop the calls.
+ */
+template <class F>
+double gbPerSecond(size_t bytes, double &sink, F reduce) {
+    size_t reps = (size_t(2u) << 30) / bytes + 1u;
+    auto start = std::chrono::steady_clock::now();
+    for(size_t r = 0u; r < reps; r++) {
+        sink += double(reduce());
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    return double(bytes) * reps / seconds / 1e9;
+}
+
+/**
+ * @brief Benchmark for the reduction library.
+ *
+ * This program times each reduction on arrays sized for L1, L2, L3, and
+ * main memory, and reports the rates in GB/s next to the memcpy rate for
+ * the same size, as a yardstick for memory bandwidth.
+ */
+int main() {
+    Xoshiro256ss prng(246u);
+    const size_t sizes[] = { size_t(32u) << 10, size_t(1u) << 20,
+        size_t(16u) << 20, size_t(256u) << 20 };
+    double sink = 0.0;
+
+    for(size_t s = 0u; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s] / sizeof(float);
+        std::vector<int> ints(n);
+        std::vector<float> floats(n), floats2(n), copy(n);
+        for(size_t i = 0u; i < n; i++) {
+            ints[i] = int(uniformBelow(prng, 101));
+            floats[i] = unitReal<float>(prng());
+            floats2[i] = unitReal<float>(prng());
+        }
+        const int *pInts = ints.data();
+        const float *pF = floats.data(), *pF2 = floats2.data();
+        size_t bytes = n * sizeof(float);
+
+        std::cout << (bytes >> 10) << " KiB:" << std::endl;
+        std::cout << "  memcpy         " << gbPerSecond(2u * bytes, sink,
+            [&]() {
+                std::memcpy(copy.data(), pF, bytes);
+                return copy[n / 2u];
+            }) << " GB/s (read + write)" << std::endl;
+        std::cout << "  naive int sum  " << gbPerSecond(bytes, sink, [&]() {
+                return naiveSum(pInts, int(n));
+            }) << " GB/s" << std::endl;
+        std::cout << "  int sum        " << gbPerSecond(bytes, sink, [&]() {
+                return sum(pInts, n, 1u);
+            }) << " GB/s" << std::endl;
+        std::cout << "  float sum      " << gbPerSecond(bytes, sink, [&]() {
+                return sum(pF, n, SUM_FAST, 1u);
+            }) << " GB/s" << std::endl;
+        std::cout << "  Kahan sum      " << gbPerSecond(bytes, sink, [&]() {
+                return sum(pF, n, SUM_KAHAN, 1u);
+            }) << " GB/s" << std::endl;
+        std::cout << "  dot            " << gbPerSecond(2u * bytes, sink,
+            [&]() {
+                return dot(pF, pF2, n, SUM_FAST, 1u);
+            }) << " GB/s" << std::endl;
+        std::cout << "  minMax         " << gbPerSecond(bytes, sink, [&]() {
+                return minMax(pF, n, 1u).max;
+            }) << " GB/s" << std::endl;
+        std::cout << "  moments        " << gbPerSecond(bytes, sink, [&]() {
+                return moments(pF, n, 1u).variance;
+            }) << " GB/s" << std::endl;
+        std::cout << "  int sum, auto  " << gbPerSecond(bytes, sink, [&]() {
+                return sum(pInts, n);
+            }) << " GB/s (" << (bytes > PARALLEL_BYTES ?
+            std::thread::hardware_concurrency() : 1u) << " threads)" <<
+            std::endl;
+    }
+
+    // keep the results live
+    std::cerr << "checksum " << sink << std::endl;
+
+    return EXIT_SUCCESS;
+}
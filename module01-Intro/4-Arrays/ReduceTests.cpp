@@ -0,0 +1,4 @@
+// phantom C++ file for Reduce unit testing. This file only includes the Reduce
+// header; doctest generates the testing program based on unit tests written
+// alongside the code in the header file
+#include "Reduce.hpp"
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
 #include <cmath>
+#include <cstddef>
+#include <stdexcept>
 #include <doctest.h>
 
 /*-----------------------------------------------------------------------------
@@ -8,58 +11,129 @@
  *---------------------------------------------------------------------------*/
 
 /**
- * @brief CMP 246 Module 1 class representing an (x, y) coordinate.
+ * @brief CMP 246 Module 1 class representing an N-dimensional coordinate.
  * 
- * This class represents an (x, y) coordinate. The class is templated, and
- * can support float, double, or long double for the type of each element of 
- * the coordinate.
+ * This class represents an (x, y, ...) coordinate with N elements, two by
+ * default. The class is templated, and can support float, double, or long 
+ * double for the type of each element of the coordinate. The dimension is 
+ * a compile-time constant, so loops over the elements unroll completely,
+ * and the elements are stored contiguously, so an array of coordinates is
+ * one flat array of values.
  */
-template <class T> class Coordinate {
+template <class T, size_t N = 2> class Coordinate {
+    static_assert(N > 0, "a coordinate needs at least one element");
 public:
+    /**
+     * @brief Number of elements.
+     * 
+     * @return N, the dimension of the coordinate.
+     */
+    static constexpr size_t dimension() { return N; }
+
     /**
      * @brief Default constructor.
      * 
      * Create a new coordinate with each element set to zero.
      */
-    Coordinate() : x(), y() { }
+    Coordinate() : values() { }
+
+    /**
+     * @brief Initializing constructor.
+     * 
+     * Create a new coordinate with the specified values, one per element;
+     * for example, Coordinate<double>(x, y).
+     * 
+     * @param first First element for this coordinate.
+     * @param rest Remaining elements for this coordinate.
+     */
+    template <class... U>
+    Coordinate(T first, U... rest) : values{{ first, T(rest)... }} {
+        static_assert(sizeof...(U) + 1u == N, "one value per element");
+    }
 
     /**
      * @brief Initializing constructor.
      * 
-     * Create a new coordinate with the specified values.
+     * Create a new coordinate from an array of element values.
      * 
-     * @param inX x-value for this coordinate.
-     * @param inY y-value for this coordinate.
+     * @param inValues Values for this coordinate.
      */
-    Coordinate(T inX, T inY) : x(inX), y(inY) { }
+    explicit Coordinate(const std::array<T, N> &inValues) : values(inValues) { }
 
     /**
      * @brief Mutator for the x-value.
      * 
      * @param inX New x-value for this coordinate.
      */
-    void setX(T inX) { x = inX; }
+    void setX(T inX) { values[0] = inX; }
 
     /**
      * @brief Mutator for the y-value.
      * 
      * @param inY New y-value for this coordinate.
      */
-    void setY(T inY) { y = inY; }
+    void setY(T inY) {
+        static_assert(N >= 2u, "no y-value in a one-element coordinate");
+        values[1] = inY;
+    }
 
     /**
      * @brief Accessor for the x-value.
      * 
      * @return This coordinate's x-value.
      */
-    T getX() const { return x; }
+    T getX() const { return values[0]; }
 
     /**
      * @brief Accessor for the y-value.
      * 
      * @return This coordinate's y-value.
      */
-    T getY() const { return y; }
+    T getY() const {
+        static_assert(N >= 2u, "no y-value in a one-element coordinate");
+        return values[1];
+    }
+
+    /**
+     * @brief Mutator for any element.
+     * 
+     * @param idx Index of the element, from 0 to N - 1.
+     * @param value New value for the element.
+     * 
+     * @throws std::out_of_range if idx is N or more.
+     */
+    void set(size_t idx, T value);
+
+    /**
+     * @brief Accessor for any element.
+     * 
+     * @param idx Index of the element, from 0 to N - 1.
+     * 
+     * @return Value of the element.
+     * 
+     * @throws std::out_of_range if idx is N or more.
+     */
+    T get(size_t idx) const;
+
+    /**
+     * @brief Accessor for the elements.
+     * 
+     * @return Pointer to the N contiguous values of this coordinate.
+     */
+    const T *data() const { return values.data(); }
+
+    /**
+     * @brief Squared Euclidean distance method.
+     * 
+     * Calculate the square of the Euclidean distance between this coordinate
+     * and another. Comparing squared distances gives the same order as 
+     * comparing distances, without taking a square root.
+     * 
+     * @param other Reference to the other coordinate to use.
+     * @return Squared Euclidean distance between this coordinate and the 
+     * other.
+     */
+    T squaredDistanceTo(const Coordinate<T, N> &other) const;
 
     /**
      * @brief Euclidean distance method.
@@ -69,33 +143,59 @@ public:
      * @param other Reference to the other coordinate to use.
      * @return Euclidean distance between this coordinate and the other.
      */
-    T distanceTo(const Coordinate<T> &other) const;
+    T distanceTo(const Coordinate<T, N> &other) const;
 private:
     /**
-     * X-value of this coordinate.
-     */
-    T x;
-
-    /**
-     * Y-value of this coordinate.
+     * Values of the elements of this coordinate; x first, then y, and so on.
      */
-    T y;
+    std::array<T, N> values;
 };
 
 /*-----------------------------------------------------------------------------
  * method implementations
  *---------------------------------------------------------------------------*/
 
+/*
+ * Element mutator.
+ */
+template <class T, size_t N>
+void Coordinate<T, N>::set(size_t idx, T value) {
+    if(idx >= N) {
+        throw std::out_of_range("index out of range in Coordinate::set()");
+    }
+    values[idx] = value;
+}
+
+/*
+ * Element accessor.
+ */
+template <class T, size_t N>
+T Coordinate<T, N>::get(size_t idx) const {
+    if(idx >= N) {
+        throw std::out_of_range("index out of range in Coordinate::get()");
+    }
+    return values[idx];
+}
+
+/*
+ * Squared distance method.
+ */
+template <class T, size_t N>
+T Coordinate<T, N>::squaredDistanceTo(const Coordinate<T, N> &other) const {
+    T sum = T();
+    for(size_t d = 0u; d < N; d++) {
+        T diff = values[d] - other.values[d];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
 /*
  * Distance method.
  */
-template <class T>
-T Coordinate<T>::distanceTo(const Coordinate<T> &other) const {
-    T dx = x - other.x;
-    dx = dx * dx;
-    T dy = y - other.y;
-    dy = dy * dy;
-    return sqrt(dx + dy);
+template <class T, size_t N>
+T Coordinate<T, N>::distanceTo(const Coordinate<T, N> &other) const {
+    return sqrt(squaredDistanceTo(other));
 }
 
 // Doctest unit tests for distanceTo
@@ -119,4 +219,48 @@ TEST_CASE("testing Coordinate<T>::distanceTo") {
     Coordinate<long double> f6(-3.0L, -2.0L);
     // distance should be approx 7.071
     CHECK(f5.distanceTo(f6) == doctest::Approx(7.071));
-}
\ No newline at end of file
+}
+
+// Doctest unit tests for N-dimensional coordinates
+TEST_CASE("testing Coordinate<T, N>") {
+    static_assert(Coordinate<float>::dimension() == 2u, "two by default");
+    static_assert(Coordinate<double, 128>::dimension() == 128u, "constexpr");
+
+    Coordinate<double, 3> a(1.0, 2.0, 3.0);
+    Coordinate<double, 3> b(4.0, 6.0, 3.0);
+    CHECK(a.squaredDistanceTo(b) == 25.0);
+    CHECK(a.distanceTo(b) == 5.0);
+    CHECK(a.get(2) == 3.0);
+    a.set(2, 15.0);
+    CHECK(a.squaredDistanceTo(b) == 169.0);
+
+    // from an array, with every element filled
+    std::array<float, 16> ones;
+    ones.fill(1.0f);
+    Coordinate<float, 16> c(ones), origin;
+    CHECK(c.squaredDistanceTo(origin) == 16.0f);
+    CHECK(c.distanceTo(origin) == 4.0f);
+    CHECK(c.data()[15] == 1.0f);
+
+    // 2D coordinates are unchanged
+    Coordinate<long double> d(3.0L, 4.0L);
+    CHECK(d.getX() == 3.0L);
+    CHECK(d.getY() == 4.0L);
+    CHECK(d.squaredDistanceTo(Coordinate<long double>()) == 25.0L);
+
+    // check exception handling
+    bool flag = true;
+    try {
+        a.get(3);       // should throw an exception
+        flag = false;   // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        a.set(3, 0.0);  // should throw an exception
+        flag = false;   // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+}
@@ -0,0 +1,420 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <doctest.h>
+#include "Coordinate.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define COORDINATE_BATCH_X86 1
+#endif
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief CMP 246 Module 1 batch of (x, y) coordinates.
+ *
+ * This class holds many coordinates in structure-of-arrays form: all of the
+ * x-values are stored together in one array, and all of the y-values in
+ * another. Loops over a batch can then load several x-values (or y-values)
+ * at once into one vector register, which is what the SIMD kernels below
+ * rely on. Like Coordinate, the class is templated on the element type.
+ */
+template <class T> class CoordinateBatch {
+public:
+    /**
+     * @brief Default constructor.
+     *
+     * Create an empty batch.
+     */
+    CoordinateBatch() : xs(), ys() { }
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * Create a batch of n coordinates, each set to (0, 0).
+     *
+     * @param n Number of coordinates in the batch.
+     */
+    CoordinateBatch(size_t n) : xs(n), ys(n) { }
+
+    /**
+     * @brief Change the batch size.
+     *
+     * New coordinates are set to (0, 0).
+     *
+     * @param n New number of coordinates in the batch.
+     */
+    void resize(size_t n) { xs.resize(n); ys.resize(n); }
+
+    /**
+     * @brief Get batch size.
+     *
+     * @return The number of coordinates in the batch.
+     */
+    size_t size() const { return xs.size(); }
+
+    /**
+     * @brief Accessor for the x-values.
+     *
+     * @return Pointer to the first of size() contiguous x-values.
+     */
+    T *getXs() { return xs.data(); }
+
+    /**
+     * @brief Accessor for the x-values.
+     *
+     * @return Pointer to the first of size() contiguous x-values.
+     */
+    const T *getXs() const { return xs.data(); }
+
+    /**
+     * @brief Accessor for the y-values.
+     *
+     * @return Pointer to the first of size() contiguous y-values.
+     */
+    T *getYs() { return ys.data(); }
+
+    /**
+     * @brief Accessor for the y-values.
+     *
+     * @return Pointer to the first of size() contiguous y-values.
+     */
+    const T *getYs() const { return ys.data(); }
+
+    /**
+     * @brief Get one coordinate.
+     *
+     * @param idx Index of the coordinate to get.
+     *
+     * @throws std::out_of_range if idx is past the end of the batch.
+     *
+     * @return Coordinate at location idx in the batch.
+     */
+    Coordinate<T> get(size_t idx) const;
+
+    /**
+     * @brief Change one coordinate.
+     *
+     * @param idx Index of the coordinate to change.
+     * @param c New value for the coordinate.
+     *
+     * @throws std::out_of_range if idx is past the end of the batch.
+     */
+    void set(size_t idx, const Coordinate<T> &c);
+
+private:
+    /**
+     * X-values of the coordinates.
+     */
+    std::vector<T> xs;
+
+    /**
+     * Y-values of the coordinates.
+     */
+    std::vector<T> ys;
+};
+
+/*-----------------------------------------------------------------------------
+ * method implementations
+ *---------------------------------------------------------------------------*/
+
+/*
+ * Get the coordinate at location idx.
+ */
+template <class T>
+Coordinate<T> CoordinateBatch<T>::get(size_t idx) const {
+    if(idx >= xs.size()) {
+        throw std::out_of_range("Index out of range in CoordinateBatch::get()");
+    }
+
+    return Coordinate<T>(xs[idx], ys[idx]);
+}
+
+/*
+ * Change the coordinate at location idx.
+ */
+template <class T>
+void CoordinateBatch<T>::set(size_t idx, const Coordinate<T> &c) {
+    if(idx >= xs.size()) {
+        throw std::out_of_range("Index out of range in CoordinateBatch::set()");
+    }
+
+    xs[idx] = c.getX();
+    ys[idx] = c.getY();
+}
+
+// doctest unit tests for get and set
+TEST_CASE("testing CoordinateBatch<T>::get and set") {
+    CoordinateBatch<double> batch(3);
+    CHECK(batch.size() == 3u);
+
+    // new coordinates are (0, 0)
+    CHECK(batch.get(2).getX() == 0.0);
+
+    // values are stored in the separate arrays
+    batch.set(1, Coordinate<double>(2.0, 3.0));
+    CHECK(batch.get(1).getX() == 2.0);
+    CHECK(batch.get(1).getY() == 3.0);
+    CHECK(batch.getXs()[1] == 2.0);
+    CHECK(batch.getYs()[1] == 3.0);
+
+    // check exception handling
+    bool flag = true;
+    try {
+        batch.get(3);   // should throw an exception
+        flag = false;   // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * unit circle kernels
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Instruction sets the unit circle kernels can use.
+ */
+enum SimdLevel { SIMD_SCALAR, SIMD_AVX2, SIMD_AVX512 };
+
+/**
+ * @brief Detect the best instruction set on this processor.
+ *
+ * @return Widest instruction set supported by both the processor and the
+ * kernels. The answer is computed once and cached.
+ */
+inline SimdLevel detectSimd() {
+#ifdef COORDINATE_BATCH_X86
+    static const SimdLevel level =
+        __builtin_cpu_supports("avx512f") ? SIMD_AVX512 :
+        __builtin_cpu_supports("avx2") ? SIMD_AVX2 : SIMD_SCALAR;
+    return level;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+/**
+ * @brief Count coordinates inside the unit circle, one at a time.
+ *
+ * Portable kernel; counts the i for which xs[i]^2 + ys[i]^2 < 1.
+ *
+ * @param xs Pointer to the x-values.
+ * @param ys Pointer to the y-values.
+ * @param n Number of coordinates.
+ *
+ * @return Number of coordinates strictly inside the unit circle.
+ */
+template <class T>
+uint64_t countInsideUnitScalar(const T *xs, const T *ys, size_t n) {
+    uint64_t hits = 0u;
+    for(size_t i = 0u; i < n; i++) {
+        hits += (xs[i] * xs[i] + ys[i] * ys[i] < T(1));
+    }
+
+    return hits;
+}
+
+#ifdef COORDINATE_BATCH_X86
+/**
+ * @brief AVX2 version of countInsideUnitScalar() for floats.
+ *
+ * Must only be called if detectSimd() returns SIMD_AVX2 or better.
+ */
+__attribute__((target("avx2")))
+inline uint64_t countInsideUnitAvx2(const float *xs, const float *ys,
+    size_t n) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    uint64_t hits = 0u;
+    size_t i = 0u;
+    for(; i + 8u <= n; i += 8u) {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256 d = _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y));
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(d, one, _CMP_LT_OQ));
+        hits += __builtin_popcount(mask);
+    }
+
+    return hits + countInsideUnitScalar(xs + i, ys + i, n - i);
+}
+
+/**
+ * @brief AVX2 version of countInsideUnitScalar() for doubles.
+ *
+ * Must only be called if detectSimd() returns SIMD_AVX2 or better.
+ */
+__attribute__((target("avx2")))
+inline uint64_t countInsideUnitAvx2(const double *xs, const double *ys,
+    size_t n) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    uint64_t hits = 0u;
+    size_t i = 0u;
+    for(; i + 4u <= n; i += 4u) {
+        __m256d x = _mm256_loadu_pd(xs + i);
+        __m256d y = _mm256_loadu_pd(ys + i);
+        __m256d d = _mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y));
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(d, one, _CMP_LT_OQ));
+        hits += __builtin_popcount(mask);
+    }
+
+    return hits + countInsideUnitScalar(xs + i, ys + i, n - i);
+}
+
+/**
+ * @brief AVX-512 version of countInsideUnitScalar() for floats.
+ *
+ * Must only be called if detectSimd() returns SIMD_AVX512.
+ */
+__attribute__((target("avx512f")))
+inline uint64_t countInsideUnitAvx512(const float *xs, const float *ys,
+    size_t n) {
+    const __m512 one = _mm512_set1_ps(1.0f);
+    uint64_t hits = 0u;
+    for(size_t i = 0u; i < n; i += 16u) {
+        __mmask16 live = (n - i >= 16u) ? __mmask16(0xFFFF) :
+            __mmask16((1u << (n - i)) - 1u);
+        __m512 x = _mm512_maskz_loadu_ps(live, xs + i);
+        __m512 y = _mm512_maskz_loadu_ps(live, ys + i);
+        __m512 d = _mm512_add_ps(_mm512_mul_ps(x, x), _mm512_mul_ps(y, y));
+        __mmask16 in = _mm512_mask_cmp_ps_mask(live, d, one, _CMP_LT_OQ);
+        hits += __builtin_popcount(in);
+    }
+
+    return hits;
+}
+
+/**
+ * @brief AVX-512 version of countInsideUnitScalar() for doubles.
+ *
+ * Must only be called if detectSimd() returns SIMD_AVX512.
+ */
+__attribute__((target("avx512f")))
+inline uint64_t countInsideUnitAvx512(const double *xs, const double *ys,
+    size_t n) {
+    const __m512d one = _mm512_set1_pd(1.0);
+    uint64_t hits = 0u;
+    for(size_t i = 0u; i < n; i += 8u) {
+        __mmask8 live = (n - i >= 8u) ? __mmask8(0xFF) :
+            __mmask8((1u << (n - i)) - 1u);
+        __m512d x = _mm512_maskz_loadu_pd(live, xs + i);
+        __m512d y = _mm512_maskz_loadu_pd(live, ys + i);
+        __m512d d = _mm512_add_pd(_mm512_mul_pd(x, x), _mm512_mul_pd(y, y));
+        __mmask8 in = _mm512_mask_cmp_pd_mask(live, d, one, _CMP_LT_OQ);
+        hits += __builtin_popcount(in);
+    }
+
+    return hits;
+}
+#endif
+
+/**
+ * @brief Count coordinates inside the unit circle.
+ *
+ * Counts the coordinates in the batch that are strictly inside the unit
+ * circle centered on the origin. The squared distance is compared against
+ * one, so no square roots are taken. Float and double batches are counted
+ * with the widest SIMD kernel the processor supports: the comparison of a
+ * whole register of coordinates produces a bit mask, and the set bits of
+ * the mask are counted with one population count instruction. Other types
+ * use the scalar kernel.
+ *
+ * @param batch Batch of coordinates to test.
+ *
+ * @return Number of coordinates strictly inside the unit circle.
+ */
+template <class T>
+uint64_t countInsideUnit(const CoordinateBatch<T> &batch) {
+    return countInsideUnitScalar(batch.getXs(), batch.getYs(), batch.size());
+}
+
+/*
+ * Pick the float kernel for this processor.
+ */
+template <>
+inline uint64_t countInsideUnit<float>(const CoordinateBatch<float> &batch) {
+#ifdef COORDINATE_BATCH_X86
+    switch(detectSimd()) {
+    case SIMD_AVX512:
+        return countInsideUnitAvx512(batch.getXs(), batch.getYs(),
+            batch.size());
+    case SIMD_AVX2:
+        return countInsideUnitAvx2(batch.getXs(), batch.getYs(),
+            batch.size());
+    default:
+        break;
+    }
+#endif
+    return countInsideUnitScalar(batch.getXs(), batch.getYs(), batch.size());
+}
+
+/*
+ * Pick the double kernel for this processor.
+ */
+template <>
+inline uint64_t countInsideUnit<double>(const CoordinateBatch<double> &batch) {
+#ifdef COORDINATE_BATCH_X86
+    switch(detectSimd()) {
+    case SIMD_AVX512:
+        return countInsideUnitAvx512(batch.getXs(), batch.getYs(),
+            batch.size());
+    case SIMD_AVX2:
+        return countInsideUnitAvx2(batch.getXs(), batch.getYs(),
+            batch.size());
+    default:
+        break;
+    }
+#endif
+    return countInsideUnitScalar(batch.getXs(), batch.getYs(), batch.size());
+}
+
+/*
+ * Check one kernel against the scalar kernel, for several batch sizes so
+ * that every tail length is covered.
+ */
+template <class T, class K>
+void checkKernel(K kernel) {
+    for(size_t n = 0; n <= 40; n++) {
+        CoordinateBatch<T> batch(n);
+        for(size_t i = 0; i < n; i++) {
+            // a grid of points on both sides of the circle
+            batch.set(i, Coordinate<T>(T(i % 7) / 6, T(i % 5) / 4));
+        }
+        CHECK(kernel(batch.getXs(), batch.getYs(), n) ==
+            countInsideUnitScalar(batch.getXs(), batch.getYs(), n));
+    }
+}
+
+// doctest unit tests for the unit circle kernels
+TEST_CASE("testing countInsideUnit") {
+    CoordinateBatch<float> batchF(4);
+    batchF.set(0, Coordinate<float>(0.5f, 0.5f));     // inside
+    batchF.set(1, Coordinate<float>(1.0f, 0.0f));     // on the circle
+    batchF.set(2, Coordinate<float>(-0.9f, 0.1f));    // inside
+    batchF.set(3, Coordinate<float>(0.8f, 0.8f));     // outside
+    CHECK(countInsideUnit(batchF) == 2u);
+
+    CoordinateBatch<long double> batchLD(2);
+    batchLD.set(0, Coordinate<long double>(0.1L, 0.2L));
+    CHECK(countInsideUnit(batchLD) == 2u);
+
+    // every kernel the processor supports agrees with the scalar kernel
+    checkKernel<float>(countInsideUnitScalar<float>);
+    checkKernel<double>(countInsideUnitScalar<double>);
+#ifdef COORDINATE_BATCH_X86
+    typedef uint64_t (*KernelF)(const float *, const float *, size_t);
+    typedef uint64_t (*KernelD)(const double *, const double *, size_t);
+    if(detectSimd() >= SIMD_AVX2) {
+        checkKernel<float>(KernelF(countInsideUnitAvx2));
+        checkKernel<double>(KernelD(countInsideUnitAvx2));
+    }
+    if(detectSimd() >= SIMD_AVX512) {
+        checkKernel<float>(KernelF(countInsideUnitAvx512));
+        checkKernel<double>(KernelD(countInsideUnitAvx512));
+    }
+#endif
+}
@@ -0,0 +1,4 @@
+// phantom C++ file for CoordinateBatch unit testing. This file only includes 
+// the CoordinateBatch header; doctest generates the testing program based on 
+// unit tests written alongside the code in the header file
+#include "CoordinateBatch.hpp"
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "DistanceMatrix.hpp"
+#include "Rng.hpp"
+
+/**
+ * Helper function to time a distance matrix of N-dimensional coordinates,
+ * first pair by pair with squaredDistanceTo(), then with the blocked 
+ * kernel, and print the throughput of each.
+ */
+template <class T, size_t N>
+void benchMatrix(size_t n, size_t m) {
+    Xoshiro256ss prng(246u);
+    std::vector<Coordinate<T, N> > as(n), bs(m);
+    for(size_t i = 0u; i < n; i++) {
+        for(size_t d = 0u; d < N; d++) {
+            as[i].set(d, unitReal<T>(prng()));
+        }
+    }
+    for(size_t j = 0u; j < m; j++) {
+        for(size_t d = 0u; d < N; d++) {
+            bs[j].set(d, unitReal<T>(prng()));
+        }
+    }
+    std::vector<T> out(n * m);
+
+    // pair by pair
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0u; i < n; i++) {
+        for(size_t j = 0u; j < m; j++) {
+            out[i * m + j] = as[i].squaredDistanceTo(bs[j]);
+        }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double naive = std::chrono::duration<double>(stop - start).count();
+    T check = out[n * m - 1u];
+
+    // blocked
+    start = std::chrono::steady_clock::now();
+    squaredDistanceMatrix(as.data(), n, bs.data(), m, out.data());
+    stop = std::chrono::steady_clock::now();
+    double blocked = std::chrono::duration<double>(stop - start).count();
+
+    double pairs = double(n) * m;
+    std::cout << "N = " << N << ", " << n << " x " << m << ": pairwise " <<
+        pairs / naive / 1e6 << " M/s, blocked " << pairs / blocked / 1e6 <<
+        " M/s (" << 3.0 * N * pairs / blocked / 1e9 << " GFLOP/s)" <<
+        (std::fabs(check - out[n * m - 1u]) <= T(1e-4) * check ? "" :
+        " MISMATCH") << std::endl;
+}
+
+/**
+ * @brief Benchmark for the distance matrix kernels.
+ * 
+ * This program times n x m squared distance matrices for N = 2, 3, 16, and
+ * 128, with float and double coordinates, computing the same number of
+ * element differences for each N.
+ */
+int main() {
+    std::cout << "float" << std::endl;
+    benchMatrix<float, 2>(2048u, 16384u);
+    benchMatrix<float, 3>(2048u, 16384u);
+    benchMatrix<float, 16>(1024u, 4096u);
+    benchMatrix<float, 128>(256u, 2048u);
+
+    std::cout << "double" << std::endl;
+    benchMatrix<double, 2>(2048u, 16384u);
+    benchMatrix<double, 3>(2048u, 16384u);
+    benchMatrix<double, 16>(1024u, 4096u);
+    benchMatrix<double, 128>(256u, 2048u);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <doctest.h>
+#include "Coordinate.hpp"
+
+/*-----------------------------------------------------------------------------
+ * declarations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Squared distances from one coordinate to many.
+ *
+ * Set out[j] to the squared Euclidean distance from query to points[j], for
+ * j from 0 to m - 1. This is squaredDistanceMatrix() with a single row.
+ *
+ * @param query Coordinate to measure from.
+ * @param points Array of m coordinates to measure to.
+ * @param m Number of coordinates in points.
+ * @param out Array of m values to receive the squared distances.
+ */
+template <class T, size_t N>
+void squaredDistancesFrom(const Coordinate<T, N> &query,
+    const Coordinate<T, N> *points, size_t m, T *out);
+
+/**
+ * @brief Matrix of squared distances between two sets of coordinates.
+ *
+ * Set out[i * m + j] to the squared Euclidean distance from as[i] to bs[j],
+ * for every i from 0 to n - 1 and j from 0 to m - 1. Take the square root of
+ * an element for the distance itself.
+ *
+ * The columns are processed in blocks of about 16 KiB of coordinates. Each
+ * block is copied once into a transposed layout, one array per element,
+ * and then every row is computed against it while it stays in L1, so the
+ * innermost loop runs over consecutive columns and vectorizes for any N.
+ * For float and double the row kernel is compiled for AVX-512, AVX2, and
+ * baseline processors, and the best one is picked when the program starts.
+ *
+ * @param as Array of n coordinates, one per row.
+ * @param n Number of coordinates in as.
+ * @param bs Array of m coordinates, one per column.
+ * @param m Number of coordinates in bs.
+ * @param out Array of n * m values to receive the squared distances, in
+ * row-major order.
+ */
+template <class T, size_t N>
+void squaredDistanceMatrix(const Coordinate<T, N> *as, size_t n,
+    const Coordinate<T, N> *bs, size_t m, T *out);
+
+/*-----------------------------------------------------------------------------
+ * function implementations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Helper function to compute one row of squared distances against a block
+ * of columns in transposed layout: element d of column j is
+ * packed[d * stride + j].
+ */
+template <class T>
+inline void accumulateRow(const T *__restrict a, const T *__restrict packed,
+    size_t dims, size_t stride, size_t width, T *__restrict out) {
+    // two elements per pass over the row, and no separate zeroing pass, so
+    // a 2D row is written exactly once
+    size_t d = 0u;
+    if(dims % 2u != 0u) {
+        T a0 = a[0];
+        const T *__restrict c0 = packed;
+        for(size_t j = 0u; j < width; j++) {
+            T d0 = a0 - c0[j];
+            out[j] = d0 * d0;
+        }
+        d = 1u;
+    } else {
+        T a0 = a[0], a1 = a[1];
+        const T *__restrict c0 = packed;
+        const T *__restrict c1 = packed + stride;
+        for(size_t j = 0u; j < width; j++) {
+            T d0 = a0 - c0[j];
+            T d1 = a1 - c1[j];
+            out[j] = d0 * d0 + d1 * d1;
+        }
+        d = 2u;
+    }
+    for(; d < dims; d += 2u) {
+        T a0 = a[d], a1 = a[d + 1u];
+        const T *__restrict c0 = packed + d * stride;
+        const T *__restrict c1 = c0 + stride;
+        for(size_t j = 0u; j < width; j++) {
+            T d0 = a0 - c0[j];
+            T d1 = a1 - c1[j];
+            out[j] += d0 * d0 + d1 * d1;
+        }
+    }
+}
+
+/**
+ * Row kernel for types without a vector version.
+ */
+template <class T>
+void squaredDistanceRow(const T *a, const T *packed, size_t dims,
+    size_t stride, size_t width, T *out) {
+    accumulateRow(a, packed, dims, stride, width, out);
+}
+
+/**
+ * Row kernel for float, compiled for each vector instruction set.
+ */
+__attribute__((target_clones("avx512f", "avx2", "default")))
+void squaredDistanceRow(const float *a, const float *packed, size_t dims,
+    size_t stride, size_t width, float *out) {
+    accumulateRow(a, packed, dims, stride, width, out);
+}
+
+/**
+ * Row kernel for double, compiled for each vector instruction set.
+ */
+__attribute__((target_clones("avx512f", "avx2", "default")))
+void squaredDistanceRow(const double *a, const double *packed, size_t dims,
+    size_t stride, size_t width, double *out) {
+    accumulateRow(a, packed, dims, stride, width, out);
+}
+
+/*
+ * One row of the matrix.
+ */
+template <class T, size_t N>
+void squaredDistancesFrom(const Coordinate<T, N> &query,
+    const Coordinate<T, N> *points, size_t m, T *out) {
+    squaredDistanceMatrix(&query, 1u, points, m, out);
+}
+
+/*
+ * Pack a block of columns, then sweep every row over it.
+ */
+template <class T, size_t N>
+void squaredDistanceMatrix(const Coordinate<T, N> *as, size_t n,
+    const Coordinate<T, N> *bs, size_t m, T *out) {
+    // about 16 KiB of columns per block, in multiples of 16
+    const size_t FIT = 16384u / (N * sizeof(T)) / 16u * 16u;
+    const size_t BLOCK = FIT > 16u ? FIT : 16u;
+    std::vector<T> packed(N * BLOCK);
+
+    for(size_t j0 = 0u; j0 < m; j0 += BLOCK) {
+        size_t width = (m - j0 < BLOCK) ? m - j0 : BLOCK;
+        for(size_t j = 0u; j < width; j++) {
+            const T *b = bs[j0 + j].data();
+            for(size_t d = 0u; d < N; d++) {
+                packed[d * BLOCK + j] = b[d];
+            }
+        }
+
+        for(size_t i = 0u; i < n; i++) {
+            squaredDistanceRow(as[i].data(), packed.data(), N, BLOCK, width,
+                out + i * m + j0);
+        }
+    }
+}
+
+/**
+ * Helper function for the tests: compare the matrix for two sets of
+ * pseudo-random coordinates with pairwise squaredDistanceTo().
+ */
+template <class T, size_t N>
+void checkMatrix(size_t n, size_t m) {
+    std::vector<Coordinate<T, N> > as(n), bs(m);
+    unsigned state = 12345u;
+    for(size_t i = 0u; i < n + m; i++) {
+        for(size_t d = 0u; d < N; d++) {
+            state = state * 1103515245u + 12345u;
+            T value = T(state >> 16) / 65536 - T(0.5);
+            if(i < n) {
+                as[i].set(d, value);
+            } else {
+                bs[i - n].set(d, value);
+            }
+        }
+    }
+
+    std::vector<T> out(n * m);
+    squaredDistanceMatrix(as.data(), n, bs.data(), m, out.data());
+    for(size_t i = 0u; i < n; i++) {
+        for(size_t j = 0u; j < m; j++) {
+            CHECK(out[i * m + j] ==
+                doctest::Approx(as[i].squaredDistanceTo(bs[j])));
+        }
+    }
+
+    std::vector<T> row(m);
+    squaredDistancesFrom(as[n - 1u], bs.data(), m, row.data());
+    for(size_t j = 0u; j < m; j++) {
+        CHECK(row[j] == out[(n - 1u) * m + j]);
+    }
+}
+
+// doctest unit tests for the distance matrices
+TEST_CASE("testing squaredDistanceMatrix") {
+    // column counts that end mid-block, for each element type
+    checkMatrix<float, 2>(5u, 1000u);
+    checkMatrix<double, 3>(7u, 700u);
+    checkMatrix<long double, 3>(3u, 300u);
+    checkMatrix<float, 16>(4u, 131u);
+    checkMatrix<double, 128>(3u, 37u);
+
+    // distances from a point to itself are zero
+    Coordinate<double, 2> pts[3] = { Coordinate<double, 2>(0.0, 0.0),
+        Coordinate<double, 2>(3.0, 4.0), Coordinate<double, 2>(-3.0, 0.0) };
+    double out[9];
+    squaredDistanceMatrix(pts, 3u, pts, 3u, out);
+    CHECK(out[0] == 0.0);
+    CHECK(out[1] == 25.0);
+    CHECK(out[2] == 9.0);
+    CHECK(out[4] == 0.0);
+    CHECK(out[5] == 52.0);
+    CHECK(out[8] == 0.0);
+}
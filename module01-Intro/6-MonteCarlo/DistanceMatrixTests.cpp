@@ -0,0 +1,4 @@
+// phantom C++ file for DistanceMatrix unit testing. This file only includes
+// the DistanceMatrix header; doctest generates the testing program based on
+// unit tests written alongside the code in the header file
+#include "DistanceMatrix.hpp"
\ No newline at end of file
@@ -0,0 +1,562 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <doctest.h>
+#include "Coordinate.hpp"
+#include "Rng.hpp"
+
+/*-----------------------------------------------------------------------------
+ * declarations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Result of a Monte Carlo integration.
+ *
+ * Holds the number of samples taken, the estimate of the integral with its
+ * standard error, and how long the run took.
+ */
+struct IntegralEstimate {
+    /** Number of samples taken. */
+    uint64_t samples;
+
+    /** Estimate of the integral. */
+    long double value;
+
+    /** Standard error of the estimate. */
+    long double stdError;
+
+    /** Wall clock time for the run, in seconds. */
+    double seconds;
+
+    /**
+     * @brief Throughput of the run.
+     *
+     * @return Samples taken per second.
+     */
+    double samplesPerSecond() const {
+        return seconds > 0.0 ? samples / seconds : 0.0;
+    }
+};
+
+/**
+ * @brief Parallel Monte Carlo integral over a box.
+ *
+ * Estimate the integral of f over the N-dimensional box from lower to upper
+ * by averaging f at n uniformly random points, split evenly over numThreads
+ * threads. Points are passed to f as Coordinate<T, N>. Because N is a
+ * compile-time constant, the loops over the dimensions unroll completely,
+ * and a simple integrand inlines into the sampling loop.
+ *
+ * Sample i takes its coordinates from Philox4x32 block i of the seed's
+ * streams, one stream for each pair of dimensions. The samples are summed
+ * in fixed chunks, and the chunk sums are added in chunk order, so the same
+ * seed gives exactly the same result for any number of threads.
+ *
+ * @param f Integrand, callable with a const Coordinate<T, N> & and returning
+ * a value convertible to double. An integrand returning bool is treated as
+ * an indicator, and its hits are counted with integer arithmetic.
+ * @param lower Lower corner of the box.
+ * @param upper Upper corner of the box.
+ * @param n Number of samples.
+ * @param seed Seed for the random streams.
+ * @param numThreads Number of threads to use, or 0 to use one thread per
+ * hardware core.
+ *
+ * @return Samples, estimate, standard error, and elapsed time.
+ */
+template <class T, size_t N, class F>
+IntegralEstimate integrate(F f, const Coordinate<T, N> &lower,
+    const Coordinate<T, N> &upper, uint64_t n, uint64_t seed,
+    unsigned numThreads = 0u);
+
+/**
+ * @brief Parallel Monte Carlo volume of a region.
+ *
+ * Estimate the volume of the part of the box from lower to upper where
+ * inside is true, by integrating its indicator with integrate().
+ *
+ * @param inside Predicate, callable with a const Coordinate<T, N> &.
+ * @param lower Lower corner of the box.
+ * @param upper Upper corner of the box.
+ * @param n Number of samples.
+ * @param seed Seed for the random streams.
+ * @param numThreads Number of threads to use, or 0 to use one thread per
+ * hardware core.
+ *
+ * @return Samples, estimate, standard error, and elapsed time.
+ */
+template <class T, size_t N, class P>
+IntegralEstimate estimateVolume(P inside, const Coordinate<T, N> &lower,
+    const Coordinate<T, N> &upper, uint64_t n, uint64_t seed,
+    unsigned numThreads = 0u);
+
+/**
+ * @brief Parallel stratified Monte Carlo integral over a box.
+ *
+ * Split each side of the box into strata equal parts, giving strata^N
+ * cells, and average f at perStratum uniformly random points in each cell.
+ * The integral is the sum of the cell estimates, and its variance is the
+ * sum of the cell variances, so a smooth integrand gets a much smaller
+ * error than from the same number of unstratified samples. The cells are
+ * split evenly over numThreads threads. As in integrate(), the cell
+ * estimates are summed in fixed chunks added in chunk order, so the result
+ * is exactly the same for any number of threads.
+ *
+ * @param f Integrand, callable with a const Coordinate<T, N> & and returning
+ * a value convertible to double.
+ * @param lower Lower corner of the box.
+ * @param upper Upper corner of the box.
+ * @param strata Number of parts to split each side into.
+ * @param perStratum Number of samples in each cell.
+ * @param seed Seed for the random streams.
+ * @param numThreads Number of threads to use, or 0 to use one thread per
+ * hardware core.
+ *
+ * @return Samples, estimate, standard error, and elapsed time.
+ *
+ * @throws std::invalid_argument if strata is zero, strata^N is more than
+ * 2^32, or perStratum is less than 2.
+ */
+template <class T, size_t N, class F>
+IntegralEstimate integrateStratified(F f, const Coordinate<T, N> &lower,
+    const Coordinate<T, N> &upper, unsigned strata, uint64_t perStratum,
+    uint64_t seed, unsigned numThreads = 0u);
+
+/*-----------------------------------------------------------------------------
+ * function implementations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Helper class holding one batch of sample points, one column per
+ * dimension, and the running sums of the integrand over them.
+ */
+template <class T, size_t N>
+class SampleBatch {
+public:
+    /** Samples per batch; about 32 KiB of coordinates for doubles. */
+    static const size_t SIZE = 4096u / N > 64u ? 4096u / N : 64u;
+
+    SampleBatch() : cols(N * SIZE), words(4u * SIZE), sum(0.0), sumSq(0.0) { }
+
+    /**
+     * Fill the first n points with samples first through first + n - 1,
+     * mapping dimension d from [0, 1) to [lo[d], lo[d] + scale[d]).
+     */
+    void fill(uint64_t seed, uint64_t first, size_t n,
+        const std::array<T, N> &lo, const std::array<T, N> &scale) {
+        const uint32_t key[2] = { uint32_t(seed), uint32_t(seed >> 32) };
+        uint32_t *const pWords[4] = { words.data(), words.data() + SIZE,
+            words.data() + 2u * SIZE, words.data() + 3u * SIZE };
+
+        // each Philox block holds two 64-bit values, for two dimensions
+        for(size_t q = 0u; 2u * q < N; q++) {
+            Philox4x32::blocks(first, q, key, n, pWords);
+            T *x = &cols[2u * q * SIZE];
+            for(size_t j = 0u; j < n; j++) {
+                x[j] = lo[2u * q] + scale[2u * q] * unitReal<T>(pWords[0][j] |
+                    (uint64_t(pWords[1][j]) << 32));
+            }
+            if(2u * q + 1u < N) {
+                T *y = &cols[(2u * q + 1u) * SIZE];
+                for(size_t j = 0u; j < n; j++) {
+                    y[j] = lo[2u * q + 1u] + scale[2u * q + 1u] *
+                        unitReal<T>(pWords[2][j] |
+                        (uint64_t(pWords[3][j]) << 32));
+                }
+            }
+        }
+    }
+
+    /** Add f at the first n points to the running sums. */
+    template <class F>
+    void evaluate(F &f, size_t n) {
+        typedef decltype(f(std::declval<const Coordinate<T, N> &>())) R;
+        evaluate(f, n, typename std::is_same<R, bool>::type());
+    }
+
+    /** Copy point j out of the columns. */
+    Coordinate<T, N> point(size_t j) const {
+        std::array<T, N> p;
+        for(size_t d = 0u; d < N; d++) {
+            p[d] = cols[d * SIZE + j];
+        }
+        return Coordinate<T, N>(p);
+    }
+
+    /**
+     * Add f at the first n points, for a predicate f. The hits are counted
+     * as integers, which vectorizes; the sum of squares equals the sum.
+     */
+    template <class F>
+    void evaluate(F &f, size_t n, std::true_type) {
+        uint64_t hits = 0u;
+        for(size_t j = 0u; j < n; j++) {
+            hits += f(point(j));
+        }
+        sum += hits;
+        sumSq += hits;
+    }
+
+    /**
+     * Add f at the first n points, for a general f. Four sets of partial
+     * sums keep four additions in flight instead of one.
+     */
+    template <class F>
+    void evaluate(F &f, size_t n, std::false_type) {
+        double s[4] = { 0.0, 0.0, 0.0, 0.0 };
+        double s2[4] = { 0.0, 0.0, 0.0, 0.0 };
+        size_t j = 0u;
+        for(; j + 4u <= n; j += 4u) {
+            for(size_t k = 0u; k < 4u; k++) {
+                double v = f(point(j + k));
+                s[k] += v;
+                s2[k] += v * v;
+            }
+        }
+        for(; j < n; j++) {
+            double v = f(point(j));
+            s[0] += v;
+            s2[0] += v * v;
+        }
+        sum += (s[0] + s[1]) + (s[2] + s[3]);
+        sumSq += (s2[0] + s2[1]) + (s2[2] + s2[3]);
+    }
+
+    /** Coordinates, column by column. */
+    std::vector<T> cols;
+
+    /** Philox output for one pair of columns. */
+    std::vector<uint32_t> words;
+
+    /** Running sum of the integrand. */
+    double sum;
+
+    /** Running sum of the squared integrand. */
+    double sumSq;
+};
+
+template <class T, size_t N>
+const size_t SampleBatch<T, N>::SIZE;
+
+/**
+ * Helper function to count the threads runParallel() will use.
+ */
+inline unsigned threadCount(unsigned numThreads) {
+    if(numThreads == 0u) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    return numThreads == 0u ? 1u : numThreads;
+}
+
+/**
+ * Helper function to run work(t, first, last) on numThreads threads, with
+ * the range from 0 to count split evenly between them.
+ */
+template <class W>
+void runParallel(uint64_t count, unsigned numThreads, W work) {
+    numThreads = threadCount(numThreads);
+
+    std::vector<std::thread> threads;
+    uint64_t slice = count / numThreads;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        uint64_t first = t * slice;
+        uint64_t last = (t == numThreads - 1u) ? count : first + slice;
+        threads.push_back(std::thread([&work, t, first, last]() {
+            work(t, first, last);
+        }));
+    }
+    for(unsigned t = 0u; t < numThreads; t++) {
+        threads[t].join();
+    }
+}
+
+/**
+ * Helper function to pick how many units go in each chunk of a sum over
+ * count units. It depends only on count, never on the number of threads, so
+ * adding the chunk sums in chunk order always rounds the same way.
+ */
+inline uint64_t chunkUnits(uint64_t count) {
+    const uint64_t MAX_CHUNKS = 4096u;
+    uint64_t units = (count + MAX_CHUNKS - 1u) / MAX_CHUNKS;
+    return units == 0u ? 1u : units;
+}
+
+/*
+ * Average the integrand over uniform samples, one batch at a time per thread,
+ * with one partial sum per chunk of batches.
+ */
+template <class T, size_t N, class F>
+IntegralEstimate integrate(F f, const Coordinate<T, N> &lower,
+    const Coordinate<T, N> &upper, uint64_t n, uint64_t seed,
+    unsigned numThreads) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::array<T, N> lo, width;
+    long double volume = 1.0L;
+    for(size_t d = 0u; d < N; d++) {
+        lo[d] = lower.get(d);
+        width[d] = upper.get(d) - lo[d];
+        volume *= width[d];
+    }
+
+    // chunks are whole batches, so batch boundaries do not move either
+    const uint64_t SIZE = SampleBatch<T, N>::SIZE;
+    const uint64_t perChunk = chunkUnits((n + SIZE - 1u) / SIZE) * SIZE;
+    const uint64_t numChunks = (n + perChunk - 1u) / perChunk;
+
+    // each thread writes only the sums of its own chunks
+    std::vector<double> sums(numChunks, 0.0), sumSqs(numChunks, 0.0);
+    runParallel(numChunks, numThreads, [&](unsigned, uint64_t first,
+        uint64_t last) {
+        F local = f;
+        SampleBatch<T, N> batch;
+        for(uint64_t k = first; k < last; k++) {
+            uint64_t end = n - k * perChunk < perChunk ? n :
+                (k + 1u) * perChunk;
+            batch.sum = batch.sumSq = 0.0;
+            for(uint64_t i = k * perChunk; i < end; i += SIZE) {
+                size_t count = size_t(end - i < SIZE ? end - i : SIZE);
+                batch.fill(seed, i, count, lo, width);
+                batch.evaluate(local, count);
+            }
+            sums[k] = batch.sum;
+            sumSqs[k] = batch.sumSq;
+        }
+    });
+
+    long double sum = 0.0L, sumSq = 0.0L;
+    for(uint64_t k = 0u; k < numChunks; k++) {
+        sum += sums[k];
+        sumSq += sumSqs[k];
+    }
+
+    IntegralEstimate result = { n, 0.0L, 0.0L, 0.0 };
+    if(n > 0u) {
+        long double mean = sum / n;
+        result.value = volume * mean;
+        if(n > 1u) {
+            long double var = (sumSq - sum * mean) / (n - 1u);
+            result.stdError = volume * std::sqrt((var > 0.0L ? var : 0.0L) /
+                n);
+        }
+    }
+
+    auto stop = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(stop - start).count();
+
+    return result;
+}
+
+/*
+ * Integrate the indicator of the region.
+ */
+template <class T, size_t N, class P>
+IntegralEstimate estimateVolume(P inside, const Coordinate<T, N> &lower,
+    const Coordinate<T, N> &upper, uint64_t n, uint64_t seed,
+    unsigned numThreads) {
+    return integrate<T, N>([inside](const Coordinate<T, N> &p) {
+            return bool(inside(p));
+        }, lower, upper, n, seed, numThreads);
+}
+
+/*
+ * Estimate each cell separately and add up the estimates and variances, with
+ * one partial sum per chunk of cells.
+ */
+template <class T, size_t N, class F>
+IntegralEstimate integrateStratified(F f, const Coordinate<T, N> &lower,
+    const Coordinate<T, N> &upper, unsigned strata, uint64_t perStratum,
+    uint64_t seed, unsigned numThreads) {
+    uint64_t cells = 1u;
+    for(size_t d = 0u; d < N && strata != 0u; d++) {
+        cells *= strata;
+        if(cells > (uint64_t(1u) << 32)) {
+            break;
+        }
+    }
+    if(strata == 0u || cells > (uint64_t(1u) << 32) || perStratum < 2u) {
+        throw std::invalid_argument("bad strata in integrateStratified()");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::array<T, N> cellWidth;
+    long double cellVolume = 1.0L;
+    for(size_t d = 0u; d < N; d++) {
+        cellWidth[d] = (upper.get(d) - lower.get(d)) / strata;
+        cellVolume *= cellWidth[d];
+    }
+
+    const uint64_t perChunk = chunkUnits(cells);
+    const uint64_t numChunks = (cells + perChunk - 1u) / perChunk;
+
+    // each thread writes only the sums of its own chunks
+    std::vector<long double> values(numChunks, 0.0L);
+    std::vector<long double> variances(numChunks, 0.0L);
+    runParallel(numChunks, numThreads, [&](unsigned, uint64_t first,
+        uint64_t last) {
+        F local = f;
+        SampleBatch<T, N> batch;
+        for(uint64_t k = first; k < last; k++) {
+            uint64_t end = cells - k * perChunk < perChunk ? cells :
+                (k + 1u) * perChunk;
+            long double value = 0.0L, variance = 0.0L;
+            for(uint64_t c = k * perChunk; c < end; c++) {
+                // the digits of the cell number, base strata, give its
+                // corner
+                std::array<T, N> corner;
+                uint64_t rest = c;
+                for(size_t d = 0u; d < N; d++) {
+                    corner[d] = lower.get(d) + cellWidth[d] *
+                        T(rest % strata);
+                    rest /= strata;
+                }
+
+                batch.sum = batch.sumSq = 0.0;
+                for(uint64_t i = 0u; i < perStratum; i += batch.SIZE) {
+                    size_t count = size_t(perStratum - i < batch.SIZE ?
+                        perStratum - i : batch.SIZE);
+                    batch.fill(seed, c * perStratum + i, count, corner,
+                        cellWidth);
+                    batch.evaluate(local, count);
+                }
+
+                long double mean = batch.sum / perStratum;
+                long double var = (batch.sumSq - batch.sum * mean) /
+                    (perStratum - 1u);
+                value += cellVolume * mean;
+                variance += cellVolume * cellVolume *
+                    (var > 0.0L ? var : 0.0L) / perStratum;
+            }
+            values[k] = value;
+            variances[k] = variance;
+        }
+    });
+
+    IntegralEstimate result = { cells * perStratum, 0.0L, 0.0L, 0.0 };
+    long double variance = 0.0L;
+    for(uint64_t k = 0u; k < numChunks; k++) {
+        result.value += values[k];
+        variance += variances[k];
+    }
+    result.stdError = std::sqrt(variance);
+
+    auto stop = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(stop - start).count();
+
+    return result;
+}
+
+// doctest unit tests for the integrators
+TEST_CASE("testing integrate") {
+    // four times the area of the unit quarter circle is pi
+    const Coordinate<double, 2> lo2(0.0, 0.0), hi2(1.0, 1.0);
+    IntegralEstimate quarter = estimateVolume<double, 2>(
+        [](const Coordinate<double, 2> &p) {
+            return p.getX() * p.getX() + p.getY() * p.getY() < 1.0;
+        }, lo2, hi2, 1000000u, 246u);
+    CHECK(quarter.samples == 1000000u);
+    CHECK(4.0L * quarter.value == doctest::Approx(3.14159).epsilon(0.01));
+    CHECK(quarter.stdError > 0.0L);
+    CHECK(quarter.stdError < 0.001L);
+
+    // same seed, same samples, regardless of the number of threads
+    IntegralEstimate one = estimateVolume<double, 2>(
+        [](const Coordinate<double, 2> &p) {
+            return p.getX() * p.getX() + p.getY() * p.getY() < 1.0;
+        }, lo2, hi2, 100000u, 246u, 1u);
+    IntegralEstimate three = estimateVolume<double, 2>(
+        [](const Coordinate<double, 2> &p) {
+            return p.getX() * p.getX() + p.getY() * p.getY() < 1.0;
+        }, lo2, hi2, 100000u, 246u, 3u);
+    CHECK(one.value == three.value);
+    CHECK(one.stdError == three.stdError);
+
+    // a general integrand sums in floating point, in the same order for any
+    // number of threads, even when the threads split the chunks unevenly
+    auto ripple = [](const Coordinate<double, 2> &p) {
+        return std::sin(7.0 * p.getX()) * std::cos(3.0 * p.getY());
+    };
+    IntegralEstimate rOne = integrate<double, 2>(ripple, lo2, hi2, 1234567u,
+        5u, 1u);
+    IntegralEstimate rThree = integrate<double, 2>(ripple, lo2, hi2,
+        1234567u, 5u, 3u);
+    IntegralEstimate rEight = integrate<double, 2>(ripple, lo2, hi2,
+        1234567u, 5u, 8u);
+    CHECK(rOne.value == rThree.value);
+    CHECK(rOne.value == rEight.value);
+    CHECK(rOne.stdError == rEight.stdError);
+
+    // volume of the 5-dimensional unit ball is 8 pi^2 / 15
+    const Coordinate<float, 5> lo5(-1.0f, -1.0f, -1.0f, -1.0f, -1.0f);
+    const Coordinate<float, 5> hi5(1.0f, 1.0f, 1.0f, 1.0f, 1.0f);
+    IntegralEstimate ball = estimateVolume<float, 5>(
+        [](const Coordinate<float, 5> &p) {
+            return p.squaredDistanceTo(Coordinate<float, 5>()) < 1.0f;
+        }, lo5, hi5, 2000000u, 1u);
+    CHECK(ball.value == doctest::Approx(5.26379).epsilon(0.01));
+
+    // the mean of x * y * z over [0, 2]^3 is 1, so the integral is 8,
+    // using odd dimension counts and long doubles
+    const Coordinate<long double, 3> lo3(0.0L, 0.0L, 0.0L);
+    const Coordinate<long double, 3> hi3(2.0L, 2.0L, 2.0L);
+    IntegralEstimate xyz = integrate<long double, 3>(
+        [](const Coordinate<long double, 3> &p) {
+            return double(p.get(0) * p.get(1) * p.get(2));
+        }, lo3, hi3, 1000000u, 2u);
+    CHECK(xyz.value == doctest::Approx(8.0).epsilon(0.01));
+
+    // no samples, no estimate
+    CHECK(integrate<double, 2>([](const Coordinate<double, 2> &) {
+            return 1.0;
+        }, lo2, hi2, 0u, 1u).value == 0.0L);
+}
+
+TEST_CASE("testing integrateStratified") {
+    // the integral of x^2 + y^2 over the unit square is 2 / 3
+    const Coordinate<double, 2> lo2(0.0, 0.0), hi2(1.0, 1.0);
+    auto f = [](const Coordinate<double, 2> &p) {
+        return p.getX() * p.getX() + p.getY() * p.getY();
+    };
+    IntegralEstimate plain = integrate<double, 2>(f, lo2, hi2, 1000000u, 9u);
+    IntegralEstimate strat = integrateStratified<double, 2>(f, lo2, hi2,
+        100u, 100u, 9u);
+    CHECK(strat.samples == 1000000u);
+    CHECK(strat.value == doctest::Approx(2.0 / 3.0).epsilon(0.001));
+
+    // stratifying a smooth integrand cuts the error by far more than 10x
+    CHECK(strat.stdError * 10.0L < plain.stdError);
+    CHECK(std::fabs(strat.value - 2.0L / 3.0L) < 5.0L * strat.stdError);
+
+    // the result does not depend on the number of threads
+    IntegralEstimate one = integrateStratified<double, 2>(f, lo2, hi2, 10u,
+        50u, 3u, 1u);
+    IntegralEstimate four = integrateStratified<double, 2>(f, lo2, hi2, 10u,
+        50u, 3u, 4u);
+    CHECK(one.value == four.value);
+    CHECK(one.stdError == four.stdError);
+
+    // check exception handling
+    bool flag = true;
+    try {
+        integrateStratified<double, 2>(f, lo2, hi2, 10u, 1u, 3u); // throws
+        flag = false;                                   // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        integrateStratified<double, 2>(f, lo2, hi2, 70000u, 2u, 3u); // throws
+        flag = false;                                   // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+}
@@ -0,0 +1,4 @@
+// phantom C++ file for Integrator unit testing. This file only includes the 
+// Integrator header; doctest generates the testing program based on unit tests
+// written alongside the code in the header file
+#include "Integrator.hpp"
\ No newline at end of file
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <doctest.h>
+#include "CoordinateBatch.hpp"
+
+/*-----------------------------------------------------------------------------
+ * declarations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Kinds of dart sequences for Monte Carlo estimates.
+ *
+ * Pseudo-random darts land independently of each other, so the error of an
+ * estimate shrinks like 1 / sqrt(n). The Halton and Sobol sequences are
+ * low-discrepancy sequences: their points spread evenly over the unit square
+ * by construction, and the error of an estimate shrinks nearly like 1 / n.
+ */
+enum DartSequence {
+    DARTS_RANDOM,
+    DARTS_HALTON,
+    DARTS_SOBOL
+};
+
+/**
+ * @brief Fill a batch with randomly shifted Halton points.
+ *
+ * Set coordinate j of the batch to point first + j of the two-dimensional
+ * Halton sequence, which uses the base 2 radical inverse of the point number
+ * as its x-value and the base 3 radical inverse as its y-value. Each value
+ * is then shifted by the matching element of shift, modulo 1 (a
+ * Cranley-Patterson rotation), so that independent shifts give independent,
+ * equally accurate copies of the sequence.
+ *
+ * @param batch Batch to fill; its size is the number of points.
+ * @param first Number of the first point in the batch.
+ * @param shift Shifts for the x- and y-values, each in [0, 1).
+ */
+template <class T>
+void fillHalton(CoordinateBatch<T> &batch, uint64_t first,
+    const double shift[2]);
+
+/**
+ * @brief Fill a batch with digitally shifted Sobol points.
+ *
+ * Set coordinate j of the batch to point first + j of the two-dimensional
+ * Sobol sequence, with 32 bits per value. The points are generated in Gray
+ * code order, so each one costs a single exclusive or per value after the
+ * first. Each value is then exclusive or-ed with the matching element of
+ * shift (a random digital shift), so that independent shifts give
+ * independent, equally accurate copies of the sequence.
+ *
+ * @param batch Batch to fill; its size is the number of points.
+ * @param first Number of the first point in the batch.
+ * @param shift Digital shifts for the x- and y-values.
+ *
+ * @throws std::out_of_range if the batch would run past point 2^32 - 1.
+ */
+template <class T>
+void fillSobol(CoordinateBatch<T> &batch, uint64_t first,
+    const uint32_t shift[2]);
+
+/*-----------------------------------------------------------------------------
+ * function implementations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Helper function for the base 2 radical inverse: the bits of i reflected
+ * about the binary point.
+ */
+inline double radicalInverse2(uint64_t i) {
+    i = (i << 32) | (i >> 32);
+    i = ((i & 0x0000FFFF0000FFFFull) << 16) | ((i >> 16) & 0x0000FFFF0000FFFFull);
+    i = ((i & 0x00FF00FF00FF00FFull) << 8) | ((i >> 8) & 0x00FF00FF00FF00FFull);
+    i = ((i & 0x0F0F0F0F0F0F0F0Full) << 4) | ((i >> 4) & 0x0F0F0F0F0F0F0F0Full);
+    i = ((i & 0x3333333333333333ull) << 2) | ((i >> 2) & 0x3333333333333333ull);
+    i = ((i & 0x5555555555555555ull) << 1) | ((i >> 1) & 0x5555555555555555ull);
+    return (i >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ * Generate one batch of shifted Halton points.
+ */
+template <class T>
+void fillHalton(CoordinateBatch<T> &batch, uint64_t first,
+    const double shift[2]) {
+    T *xs = batch.getXs();
+    T *ys = batch.getYs();
+    size_t n = batch.size();
+
+    // the base 3 digits of the point number, least significant first, and
+    // the same digits reflected as a 40-digit integer; 3^40 fits in 64 bits
+    const int DIGITS = 40;
+    uint64_t pow3[DIGITS];
+    pow3[DIGITS - 1] = 1u;
+    for(int k = DIGITS - 2; k >= 0; k--) {
+        pow3[k] = pow3[k + 1] * 3u;
+    }
+    const double SCALE3 = 1.0 / (3.0 * pow3[0]);
+    unsigned char digits[DIGITS] = { 0 };
+    uint64_t reflected = 0u;
+    uint64_t i = first;
+    for(int k = 0; i != 0u; k++, i /= 3u) {
+        digits[k] = (unsigned char)(i % 3u);
+        reflected += digits[k] * pow3[k];
+    }
+
+    for(size_t j = 0u; j < n; j++) {
+        double x = radicalInverse2(first + j) + shift[0];
+        double y = reflected * SCALE3 + shift[1];
+        xs[j] = T(x >= 1.0 ? x - 1.0 : x);
+        ys[j] = T(y >= 1.0 ? y - 1.0 : y);
+
+        // add one to the digits, exactly, carrying as needed
+        int k = 0;
+        while(digits[k] == 2u) {
+            digits[k] = 0u;
+            reflected -= 2u * pow3[k];
+            k++;
+        }
+        digits[k]++;
+        reflected += pow3[k];
+    }
+}
+
+/**
+ * Helper class holding the Sobol direction numbers. The x-values use the
+ * van der Corput sequence, and the y-values the primitive polynomial x + 1,
+ * whose direction numbers satisfy m[k] = m[k - 1] ^ (m[k - 1] << 1), with
+ * m[0] = 1.
+ */
+struct SobolDirections {
+    /** Direction numbers for the x-values. */
+    uint32_t x[32];
+
+    /** Direction numbers for the y-values. */
+    uint32_t y[32];
+
+    SobolDirections() {
+        uint32_t m = 1u;
+        for(unsigned k = 0u; k < 32u; k++) {
+            x[k] = uint32_t(1u) << (31u - k);
+            y[k] = m << (31u - k);
+            m ^= m << 1;
+        }
+    }
+};
+
+/*
+ * Generate one batch of shifted Sobol points.
+ */
+template <class T>
+void fillSobol(CoordinateBatch<T> &batch, uint64_t first,
+    const uint32_t shift[2]) {
+    static const SobolDirections dirs;
+    T *xs = batch.getXs();
+    T *ys = batch.getYs();
+    size_t n = batch.size();
+    if(first + n > (uint64_t(1u) << 32)) {
+        throw std::out_of_range("point number out of range in fillSobol()");
+    }
+
+    // start from the Gray code of the first point
+    uint32_t x = shift[0];
+    uint32_t y = shift[1];
+    uint32_t gray = uint32_t(first ^ (first >> 1));
+    for(unsigned k = 0u; gray != 0u; k++, gray >>= 1) {
+        if(gray & 1u) {
+            x ^= dirs.x[k];
+            y ^= dirs.y[k];
+        }
+    }
+
+    // keep only the bits T holds exactly, so no point rounds up to 1; for
+    // float, (x >> 8) * 2^-24
+    const int DIGITS = std::numeric_limits<T>::digits;
+    const unsigned DROP = DIGITS < 32 ? unsigned(32 - DIGITS) : 0u;
+    const T SCALE = std::ldexp(T(1), -int(32u - DROP));
+
+    // consecutive Gray codes differ in the lowest zero bit of the point number
+    for(size_t j = 0u; j < n; j++) {
+        xs[j] = T(x >> DROP) * SCALE;
+        ys[j] = T(y >> DROP) * SCALE;
+        uint64_t i = first + j + 1u;
+        if(i < (uint64_t(1u) << 32)) {
+            unsigned k = __builtin_ctzll(i);
+            x ^= dirs.x[k];
+            y ^= dirs.y[k];
+        }
+    }
+}
+
+// doctest unit tests for the low-discrepancy sequences
+TEST_CASE("testing fillHalton") {
+    CoordinateBatch<double> batch;
+    batch.resize(6u);
+    const double noShift[2] = { 0.0, 0.0 };
+    fillHalton(batch, 0u, noShift);
+    const double xs[] = { 0.0, 0.5, 0.25, 0.75, 0.125, 0.625 };
+    const double ys[] = { 0.0, 1.0 / 3, 2.0 / 3, 1.0 / 9, 4.0 / 9, 7.0 / 9 };
+    for(size_t j = 0u; j < 6u; j++) {
+        CHECK(batch.getXs()[j] == doctest::Approx(xs[j]));
+        CHECK(batch.getYs()[j] == doctest::Approx(ys[j]));
+    }
+
+    // shifts wrap around modulo 1, and batches can start anywhere
+    const double shift[2] = { 0.5, 0.5 };
+    batch.resize(2u);
+    fillHalton(batch, 3u, shift);
+    CHECK(batch.getXs()[0] == doctest::Approx(0.25));
+    CHECK(batch.getYs()[0] == doctest::Approx(1.0 / 9 + 0.5));
+    CHECK(batch.getXs()[1] == doctest::Approx(0.625));
+    CHECK(batch.getYs()[1] == doctest::Approx(4.0 / 9 + 0.5));
+}
+
+TEST_CASE("testing fillSobol") {
+    CoordinateBatch<double> batch;
+    batch.resize(8u);
+    const uint32_t noShift[2] = { 0u, 0u };
+    fillSobol(batch, 0u, noShift);
+    const double xs[] = { 0.0, 0.5, 0.75, 0.25, 0.375, 0.875, 0.625, 0.125 };
+    const double ys[] = { 0.0, 0.5, 0.25, 0.75, 0.375, 0.875, 0.125, 0.625 };
+    for(size_t j = 0u; j < 8u; j++) {
+        CHECK(batch.getXs()[j] == xs[j]);
+        CHECK(batch.getYs()[j] == ys[j]);
+    }
+
+    // a batch starting mid-sequence matches the same points from the start
+    CoordinateBatch<double> tail;
+    tail.resize(3u);
+    fillSobol(tail, 5u, noShift);
+    for(size_t j = 0u; j < 3u; j++) {
+        CHECK(tail.getXs()[j] == xs[5u + j]);
+        CHECK(tail.getYs()[j] == ys[5u + j]);
+    }
+
+    // the first 2^k points put exactly one point in each 2^-k wide strip
+    batch.resize(1024u);
+    const uint32_t shift[2] = { 0x12345678u, 0x9ABCDEF0u };
+    fillSobol(batch, 0u, shift);
+    int strips[1024] = { 0 };
+    for(size_t j = 0u; j < 1024u; j++) {
+        strips[int(batch.getYs()[j] * 1024)]++;
+    }
+    for(int s = 0; s < 1024; s++) {
+        CHECK(strips[s] == 1);
+    }
+
+    // points at the very top of the range stay below 1, even in float
+    CoordinateBatch<float> top;
+    top.resize(2u);
+    const uint32_t topShift[2] = { 0xFFFFFFFFu, 0xFFFFFF80u };
+    fillSobol(top, 0u, topShift);
+    CHECK(top.getXs()[0] < 1.0f);
+    CHECK(top.getXs()[0] == 1.0f - std::ldexp(1.0f, -24));
+    CHECK(top.getYs()[0] < 1.0f);
+    CHECK(top.getXs()[1] == 0.5f - std::ldexp(1.0f, -24));
+    fillSobol(batch, 0u, topShift);
+    CHECK(batch.getXs()[0] == 1.0 - std::ldexp(1.0, -32));
+
+    // the sequence has 2^32 points
+    bool flag = true;
+    try {
+        fillSobol(tail, 4294967294ull, noShift);   // should throw
+        flag = false;                               // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+}
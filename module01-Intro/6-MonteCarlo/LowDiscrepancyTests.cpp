@@ -0,0 +1,4 @@
+// phantom C++ file for LowDiscrepancy unit testing. This file only includes
+// the LowDiscrepancy header; doctest generates the testing program based on
+// unit tests written alongside the code in the header file
+#include "LowDiscrepancy.hpp"
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include "Integrator.hpp"
+#include "ParallelPi.hpp"
+
+/**
+ * Helper function to estimate the volume of the N-dimensional unit ball
+ * and print it with its error and throughput.
+ */
+template <size_t N>
+void ballVolume(uint64_t n, uint64_t seed, long double exact) {
+    std::array<float, N> ones;
+    ones.fill(1.0f);
+    const Coordinate<float, N> upper(ones), center;
+    Coordinate<float, N> lower;
+    for(size_t d = 0u; d < N; d++) {
+        lower.set(d, -1.0f);
+    }
+    IntegralEstimate est = estimateVolume<float, N>(
+        [center](const Coordinate<float, N> &p) {
+            return p.squaredDistanceTo(center) < 1.0f;
+        }, lower, upper, n, seed);
+
+    std::cout << N << "-ball volume: " << est.value << " +/- " << 
+        est.stdError << " (exact " << exact << ", " << 
+        est.samplesPerSecond() << " samples/s)" << std::endl;
+}
+
+/**
+ * @brief CMP 246 Module 1 program for general Monte Carlo integration.
+ * 
+ * This program estimates pi through the general integrator and through the
+ * tuned pi kernel, to compare their throughput, then estimates the volumes 
+ * of unit balls in higher dimensions, and an integral with and without 
+ * stratified sampling.
+ */
+int main() {
+    uint64_t seed = time(0);
+
+    // prompt for number of samples
+    uint64_t n;
+    std::cout << "Enter number of samples: ";
+    std::cin >> n;
+
+    // pi, both ways
+    const Coordinate<float, 2> lo2(0.0f, 0.0f), hi2(1.0f, 1.0f);
+    IntegralEstimate quarter = estimateVolume<float, 2>(
+        [](const Coordinate<float, 2> &p) {
+            return p.getX() * p.getX() + p.getY() * p.getY() < 1.0f;
+        }, lo2, hi2, n, seed);
+    std::cout << "Integrator estimate of pi: " << 4.0L * quarter.value << 
+        " (" << quarter.samplesPerSecond() << " samples/s)" << std::endl;
+    PiEstimate tuned = estimatePi<float>(n, seed);
+    std::cout << "Pi kernel estimate of pi: " << tuned.estimate() << 
+        " (" << tuned.dartsPerSecond() << " darts/s)" << std::endl;
+
+    // unit balls, with volume pi^(N/2) / (N/2)!
+    const long double PI = 3.14159265358979323846L;
+    ballVolume<3>(n, seed, 4.0L * PI / 3.0L);
+    ballVolume<4>(n, seed, PI * PI / 2.0L);
+    ballVolume<8>(n, seed, PI * PI * PI * PI / 24.0L);
+
+    // a smooth integral, with and without strata: the integral of
+    // exp(-x^2 - y^2) over [0, 1]^2 is pi erf(1)^2 / 4
+    auto gauss = [](const Coordinate<double, 2> &p) {
+        return std::exp(-p.getX() * p.getX() - p.getY() * p.getY());
+    };
+    const Coordinate<double, 2> lo(0.0, 0.0), hi(1.0, 1.0);
+    IntegralEstimate plain = integrate<double, 2>(gauss, lo, hi, n, seed);
+    unsigned strata = unsigned(std::sqrt(n / 16.0));
+    strata = strata < 1u ? 1u : strata > 65536u ? 65536u : strata;
+    IntegralEstimate strat = integrateStratified<double, 2>(gauss, lo, hi,
+        strata, 16u, seed);
+    std::cout.precision(12);
+    std::cout << "Exact Gaussian integral: " << 
+        PI * std::erf(1.0L) * std::erf(1.0L) / 4.0L << std::endl;
+    std::cout << "Plain: " << plain.value << " +/- " << plain.stdError << 
+        std::endl;
+    std::cout << "Stratified: " << strat.value << " +/- " << strat.stdError <<
+        std::endl;
+
+    return EXIT_SUCCESS;
+}
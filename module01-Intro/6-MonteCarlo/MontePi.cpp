@@ -1,55 +1,82 @@
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <iostream>
-#include <random>
-#include "Coordinate.hpp"
+#include "ParallelPi.hpp"
 
 /**
- * @brief CMP 246 Module 1 main program to exercise the Coordinate class.
+ * Helper function to print how to run the program, and fail.
+ */
+int usage() {
+    std::cerr << "Usage: MontePi [precision [random|halton|sobol]]" <<
+        std::endl;
+    return EXIT_FAILURE;
+}
+
+/**
+ * @brief CMP 246 Module 1 main program to estimate pi.
  * 
  * This program uses the Monte Carlo technique to create an estimate of the 
- * number pi, using float and long double coordinates.
+ * number pi, using float and long double coordinates. The darts are thrown
+ * in parallel, on every core, and the throughput of each run is reported.
+ *
+ * Run as MontePi precision [random|halton|sobol], it instead throws double
+ * coordinate darts of the given kind (Sobol by default) until the 95% 
+ * confidence interval is within plus or minus precision, printing the 
+ * running estimate after each round.
  */
-int main() {
-    // Mersenne Twister high-quality pseudo-random number generator
-    std::mt19937_64 prng(time(0));
+int main(int argc, char *argv[]) {
+    // seed for the counter-based random number stream
+    uint64_t seed = time(0);
+
+    if(argc > 3) {
+        return usage();
+    }
+    if(argc > 1) {
+        long double precision = std::strtold(argv[1], 0);
+        DartSequence seq = DARTS_SOBOL;
+        if(argc > 2 && std::strcmp(argv[2], "random") == 0) {
+            seq = DARTS_RANDOM;
+        } else if(argc > 2 && std::strcmp(argv[2], "halton") == 0) {
+            seq = DARTS_HALTON;
+        } else if(argc > 2 && std::strcmp(argv[2], "sobol") != 0) {
+            std::cerr << "unknown sequence " << argv[2] << std::endl;
+            return usage();
+        }
+        if(!(precision > 0.0L)) {
+            std::cerr << "precision must be positive" << std::endl;
+            return EXIT_FAILURE;
+        }
 
-    // distributions to produce numbers in [0, 1] for floats and long doubles
-    std::uniform_real_distribution<float> distribF(0.0f, 1.0f);
-    std::uniform_real_distribution<long double> distribLD(0.0L, 1.0L);
+        std::cout.precision(12);
+        PiInterval est = estimatePiTo<double>(precision, seq, seed, 
+            uint64_t(1) << 40, [](const PiInterval &step) {
+                std::cout << step.darts << " darts: " << step.estimate << 
+                    " +/- " << step.halfWidth << std::endl;
+            });
+        std::cout << (est.converged ? "Converged" : "Gave up") << " after " <<
+            est.darts << " darts in " << est.seconds << " s" << std::endl;
+
+        return est.converged ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
     // prompt for number of coordinates
-    unsigned n;
+    uint64_t n;
     std::cout << "Enter number of darts to throw: ";
     std::cin >> n;
 
     // perform the estimate using float coordinates
-    Coordinate<float> zeroF, dartF;
-    float numInF = 0.0f;
-    for(unsigned i = 0u; i < n; i++) {
-        dartF.setX(distribF(prng));
-        dartF.setY(distribF(prng));
-        if(zeroF.distanceTo(dartF) < 1.0f) {
-            numInF++;
-        }
-    }
-    float estPiF = numInF / n * 4.0f;
+    PiEstimate estF = estimatePi<float>(n, seed);
 
-    std::cout << "Float estimate of pi: " << estPiF << std::endl;
+    std::cout << "Float estimate of pi: " << float(estF.estimate()) << 
+        " (" << estF.dartsPerSecond() << " darts/s)" << std::endl;
 
     // perform the estimate using long double coordinates
-    Coordinate<long double> zeroLD, dartLD;
-    long double numInLD = 0.0L;
-    for(unsigned i = 0u; i < n; i++) {
-        dartLD.setX(distribLD(prng));
-        dartLD.setY(distribLD(prng));
-        if(zeroLD.distanceTo(dartLD) < 1.0L) {
-            numInLD++;
-        }
-    }
-    long double estPiLD = numInLD / n * 4.0L;
+    PiEstimate estLD = estimatePi<long double>(n, seed);
 
-    std::cout << "Long double estimate of pi: " << estPiLD << std::endl;
+    std::cout << "Long double estimate of pi: " << estLD.estimate() << 
+        " (" << estLD.dartsPerSecond() << " darts/s)" << std::endl;
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,484 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <doctest.h>
+#include "CoordinateBatch.hpp"
+#include "LowDiscrepancy.hpp"
+#include "Rng.hpp"
+
+/*-----------------------------------------------------------------------------
+ * declarations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Result of a Monte Carlo estimate of pi.
+ *
+ * Holds the number of darts thrown, the number that landed inside the unit
+ * quarter circle, and how long the run took.
+ */
+struct PiEstimate {
+    /** Number of darts thrown. */
+    uint64_t darts;
+
+    /** Number of darts inside the quarter circle. */
+    uint64_t hits;
+
+    /** Wall clock time for the run, in seconds. */
+    double seconds;
+
+    /**
+     * @brief Estimate of pi.
+     *
+     * @return Four times the fraction of darts inside the quarter circle.
+     */
+    long double estimate() const {
+        return darts == 0u ? 0.0L : 4.0L * hits / darts;
+    }
+
+    /**
+     * @brief Throughput of the run.
+     *
+     * @return Darts thrown per second.
+     */
+    double dartsPerSecond() const {
+        return seconds > 0.0 ? darts / seconds : 0.0;
+    }
+};
+
+/**
+ * @brief Running estimate of pi with a confidence interval.
+ *
+ * Holds the estimate after some number of darts, the half-width of its 95%
+ * confidence interval, and whether that half-width has reached the
+ * requested precision.
+ */
+struct PiInterval {
+    /** Number of darts thrown so far. */
+    uint64_t darts;
+
+    /** Estimate of pi. */
+    long double estimate;
+
+    /** Half-width of the 95% confidence interval around the estimate. */
+    long double halfWidth;
+
+    /** Wall clock time so far, in seconds. */
+    double seconds;
+
+    /** True if the half-width is no more than the requested precision. */
+    bool converged;
+};
+
+/**
+ * @brief Fill a batch with random darts.
+ *
+ * Set coordinate j of the batch to dart first + j of a stream. Dart i is
+ * Philox4x32 block i of the stream: the first two words of the block are
+ * its x-value, and the last two its y-value. Each lane is computed 
+ * independently of the others, so the compiler is free to vectorize the 
+ * loop.
+ *
+ * @param batch Batch to fill; its size is the number of darts.
+ * @param seed Seed for the stream.
+ * @param first Number of the first dart in the batch.
+ */
+template <class T>
+void fillDarts(CoordinateBatch<T> &batch, uint64_t seed, uint64_t first);
+
+/**
+ * @brief Count darts inside the unit quarter circle.
+ *
+ * Throw darts first through last - 1 of a stream, as filled in by 
+ * fillDarts(), and count how many land inside the quarter circle. The darts
+ * are generated and tested in cache-sized batches, using the SIMD kernel
+ * behind countInsideUnit().
+ *
+ * @param seed Seed for the stream.
+ * @param first Number of the first dart to throw.
+ * @param last One past the number of the last dart to throw.
+ *
+ * @return Number of darts inside the quarter circle.
+ */
+template <class T>
+uint64_t countHits(uint64_t seed, uint64_t first, uint64_t last);
+
+/**
+ * @brief Parallel Monte Carlo estimate of pi.
+ *
+ * Throw n darts at the unit square using type T coordinates, split evenly
+ * over numThreads threads, and count how many land inside the unit quarter
+ * circle. The darts come from one counter-based random stream, so the same
+ * seed gives the same result for any number of threads.
+ *
+ * @param n Number of darts to throw.
+ * @param seed Seed for the random stream.
+ * @param numThreads Number of threads to use, or 0 to use one thread per
+ * hardware core.
+ *
+ * @return Darts, hits, and elapsed time for the run.
+ */
+template <class T>
+PiEstimate estimatePi(uint64_t n, uint64_t seed, unsigned numThreads = 0u);
+
+/**
+ * @brief Count points of a randomized low-discrepancy sequence inside the 
+ * unit quarter circle.
+ *
+ * Test points first through last - 1 of one randomly shifted copy of a
+ * Halton or Sobol sequence, as filled in by fillHalton() or fillSobol().
+ * The shifts for each copy come from the seed and the copy number, so
+ * different copies are independent of each other.
+ *
+ * @param seq DARTS_HALTON or DARTS_SOBOL.
+ * @param seed Seed for the shifts.
+ * @param copy Number of the shifted copy.
+ * @param first Number of the first point to test.
+ * @param last One past the number of the last point to test.
+ *
+ * @return Number of points inside the quarter circle.
+ *
+ * @throws std::invalid_argument if seq is not a low-discrepancy sequence.
+ */
+template <class T>
+uint64_t countQuasiHits(DartSequence seq, uint64_t seed, unsigned copy,
+    uint64_t first, uint64_t last);
+
+/**
+ * @brief Estimate pi to a requested precision.
+ *
+ * Throw darts in rounds, in parallel, until the 95% confidence interval 
+ * around the estimate is no wider than plus or minus precision, or until
+ * maxDarts darts have been thrown. Each round throws as many darts as all 
+ * the rounds before it, starting with 65536, and progress, if given, is 
+ * called with the running estimate after every round.
+ *
+ * For pseudo-random darts the interval comes from the binomial variance of
+ * the hit count. For low-discrepancy darts it comes from the spread of the
+ * estimates of 16 independently shifted copies of the sequence, which share
+ * the darts evenly; Sobol copies have at most 2^32 points each.
+ *
+ * @param precision Requested half-width of the confidence interval.
+ * @param seq Kind of dart sequence to throw.
+ * @param seed Seed for the darts or the shifts.
+ * @param maxDarts Largest number of darts to throw.
+ * @param progress Function called with the running estimate after each
+ * round, or nullptr.
+ * @param numThreads Number of threads to use, or 0 to use one thread per
+ * hardware core.
+ *
+ * @return Final estimate, interval, and whether it converged.
+ *
+ * @throws std::invalid_argument if precision is not positive.
+ */
+template <class T>
+PiInterval estimatePiTo(long double precision, DartSequence seq,
+    uint64_t seed, uint64_t maxDarts,
+    std::function<void(const PiInterval &)> progress = nullptr,
+    unsigned numThreads = 0u);
+
+/*-----------------------------------------------------------------------------
+ * function implementations
+ *---------------------------------------------------------------------------*/
+
+/*
+ * Generate one batch of darts.
+ */
+template <class T>
+void fillDarts(CoordinateBatch<T> &batch, uint64_t seed, uint64_t first) {
+    T *xs = batch.getXs();
+    T *ys = batch.getYs();
+    size_t n = batch.size();
+    const uint32_t key[2] = { uint32_t(seed), uint32_t(seed >> 32) };
+
+    // one Philox block per dart, computed in vector lanes
+    std::vector<uint32_t> words(4u * n);
+    uint32_t *const pWords[4] = { words.data(), words.data() + n,
+        words.data() + 2u * n, words.data() + 3u * n };
+    Philox4x32::blocks(first, 0u, key, n, pWords);
+
+    for(size_t j = 0u; j < n; j++) {
+        xs[j] = unitReal<T>(pWords[0][j] | (uint64_t(pWords[1][j]) << 32));
+        ys[j] = unitReal<T>(pWords[2][j] | (uint64_t(pWords[3][j]) << 32));
+    }
+}
+
+/*
+ * Count the hits for one range of darts, one batch at a time.
+ */
+template <class T>
+uint64_t countHits(uint64_t seed, uint64_t first, uint64_t last) {
+    // 4096 darts per batch keeps both arrays in L1 for floats and doubles
+    const uint64_t BATCH = 4096u;
+    CoordinateBatch<T> batch;
+    uint64_t hits = 0u;
+    for(uint64_t i = first; i < last; i += BATCH) {
+        batch.resize(size_t(last - i < BATCH ? last - i : BATCH));
+        fillDarts(batch, seed, i);
+        hits += countInsideUnit(batch);
+    }
+
+    return hits;
+}
+
+/**
+ * Helper function to split points first through last - 1 evenly over
+ * numThreads threads and add up the hits that count(first, last) reports
+ * for each thread's share.
+ */
+template <class Count>
+uint64_t countParallel(uint64_t first, uint64_t last, unsigned numThreads,
+    Count count) {
+    if(numThreads == 0u) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    if(numThreads == 0u) {
+        numThreads = 1u;
+    }
+
+    // each thread writes only its own hit count
+    std::vector<uint64_t> hits(numThreads, 0u);
+    std::vector<std::thread> threads;
+    uint64_t slice = (last - first) / numThreads;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        uint64_t a = first + t * slice;
+        uint64_t b = (t == numThreads - 1u) ? last : a + slice;
+        threads.push_back(std::thread([&hits, &count, t, a, b]() {
+            hits[t] = count(a, b);
+        }));
+    }
+
+    uint64_t total = 0u;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        threads[t].join();
+        total += hits[t];
+    }
+
+    return total;
+}
+
+/*
+ * Split the darts over the threads and add up the hits.
+ */
+template <class T>
+PiEstimate estimatePi(uint64_t n, uint64_t seed, unsigned numThreads) {
+    auto start = std::chrono::steady_clock::now();
+
+    PiEstimate result = { n, 0u, 0.0 };
+    result.hits = countParallel(0u, n, numThreads,
+        [seed](uint64_t first, uint64_t last) {
+            return countHits<T>(seed, first, last);
+        });
+
+    auto stop = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(stop - start).count();
+
+    return result;
+}
+
+/*
+ * Count the hits for one range of one shifted copy, one batch at a time.
+ */
+template <class T>
+uint64_t countQuasiHits(DartSequence seq, uint64_t seed, unsigned copy,
+    uint64_t first, uint64_t last) {
+    if(seq != DARTS_HALTON && seq != DARTS_SOBOL) {
+        throw std::invalid_argument("not a low-discrepancy sequence in countQuasiHits()");
+    }
+
+    // stream 0 holds the pseudo-random darts, so the shifts start at 1
+    Philox4x32 stream(seed, 1u + copy);
+    uint64_t a = stream.next();
+    uint64_t b = stream.next();
+    const double haltonShift[2] = { unitReal<double>(a), unitReal<double>(b) };
+    const uint32_t sobolShift[2] = { uint32_t(a >> 32), uint32_t(b >> 32) };
+
+    const uint64_t BATCH = 4096u;
+    CoordinateBatch<T> batch;
+    uint64_t hits = 0u;
+    for(uint64_t i = first; i < last; i += BATCH) {
+        batch.resize(size_t(last - i < BATCH ? last - i : BATCH));
+        if(seq == DARTS_HALTON) {
+            fillHalton(batch, i, haltonShift);
+        } else {
+            fillSobol(batch, i, sobolShift);
+        }
+        hits += countInsideUnit(batch);
+    }
+
+    return hits;
+}
+
+/*
+ * Throw rounds of darts until the confidence interval is narrow enough.
+ */
+template <class T>
+PiInterval estimatePiTo(long double precision, DartSequence seq,
+    uint64_t seed, uint64_t maxDarts,
+    std::function<void(const PiInterval &)> progress, unsigned numThreads) {
+    if(!(precision > 0.0L)) {
+        throw std::invalid_argument("precision must be positive in estimatePiTo()");
+    }
+
+    // 95% quantiles of the normal and of Student's t with 15 degrees of freedom
+    const long double Z95 = 1.959964L;
+    const long double T95 = 2.131450L;
+    const unsigned COPIES = 16u;
+    const uint64_t FIRST_ROUND = 65536u;
+
+    // low-discrepancy darts are split evenly over the copies
+    bool quasi = (seq != DARTS_RANDOM);
+    if(quasi) {
+        uint64_t limit = uint64_t(COPIES) << 32;
+        maxDarts = (maxDarts < limit ? maxDarts : limit) / COPIES * COPIES;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    PiInterval result = { 0u, 0.0L, HUGE_VALL, 0.0, false };
+    uint64_t hits = 0u;
+    std::vector<uint64_t> copyHits(COPIES, 0u);
+    while(!result.converged && result.darts < maxDarts) {
+        uint64_t round = result.darts == 0u ? FIRST_ROUND : result.darts;
+        if(round > maxDarts - result.darts) {
+            round = maxDarts - result.darts;
+        }
+
+        if(!quasi) {
+            hits += countParallel(result.darts, result.darts + round,
+                numThreads, [seed](uint64_t first, uint64_t last) {
+                    return countHits<T>(seed, first, last);
+                });
+            result.darts += round;
+            long double p = (long double)hits / result.darts;
+            result.estimate = 4.0L * p;
+            result.halfWidth = Z95 * 4.0L * std::sqrt(p * (1.0L - p) /
+                result.darts);
+        } else {
+            uint64_t first = result.darts / COPIES;
+            uint64_t last = first + round / COPIES;
+            for(unsigned c = 0u; c < COPIES; c++) {
+                copyHits[c] += countParallel(first, last, numThreads,
+                    [seq, seed, c](uint64_t a, uint64_t b) {
+                        return countQuasiHits<T>(seq, seed, c, a, b);
+                    });
+            }
+            result.darts += round;
+
+            // the copies are independent estimates; use their mean and spread
+            long double sum = 0.0L, sumSq = 0.0L;
+            for(unsigned c = 0u; c < COPIES; c++) {
+                long double est = 4.0L * copyHits[c] / last;
+                sum += est;
+                sumSq += est * est;
+            }
+            long double mean = sum / COPIES;
+            long double var = (sumSq - sum * mean) / (COPIES - 1u);
+            result.estimate = mean;
+            result.halfWidth = T95 * std::sqrt((var > 0.0L ? var : 0.0L) /
+                COPIES);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        result.seconds = std::chrono::duration<double>(now - start).count();
+        result.converged = (result.halfWidth <= precision);
+        if(progress) {
+            progress(result);
+        }
+    }
+
+    return result;
+}
+
+// doctest unit tests for estimatePi
+TEST_CASE("testing estimatePi") {
+    // same seed, same darts, regardless of the number of threads
+    PiEstimate one = estimatePi<double>(100000u, 246u, 1u);
+    PiEstimate three = estimatePi<double>(100000u, 246u, 3u);
+    CHECK(one.darts == 100000u);
+    CHECK(one.hits == three.hits);
+
+    // the estimate should be close to pi for each type
+    CHECK(estimatePi<float>(1000000u, 1u).estimate() ==
+        doctest::Approx(3.14159).epsilon(0.01));
+    CHECK(estimatePi<double>(1000000u, 2u).estimate() ==
+        doctest::Approx(3.14159).epsilon(0.01));
+    CHECK(estimatePi<long double>(1000000u, 3u).estimate() ==
+        doctest::Approx(3.14159).epsilon(0.01));
+
+    // the batches see exactly the darts a one-at-a-time loop would
+    uint64_t hits = 0u;
+    Philox4x32 stream(246u);
+    for(uint64_t i = 0u; i < 10000u; i++) {
+        double x = unitReal<double>(stream.next());
+        double y = unitReal<double>(stream.next());
+        hits += (x * x + y * y < 1.0);
+    }
+    CHECK(countHits<double>(246u, 0u, 10000u) == hits);
+    CHECK(countHits<double>(246u, 0u, 5000u) + 
+        countHits<double>(246u, 5000u, 10000u) == hits);
+
+    // no darts, no estimate
+    CHECK(estimatePi<float>(0u, 1u).estimate() == 0.0L);
+}
+
+// doctest unit tests for estimatePiTo
+TEST_CASE("testing estimatePiTo") {
+    const long double PI = 3.14159265358979323846L;
+
+    // pseudo-random darts reach a loose precision, with a running estimate
+    // after every round
+    int rounds = 0;
+    uint64_t lastDarts = 0u;
+    PiInterval rand = estimatePiTo<double>(0.01L, DARTS_RANDOM, 5u, 
+        100000000u, [&rounds, &lastDarts](const PiInterval &step) {
+            rounds++;
+            CHECK(step.darts > lastDarts);
+            lastDarts = step.darts;
+        });
+    CHECK(rand.converged);
+    CHECK(rand.halfWidth <= 0.01L);
+    CHECK(rounds >= 1);
+    CHECK(lastDarts == rand.darts);
+    CHECK(std::fabs(rand.estimate - PI) < 0.03L);
+
+    // low-discrepancy darts reach a much tighter precision with fewer darts
+    PiInterval sobol = estimatePiTo<double>(0.0001L, DARTS_SOBOL, 5u, 
+        100000000u);
+    CHECK(sobol.converged);
+    CHECK(sobol.darts < 20000000u);
+    CHECK(std::fabs(sobol.estimate - PI) < 0.0003L);
+    PiInterval halton = estimatePiTo<double>(0.0001L, DARTS_HALTON, 5u, 
+        100000000u);
+    CHECK(halton.converged);
+    CHECK(halton.darts < 20000000u);
+    CHECK(std::fabs(halton.estimate - PI) < 0.0003L);
+
+    // the results do not depend on the number of threads
+    PiInterval one = estimatePiTo<float>(0.001L, DARTS_SOBOL, 7u, 
+        1000000u, nullptr, 1u);
+    PiInterval three = estimatePiTo<float>(0.001L, DARTS_SOBOL, 7u, 
+        1000000u, nullptr, 3u);
+    CHECK(one.darts == three.darts);
+    CHECK(one.estimate == three.estimate);
+
+    // the dart budget stops a run that can't converge
+    PiInterval capped = estimatePiTo<double>(1.0e-9L, DARTS_RANDOM, 5u, 
+        100000u);
+    CHECK(!capped.converged);
+    CHECK(capped.darts == 100000u);
+
+    // check exception handling
+    bool flag = true;
+    try {
+        estimatePiTo<double>(0.0L, DARTS_SOBOL, 5u, 1000u); // should throw
+        flag = false;                                       // never happens
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+}
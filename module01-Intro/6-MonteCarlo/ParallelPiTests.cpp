@@ -0,0 +1,4 @@
+// phantom C++ file for ParallelPi unit testing. This file only includes the 
+// ParallelPi header; doctest generates the testing program based on unit tests
+// written alongside the code in the header file
+#include "ParallelPi.hpp"
\ No newline at end of file
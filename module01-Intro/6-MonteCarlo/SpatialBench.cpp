@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "DistanceMatrix.hpp"
+#include "Rng.hpp"
+#include "SpatialIndex.hpp"
+
+/**
+ * Helper function for the seconds since a start time.
+ */
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+/**
+ * Helper function to time building an index and running a batch of k 
+ * nearest neighbor queries and a batch of radius queries on it.
+ */
+template <class Index, size_t N>
+void benchIndex(const char *name, 
+    const std::vector<Coordinate<double, N> > &points,
+    const std::vector<Coordinate<double, N> > &queries, size_t k, 
+    double radius, double bruteRate) {
+    auto start = std::chrono::steady_clock::now();
+    Index index(points);
+    double build = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<Neighbor<double> > knn = nearestBatch(index, queries, k);
+    double knnTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    size_t found = 0u;
+    for(size_t q = 0u; q < queries.size(); q++) {
+        found += index.withinRadius(queries[q], radius).size();
+    }
+    double radiusTime = secondsSince(start);
+
+    double knnRate = queries.size() / knnTime;
+    std::cout << "  " << name << ": build " << build << " s, " << k << 
+        "-NN " << knnRate << " queries/s (" << knnRate / bruteRate << 
+        "x brute force), radius " << queries.size() / radiusTime << 
+        " queries/s (" << double(found) / queries.size() << 
+        " points each)" << std::endl;
+}
+
+/**
+ * Helper function to benchmark both indexes against brute force on n 
+ * uniformly random N-dimensional points.
+ */
+template <size_t N>
+void benchDimension(size_t n, size_t numQueries, size_t k, double radius) {
+    Xoshiro256ss prng(246u);
+    std::vector<Coordinate<double, N> > points(n), queries(numQueries);
+    for(size_t i = 0u; i < n; i++) {
+        for(size_t d = 0u; d < N; d++) {
+            points[i].set(d, unitReal<double>(prng()));
+        }
+    }
+    for(size_t q = 0u; q < numQueries; q++) {
+        for(size_t d = 0u; d < N; d++) {
+            queries[q].set(d, unitReal<double>(prng()));
+        }
+    }
+
+    // brute force: every distance, then the k smallest
+    const size_t BRUTE = 100u;
+    std::vector<double> dist(n);
+    std::vector<size_t> order(n);
+    auto start = std::chrono::steady_clock::now();
+    for(size_t q = 0u; q < BRUTE; q++) {
+        squaredDistancesFrom(queries[q], points.data(), n, dist.data());
+        for(size_t i = 0u; i < n; i++) {
+            order[i] = i;
+        }
+        std::partial_sort(order.begin(), order.begin() + k, order.end(),
+            [&dist](size_t a, size_t b) { return dist[a] < dist[b]; });
+    }
+    double bruteRate = BRUTE / secondsSince(start);
+
+    std::cout << N << "D, " << n << " points, brute force " << k << "-NN " <<
+        bruteRate << " queries/s" << std::endl;
+    benchIndex<KdTree<double, N>, N>("k-d tree", points, queries, k, radius,
+        bruteRate);
+    benchIndex<UniformGrid<double, N>, N>("grid", points, queries, k, radius,
+        bruteRate);
+}
+
+/**
+ * @brief Benchmark for the spatial indexes.
+ * 
+ * This program builds a k-d tree and a uniform grid over a million random
+ * points in two and three dimensions, and times batches of nearest 
+ * neighbor and radius queries against brute force.
+ */
+int main() {
+    benchDimension<2>(1000000u, 100000u, 8u, 0.002);
+    benchDimension<3>(1000000u, 100000u, 8u, 0.02);
+
+    return EXIT_SUCCESS;
+}
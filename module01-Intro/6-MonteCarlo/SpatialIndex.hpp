@@ -0,0 +1,770 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <doctest.h>
+#include "Coordinate.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Result of a nearest neighbor query.
+ *
+ * Holds the index of a point in the set the spatial index was built from,
+ * and its squared distance from the query.
+ */
+template <class T> struct Neighbor {
+    /** Index of the point in the original point set. */
+    size_t index;
+
+    /** Squared Euclidean distance from the query to the point. */
+    T squaredDistance;
+
+    /**
+     * @brief Ordering by distance, then by index.
+     *
+     * @param other Reference to the other neighbor.
+     * @return True if this neighbor is closer than the other one.
+     */
+    bool operator<(const Neighbor<T> &other) const {
+        return squaredDistance < other.squaredDistance ||
+            (squaredDistance == other.squaredDistance && index < other.index);
+    }
+};
+
+/**
+ * @brief Bulk-loaded k-d tree over N-dimensional coordinates.
+ *
+ * The tree is built once from a point set, splitting each node at the
+ * median of its widest dimension until at most LEAF points remain. Because
+ * median splits keep the tree balanced, every leaf is at the same depth and
+ * the nodes are stored in one flat array in breadth-first order, with the
+ * children of node i at 2i + 1 and 2i + 2, so a query walks the tree without
+ * following pointers. The points are copied into leaf order, so each leaf
+ * is one contiguous run of coordinates.
+ *
+ * The tree is read-only once built; any number of threads may query it at
+ * the same time.
+ */
+template <class T, size_t N> class KdTree {
+public:
+    /** Largest number of points in a leaf. */
+    static const size_t LEAF = 16u;
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * Build a tree over a set of points. The tree keeps its own copy.
+     *
+     * @param points Points to index.
+     *
+     * @throws std::length_error if there are 2^32 or more points.
+     */
+    explicit KdTree(const std::vector<Coordinate<T, N> > &points);
+
+    /**
+     * @brief Number of points in the tree.
+     *
+     * @return Number of points the tree was built from.
+     */
+    size_t size() const { return pts.size(); }
+
+    /**
+     * @brief k nearest neighbors of a query point.
+     *
+     * @param query Point to search from.
+     * @param k Number of neighbors to find.
+     *
+     * @return The min(k, size()) points nearest the query, closest first.
+     */
+    std::vector<Neighbor<T> > nearest(const Coordinate<T, N> &query,
+        size_t k) const;
+
+    /**
+     * @brief Points within a radius of a query point.
+     *
+     * @param query Point to search from.
+     * @param radius Largest distance to include.
+     *
+     * @return Every point at distance radius or less, closest first.
+     */
+    std::vector<Neighbor<T> > withinRadius(const Coordinate<T, N> &query,
+        T radius) const;
+
+private:
+    /**
+     * Node of the tree. Internal nodes split at split along dimension dim;
+     * every node covers points begin through end - 1.
+     */
+    struct Node {
+        T split;
+        uint32_t dim;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    /** Helper method to build the subtree at node from a range of order. */
+    void build(size_t node, size_t depth, uint32_t begin, uint32_t end,
+        std::vector<uint32_t> &order,
+        const std::vector<Coordinate<T, N> > &points);
+
+    /** Helper method for nearest(): search the subtree at node. */
+    void searchNearest(size_t node, const Coordinate<T, N> &query, size_t k,
+        std::vector<Neighbor<T> > &heap) const;
+
+    /** Helper method for withinRadius(): search the subtree at node. */
+    void searchRadius(size_t node, const Coordinate<T, N> &query, T r2,
+        std::vector<Neighbor<T> > &found) const;
+
+    /** Index of the first leaf; every node from here on is a leaf. */
+    size_t firstLeaf;
+
+    /** Nodes in breadth-first order. */
+    std::vector<Node> nodes;
+
+    /** Points in leaf order. */
+    std::vector<Coordinate<T, N> > pts;
+
+    /** Original index of each point in pts. */
+    std::vector<uint32_t> ids;
+};
+
+/**
+ * @brief Uniform grid over N-dimensional coordinates.
+ *
+ * The bounding box of the points is split into equal cells, about two
+ * points per cell on average, and the points are stored sorted by cell,
+ * with an offset array marking where each cell starts. A radius query scans
+ * only the cells overlapping the query's bounding box, and a k nearest
+ * neighbor query scans rings of cells outward from the query's cell until
+ * no unscanned cell can be closer than the k-th neighbor found. Queries
+ * visit at least 3^N cells, so the grid suits low dimensions and evenly
+ * spread points, where it builds several times faster than the k-d tree
+ * and answers queries about as fast.
+ *
+ * The grid is read-only once built; any number of threads may query it at
+ * the same time.
+ */
+template <class T, size_t N> class UniformGrid {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * Build a grid over a set of points. The grid keeps its own copy.
+     *
+     * @param points Points to index.
+     *
+     * @throws std::length_error if there are 2^32 or more points.
+     */
+    explicit UniformGrid(const std::vector<Coordinate<T, N> > &points);
+
+    /**
+     * @brief Number of points in the grid.
+     *
+     * @return Number of points the grid was built from.
+     */
+    size_t size() const { return pts.size(); }
+
+    /**
+     * @brief k nearest neighbors of a query point.
+     *
+     * @param query Point to search from.
+     * @param k Number of neighbors to find.
+     *
+     * @return The min(k, size()) points nearest the query, closest first.
+     */
+    std::vector<Neighbor<T> > nearest(const Coordinate<T, N> &query,
+        size_t k) const;
+
+    /**
+     * @brief Points within a radius of a query point.
+     *
+     * @param query Point to search from.
+     * @param radius Largest distance to include.
+     *
+     * @return Every point at distance radius or less, closest first.
+     */
+    std::vector<Neighbor<T> > withinRadius(const Coordinate<T, N> &query,
+        T radius) const;
+
+private:
+    /** Helper method for the cell number along dimension d of a value. */
+    size_t cellOf(T value, size_t d) const;
+
+    /**
+     * Helper method to scan every cell in the box from lo to hi, inclusive,
+     * skipping cells closer than ring to center in every dimension, and
+     * call visit(begin, end) with the range of points in each one.
+     */
+    template <class V>
+    void scanCells(const size_t lo[N], const size_t hi[N],
+        const size_t center[N], size_t ring, V visit) const;
+
+    /** Number of cells along each dimension. */
+    size_t cellsPerDim;
+
+    /** Lower corner of the bounding box. */
+    T lower[N];
+
+    /** Reciprocal of the cell width along each dimension. */
+    T invWidth[N];
+
+    /** Smallest cell width over all dimensions. */
+    T minWidth;
+
+    /** Offset of the first point of each cell, plus one past the end. */
+    std::vector<uint32_t> cellStart;
+
+    /** Points sorted by cell. */
+    std::vector<Coordinate<T, N> > pts;
+
+    /** Original index of each point in pts. */
+    std::vector<uint32_t> ids;
+};
+
+/**
+ * @brief Parallel batch of nearest neighbor queries.
+ *
+ * Run nearest() for every query on an index, split evenly over numThreads
+ * threads. Row i of the result, elements i * k through i * k + k - 1, holds
+ * the neighbors of queries[i], closest first. If the index holds fewer than
+ * k points, the rest of each row is filled with index SIZE_MAX.
+ *
+ * @param index KdTree or UniformGrid to search.
+ * @param queries Points to search from.
+ * @param k Number of neighbors per query.
+ * @param numThreads Number of threads to use, or 0 to use one thread per
+ * hardware core.
+ *
+ * @return queries.size() rows of k neighbors.
+ */
+template <class Index, class T, size_t N>
+std::vector<Neighbor<T> > nearestBatch(const Index &index,
+    const std::vector<Coordinate<T, N> > &queries, size_t k,
+    unsigned numThreads = 0u);
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/**
+ * Helper function to offer a point to a bounded max-heap of the k nearest
+ * neighbors found so far.
+ */
+template <class T>
+inline void offerNeighbor(std::vector<Neighbor<T> > &heap, size_t k,
+    size_t index, T d2) {
+    Neighbor<T> nb = { index, d2 };
+    if(heap.size() < k) {
+        heap.push_back(nb);
+        std::push_heap(heap.begin(), heap.end());
+    } else if(nb < heap.front()) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = nb;
+        std::push_heap(heap.begin(), heap.end());
+    }
+}
+
+template <class T, size_t N>
+const size_t KdTree<T, N>::LEAF;
+
+/*
+ * Pick the depth that makes every leaf small enough, then build top down.
+ */
+template <class T, size_t N>
+KdTree<T, N>::KdTree(const std::vector<Coordinate<T, N> > &points) :
+    firstLeaf(0u) {
+    if(points.size() >= (uint64_t(1u) << 32)) {
+        throw std::length_error("too many points in KdTree::KdTree()");
+    }
+
+    // leaves at depth D hold at most ceil(n / 2^D) points
+    size_t depth = 0u;
+    while((points.size() >> depth) > LEAF) {
+        depth++;
+    }
+    firstLeaf = (size_t(1u) << depth) - 1u;
+    nodes.resize(2u * firstLeaf + 1u);
+
+    std::vector<uint32_t> order(points.size());
+    for(size_t i = 0u; i < order.size(); i++) {
+        order[i] = uint32_t(i);
+    }
+    build(0u, depth, 0u, uint32_t(points.size()), order, points);
+
+    pts.resize(points.size());
+    for(size_t i = 0u; i < order.size(); i++) {
+        pts[i] = points[order[i]];
+    }
+    ids.swap(order);
+}
+
+/*
+ * Split a range at the median of its widest dimension.
+ */
+template <class T, size_t N>
+void KdTree<T, N>::build(size_t node, size_t depth, uint32_t begin,
+    uint32_t end, std::vector<uint32_t> &order,
+    const std::vector<Coordinate<T, N> > &points) {
+    Node &nd = nodes[node];
+    nd.begin = begin;
+    nd.end = end;
+    nd.dim = 0u;
+    nd.split = T();
+    if(depth == 0u) {
+        return;
+    }
+
+    // widest dimension of the bounding box of the range
+    T best = T(-1);
+    for(size_t d = 0u; d < N; d++) {
+        T lo = T(), hi = T();
+        for(uint32_t i = begin; i < end; i++) {
+            T v = points[order[i]].data()[d];
+            if(i == begin || v < lo) {
+                lo = v;
+            }
+            if(i == begin || v > hi) {
+                hi = v;
+            }
+        }
+        if(hi - lo > best) {
+            best = hi - lo;
+            nd.dim = uint32_t(d);
+        }
+    }
+
+    uint32_t mid = begin + (end - begin) / 2u;
+    size_t dim = nd.dim;
+    std::nth_element(order.begin() + begin, order.begin() + mid,
+        order.begin() + end, [&points, dim](uint32_t a, uint32_t b) {
+            return points[a].data()[dim] < points[b].data()[dim];
+        });
+    if(end > begin) {
+        nd.split = points[order[mid]].data()[dim];
+    }
+
+    build(2u * node + 1u, depth - 1u, begin, mid, order, points);
+    build(2u * node + 2u, depth - 1u, mid, end, order, points);
+}
+
+/*
+ * Depth-first search, nearer child first, pruned by the k-th distance.
+ */
+template <class T, size_t N>
+void KdTree<T, N>::searchNearest(size_t node, const Coordinate<T, N> &query,
+    size_t k, std::vector<Neighbor<T> > &heap) const {
+    const Node &nd = nodes[node];
+    if(node >= firstLeaf) {
+        for(uint32_t i = nd.begin; i < nd.end; i++) {
+            offerNeighbor(heap, k, ids[i], query.squaredDistanceTo(pts[i]));
+        }
+        return;
+    }
+
+    T diff = query.data()[nd.dim] - nd.split;
+    size_t nearChild = diff < T() ? 2u * node + 1u : 2u * node + 2u;
+    size_t farChild = diff < T() ? 2u * node + 2u : 2u * node + 1u;
+    searchNearest(nearChild, query, k, heap);
+    if(heap.size() < k || diff * diff <= heap.front().squaredDistance) {
+        searchNearest(farChild, query, k, heap);
+    }
+}
+
+/*
+ * Depth-first search, pruned by the radius.
+ */
+template <class T, size_t N>
+void KdTree<T, N>::searchRadius(size_t node, const Coordinate<T, N> &query,
+    T r2, std::vector<Neighbor<T> > &found) const {
+    const Node &nd = nodes[node];
+    if(node >= firstLeaf) {
+        for(uint32_t i = nd.begin; i < nd.end; i++) {
+            T d2 = query.squaredDistanceTo(pts[i]);
+            if(d2 <= r2) {
+                Neighbor<T> nb = { ids[i], d2 };
+                found.push_back(nb);
+            }
+        }
+        return;
+    }
+
+    T diff = query.data()[nd.dim] - nd.split;
+    if(diff < T() || diff * diff <= r2) {
+        searchRadius(2u * node + 1u, query, r2, found);
+    }
+    if(diff >= T() || diff * diff <= r2) {
+        searchRadius(2u * node + 2u, query, r2, found);
+    }
+}
+
+/*
+ * Collect the k nearest in a max-heap, then sort them.
+ */
+template <class T, size_t N>
+std::vector<Neighbor<T> > KdTree<T, N>::nearest(
+    const Coordinate<T, N> &query, size_t k) const {
+    std::vector<Neighbor<T> > heap;
+    if(k > 0u && !pts.empty()) {
+        heap.reserve(k < pts.size() ? k : pts.size());
+        searchNearest(0u, query, k, heap);
+    }
+    std::sort_heap(heap.begin(), heap.end());
+    return heap;
+}
+
+/*
+ * Collect every point in the ball, then sort them.
+ */
+template <class T, size_t N>
+std::vector<Neighbor<T> > KdTree<T, N>::withinRadius(
+    const Coordinate<T, N> &query, T radius) const {
+    std::vector<Neighbor<T> > found;
+    if(!pts.empty() && radius >= T()) {
+        searchRadius(0u, query, radius * radius, found);
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+/*
+ * Size the cells from the bounding box, then counting sort the points.
+ */
+template <class T, size_t N>
+UniformGrid<T, N>::UniformGrid(const std::vector<Coordinate<T, N> > &points) :
+    cellsPerDim(1u), minWidth(T(1)) {
+    if(points.size() >= (uint64_t(1u) << 32)) {
+        throw std::length_error("too many points in UniformGrid::UniformGrid()");
+    }
+
+    // about two points per cell, and at most 2^24 cells
+    cellsPerDim = size_t(std::pow(points.size() / 2.0, 1.0 / N));
+    if(cellsPerDim < 1u) {
+        cellsPerDim = 1u;
+    }
+    while(std::pow(double(cellsPerDim), double(N)) > 16777216.0) {
+        cellsPerDim--;
+    }
+    size_t cells = 1u;
+    for(size_t d = 0u; d < N; d++) {
+        cells *= cellsPerDim;
+    }
+
+    for(size_t d = 0u; d < N; d++) {
+        T lo = T(), hi = T();
+        for(size_t i = 0u; i < points.size(); i++) {
+            T v = points[i].data()[d];
+            if(i == 0u || v < lo) {
+                lo = v;
+            }
+            if(i == 0u || v > hi) {
+                hi = v;
+            }
+        }
+        T width = (hi - lo) / cellsPerDim;
+        if(!(width > T())) {
+            width = T(1);
+        }
+        lower[d] = lo;
+        invWidth[d] = T(1) / width;
+        if(d == 0u || width < minWidth) {
+            minWidth = width;
+        }
+    }
+
+    // counting sort by cell number
+    std::vector<uint32_t> cellOfPoint(points.size());
+    cellStart.assign(cells + 1u, 0u);
+    for(size_t i = 0u; i < points.size(); i++) {
+        size_t cell = 0u;
+        for(size_t d = N; d-- > 0u; ) {
+            cell = cell * cellsPerDim + cellOf(points[i].data()[d], d);
+        }
+        cellOfPoint[i] = uint32_t(cell);
+        cellStart[cell + 1u]++;
+    }
+    for(size_t c = 0u; c < cells; c++) {
+        cellStart[c + 1u] += cellStart[c];
+    }
+    std::vector<uint32_t> next(cellStart.begin(), cellStart.end() - 1);
+    pts.resize(points.size());
+    ids.resize(points.size());
+    for(size_t i = 0u; i < points.size(); i++) {
+        uint32_t slot = next[cellOfPoint[i]]++;
+        pts[slot] = points[i];
+        ids[slot] = uint32_t(i);
+    }
+}
+
+/*
+ * Cell number along one dimension, clamped to the grid.
+ */
+template <class T, size_t N>
+size_t UniformGrid<T, N>::cellOf(T value, size_t d) const {
+    T pos = (value - lower[d]) * invWidth[d];
+    if(!(pos > T())) {
+        return 0u;
+    }
+    return pos >= T(cellsPerDim) ? cellsPerDim - 1u : size_t(pos);
+}
+
+/*
+ * Odometer over the box, first dimension fastest.
+ */
+template <class T, size_t N>
+template <class V>
+void UniformGrid<T, N>::scanCells(const size_t lo[N], const size_t hi[N],
+    const size_t center[N], size_t ring, V visit) const {
+    size_t idx[N];
+    for(size_t d = 0u; d < N; d++) {
+        idx[d] = lo[d];
+    }
+
+    for(;;) {
+        // a cell is on the ring if it is ring cells away in some dimension
+        bool onRing = (ring == 0u);
+        size_t cell = 0u;
+        for(size_t d = N; d-- > 0u; ) {
+            size_t off = idx[d] > center[d] ? idx[d] - center[d] :
+                center[d] - idx[d];
+            onRing = onRing || off == ring;
+            cell = cell * cellsPerDim + idx[d];
+        }
+        if(onRing) {
+            visit(cellStart[cell], cellStart[cell + 1u]);
+        }
+
+        size_t d = 0u;
+        while(d < N && idx[d] == hi[d]) {
+            idx[d] = lo[d];
+            d++;
+        }
+        if(d == N) {
+            return;
+        }
+        idx[d]++;
+    }
+}
+
+/*
+ * Scan rings of cells outward until the k-th neighbor is closer than any
+ * unscanned cell.
+ */
+template <class T, size_t N>
+std::vector<Neighbor<T> > UniformGrid<T, N>::nearest(
+    const Coordinate<T, N> &query, size_t k) const {
+    std::vector<Neighbor<T> > heap;
+    if(k == 0u || pts.empty()) {
+        return heap;
+    }
+    heap.reserve(k < pts.size() ? k : pts.size());
+
+    size_t center[N], lo[N], hi[N];
+    for(size_t d = 0u; d < N; d++) {
+        center[d] = cellOf(query.data()[d], d);
+    }
+
+    auto visit = [this, &query, &heap, k](uint32_t begin, uint32_t end) {
+        for(uint32_t i = begin; i < end; i++) {
+            offerNeighbor(heap, k, ids[i], query.squaredDistanceTo(pts[i]));
+        }
+    };
+    for(size_t ring = 0u; ring < cellsPerDim; ring++) {
+        for(size_t d = 0u; d < N; d++) {
+            lo[d] = center[d] > ring ? center[d] - ring : 0u;
+            hi[d] = center[d] + ring < cellsPerDim ? center[d] + ring :
+                cellsPerDim - 1u;
+        }
+        scanCells(lo, hi, center, ring, visit);
+
+        // unscanned cells are at least ring cell widths away
+        T bound = T(ring) * minWidth;
+        if(heap.size() == k && heap.front().squaredDistance < bound * bound) {
+            break;
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+    return heap;
+}
+
+/*
+ * Scan the cells overlapping the bounding box of the ball.
+ */
+template <class T, size_t N>
+std::vector<Neighbor<T> > UniformGrid<T, N>::withinRadius(
+    const Coordinate<T, N> &query, T radius) const {
+    std::vector<Neighbor<T> > found;
+    if(pts.empty() || radius < T()) {
+        return found;
+    }
+
+    size_t lo[N], hi[N];
+    for(size_t d = 0u; d < N; d++) {
+        lo[d] = cellOf(query.data()[d] - radius, d);
+        hi[d] = cellOf(query.data()[d] + radius, d);
+    }
+    T r2 = radius * radius;
+    scanCells(lo, hi, lo, 0u, [this, &query, &found, r2](uint32_t begin,
+        uint32_t end) {
+        for(uint32_t i = begin; i < end; i++) {
+            T d2 = query.squaredDistanceTo(pts[i]);
+            if(d2 <= r2) {
+                Neighbor<T> nb = { ids[i], d2 };
+                found.push_back(nb);
+            }
+        }
+    });
+
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+/*
+ * Each thread fills its own rows of the result.
+ */
+template <class Index, class T, size_t N>
+std::vector<Neighbor<T> > nearestBatch(const Index &index,
+    const std::vector<Coordinate<T, N> > &queries, size_t k,
+    unsigned numThreads) {
+    if(numThreads == 0u) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    if(numThreads == 0u) {
+        numThreads = 1u;
+    }
+
+    Neighbor<T> empty = { SIZE_MAX, T() };
+    std::vector<Neighbor<T> > out(queries.size() * k, empty);
+    std::vector<std::thread> threads;
+    size_t slice = queries.size() / numThreads;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        size_t first = t * slice;
+        size_t last = (t == numThreads - 1u) ? queries.size() : first + slice;
+        threads.push_back(std::thread([&index, &queries, &out, k, first,
+            last]() {
+            for(size_t q = first; q < last; q++) {
+                std::vector<Neighbor<T> > row = index.nearest(queries[q], k);
+                std::copy(row.begin(), row.end(), out.begin() + q * k);
+            }
+        }));
+    }
+    for(unsigned t = 0u; t < numThreads; t++) {
+        threads[t].join();
+    }
+
+    return out;
+}
+
+/**
+ * Helper function for the tests: check an index's queries against brute
+ * force over pseudo-random points, some of them duplicates.
+ */
+template <class Index, class T, size_t N>
+void checkIndex(size_t n) {
+    std::vector<Coordinate<T, N> > points(n);
+    unsigned state = 246u;
+    for(size_t i = 0u; i < n; i++) {
+        for(size_t d = 0u; d < N; d++) {
+            state = state * 1103515245u + 12345u;
+            points[i].set(d, T(state >> 16) / 65536);
+        }
+    }
+    for(size_t i = 0u; i < n / 10u; i++) {
+        points[n - 1u - i] = points[i];
+    }
+    Index index(points);
+    CHECK(index.size() == n);
+
+    std::vector<Coordinate<T, N> > queries(20u);
+    for(size_t q = 0u; q < queries.size(); q++) {
+        for(size_t d = 0u; d < N; d++) {
+            state = state * 1103515245u + 12345u;
+            // some queries fall outside the bounding box
+            queries[q].set(d, T(state >> 16) / 52000 - T(0.1));
+        }
+    }
+    queries[0] = points[3];
+
+    for(size_t q = 0u; q < queries.size(); q++) {
+        std::vector<Neighbor<T> > all(n);
+        for(size_t i = 0u; i < n; i++) {
+            all[i].index = i;
+            all[i].squaredDistance = queries[q].squaredDistanceTo(points[i]);
+        }
+        std::sort(all.begin(), all.end());
+
+        std::vector<Neighbor<T> > knn = index.nearest(queries[q], 7u);
+        REQUIRE(knn.size() == 7u);
+        for(size_t j = 0u; j < 7u; j++) {
+            CHECK(knn[j].index == all[j].index);
+            CHECK(knn[j].squaredDistance == all[j].squaredDistance);
+        }
+
+        T radius = T(0.2);
+        size_t inside = 0u;
+        while(inside < n && all[inside].squaredDistance <= radius * radius) {
+            inside++;
+        }
+        std::vector<Neighbor<T> > ball = index.withinRadius(queries[q],
+            radius);
+        REQUIRE(ball.size() == inside);
+        for(size_t j = 0u; j < inside; j++) {
+            CHECK(ball[j].index == all[j].index);
+        }
+    }
+
+    // batches match single queries, for any number of threads
+    std::vector<Neighbor<T> > batch = nearestBatch(index, queries, 3u, 3u);
+    REQUIRE(batch.size() == 3u * queries.size());
+    for(size_t q = 0u; q < queries.size(); q++) {
+        std::vector<Neighbor<T> > knn = index.nearest(queries[q], 3u);
+        for(size_t j = 0u; j < 3u; j++) {
+            CHECK(batch[q * 3u + j].index == knn[j].index);
+        }
+    }
+
+    // asking for more neighbors than points returns them all
+    CHECK(index.nearest(queries[1], n + 5u).size() == n);
+    CHECK(index.nearest(queries[1], 0u).empty());
+}
+
+// doctest unit tests for the spatial indexes
+TEST_CASE("testing KdTree") {
+    checkIndex<KdTree<double, 2>, double, 2>(1000u);
+    checkIndex<KdTree<float, 3>, float, 3>(500u);
+    checkIndex<KdTree<double, 5>, double, 5>(300u);
+    checkIndex<KdTree<double, 2>, double, 2>(10u);
+
+    // an empty tree finds nothing
+    std::vector<Coordinate<double, 2> > none;
+    KdTree<double, 2> empty(none);
+    CHECK(empty.nearest(Coordinate<double, 2>(), 3u).empty());
+    CHECK(empty.withinRadius(Coordinate<double, 2>(), 1.0).empty());
+}
+
+TEST_CASE("testing UniformGrid") {
+    checkIndex<UniformGrid<double, 2>, double, 2>(1000u);
+    checkIndex<UniformGrid<float, 3>, float, 3>(500u);
+    checkIndex<UniformGrid<double, 2>, double, 2>(10u);
+
+    // every point in one place
+    std::vector<Coordinate<double, 2> > same(50u,
+        Coordinate<double, 2>(1.0, 1.0));
+    UniformGrid<double, 2> grid(same);
+    CHECK(grid.nearest(Coordinate<double, 2>(0.0, 0.0), 5u).size() == 5u);
+    CHECK(grid.withinRadius(Coordinate<double, 2>(1.0, 1.0), 0.0).size() ==
+        50u);
+
+    std::vector<Coordinate<double, 2> > none;
+    UniformGrid<double, 2> empty(none);
+    CHECK(empty.nearest(Coordinate<double, 2>(), 3u).empty());
+    CHECK(empty.withinRadius(Coordinate<double, 2>(), 1.0).empty());
+}
@@ -0,0 +1,4 @@
+// phantom C++ file for SpatialIndex unit testing. This file only includes the
+// SpatialIndex header; doctest generates the testing program based on unit
+// tests written alongside the code in the header file
+#include "SpatialIndex.hpp"
\ No newline at end of file
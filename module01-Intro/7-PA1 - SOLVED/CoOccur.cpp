@@ -0,0 +1,68 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "CoOccurrence.h"
+#include "DrawReader.h"
+
+/**
+ * Program to find the number pairs and triples that most often occur
+ * together in PowerBall lottery drawings. Usage:
+ *
+ *     CoOccur [file [k [threads]]]
+ *
+ * where file is the draw file (default numbers.txt), k is the number of top
+ * pairs and triples to report (default 10), and threads is the number of 
+ * counting threads (default one per core).
+ */
+int main(int argc, char **argv) {
+    std::string fileName = "numbers.txt";
+    size_t k = 10u;
+    unsigned numThreads = 0u;
+    if(argc > 1) {
+        fileName = argv[1];
+    }
+    if(argc > 2) {
+        k = std::strtoul(argv[2], 0, 10);
+    }
+    if(argc > 3) {
+        numThreads = unsigned(std::strtoul(argv[3], 0, 10));
+    }
+
+    // PowerBall numbers are in [1, 59], six to a draw
+    CoOccurrence co(59);
+    try {
+        DrawReader reader(fileName);
+        std::vector<uint32_t> vals = reader.parseAll();
+        size_t numDraws = vals.size() / 6u;
+
+        auto start = std::chrono::steady_clock::now();
+        co.addDraws(vals.data(), numDraws, 6u, numThreads);
+        auto stop = std::chrono::steady_clock::now();
+
+        double secs = std::chrono::duration<double>(stop - start).count();
+        std::cerr << "Counted " << numDraws << " draws in " << secs << 
+            " s (" << (numDraws / secs / 1.0e6) << " M draws/s)" << std::endl;
+    } catch(std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Top " << k << " pairs:\n";
+    std::vector<CoOccurrence::Group> pairs = co.topPairs(k);
+    for(size_t i = 0u; i < pairs.size(); i++) {
+        std::cout << pairs[i].a << "\t" << pairs[i].b << "\t" << 
+            pairs[i].count << "\n";
+    }
+
+    std::cout << "\nTop " << k << " triples:\n";
+    std::vector<CoOccurrence::Group> triples = co.topTriples(k);
+    for(size_t i = 0u; i < triples.size(); i++) {
+        std::cout << triples[i].a << "\t" << triples[i].b << "\t" << 
+            triples[i].c << "\t" << triples[i].count << "\n";
+    }
+
+    return EXIT_SUCCESS;
+}
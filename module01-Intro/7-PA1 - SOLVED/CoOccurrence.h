@@ -0,0 +1,523 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <doctest.h>
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Pair and triple co-occurrence counter for lottery draws.
+ *
+ * This class is the companion of ObjectCounter for questions about which
+ * objects occur together. Objects are labeled in the closed range [1, n],
+ * with n at most 63, and each draw is stored as a 64-bit mask with bit i set
+ * if object i was drawn. The pairs and triples in a draw are enumerated
+ * directly from the set bits of its mask, so the cost of a draw depends only
+ * on how many objects were drawn, not on n.
+ */
+class CoOccurrence {
+public:
+    /**
+     * @brief Count of one pair or triple of object labels.
+     *
+     * Unused labels are zero, so a pair has c equal to zero.
+     */
+    struct Group {
+        /** Smallest label in the group. */
+        unsigned a;
+        /** Middle label in the group, or the largest label for a pair. */
+        unsigned b;
+        /** Largest label in a triple, zero for a pair. */
+        unsigned c;
+        /** Number of draws containing the whole group. */
+        unsigned count;
+    };
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * Create a co-occurrence counter for objects numbered from 1 to num.
+     *
+     * @param num Upper limit (inclusive) for range of object labels.
+     *
+     * @throws std::invalid_argument if num is greater than 63.
+     */
+    CoOccurrence(size_t num);
+
+    /**
+     * @brief Build the mask for one draw.
+     *
+     * @param pDraw Pointer to the labels in the draw.
+     * @param k Number of labels in the draw. Repeated labels are counted
+     * once.
+     *
+     * @return Mask with bit i set for each label i in the draw.
+     *
+     * @throws std::out_of_range if any label is less than 1 or greater than
+     * num.
+     */
+    uint64_t drawMask(const uint32_t *pDraw, size_t k) const;
+
+    /**
+     * @brief Count the pairs and triples in a batch of draws.
+     *
+     * The batch is split into one contiguous slice per thread. Each thread
+     * counts its slice into private pair and triple tables, which are merged
+     * into this counter when all threads are done.
+     *
+     * @param pMasks Pointer to the first draw mask, built by drawMask().
+     * @param count Number of draws in the batch.
+     * @param numThreads Number of threads to use, or 0 to use one thread per
+     * hardware core.
+     *
+     * @throws std::out_of_range if any mask has a bit set outside [1, num].
+     */
+    void addDraws(const uint64_t *pMasks, size_t count,
+        unsigned numThreads = 1u);
+
+    /**
+     * @brief Count the pairs and triples in a batch of draws.
+     *
+     * Convenience version of addDraws() for draws stored as consecutive
+     * groups of k labels, like the rows of a PowerBall draw file.
+     *
+     * @param pVals Pointer to the first label of the first draw.
+     * @param numDraws Number of draws in the batch.
+     * @param k Number of labels per draw.
+     * @param numThreads Number of threads to use, or 0 to use one thread per
+     * hardware core.
+     *
+     * @throws std::out_of_range if any label is less than 1 or greater than
+     * num.
+     */
+    void addDraws(const uint32_t *pVals, size_t numDraws, size_t k,
+        unsigned numThreads = 1u);
+
+    /**
+     * @brief Accessor for a pair count.
+     *
+     * @param i Label of one object in the pair.
+     * @param j Label of the other object in the pair.
+     *
+     * @return Number of draws containing both i and j.
+     *
+     * @throws std::out_of_range if either label is out of range or the
+     * labels are equal.
+     */
+    unsigned getPairCount(size_t i, size_t j) const;
+
+    /**
+     * @brief Accessor for a triple count.
+     *
+     * @param i Label of one object in the triple.
+     * @param j Label of another object in the triple.
+     * @param k Label of the last object in the triple.
+     *
+     * @return Number of draws containing i, j, and k.
+     *
+     * @throws std::out_of_range if any label is out of range or any two of
+     * the labels are equal.
+     */
+    unsigned getTripleCount(size_t i, size_t j, size_t k) const;
+
+    /**
+     * @brief Most frequent pairs.
+     *
+     * @param k Number of pairs to report.
+     *
+     * @return Up to k pairs, most frequent first. Ties are broken by label
+     * order, so the result is deterministic.
+     */
+    std::vector<Group> topPairs(size_t k) const;
+
+    /**
+     * @brief Most frequent triples.
+     *
+     * @param k Number of triples to report.
+     *
+     * @return Up to k triples, most frequent first. Ties are broken by label
+     * order, so the result is deterministic.
+     */
+    std::vector<Group> topTriples(size_t k) const;
+
+    /**
+     * @brief Reset the state of the counter.
+     *
+     * Reset all of the pair and triple counts to zero.
+     */
+    void resetCounter();
+
+private:
+    /**
+     * Helper method to count a slice of draws into pair and triple tables
+     * laid out like the pairs and triples fields.
+     */
+    static void countSlice(const uint64_t *pMasks, size_t count,
+        unsigned *pPairs, unsigned *pTriples);
+
+    /**
+     * Helper method to sort groups most frequent first and keep k of them.
+     */
+    static std::vector<Group> topGroups(std::vector<Group> &groups, size_t k);
+
+    /** Number of draws counted together when blocking the triple table. */
+    static const size_t DRAW_BLOCK = 2048u;
+
+    /** Number of smallest labels whose triple rows are updated together. */
+    static const unsigned LABEL_BAND = 8u;
+
+    /** Mask of the valid label bits, 1 through num. */
+    uint64_t validBits;
+
+    /** Number of object labels, num from the constructor. */
+    size_t n;
+
+    /** Pair counts, 64 x 64, indexed [smaller label][larger label]. */
+    std::vector<unsigned> pairs;
+
+    /** Triple counts, 64 x 64 x 64, indexed by labels in increasing order. */
+    std::vector<unsigned> triples;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Create the pair and triple tables.
+ */
+CoOccurrence::CoOccurrence(size_t num) : validBits(0u), n(num),
+    pairs(64u * 64u, 0u), triples(64u * 64u * 64u, 0u) {
+    if(num > 63u) {
+        throw std::invalid_argument("too many labels in CoOccurrence::CoOccurrence()");
+    }
+
+    // bits 1 through num
+    validBits = ((num == 63u) ? ~uint64_t(0) : (uint64_t(1) << (num + 1u)) - 1u)
+        & ~uint64_t(1);
+}
+
+/*
+ * Build the bit mask for one draw.
+ */
+uint64_t CoOccurrence::drawMask(const uint32_t *pDraw, size_t k) const {
+    uint64_t mask = 0u;
+    for(size_t i = 0u; i < k; i++) {
+        if(pDraw[i] < 1u || pDraw[i] > n) {
+            throw std::out_of_range("index out of range in CoOccurrence::drawMask()");
+        }
+        mask |= uint64_t(1) << pDraw[i];
+    }
+
+    return mask;
+}
+
+/*
+ * Count one slice of draws into private tables.
+ */
+void CoOccurrence::countSlice(const uint64_t *pMasks, size_t count,
+    unsigned *pPairs, unsigned *pTriples) {
+    for(size_t start = 0u; start < count; start += DRAW_BLOCK) {
+        size_t end = std::min(count, start + DRAW_BLOCK);
+
+        // pairs: the whole 16 KiB table stays in L1
+        for(size_t d = start; d < end; d++) {
+            uint64_t m = pMasks[d];
+            while(m != 0u) {
+                unsigned i = __builtin_ctzll(m);
+                m &= m - 1u;    // clear lowest set bit
+                for(uint64_t r = m; r != 0u; r &= r - 1u) {
+                    pPairs[(i << 6) + __builtin_ctzll(r)]++;
+                }
+            }
+        }
+
+        // triples: sweep the block once per band of smallest labels, so
+        // only LABEL_BAND rows of the 1 MiB table are touched at a time
+        for(unsigned band = 0u; band < 64u; band += LABEL_BAND) {
+            uint64_t bandBits = ((uint64_t(1) << LABEL_BAND) - 1u) << band;
+            for(size_t d = start; d < end; d++) {
+                uint64_t m = pMasks[d];
+                uint64_t lows = m & bandBits;
+                while(lows != 0u) {
+                    unsigned i = __builtin_ctzll(lows);
+                    lows &= lows - 1u;
+
+                    // labels above i, then each pair among them
+                    uint64_t above = m & ~((uint64_t(2) << i) - 1u);
+                    if(__builtin_popcountll(above) < 2) {
+                        continue;
+                    }
+                    unsigned *pRow = pTriples + (size_t(i) << 12);
+                    while(above != 0u) {
+                        unsigned j = __builtin_ctzll(above);
+                        above &= above - 1u;
+                        for(uint64_t r = above; r != 0u; r &= r - 1u) {
+                            pRow[(j << 6) + __builtin_ctzll(r)]++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Count a batch of draw masks, with one set of private tables per thread.
+ */
+void CoOccurrence::addDraws(const uint64_t *pMasks, size_t count,
+    unsigned numThreads) {
+    // validate the whole batch first, so a bad mask changes nothing
+    for(size_t d = 0u; d < count; d++) {
+        if((pMasks[d] & ~validBits) != 0u) {
+            throw std::out_of_range("index out of range in CoOccurrence::addDraws()");
+        }
+    }
+
+    if(numThreads == 0u) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    if(numThreads <= 1u) {
+        countSlice(pMasks, count, &pairs[0], &triples[0]);
+        return;
+    }
+
+    std::vector<std::vector<unsigned> > threadPairs(numThreads,
+        std::vector<unsigned>(pairs.size(), 0u));
+    std::vector<std::vector<unsigned> > threadTriples(numThreads,
+        std::vector<unsigned>(triples.size(), 0u));
+    std::vector<std::thread> threads;
+    size_t slice = count / numThreads;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        size_t start = t * slice;
+        size_t len = (t == numThreads - 1u) ? count - start : slice;
+        threads.push_back(std::thread(&CoOccurrence::countSlice,
+            pMasks + start, len, &threadPairs[t][0], &threadTriples[t][0]));
+    }
+    for(size_t t = 0u; t < threads.size(); t++) {
+        threads[t].join();
+    }
+
+    // merge the private tables
+    for(unsigned t = 0u; t < numThreads; t++) {
+        for(size_t i = 0u; i < pairs.size(); i++) {
+            pairs[i] += threadPairs[t][i];
+        }
+        for(size_t i = 0u; i < triples.size(); i++) {
+            triples[i] += threadTriples[t][i];
+        }
+    }
+}
+
+/*
+ * Count a batch of draws stored as groups of k labels.
+ */
+void CoOccurrence::addDraws(const uint32_t *pVals, size_t numDraws, size_t k,
+    unsigned numThreads) {
+    std::vector<uint64_t> masks(numDraws);
+    for(size_t d = 0u; d < numDraws; d++) {
+        masks[d] = drawMask(pVals + d * k, k);
+    }
+    if(numDraws > 0u) {
+        addDraws(&masks[0], numDraws, numThreads);
+    }
+}
+
+/*
+ * Get the count for the pair (i, j).
+ */
+unsigned CoOccurrence::getPairCount(size_t i, size_t j) const {
+    if(i > j) {
+        std::swap(i, j);
+    }
+    if(i < 1u || j > n || i == j) {
+        throw std::out_of_range("index out of range in CoOccurrence::getPairCount()");
+    }
+
+    return pairs[(i << 6) + j];
+}
+
+/*
+ * Get the count for the triple (i, j, k).
+ */
+unsigned CoOccurrence::getTripleCount(size_t i, size_t j, size_t k) const {
+    // sort the three labels
+    if(i > j) std::swap(i, j);
+    if(j > k) std::swap(j, k);
+    if(i > j) std::swap(i, j);
+    if(i < 1u || k > n || i == j || j == k) {
+        throw std::out_of_range("index out of range in CoOccurrence::getTripleCount()");
+    }
+
+    return triples[(i << 12) + (j << 6) + k];
+}
+
+/*
+ * Sort groups by decreasing count, then increasing labels, and keep k.
+ */
+std::vector<CoOccurrence::Group> CoOccurrence::topGroups(
+    std::vector<Group> &groups, size_t k) {
+    k = std::min(k, groups.size());
+    std::partial_sort(groups.begin(), groups.begin() + k, groups.end(),
+        [](const Group &x, const Group &y) {
+            if(x.count != y.count) return x.count > y.count;
+            if(x.a != y.a) return x.a < y.a;
+            if(x.b != y.b) return x.b < y.b;
+            return x.c < y.c;
+        });
+    groups.resize(k);
+
+    return groups;
+}
+
+/*
+ * Report the k most frequent pairs.
+ */
+std::vector<CoOccurrence::Group> CoOccurrence::topPairs(size_t k) const {
+    std::vector<Group> groups;
+    for(unsigned i = 1u; i <= n; i++) {
+        for(unsigned j = i + 1u; j <= n; j++) {
+            Group g = { i, j, 0u, pairs[(i << 6) + j] };
+            groups.push_back(g);
+        }
+    }
+
+    return topGroups(groups, k);
+}
+
+/*
+ * Report the k most frequent triples.
+ */
+std::vector<CoOccurrence::Group> CoOccurrence::topTriples(size_t k) const {
+    std::vector<Group> groups;
+    for(unsigned i = 1u; i <= n; i++) {
+        for(unsigned j = i + 1u; j <= n; j++) {
+            for(unsigned l = j + 1u; l <= n; l++) {
+                Group g = { i, j, l, triples[(i << 12) + (j << 6) + l] };
+                groups.push_back(g);
+            }
+        }
+    }
+
+    return topGroups(groups, k);
+}
+
+/*
+ * Reset all counts to zero.
+ */
+void CoOccurrence::resetCounter() {
+    std::fill(pairs.begin(), pairs.end(), 0u);
+    std::fill(triples.begin(), triples.end(), 0u);
+}
+
+// doctest unit test for counting pairs and triples
+TEST_CASE("testing CoOccurrence::addDraws") {
+    CoOccurrence co(59), coThreaded(59);
+
+    // three draws; 1 and 2 are together in all of them, 1, 2, 3 in two
+    uint32_t draws[] = { 1, 2, 3, 4,
+                         2, 1, 3, 59,
+                         1, 2, 58, 59 };
+    co.addDraws(draws, 3, 4);
+    coThreaded.addDraws(draws, 3, 4, 3u);
+
+    CHECK(co.getPairCount(1, 2) == 3u);
+    CHECK(co.getPairCount(2, 1) == 3u);
+    CHECK(co.getPairCount(3, 59) == 1u);
+    CHECK(co.getPairCount(4, 59) == 0u);
+    CHECK(co.getTripleCount(1, 2, 3) == 2u);
+    CHECK(co.getTripleCount(59, 1, 2) == 2u);
+    CHECK(co.getTripleCount(1, 58, 59) == 1u);
+    CHECK(co.getTripleCount(3, 4, 59) == 0u);
+    for(size_t i = 1; i <= 59; i++) {
+        for(size_t j = i + 1; j <= 59; j++) {
+            CHECK(co.getPairCount(i, j) == coThreaded.getPairCount(i, j));
+            for(size_t l = j + 1; l <= 59; l++) {
+                CHECK(co.getTripleCount(i, j, l) ==
+                    coThreaded.getTripleCount(i, j, l));
+            }
+        }
+    }
+
+    // a bigger batch that doesn't split evenly between the threads, added
+    // on top of counts already there
+    CoOccurrence many(59), manyThreaded(59);
+    std::vector<uint32_t> manyDraws(1001u * 6u);
+    for(size_t d = 0u; d < 1001u; d++) {
+        for(size_t j = 0u; j < 6u; j++) {
+            manyDraws[d * 6u + j] = uint32_t((d * d * 7u + j * 11u) % 59u + 1u);
+        }
+    }
+    many.addDraws(draws, 3, 4);
+    many.addDraws(&manyDraws[0], 1001u, 6u, 1u);
+    manyThreaded.addDraws(draws, 3, 4, 2u);
+    manyThreaded.addDraws(&manyDraws[0], 1001u, 6u, 4u);
+    size_t pairsDiffer = 0u, triplesDiffer = 0u;
+    unsigned triplesTotal = 0u;
+    for(size_t i = 1; i <= 59; i++) {
+        for(size_t j = i + 1; j <= 59; j++) {
+            pairsDiffer += many.getPairCount(i, j) !=
+                manyThreaded.getPairCount(i, j);
+            for(size_t l = j + 1; l <= 59; l++) {
+                triplesDiffer += many.getTripleCount(i, j, l) !=
+                    manyThreaded.getTripleCount(i, j, l);
+                triplesTotal += manyThreaded.getTripleCount(i, j, l);
+            }
+        }
+    }
+    CHECK(pairsDiffer == 0u);
+    CHECK(triplesDiffer == 0u);
+    CHECK(triplesTotal == 3u * 4u + 1001u * 20u);
+
+    // top groups, most frequent first, ties in label order
+    std::vector<CoOccurrence::Group> top = co.topPairs(3);
+    REQUIRE(top.size() == 3u);
+    CHECK(top[0].a == 1u);
+    CHECK(top[0].b == 2u);
+    CHECK(top[0].count == 3u);
+    CHECK(top[1].a == 1u);
+    CHECK(top[1].b == 3u);
+    CHECK(top[1].count == 2u);
+    std::vector<CoOccurrence::Group> top3 = co.topTriples(1);
+    REQUIRE(top3.size() == 1u);
+    CHECK(top3[0].a == 1u);
+    CHECK(top3[0].b == 2u);
+    CHECK(top3[0].c == 3u);
+    CHECK(top3[0].count == 2u);
+
+    // check exception handling
+    bool flag = true;
+    try {
+        uint32_t bad[] = { 1, 60 };
+        co.addDraws(bad, 1, 2);     // should throw an exception
+        flag = false;               // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        co.getPairCount(5, 5);      // should throw an exception
+        flag = false;               // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        CoOccurrence tooBig(64);    // should throw an exception
+        flag = false;               // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+    CHECK(co.getPairCount(1, 2) == 3u);
+
+    // reset clears everything
+    co.resetCounter();
+    CHECK(co.getPairCount(1, 2) == 0u);
+    CHECK(co.getTripleCount(1, 2, 3) == 0u);
+}
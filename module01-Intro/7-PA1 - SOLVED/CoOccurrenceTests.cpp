@@ -0,0 +1,4 @@
+// phantom C++ file for CoOccurrence unit testing. This file only includes the 
+// CoOccurrence header; doctest generates the testing program based on unit 
+// tests written alongside the code in the header file
+#include "CoOccurrence.h"
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "ConcurrentObjectCounter.h"
+#include "ObjectCounter.h"
+
+/**
+ * @brief Time many threads sharing one counter.
+ *
+ * Splits total increments evenly among numThreads threads, each of which 
+ * walks its own copy of the synthetic draws, and returns the elapsed time.
+ *
+ * @param numThreads Number of threads to start.
+ * @param total Total number of increments, over all threads.
+ * @param draws Synthetic draws to count, reused as needed.
+ * @param inc Function that counts one label; called from every thread.
+ *
+ * @return Elapsed time, in seconds.
+ */
+template <class F>
+double timeThreads(unsigned numThreads, uint64_t total,
+    const std::vector<uint8_t> &draws, F inc) {
+    uint64_t each = total / numThreads;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        threads.push_back(std::thread([&draws, each, t, inc]() {
+            size_t pos = (t * 4099u) % draws.size();
+            for(uint64_t i = 0u; i < each; i++) {
+                inc(draws[pos]);
+                if(++pos == draws.size()) {
+                    pos = 0u;
+                }
+            }
+        }));
+    }
+    for(size_t t = 0u; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+/**
+ * Scaling benchmark for counting from many threads at once. For 1, 2, 4, 
+ * ..., 64 threads, a fixed total number of increments (the first command 
+ * line argument, default 64 million) is split among the threads, which count 
+ * into a mutex-guarded ObjectCounter and into a ConcurrentObjectCounter. 
+ * Reports millions of increments per second for each.
+ */
+int main(int argc, char **argv) {
+    uint64_t total = 64000000u;
+    if(argc > 1) {
+        total = std::strtoull(argv[1], 0, 10);
+    }
+
+    // 1M synthetic draws in [1, 59]
+    std::mt19937_64 prng(246);
+    std::uniform_int_distribution<int> dist(1, 59);
+    std::vector<uint8_t> draws(1u << 20);
+    for(size_t i = 0u; i < draws.size(); i++) {
+        draws[i] = uint8_t(dist(prng));
+    }
+
+    std::cout << "threads\tmutex (M/s)\tsharded (M/s)" << std::endl;
+    for(unsigned numThreads = 1u; numThreads <= 64u; numThreads *= 2u) {
+        ObjectCounter oc(59);
+        std::mutex lock;
+        double mutexSecs = timeThreads(numThreads, total, draws,
+            [&oc, &lock](uint8_t v) {
+                std::lock_guard<std::mutex> guard(lock);
+                oc.increment(v);
+            });
+
+        ConcurrentObjectCounter coc(59);
+        double shardSecs = timeThreads(numThreads, total, draws,
+            [&coc](uint8_t v) {
+                coc.increment(v);
+            });
+
+        // both counters must agree
+        std::vector<unsigned> counts = coc.getCounts();
+        for(size_t i = 1u; i <= 59u; i++) {
+            if(counts[i] != oc.getCount(i)) {
+                std::cerr << "count mismatch for " << i << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        uint64_t done = total / numThreads * numThreads;
+        std::cout << numThreads << "\t" << (done / mutexSecs / 1.0e6) << 
+            "\t\t" << (done / shardSecs / 1.0e6) << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,360 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <doctest.h>
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Thread-safe object counter with sharded atomic counts.
+ *
+ * This class counts objects labeled in the closed range [1, n], like
+ * ObjectCounter, but any number of threads may call increment() at the same
+ * time. Each shard holds its own copy of every count, starting on its own
+ * cache line. Each thread gets a slot number the first time it increments,
+ * in order of first use, and always writes to shard slot % numShards.
+ * Shards belong to threads, not cores: the operating system may run any
+ * thread on any core, and with more threads than shards some threads share
+ * a shard. Threads on different shards never write to the same cache line,
+ * so increments scale with the number of cores as long as there are no
+ * more busy threads than shards.
+ *
+ * Reads add the counts from every shard, and see every shard at one moment.
+ * Each shard also counts the increments started and finished on it, on a
+ * cache line after its counts; a read takes the finished counts, then the counts, then
+ * the started counts, and tries again unless every shard's started count
+ * matches its finished count, which shows no increment was under way on any
+ * shard while the counts were read. While a read is trying, new increments
+ * wait for it, so a read never has to try for long.
+ */
+class ConcurrentObjectCounter {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * Create a concurrent object counter for objects numbered from 1 to num.
+     *
+     * @param num Upper limit (inclusive) for range of object labels.
+     * @param numShards Number of shards, or 0 for as many shards as there
+     * are hardware cores.
+     */
+    ConcurrentObjectCounter(size_t num, unsigned numShards = 0u);
+
+    /**
+     * Free the object's memory.
+     */
+    ~ConcurrentObjectCounter() { delete [] pAlloc; }
+
+    /**
+     * @brief Add one to an individual count.
+     *
+     * Add one to the count associated with the object labeled idx. Safe to
+     * call from many threads at once.
+     *
+     * @param idx Label number for the object.
+     *
+     * @throws std::out_of_range if idx is less than 1 or greater than num.
+     */
+    void increment(size_t idx);
+
+    /**
+     * @brief Accessor for an individual count.
+     *
+     * Get the number of times the object labeled idx was seen, summed over
+     * every shard, at one moment. Safe to call while other threads
+     * increment.
+     *
+     * @param idx Label number for the object.
+     *
+     * @return Number of times object number idx was seen.
+     *
+     * @throws std::out_of_range if idx is less than 1 or greater than num.
+     */
+    unsigned getCount(size_t idx) const;
+
+    /**
+     * @brief Snapshot of every count.
+     *
+     * Get all of the counts, as they were at one moment: the snapshot holds
+     * every increment that finished before that moment, and none that
+     * started after it. Safe to call while other threads increment; each
+     * count in a snapshot is at least that in any earlier one.
+     *
+     * @return Vector of num + 1 counts, indexed by label; element zero is
+     * unused and always zero.
+     */
+    std::vector<unsigned> getCounts() const;
+
+    /**
+     * @brief Reset the state of the counter.
+     *
+     * Reset all of the object counts to zero. Must not be called while
+     * other threads are incrementing.
+     */
+    void resetCounter();
+
+private:
+    // the counters are atomics, which can't be copied
+    ConcurrentObjectCounter(const ConcurrentObjectCounter &);
+    ConcurrentObjectCounter &operator=(const ConcurrentObjectCounter &);
+
+    /**
+     * Helper method to call read(s, pShard) for every shard s, again and
+     * again until no increment ran on any shard during a pass; read starts
+     * its sums over when s is zero.
+     */
+    template <class F>
+    void readSnapshot(F read) const;
+
+    /**
+     * Helper method to get the calling thread's slot number. Threads are
+     * given slots in the order they first call it, whatever core they run
+     * on.
+     */
+    static unsigned threadSlot() {
+        static std::atomic<unsigned> nextSlot(0u);
+        thread_local unsigned slot = nextSlot.fetch_add(1u,
+            std::memory_order_relaxed);
+        return slot;
+    }
+
+    /** Number of counts per cache line. */
+    static const size_t LINE = 64u / sizeof(std::atomic<unsigned>);
+
+    /**
+     * Number of counts in each shard, 1 more than the number from the
+     * constructor. Element zero is unused.
+     */
+    size_t n;
+
+    /**
+     * Offsets in each shard of the numbers of increments started and
+     * finished on it, side by side on a cache line after the counts.
+     */
+    size_t started, finished;
+
+    /** Distance between shards, in whole cache lines. */
+    size_t stride;
+
+    /** Number of reads trying for a snapshot; increments wait while set. */
+    mutable std::atomic<unsigned> readers;
+
+    /** Number of shards. */
+    unsigned numShards;
+
+    /** Pointer to the allocated counters, before cache line alignment. */
+    std::atomic<unsigned> *pAlloc;
+
+    /** Pointer to the first shard, aligned to a cache line. */
+    std::atomic<unsigned> *pShards;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Allocate the shards and zero them.
+ */
+ConcurrentObjectCounter::ConcurrentObjectCounter(size_t num,
+    unsigned numShards) : n(num + 1u), started((num + LINE) / LINE * LINE),
+    finished(started + 1u), stride(started + LINE), readers(0u),
+    numShards(numShards), pAlloc(0), pShards(0) {
+    if(this->numShards == 0u) {
+        this->numShards = std::thread::hardware_concurrency();
+    }
+    if(this->numShards == 0u) {
+        this->numShards = 1u;
+    }
+
+    // allocate one extra line, then round the start up to a line boundary
+    pAlloc = new std::atomic<unsigned>[stride * this->numShards + LINE];
+    uintptr_t addr = reinterpret_cast<uintptr_t>(pAlloc);
+    uintptr_t aligned = (addr + 63u) & ~uintptr_t(63u);
+    pShards = pAlloc + (aligned - addr) / sizeof(std::atomic<unsigned>);
+
+    resetCounter();
+}
+
+/*
+ * Increment the count for object idx in this thread's shard.
+ */
+void ConcurrentObjectCounter::increment(size_t idx) {
+    if(idx < 1u || idx >= n) {
+        throw std::out_of_range("index out of range in ConcurrentObjectCounter::increment()");
+    }
+
+    std::atomic<unsigned> *pShard = pShards +
+        (threadSlot() % numShards) * stride;
+    while(readers.load() != 0u) {
+        std::this_thread::yield();
+    }
+
+    // a read that sees this count also sees that the increment started
+    pShard[started].fetch_add(1u);
+    std::atomic_thread_fence(std::memory_order_release);
+    pShard[idx].fetch_add(1u, std::memory_order_relaxed);
+    pShard[finished].fetch_add(1u);
+}
+
+/*
+ * Finished counts, then counts, then started counts; if they match, no
+ * increment ran while the counts were read.
+ */
+template <class F>
+void ConcurrentObjectCounter::readSnapshot(F read) const {
+    std::vector<unsigned> done(numShards);
+    readers.fetch_add(1u);
+    for(;;) {
+        for(unsigned s = 0u; s < numShards; s++) {
+            done[s] = pShards[s * stride + finished].load();
+        }
+        for(unsigned s = 0u; s < numShards; s++) {
+            read(s, pShards + s * stride);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        bool quiet = true;
+        for(unsigned s = 0u; s < numShards; s++) {
+            quiet = quiet && pShards[s * stride + started].load() == done[s];
+        }
+        if(quiet) {
+            break;
+        }
+        std::this_thread::yield();
+    }
+    readers.fetch_sub(1u);
+}
+
+/*
+ * Get the count for object idx, summed over all shards.
+ */
+unsigned ConcurrentObjectCounter::getCount(size_t idx) const {
+    if(idx < 1u || idx >= n) {
+        throw std::out_of_range("index out of range in ConcurrentObjectCounter::getCount()");
+    }
+
+    unsigned sum = 0u;
+    readSnapshot([&](unsigned s, const std::atomic<unsigned> *pShard) {
+        sum = (s == 0u ? 0u : sum) +
+            pShard[idx].load(std::memory_order_relaxed);
+    });
+
+    return sum;
+}
+
+/*
+ * Sum every shard into one vector of counts.
+ */
+std::vector<unsigned> ConcurrentObjectCounter::getCounts() const {
+    std::vector<unsigned> counts(n, 0u);
+
+    // shard by shard, so each shard's lines are read once, in order
+    readSnapshot([&](unsigned s, const std::atomic<unsigned> *pShard) {
+        for(size_t i = 1u; i < n; i++) {
+            counts[i] = (s == 0u ? 0u : counts[i]) +
+                pShard[i].load(std::memory_order_relaxed);
+        }
+    });
+
+    return counts;
+}
+
+/*
+ * Reset all counts to zero.
+ */
+void ConcurrentObjectCounter::resetCounter() {
+    for(size_t i = 0u; i < stride * numShards; i++) {
+        pShards[i].store(0u, std::memory_order_relaxed);
+    }
+}
+
+// doctest unit test for the ConcurrentObjectCounter class
+TEST_CASE("testing ConcurrentObjectCounter") {
+    ConcurrentObjectCounter oc(15, 3u);
+
+    // four threads, each adding label i to the count i times
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++) {
+        threads.push_back(std::thread([&oc]() {
+            for(size_t i = 1; i <= 15; i++) {
+                for(size_t j = 0; j < i; j++) {
+                    oc.increment(i);
+                }
+            }
+        }));
+    }
+    for(size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+
+    // verify results
+    std::vector<unsigned> counts = oc.getCounts();
+    REQUIRE(counts.size() == 16u);
+    CHECK(counts[0] == 0u);
+    for(size_t i = 1; i <= 15; i++) {
+        CHECK(oc.getCount(i) == 4 * i);
+        CHECK(counts[i] == 4 * i);
+    }
+
+    // check exception handling
+    bool flag = true;
+    try {
+        oc.increment(16);   // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        oc.getCount(0);     // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+
+    oc.resetCounter();
+    CHECK(oc.getCount(15) == 0u);
+}
+
+TEST_CASE("testing ConcurrentObjectCounter snapshots") {
+    // writers on fewer shards than threads each count label 1, then label
+    // 2, over and over, so in a consistent snapshot label 1 is ahead of
+    // label 2 by at most one per writer
+    const unsigned WRITERS = 4u, ROUNDS = 200000u;
+    ConcurrentObjectCounter oc(2, 3u);
+    std::atomic<unsigned> running(WRITERS);
+    std::vector<std::thread> threads;
+    for(unsigned t = 0u; t < WRITERS; t++) {
+        threads.push_back(std::thread([&oc, &running]() {
+            for(unsigned r = 0u; r < ROUNDS; r++) {
+                oc.increment(1);
+                oc.increment(2);
+            }
+            running--;
+        }));
+    }
+
+    // take snapshots while they run
+    unsigned snapshots = 0u, bad = 0u, prev1 = 0u, prev2 = 0u;
+    do {
+        std::vector<unsigned> counts = oc.getCounts();
+        bad += counts[1] < counts[2] || counts[1] - counts[2] > WRITERS ||
+            counts[1] < prev1 || counts[2] < prev2;
+        prev1 = counts[1];
+        prev2 = counts[2];
+        snapshots++;
+    } while(running.load() != 0u);
+    for(size_t t = 0u; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    CHECK(snapshots > 0u);
+    CHECK(bad == 0u);
+    CHECK(oc.getCount(1) == WRITERS * ROUNDS);
+    CHECK(oc.getCount(2) == WRITERS * ROUNDS);
+}
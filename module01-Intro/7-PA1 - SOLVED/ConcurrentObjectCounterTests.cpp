@@ -0,0 +1,4 @@
+// phantom C++ file for ConcurrentObjectCounter unit testing. This file only 
+// includes the ConcurrentObjectCounter header; doctest generates the testing 
+// program based on unit tests written alongside the code in the header file
+#include "ConcurrentObjectCounter.h"
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "ObjectCounter.h"
+
+/**
+ * @brief Time one counting strategy over the synthetic draws.
+ *
+ * Runs the counting function over the block of draws until total draws have
+ * been counted, then reports the elapsed time and draws per second.
+ *
+ * @param name Name of the strategy, for output.
+ * @param oc Counter to use; it is reset before timing starts.
+ * @param block Block of synthetic draws, reused until total is reached.
+ * @param total Total number of draws to count.
+ * @param count Function that counts len draws starting at pVals into oc.
+ */
+template <class F>
+void timeIt(const std::string &name, ObjectCounter &oc,
+    const std::vector<uint8_t> &block, uint64_t total, F count) {
+    oc.resetCounter();
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t done = 0u;
+    while(done < total) {
+        size_t len = block.size();
+        if(total - done < len) {
+            len = size_t(total - done);
+        }
+        count(oc, &block[0], len);
+        done += len;
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    double secs = std::chrono::duration<double>(stop - start).count();
+    std::cout << name << ":\t" << secs << " s\t" <<
+        (total / secs / 1.0e6) << " M draws/s\t(count of 1 = " <<
+        oc.getCount(1) << ")" << std::endl;
+}
+
+/**
+ * Benchmark for the ObjectCounter counting strategies. Counts a billion
+ * synthetic PowerBall numbers (or the number given as the first command line
+ * argument) one at a time with increment(), in batches with incrementAll(),
+ * and in batches with the threaded incrementAll(). The optional second
+ * argument is the number of threads, defaulting to one per core.
+ */
+int main(int argc, char **argv) {
+    uint64_t total = 1000000000u;
+    unsigned numThreads = 0u;
+    if(argc > 1) {
+        total = std::strtoull(argv[1], 0, 10);
+    }
+    if(argc > 2) {
+        numThreads = unsigned(std::strtoul(argv[2], 0, 10));
+    }
+
+    // 16M synthetic draws in [1, 59], reused until the total is reached
+    std::mt19937_64 prng(246);
+    std::uniform_int_distribution<int> dist(1, 59);
+    std::vector<uint8_t> block(1u << 24);
+    for(size_t i = 0u; i < block.size(); i++) {
+        block[i] = uint8_t(dist(prng));
+    }
+
+    ObjectCounter oc(59);
+    std::cout << "Counting " << total << " synthetic draws" << std::endl;
+
+    timeIt("increment()", oc, block, total,
+        [](ObjectCounter &c, const uint8_t *p, size_t len) {
+            for(size_t i = 0u; i < len; i++) {
+                c.increment(p[i]);
+            }
+        });
+
+    timeIt("incrementAll()", oc, block, total,
+        [](ObjectCounter &c, const uint8_t *p, size_t len) {
+            c.incrementAll(p, len);
+        });
+
+    timeIt("threaded incrementAll()", oc, block, total,
+        [numThreads](ObjectCounter &c, const uint8_t *p, size_t len) {
+            c.incrementAll(p, len, numThreads);
+        });
+
+    return EXIT_SUCCESS;
+}
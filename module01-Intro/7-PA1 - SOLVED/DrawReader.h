@@ -0,0 +1,437 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <doctest.h>
+#include "ObjectCounter.h"
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Branchless parser for whitespace separated unsigned integers.
+ *
+ * NumberParser turns text like the tab and newline separated PowerBall draw
+ * files into unsigned integers. Tabs, spaces, and both kinds of line endings
+ * all end the current number the same way; any other byte, or a number too
+ * large for a uint32_t, makes the parse fail. The parser keeps its state
+ * between calls, so a file may be fed to it in chunks that split numbers
+ * anywhere.
+ */
+class NumberParser {
+public:
+    /**
+     * @brief Default constructor.
+     *
+     * Create a parser that is not in the middle of a number.
+     */
+    NumberParser() : val(0u), inNum(0u), offset(0u) { }
+
+    /**
+     * @brief Parse a chunk of text.
+     *
+     * Parse len bytes of text, writing each number that ends in the chunk to
+     * pOut. A chunk of len bytes holds at most len / 2 + 1 complete numbers,
+     * and the parser may write one element past the last number, so pOut
+     * must have room for len / 2 + 2 values.
+     *
+     * @param pText Pointer to the first byte of the chunk.
+     * @param len Number of bytes in the chunk.
+     * @param pOut Pointer to the output array.
+     *
+     * @return Number of values written to pOut.
+     *
+     * @throws std::invalid_argument if the chunk holds a byte that is not a
+     * digit, tab, space, carriage return or newline.
+     * @throws std::out_of_range if a number is too large for a uint32_t.
+     * Both messages give the offset of the bad byte from the start of the
+     * text, and the parser is left in an unspecified state.
+     */
+    size_t parse(const char *pText, size_t len, uint32_t *pOut);
+
+    /**
+     * @brief Finish parsing.
+     *
+     * Write the number the last chunk ended in the middle of, if any, to
+     * pOut, and reset the parser.
+     *
+     * @param pOut Pointer to the output array, with room for one value.
+     *
+     * @return Number of values written to pOut, zero or one.
+     */
+    size_t finish(uint32_t *pOut);
+
+private:
+    /**
+     * Find the first bad byte of a chunk parse() has rejected, and throw
+     * the exception for it.
+     */
+    void fail(const char *pText, size_t len) const;
+
+    /** Value of the number parsed so far. */
+    uint64_t val;
+
+    /** One if the last byte parsed was a digit, zero otherwise. */
+    uint32_t inNum;
+
+    /** Number of bytes parsed before the current chunk. */
+    size_t offset;
+};
+
+/**
+ * @brief Read-only memory mapped view of a PowerBall draw file.
+ *
+ * DrawReader maps a whole draw file into memory, so it can be parsed in
+ * place without copying it through an input stream.
+ */
+class DrawReader {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * Map the named file into memory.
+     *
+     * @param fileName Name of the file to map.
+     *
+     * @throws std::runtime_error if the file cannot be opened or mapped.
+     */
+    DrawReader(const std::string &fileName);
+
+    /**
+     * Unmap the file.
+     */
+    ~DrawReader();
+
+    /**
+     * @brief Accessor for the file contents.
+     *
+     * @return Pointer to the first byte of the file.
+     */
+    const char *data() const { return pData; }
+
+    /**
+     * @brief Accessor for the file size.
+     *
+     * @return Number of bytes in the file.
+     */
+    size_t size() const { return len; }
+
+    /**
+     * @brief Count every number in the file.
+     *
+     * Parse the file in blocks, and add each block of numbers to the counter
+     * with ObjectCounter::incrementAll().
+     *
+     * @param oc Counter to add the numbers to.
+     *
+     * @return Number of numbers counted.
+     *
+     * @throws std::out_of_range if the file holds a number outside the range
+     * of the counter, or too large for a uint32_t. Blocks before the one
+     * holding the bad number will already have been counted.
+     * @throws std::invalid_argument if the file holds a byte that is not a
+     * digit or whitespace.
+     */
+    size_t countAll(ObjectCounter &oc) const;
+
+    /**
+     * @brief Parse every number in the file.
+     *
+     * @return Vector holding every number in the file, in file order.
+     *
+     * @throws std::invalid_argument if the file holds a byte that is not a
+     * digit or whitespace.
+     * @throws std::out_of_range if a number is too large for a uint32_t.
+     */
+    std::vector<uint32_t> parseAll() const;
+
+private:
+    // mapped files can't be copied
+    DrawReader(const DrawReader &);
+    DrawReader &operator=(const DrawReader &);
+
+    /** Pointer to the mapped file, or 0 for an empty file. */
+    const char *pData;
+
+    /** Number of bytes in the file. */
+    size_t len;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Parse one chunk of text.
+ */
+size_t NumberParser::parse(const char *pText, size_t len, uint32_t *pOut) {
+    size_t k = 0u;
+    uint64_t v = val;
+    uint32_t in = inNum, bad = 0u;
+
+    for(size_t i = 0u; i < len; i++) {
+        uint32_t c = uint8_t(pText[i]);
+        uint32_t d = c - uint32_t('0');
+        uint32_t isDigit = d < 10u;
+        uint32_t isSep = (c == ' ') | (c == '\t') | (c == '\r') | (c == '\n');
+
+        // always store the running value, but only advance past it when
+        // a number has just ended
+        pOut[k] = uint32_t(v);
+        k += in & (isDigit ^ 1u);
+
+        // remember any stray byte or oversized number, and check them once
+        // the chunk is done, so the loop stays branch free
+        bad |= (isDigit | isSep) ^ 1u;
+
+        // mask is all ones for a digit, all zeros for a separator; a value
+        // past 32 bits sets bad long before it could wrap around 64 bits
+        uint64_t mask = 0u - uint64_t(isDigit);
+        v = (v * 10u + d) & mask;
+        bad |= uint32_t(v >> 32);
+        in = isDigit;
+    }
+
+    if(bad != 0u) {
+        fail(pText, len);
+    }
+    val = v;
+    inNum = in;
+    offset += len;
+    return k;
+}
+
+/*
+ * Rescan a rejected chunk one byte at a time, to report where it went wrong.
+ */
+void NumberParser::fail(const char *pText, size_t len) const {
+    uint64_t v = val;
+    for(size_t i = 0u; i < len; i++) {
+        char c = pText[i];
+        if(c >= '0' && c <= '9') {
+            v = v * 10u + uint64_t(c - '0');
+            if((v >> 32) != 0u) {
+                throw std::out_of_range("number too large at offset " +
+                    std::to_string(offset + i) + " in NumberParser::parse()");
+            }
+        } else if(c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            v = 0u;
+        } else {
+            throw std::invalid_argument("unexpected byte at offset " +
+                std::to_string(offset + i) + " in NumberParser::parse()");
+        }
+    }
+}
+
+/*
+ * Flush a trailing number.
+ */
+size_t NumberParser::finish(uint32_t *pOut) {
+    size_t k = inNum;
+    if(k != 0u) {
+        pOut[0] = uint32_t(val);
+    }
+    val = 0u;
+    inNum = 0u;
+    offset = 0u;
+    return k;
+}
+
+// doctest unit test for the NumberParser class
+TEST_CASE("testing NumberParser") {
+    std::string text = "6\t43\t48\t50\t8\t7\r\n3\t17\t13\t52\t42\t24";
+    std::vector<uint32_t> out(text.size());
+
+    // whole text at once
+    NumberParser p;
+    size_t k = p.parse(text.data(), text.size(), &out[0]);
+    k += p.finish(&out[k]);
+    CHECK(k == 12u);
+    CHECK(out[0] == 6u);
+    CHECK(out[5] == 7u);
+    CHECK(out[6] == 3u);
+    CHECK(out[11] == 24u);
+
+    // same text, split in the middle of a number
+    NumberParser q;
+    k = q.parse(text.data(), 3, &out[0]);
+    CHECK(k == 1u);
+    k += q.parse(text.data() + 3, text.size() - 3, &out[k]);
+    k += q.finish(&out[k]);
+    CHECK(k == 12u);
+    CHECK(out[1] == 43u);
+    CHECK(out[11] == 24u);
+
+    // only separators
+    NumberParser r;
+    CHECK(r.parse(" \t\r\n", 4, &out[0]) == 0u);
+    CHECK(r.finish(&out[0]) == 0u);
+
+    // largest value that fits, split across chunks
+    NumberParser s;
+    k = s.parse("42949", 5, &out[0]);
+    k += s.parse("67295\n", 6, &out[k]);
+    CHECK(k == 1u);
+    CHECK(out[0] == 4294967295u);
+
+    // check exception handling for stray bytes, with their offsets
+    const char *strays[] = { "-5", "4x3", "1\t2,3", "7\0" };
+    const char *offsets[] = { "offset 0 ", "offset 1 ", "offset 3 ",
+        "offset 1 " };
+    size_t lens[] = { 2u, 3u, 5u, 2u };
+    for(int i = 0; i < 4; i++) {
+        NumberParser t;
+        bool flag = true;
+        try {
+            t.parse(strays[i], lens[i], &out[0]); // should throw an exception
+            flag = false;                       // should never happen
+        } catch(std::invalid_argument ia) {
+            CHECK(flag);
+            CHECK(std::string(ia.what()).find(offsets[i]) !=
+                std::string::npos);
+        }
+    }
+
+    // check exception handling for numbers too large, even when they
+    // are split across chunks
+    NumberParser u;
+    bool flag = true;
+    try {
+        u.parse("1 99999", 7, &out[0]);     // fits so far
+        u.parse("99999\n", 6, &out[0]);     // should throw an exception
+        flag = false;                       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+        CHECK(std::string(oor.what()).find("offset 11 ") !=
+            std::string::npos);
+    }
+    NumberParser w;
+    flag = true;
+    try {
+        w.parse("4294967296", 10, &out[0]); // should throw an exception
+        flag = false;                       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+        CHECK(std::string(oor.what()).find("offset 9 ") != std::string::npos);
+    }
+}
+
+/*
+ * Map the file into memory.
+ */
+DrawReader::DrawReader(const std::string &fileName) : pData(0), len(0u) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw std::runtime_error("unable to open " + fileName +
+            " in DrawReader::DrawReader()");
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("unable to stat " + fileName +
+            " in DrawReader::DrawReader()");
+    }
+    len = size_t(st.st_size);
+
+    // mmap rejects zero-length mappings, so empty files stay unmapped
+    if(len > 0u) {
+        void *p = mmap(0, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("unable to map " + fileName +
+                " in DrawReader::DrawReader()");
+        }
+        madvise(p, len, MADV_SEQUENTIAL);
+        pData = static_cast<const char *>(p);
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+/*
+ * Unmap the file.
+ */
+DrawReader::~DrawReader() {
+    if(pData != 0) {
+        munmap(const_cast<char *>(pData), len);
+    }
+}
+
+/*
+ * Parse the file in blocks and count the numbers.
+ */
+size_t DrawReader::countAll(ObjectCounter &oc) const {
+    // 64 KiB of text at a time, so the block of numbers stays in L2
+    const size_t CHUNK = 65536u;
+    std::vector<uint32_t> block(CHUNK / 2u + 2u);
+    NumberParser parser;
+    size_t total = 0u;
+
+    for(size_t pos = 0u; pos < len; pos += CHUNK) {
+        size_t chunkLen = (len - pos < CHUNK) ? len - pos : CHUNK;
+        size_t k = parser.parse(pData + pos, chunkLen, &block[0]);
+        oc.incrementAll(&block[0], k);
+        total += k;
+    }
+
+    size_t k = parser.finish(&block[0]);
+    oc.incrementAll(&block[0], k);
+    return total + k;
+}
+
+/*
+ * Parse the whole file into one vector.
+ */
+std::vector<uint32_t> DrawReader::parseAll() const {
+    // every number needs at least one digit and one separator, except the 
+    // last, and the parser may write one element past the last number
+    std::vector<uint32_t> vals(len / 2u + 2u);
+    NumberParser parser;
+    size_t k = (len > 0u) ? parser.parse(pData, len, &vals[0]) : 0u;
+    k += parser.finish(&vals[k]);
+    vals.resize(k);
+
+    return vals;
+}
+
+// doctest unit test for the DrawReader class
+TEST_CASE("testing DrawReader::countAll") {
+    // the draw file has 1858 lines of six numbers
+    DrawReader reader("numbers.txt");
+    ObjectCounter oc(59);
+    CHECK(reader.countAll(oc) == 1858u * 6u);
+    CHECK(oc.getCount(1) == 208u);
+    CHECK(oc.getCount(59) == 62u);
+    std::vector<uint32_t> vals = reader.parseAll();
+    REQUIRE(vals.size() == 1858u * 6u);
+    CHECK(vals[0] == 6u);
+    CHECK(vals[6] == 3u);
+
+    // check exception handling for a missing file
+    bool flag = true;
+    try {
+        DrawReader missing("no-such-file.txt");  // should throw an exception
+        flag = false;                           // should never happen
+    } catch(std::runtime_error re) {
+        CHECK(flag);
+    }
+
+    // numbers out of range for the counter
+    ObjectCounter small(10);
+    flag = true;
+    try {
+        reader.countAll(small); // should throw an exception
+        flag = false;           // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+}
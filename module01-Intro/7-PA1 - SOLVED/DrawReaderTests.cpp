@@ -0,0 +1,4 @@
+// phantom C++ file for DrawReader unit testing. This file only includes the 
+// DrawReader header; doctest generates the testing program based on unit tests
+// written alongside the code in the header file
+#include "DrawReader.h"
\ No newline at end of file
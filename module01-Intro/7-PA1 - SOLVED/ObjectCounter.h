@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 #include <doctest.h>
 
 /*-----------------------------------------------------------------------------
@@ -62,6 +65,67 @@ public:
      */
     void increment(size_t idx);
 
+    /**
+     * @brief Add one to the count of every label in a batch.
+     * 
+     * Count a large batch of object labels in one call. The batch is counted
+     * into several interleaved sub-histograms, so that runs of the same label
+     * do not stall on the previous store to the same counter. The counts are
+     * only updated if every label in the batch is valid.
+     * 
+     * @param pVals Pointer to the first label in the batch.
+     * @param count Number of labels in the batch.
+     * 
+     * @throws std::out_of_range if any label is less than 1 or greater than 
+     * num.
+     */
+    void incrementAll(const uint8_t *pVals, size_t count);
+
+    /**
+     * @brief Add one to the count of every label in a batch.
+     * 
+     * 32-bit label version of incrementAll().
+     * 
+     * @param pVals Pointer to the first label in the batch.
+     * @param count Number of labels in the batch.
+     * 
+     * @throws std::out_of_range if any label is less than 1 or greater than 
+     * num.
+     */
+    void incrementAll(const uint32_t *pVals, size_t count);
+
+    /**
+     * @brief Add one to the count of every label in a batch, using threads.
+     * 
+     * The batch is split into one contiguous slice per thread. Each thread 
+     * counts its slice into a private histogram, and the private histograms 
+     * are merged into this counter when all threads are done.
+     * 
+     * @param pVals Pointer to the first label in the batch.
+     * @param count Number of labels in the batch.
+     * @param numThreads Number of threads to use, or 0 to use one thread per
+     * hardware core.
+     * 
+     * @throws std::out_of_range if any label is less than 1 or greater than 
+     * num.
+     */
+    void incrementAll(const uint8_t *pVals, size_t count, unsigned numThreads);
+
+    /**
+     * @brief Add one to the count of every label in a batch, using threads.
+     * 
+     * 32-bit label version of the threaded incrementAll().
+     * 
+     * @param pVals Pointer to the first label in the batch.
+     * @param count Number of labels in the batch.
+     * @param numThreads Number of threads to use, or 0 to use one thread per
+     * hardware core.
+     * 
+     * @throws std::out_of_range if any label is less than 1 or greater than 
+     * num.
+     */
+    void incrementAll(const uint32_t *pVals, size_t count, unsigned numThreads);
+
     /**
      * @brief Reset the state of the counter.
      * 
@@ -75,6 +139,25 @@ private:
      */
     void createArray();
 
+    /**
+     * Helper method to count a batch of labels into the n-element histogram
+     * pointed to by pHist. Invalid labels are counted in element zero.
+     */
+    template <class V> 
+    void countBatch(const V *pVals, size_t count, unsigned *pHist) const;
+
+    /**
+     * Helper method that implements the threaded incrementAll() methods.
+     */
+    template <class V> 
+    void countThreaded(const V *pVals, size_t count, unsigned numThreads);
+
+    /**
+     * Helper method to add an n-element histogram to the counts, throwing
+     * std::out_of_range instead if the histogram holds any invalid labels.
+     */
+    void mergeHistogram(const unsigned *pHist);
+
     /** Pointer to the backing array of unsigned integers. */
     unsigned *pArr;
 
@@ -188,4 +271,174 @@ void ObjectCounter::resetCounter() {
     for(size_t i = 0; i < n; i++) {
         pArr[i] = 0u;
     }
-}
\ No newline at end of file
+}
+
+/*
+ * Count a batch of labels into a histogram, using four sub-histograms.
+ */
+template <class V>
+void ObjectCounter::countBatch(const V *pVals, size_t count, 
+    unsigned *pHist) const {
+    // round the sub-histogram stride up to a whole number of cache lines, so
+    // the four sub-histograms never share a line
+    size_t stride = (n + 15u) & ~size_t(15u);
+    std::vector<unsigned> sub(4u * stride, 0u);
+    unsigned *h0 = &sub[0];
+    unsigned *h1 = h0 + stride;
+    unsigned *h2 = h1 + stride;
+    unsigned *h3 = h2 + stride;
+
+    // labels outside [1, n) are sent to the unused element zero, so the 
+    // inner loop needs no branches
+    size_t i = 0u;
+    for(; i + 4u <= count; i += 4u) {
+        size_t v0 = pVals[i], v1 = pVals[i + 1u];
+        size_t v2 = pVals[i + 2u], v3 = pVals[i + 3u];
+        h0[v0 < n ? v0 : 0u]++;
+        h1[v1 < n ? v1 : 0u]++;
+        h2[v2 < n ? v2 : 0u]++;
+        h3[v3 < n ? v3 : 0u]++;
+    }
+    for(; i < count; i++) {
+        size_t v = pVals[i];
+        h0[v < n ? v : 0u]++;
+    }
+
+    // fold the sub-histograms together
+    for(size_t j = 0u; j < n; j++) {
+        pHist[j] = h0[j] + h1[j] + h2[j] + h3[j];
+    }
+}
+
+/*
+ * Count a batch of labels with one private histogram per thread.
+ */
+template <class V>
+void ObjectCounter::countThreaded(const V *pVals, size_t count, 
+    unsigned numThreads) {
+    if(numThreads == 0u) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    if(numThreads == 0u) {
+        numThreads = 1u;
+    }
+
+    // one private histogram per thread, each thread taking one slice
+    std::vector<std::vector<unsigned> > hists(numThreads, 
+        std::vector<unsigned>(n, 0u));
+    std::vector<std::thread> threads;
+    size_t slice = count / numThreads;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        size_t start = t * slice;
+        size_t len = (t == numThreads - 1u) ? count - start : slice;
+        threads.push_back(std::thread(&ObjectCounter::countBatch<V>, this,
+            pVals + start, len, &hists[t][0]));
+    }
+    for(size_t t = 0u; t < threads.size(); t++) {
+        threads[t].join();
+    }
+
+    // merge the private histograms
+    for(unsigned t = 1u; t < numThreads; t++) {
+        for(size_t j = 0u; j < n; j++) {
+            hists[0][j] += hists[t][j];
+        }
+    }
+    mergeHistogram(&hists[0][0]);
+}
+
+/*
+ * Add a histogram to the counts, if it holds only valid labels.
+ */
+void ObjectCounter::mergeHistogram(const unsigned *pHist) {
+    if(pHist[0] != 0u) {
+        throw std::out_of_range("index out of range in ObjectCounter::incrementAll()");
+    }
+
+    for(size_t i = 1u; i < n; i++) {
+        pArr[i] += pHist[i];
+    }
+}
+
+/*
+ * Count a batch of 8-bit labels.
+ */
+void ObjectCounter::incrementAll(const uint8_t *pVals, size_t count) {
+    std::vector<unsigned> hist(n);
+    countBatch(pVals, count, &hist[0]);
+    mergeHistogram(&hist[0]);
+}
+
+/*
+ * Count a batch of 32-bit labels.
+ */
+void ObjectCounter::incrementAll(const uint32_t *pVals, size_t count) {
+    std::vector<unsigned> hist(n);
+    countBatch(pVals, count, &hist[0]);
+    mergeHistogram(&hist[0]);
+}
+
+/*
+ * Count a batch of 8-bit labels with multiple threads.
+ */
+void ObjectCounter::incrementAll(const uint8_t *pVals, size_t count, 
+    unsigned numThreads) {
+    countThreaded(pVals, count, numThreads);
+}
+
+/*
+ * Count a batch of 32-bit labels with multiple threads.
+ */
+void ObjectCounter::incrementAll(const uint32_t *pVals, size_t count, 
+    unsigned numThreads) {
+    countThreaded(pVals, count, numThreads);
+}
+
+// doctest unit test for the incrementAll() methods
+TEST_CASE("testing ObjectCounter::incrementAll") {
+    ObjectCounter oc(15), ocThreaded(15);
+
+    // batch where label i appears i times, in a scrambled order
+    std::vector<uint8_t> vals8;
+    for(size_t i = 1; i <= 15; i++) {
+        for(size_t j = 0; j < i; j++) {
+            vals8.push_back(uint8_t(i));
+        }
+    }
+    for(size_t i = 0; i < vals8.size(); i += 7) {
+        std::swap(vals8[i], vals8[vals8.size() - 1 - i / 7]);
+    }
+    std::vector<uint32_t> vals32(vals8.begin(), vals8.end());
+
+    oc.incrementAll(&vals8[0], vals8.size());
+    oc.incrementAll(&vals32[0], vals32.size());
+    ocThreaded.incrementAll(&vals8[0], vals8.size(), 3u);
+    ocThreaded.incrementAll(&vals32[0], vals32.size(), 4u);
+
+    // verify results
+    for(size_t i = 1; i <= 15; i++) {
+        CHECK(oc.getCount(i) == 2 * i);
+        CHECK(ocThreaded.getCount(i) == 2 * i);
+    }
+
+    // check exception handling; a bad label leaves the counts unchanged
+    vals8.push_back(0);
+    vals32.push_back(16);
+    bool flag = true;
+    try {
+        oc.incrementAll(&vals8[0], vals8.size());   // should throw
+        flag = false;                               // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        oc.incrementAll(&vals32[0], vals32.size(), 2u); // should throw
+        flag = false;                                   // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    for(size_t i = 1; i <= 15; i++) {
+        CHECK(oc.getCount(i) == 2 * i);
+    }
+}
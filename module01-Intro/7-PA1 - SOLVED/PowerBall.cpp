@@ -1,54 +1,52 @@
+#include <chrono>
 #include <cstdlib>
-#include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include "DrawReader.h"
 #include "ObjectCounter.h"
 
 /**
  * Program to analyze the frequency of each number in PowerBall lottery
  * drawings.
  *
- * TODO: complete Doxygen tags for the main program.
+ * The draw file is memory mapped and parsed in blocks, rather than read 
+ * with stream extraction, so large draw archives are bound by memory speed.
+ * Parsing throughput is reported on the standard error stream, so the
+ * standard output holds only the frequency table. The draw file name may be
+ * given as the first command line argument; the default is numbers.txt.
+ *
  * @author Mark M. Meysenburg
  * @date 10-5-2021
  */
-int main() {
+int main(int argc, char **argv) {
 	// allocate counting object, for PowerBall numbers in [1, 59]
     ObjectCounter oc(59);
 	
-	// open input file
-	std::ifstream inFile;
-	inFile.open("numbers.txt");
-	
-	// read numbers, one line at a time
-	int b1, b2, b3, b4, b5, b6;
-	while( inFile >> b1 ) {
-		inFile >> b2;
-		inFile >> b3;
-		inFile >> b4;
-		inFile >> b5;
-		inFile >> b6;
-
-		// TODO: replace this output code with your code to count
-		// the frequency of each number. Use the ObjectCounter object
-		// std::cout << "placeholder outout -- replace with counting!" << 
-    	//     std::endl;
-		oc.increment(b1);
-		oc.increment(b2);
-		oc.increment(b3);
-		oc.increment(b4);
-		oc.increment(b5);
-		oc.increment(b6);
+	std::string fileName = "numbers.txt";
+	if(argc > 1) {
+		fileName = argv[1];
 	}
 
-	inFile.close();
+	// map the input file and count every number in it
+	try {
+		auto start = std::chrono::steady_clock::now();
+		DrawReader reader(fileName);
+		size_t numbers = reader.countAll(oc);
+		auto stop = std::chrono::steady_clock::now();
+
+		double secs = std::chrono::duration<double>(stop - start).count();
+		std::cerr << "Counted " << numbers << " numbers from " << 
+			reader.size() << " bytes in " << secs << " s (" << 
+			(reader.size() / secs / 1.0e6) << " MB/s)" << std::endl;
+	} catch(std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
 
-	// TODO: output the frequency for each number, as described in the
-	// assignment. Use the ObjectCounter object
-	// std::cout << "placeholder outout -- replace with output of counts!" << 
-    //     std::endl;
+	// output the frequency for each number
 	for(size_t i = 1; i <= 59; i++) {
-		std::cout << i << "\t" << oc.getCount(i) << std::endl;
+		std::cout << i << "\t" << oc.getCount(i) << "\n";
 	}
 
 	return EXIT_SUCCESS;
@@ -0,0 +1,398 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <doctest.h>
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Object counter over a sliding window of recent draws.
+ *
+ * Like ObjectCounter, this class counts objects labeled in the closed range
+ * [1, n], but the counts only cover the most recent draws. The draws in the
+ * window are kept in a ring buffer; adding a draw to a full window expires
+ * the oldest one, so each new draw costs time proportional to the draw size,
+ * no matter how large the window is.
+ */
+class WindowedCounter {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * Create a windowed counter for objects numbered from 1 to num.
+     *
+     * @param num Upper limit (inclusive) for range of object labels.
+     * @param window Number of most recent draws to count.
+     * @param drawSize Number of labels in each draw.
+     *
+     * @throws std::invalid_argument if window or drawSize is zero.
+     */
+    WindowedCounter(size_t num, size_t window, size_t drawSize);
+
+    /**
+     * @brief Add a draw to the window.
+     *
+     * Count the labels in a new draw. If the window is already full, the
+     * oldest draw in it is removed from the counts first.
+     *
+     * @param pDraw Pointer to the drawSize labels of the new draw.
+     *
+     * @throws std::out_of_range if any label is less than 1 or greater than
+     * num. The counts are unchanged if this happens.
+     */
+    void addDraw(const uint32_t *pDraw);
+
+    /**
+     * @brief Accessor for an individual count.
+     *
+     * @param idx Label number for the object.
+     *
+     * @return Number of times object number idx was seen in the window.
+     *
+     * @throws std::out_of_range if idx is less than 1 or greater than num.
+     */
+    unsigned getCount(size_t idx) const;
+
+    /**
+     * @brief Number of draws in the window.
+     *
+     * @return Number of draws currently counted, at most the window size.
+     */
+    size_t numDraws() const { return filled; }
+
+    /**
+     * @brief Reset the state of the counter.
+     *
+     * Empty the window and reset all of the counts to zero.
+     */
+    void resetCounter();
+
+private:
+    /** Number of elements in counts; element zero is unused. */
+    size_t n;
+
+    /** Maximum number of draws in the window. */
+    size_t window;
+
+    /** Number of labels per draw. */
+    size_t drawSize;
+
+    /** Ring buffer position where the next draw will be stored. */
+    size_t head;
+
+    /** Number of draws currently in the window. */
+    size_t filled;
+
+    /** Ring buffer of the draws in the window, drawSize labels each. */
+    std::vector<uint32_t> ring;
+
+    /** Count for each label over the window. */
+    std::vector<unsigned> counts;
+};
+
+/**
+ * @brief Object counter with exponentially decayed counts.
+ *
+ * Each time a draw is added, every count is multiplied by a decay factor
+ * before the labels in the draw are counted, so recent draws weigh more than
+ * old ones. Rather than touching every count on each draw, the counts are
+ * stored multiplied by a growing scale factor, which makes adding a draw cost
+ * time proportional to the draw size. The stored values are rescaled, in
+ * time proportional to n, before the scale factor can overflow.
+ */
+class DecayedCounter {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * Create a decayed counter for objects numbered from 1 to num.
+     *
+     * @param num Upper limit (inclusive) for range of object labels.
+     * @param alpha Decay factor applied to every count per draw, in (0, 1].
+     * A factor of 1 gives ordinary all-time counts.
+     *
+     * @throws std::invalid_argument if alpha is not in (0, 1].
+     */
+    DecayedCounter(size_t num, double alpha);
+
+    /**
+     * @brief Add a draw.
+     *
+     * Decay every count by alpha, then add one to the count of each label
+     * in the draw.
+     *
+     * @param pDraw Pointer to the labels of the new draw.
+     * @param k Number of labels in the draw.
+     *
+     * @throws std::out_of_range if any label is less than 1 or greater than
+     * num. The counts are unchanged if this happens.
+     */
+    void addDraw(const uint32_t *pDraw, size_t k);
+
+    /**
+     * @brief Accessor for an individual count.
+     *
+     * @param idx Label number for the object.
+     *
+     * @return Decayed count for object number idx.
+     *
+     * @throws std::out_of_range if idx is less than 1 or greater than num.
+     */
+    double getCount(size_t idx) const;
+
+    /**
+     * @brief Reset the state of the counter.
+     *
+     * Reset all of the counts to zero.
+     */
+    void resetCounter();
+
+private:
+    /** Largest scale factor allowed before the weights are rescaled. */
+    static const double MAX_SCALE;
+
+    /** Number of elements in weights; element zero is unused. */
+    size_t n;
+
+    /** Per-draw growth of the scale factor, 1 / alpha. */
+    double growth;
+
+    /** Current scale factor; each count is its weight divided by this. */
+    double scale;
+
+    /** Scaled count for each label. */
+    std::vector<double> weights;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Create an empty window.
+ */
+WindowedCounter::WindowedCounter(size_t num, size_t window, size_t drawSize) :
+    n(num + 1u), window(window), drawSize(drawSize), head(0u), filled(0u),
+    ring(window * drawSize), counts(num + 1u, 0u) {
+    if(window == 0u || drawSize == 0u) {
+        throw std::invalid_argument("empty window in WindowedCounter::WindowedCounter()");
+    }
+}
+
+/*
+ * Add a draw, expiring the oldest one if the window is full.
+ */
+void WindowedCounter::addDraw(const uint32_t *pDraw) {
+    for(size_t i = 0u; i < drawSize; i++) {
+        if(pDraw[i] < 1u || pDraw[i] >= n) {
+            throw std::out_of_range("index out of range in WindowedCounter::addDraw()");
+        }
+    }
+
+    // the slot for the new draw holds the oldest draw when the window is full
+    uint32_t *pSlot = &ring[head * drawSize];
+    if(filled == window) {
+        for(size_t i = 0u; i < drawSize; i++) {
+            counts[pSlot[i]]--;
+        }
+    } else {
+        filled++;
+    }
+
+    for(size_t i = 0u; i < drawSize; i++) {
+        pSlot[i] = pDraw[i];
+        counts[pDraw[i]]++;
+    }
+
+    head = (head + 1u == window) ? 0u : head + 1u;
+}
+
+/*
+ * Get the count for object idx over the window.
+ */
+unsigned WindowedCounter::getCount(size_t idx) const {
+    if(idx < 1u || idx >= n) {
+        throw std::out_of_range("index out of range in WindowedCounter::getCount()");
+    }
+
+    return counts[idx];
+}
+
+/*
+ * Empty the window.
+ */
+void WindowedCounter::resetCounter() {
+    head = filled = 0u;
+    for(size_t i = 0u; i < n; i++) {
+        counts[i] = 0u;
+    }
+}
+
+// doctest unit test for the WindowedCounter class
+TEST_CASE("testing WindowedCounter") {
+    WindowedCounter wc(10, 2, 3);
+
+    uint32_t d1[] = { 1, 2, 3 };
+    uint32_t d2[] = { 3, 4, 5 };
+    uint32_t d3[] = { 5, 6, 10 };
+
+    wc.addDraw(d1);
+    CHECK(wc.numDraws() == 1u);
+    CHECK(wc.getCount(1) == 1u);
+    CHECK(wc.getCount(3) == 1u);
+
+    wc.addDraw(d2);
+    CHECK(wc.numDraws() == 2u);
+    CHECK(wc.getCount(3) == 2u);
+
+    // window is full; d1 expires
+    wc.addDraw(d3);
+    CHECK(wc.numDraws() == 2u);
+    CHECK(wc.getCount(1) == 0u);
+    CHECK(wc.getCount(3) == 1u);
+    CHECK(wc.getCount(5) == 2u);
+    CHECK(wc.getCount(10) == 1u);
+
+    // d2 expires
+    wc.addDraw(d1);
+    CHECK(wc.getCount(1) == 1u);
+    CHECK(wc.getCount(4) == 0u);
+    CHECK(wc.getCount(5) == 1u);
+
+    // check exception handling; a bad draw leaves the counts unchanged
+    uint32_t bad[] = { 1, 2, 11 };
+    bool flag = true;
+    try {
+        wc.addDraw(bad);    // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    CHECK(wc.getCount(1) == 1u);
+    flag = true;
+    try {
+        wc.getCount(0);     // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+
+    wc.resetCounter();
+    CHECK(wc.numDraws() == 0u);
+    CHECK(wc.getCount(1) == 0u);
+}
+
+const double DecayedCounter::MAX_SCALE = 1.0e150;
+
+/*
+ * Create a decayed counter with all counts zero.
+ */
+DecayedCounter::DecayedCounter(size_t num, double alpha) : n(num + 1u),
+    growth(1.0), scale(1.0), weights(num + 1u, 0.0) {
+    if(!(alpha > 0.0 && alpha <= 1.0)) {
+        throw std::invalid_argument("decay factor out of range in DecayedCounter::DecayedCounter()");
+    }
+    growth = 1.0 / alpha;
+}
+
+/*
+ * Decay the counts and add a draw.
+ */
+void DecayedCounter::addDraw(const uint32_t *pDraw, size_t k) {
+    for(size_t i = 0u; i < k; i++) {
+        if(pDraw[i] < 1u || pDraw[i] >= n) {
+            throw std::out_of_range("index out of range in DecayedCounter::addDraw()");
+        }
+    }
+
+    // growing the scale decays every count at once
+    scale *= growth;
+    if(scale > MAX_SCALE) {
+        for(size_t i = 0u; i < n; i++) {
+            weights[i] /= scale;
+        }
+        scale = 1.0;
+    }
+
+    for(size_t i = 0u; i < k; i++) {
+        weights[pDraw[i]] += scale;
+    }
+}
+
+/*
+ * Get the decayed count for object idx.
+ */
+double DecayedCounter::getCount(size_t idx) const {
+    if(idx < 1u || idx >= n) {
+        throw std::out_of_range("index out of range in DecayedCounter::getCount()");
+    }
+
+    return weights[idx] / scale;
+}
+
+/*
+ * Reset all counts to zero.
+ */
+void DecayedCounter::resetCounter() {
+    scale = 1.0;
+    for(size_t i = 0u; i < n; i++) {
+        weights[i] = 0.0;
+    }
+}
+
+// doctest unit test for the DecayedCounter class
+TEST_CASE("testing DecayedCounter") {
+    DecayedCounter dc(5, 0.5);
+
+    uint32_t d1[] = { 1, 2 };
+    uint32_t d2[] = { 2, 3 };
+
+    dc.addDraw(d1, 2);
+    CHECK(dc.getCount(1) == doctest::Approx(1.0));
+    CHECK(dc.getCount(3) == doctest::Approx(0.0));
+
+    dc.addDraw(d2, 2);
+    CHECK(dc.getCount(1) == doctest::Approx(0.5));
+    CHECK(dc.getCount(2) == doctest::Approx(1.5));
+    CHECK(dc.getCount(3) == doctest::Approx(1.0));
+
+    // enough draws to force the weights to be rescaled; the count of a
+    // label drawn every time converges to 1 / (1 - alpha)
+    for(int i = 0; i < 2000; i++) {
+        dc.addDraw(d2, 2);
+    }
+    CHECK(dc.getCount(2) == doctest::Approx(2.0));
+    CHECK(dc.getCount(1) == doctest::Approx(0.0));
+
+    // alpha of one gives ordinary counts
+    DecayedCounter plain(5, 1.0);
+    for(int i = 0; i < 10; i++) {
+        plain.addDraw(d1, 2);
+    }
+    CHECK(plain.getCount(1) == doctest::Approx(10.0));
+
+    // check exception handling
+    bool flag = true;
+    try {
+        DecayedCounter badAlpha(5, 0.0);    // should throw an exception
+        flag = false;                       // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+    uint32_t bad[] = { 6 };
+    flag = true;
+    try {
+        dc.addDraw(bad, 1);     // should throw an exception
+        flag = false;           // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    CHECK(dc.getCount(2) == doctest::Approx(2.0));
+
+    dc.resetCounter();
+    CHECK(dc.getCount(2) == doctest::Approx(0.0));
+}
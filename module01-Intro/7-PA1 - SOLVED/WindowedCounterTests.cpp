@@ -0,0 +1,4 @@
+// phantom C++ file for WindowedCounter unit testing. This file only includes 
+// the WindowedCounter header; doctest generates the testing program based on 
+// unit tests written alongside the code in the header file
+#include "WindowedCounter.h"
\ No newline at end of file
@@ -0,0 +1,428 @@
+#pragma once
+
+#include <doctest.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Dictionary.hpp"
+#include "MarkovChain.hpp"
+#include "Rng.hpp"
+#include "WeightedDictionary.hpp"
+
+/*-----------------------------------------------------------------------------
+ * declarations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Statistics of one run of writePoems().
+ */
+struct BulkStats {
+    /** Number of poems written. */
+    uint64_t poems;
+
+    /** Number of words written. */
+    uint64_t words;
+
+    /** Number of bytes written. */
+    uint64_t bytes;
+
+    /** Number of write() calls made. */
+    uint64_t writes;
+
+    /** Number of threads used. */
+    unsigned threads;
+
+    /** Wall-clock time taken, in seconds. */
+    double seconds;
+
+    /**
+     * @brief Generation speed.
+     *
+     * @return Words written per second of wall-clock time, over all
+     * threads.
+     */
+    double wordsPerSecond() const { return words / seconds; }
+};
+
+/**
+ * @brief Append a poem, as RandomPoet prints it.
+ *
+ * Each line is a tab, then every word followed by a space, then a newline.
+ *
+ * @param out String to append to.
+ * @param pWords Pointer to lines * words words, line by line.
+ * @param lines Number of lines.
+ * @param words Number of words per line.
+ */
+void appendPoem(std::string &out, const std::string_view *pWords,
+    unsigned lines, unsigned words);
+
+/**
+ * @brief Write many poems, generated in parallel.
+ *
+ * The poems are made in batches of about BULK_BATCH_WORDS words. Worker
+ * threads take the next batch from an atomic counter and format it into a
+ * buffer of their own, and each full buffer goes out in one write() call,
+ * in batch order; a worker whose batch is ready early waits for the
+ * batches before it. Batch b draws from the generator seeded with seed,
+ * jumped ahead b times, as the b-th split() of it would; each worker jumps
+ * its own copy forward to the batches it takes, so the output is the same
+ * for a given seed whatever the number of threads.
+ *
+ * A poem longer than BULK_BATCH_WORDS words is a batch of its own, made
+ * and written a chunk of BULK_BATCH_WORDS words at a time, so each worker
+ * holds at most that many words whatever the size of the poems. The text
+ * is the same as if each poem's words came from one call to
+ * source.sampleN(g, pOut, k), so a Markov chain's text runs on from line
+ * to line; poems are separated by an empty line.
+ *
+ * @param source Dictionary, WeightedDictionary or MarkovChain to draw from.
+ * @param fd File descriptor to write to.
+ * @param poems Number of poems.
+ * @param lines Number of lines per poem.
+ * @param words Number of words per line.
+ * @param seed Seed for the random numbers.
+ * @param numThreads Number of worker threads, or 0 for one per hardware
+ * core.
+ *
+ * @throws std::runtime_error if the output cannot be written.
+ * @throws std::out_of_range if the source has nothing to draw from.
+ *
+ * @return Numbers of poems, words, bytes and writes, and the time taken;
+ * the counts are of what was written.
+ */
+template <class S>
+BulkStats writePoems(const S &source, int fd, uint64_t poems, unsigned lines,
+    unsigned words, uint64_t seed, unsigned numThreads = 0u);
+
+/**
+ * Words per batch of writePoems(), and per chunk of a longer poem, and so
+ * roughly the bytes per write() divided by the average word length plus
+ * one.
+ */
+const size_t BULK_BATCH_WORDS = 1u << 17;
+
+/*-----------------------------------------------------------------------------
+ * function implementations
+ *---------------------------------------------------------------------------*/
+
+inline void appendPoem(std::string &out, const std::string_view *pWords,
+    unsigned lines, unsigned words) {
+    for(unsigned i = 0u; i < lines; i++) {
+        out += '\t';
+        for(unsigned j = 0u; j < words; j++) {
+            out.append(pWords->data(), pWords->size());
+            out += ' ';
+            pWords++;
+        }
+        out += '\n';
+    }
+}
+
+/*
+ * Hand out the batches from an atomic counter, and write them in order.
+ */
+template <class S>
+BulkStats writePoems(const S &source, int fd, uint64_t poems, unsigned lines,
+    unsigned words, uint64_t seed, unsigned numThreads) {
+    auto start = std::chrono::steady_clock::now();
+    const size_t perPoem = size_t(lines) * words;
+    const uint64_t perBatch = perPoem == 0u ? BULK_BATCH_WORDS :
+        perPoem >= BULK_BATCH_WORDS ? 1u : BULK_BATCH_WORDS / perPoem;
+    const uint64_t batches = poems / perBatch + (poems % perBatch != 0u);
+    const size_t perChunk = perPoem < BULK_BATCH_WORDS ? perPoem :
+        BULK_BATCH_WORDS;
+
+    if(numThreads == 0u) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    numThreads = numThreads == 0u ? 1u : numThreads;
+    numThreads = uint64_t(numThreads) > batches ? unsigned(batches) :
+        numThreads;
+
+    BulkStats stats = { 0u, 0u, 0u, 0u, numThreads, 0.0 };
+    std::atomic<uint64_t> next(0u);
+    uint64_t turn = 0u;
+    bool failed = false;
+    std::exception_ptr failure;
+    std::mutex lock;
+    std::condition_variable written;
+
+    // write all of a buffer, however many calls it takes
+    auto writeAll = [&](const char *p, size_t n) {
+        while(n > 0u) {
+            ssize_t done = ::write(fd, p, n);
+            if(done < 0 && errno == EINTR) {
+                continue;
+            }
+            if(done <= 0) {
+                throw std::runtime_error(
+                    std::string("unable to write poems: ") + strerror(errno));
+            }
+            stats.writes++;
+            p += done;
+            n -= size_t(done);
+        }
+    };
+
+    // wait for the batches before batch b, then write what the buffer holds
+    // of it; false if another worker has failed
+    auto writeOut = [&](uint64_t b, std::string &buffer, uint64_t &pending) {
+        std::unique_lock<std::mutex> guard(lock);
+        written.wait(guard, [&]() { return failed || turn == b; });
+        if(failed) {
+            return false;
+        }
+        writeAll(buffer.data(), buffer.size());
+        stats.words += pending;
+        stats.bytes += buffer.size();
+        buffer.clear();
+        pending = 0u;
+        return true;
+    };
+
+    std::vector<std::thread> workers;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        workers.push_back(std::thread([&]() {
+            std::vector<std::string_view> chunk;
+            std::string buffer;
+
+            // the batches come in increasing order, so the generator only
+            // ever jumps forward
+            Xoshiro256ss jumped(seed);
+            uint64_t jumps = 0u;
+            for(uint64_t b = next++; b < batches; b = next++) {
+                try {
+                    for(; jumps < b; jumps++) {
+                        jumped.jump();
+                    }
+                    Xoshiro256ss g(jumped);
+                    chunk.resize(perChunk);
+
+                    // make the batch; a poem too long for one chunk is made
+                    // and written a chunk at a time, a Markov chain going on
+                    // from the state the last chunk ended in
+                    buffer.clear();
+                    uint64_t pending = 0u;
+                    uint64_t first = b * perBatch;
+                    uint64_t last = poems - first > perBatch ?
+                        first + perBatch : poems;
+                    for(uint64_t p = first; p < last; p++) {
+                        if(perPoem == perChunk) {
+                            source.sampleN(g, chunk.data(), perPoem);
+                            appendPoem(buffer, chunk.data(), lines, words);
+                            pending += perPoem;
+                            buffer += '\n';
+                            continue;
+                        }
+                        uint32_t state = MarkovChain::NO_STATE;
+                        for(size_t done = 0u; done < perPoem;
+                            done += perChunk) {
+                            size_t m = perPoem - done < perChunk ?
+                                perPoem - done : perChunk;
+                            if constexpr(std::is_same<S, MarkovChain>::value) {
+                                state = source.generate(g, state,
+                                    chunk.data(), m);
+                            } else {
+                                source.sampleN(g, chunk.data(), m);
+                            }
+                            for(size_t i = 0u; i < m; i++) {
+                                if((done + i) % words == 0u) {
+                                    buffer += '\t';
+                                }
+                                buffer.append(chunk[i].data(), chunk[i].size());
+                                buffer += ' ';
+                                if((done + i + 1u) % words == 0u) {
+                                    buffer += '\n';
+                                }
+                            }
+                            pending += m;
+                            if(done + m < perPoem &&
+                                !writeOut(b, buffer, pending)) {
+                                return;
+                            }
+                        }
+                        buffer += '\n';
+                    }
+
+                    // then the rest of it, and hand the turn on
+                    if(!writeOut(b, buffer, pending)) {
+                        return;
+                    }
+                    std::lock_guard<std::mutex> guard(lock);
+                    stats.poems += last - first;
+                    turn++;
+                    written.notify_all();
+                } catch(...) {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if(!failed) {
+                        failed = true;
+                        failure = std::current_exception();
+                    }
+                    written.notify_all();
+                    return;
+                }
+            }
+        }));
+    }
+    for(unsigned t = 0u; t < numThreads; t++) {
+        workers[t].join();
+    }
+    if(failure) {
+        std::rethrow_exception(failure);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    stats.seconds = std::chrono::duration<double>(stop - start).count();
+    return stats;
+}
+
+// doctest unit tests for the bulk poem writer
+TEST_CASE("testing appendPoem") {
+    std::string_view words[] = { "a", "bc", "d", "ef" };
+    std::string out = "x";
+    appendPoem(out, words, 2u, 2u);
+    CHECK(out == "x\ta bc \n\td ef \n");
+}
+
+TEST_CASE("testing writePoems") {
+    Dictionary dict(246u);
+    for(int i = 0; i < 500; i++) {
+        dict.add("w" + std::to_string(i));
+    }
+    const char *NAME = "BulkPoemsTests.tmp";
+    auto readBack = [](const char *pName) {
+        std::ifstream in(pName, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)),
+            std::istreambuf_iterator<char>());
+    };
+
+    // the output depends on the seed, not on the number of threads; the
+    // poems fill several batches, the last one short
+    std::string texts[3];
+    unsigned threads[3] = { 1u, 3u, 1u };
+    uint64_t seeds[3] = { 246u, 246u, 247u };
+    for(int r = 0; r < 3; r++) {
+        int fd = open(NAME, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        REQUIRE(fd >= 0);
+        BulkStats stats = writePoems(dict, fd, 10000u, 8u, 10u, seeds[r],
+            threads[r]);
+        close(fd);
+        texts[r] = readBack(NAME);
+        CHECK(stats.poems == 10000u);
+        CHECK(stats.words == 10000u * 80u);
+        CHECK(stats.bytes == texts[r].size());
+        CHECK(stats.threads == threads[r]);
+        CHECK(stats.writes >= 7u);
+        CHECK(stats.wordsPerSecond() > 0.0);
+    }
+    CHECK(texts[0] == texts[1]);
+    CHECK(texts[0] != texts[2]);
+
+    // every poem is 8 lines and an empty line, of words from the dictionary
+    size_t newlines = 0u, tabs = 0u, spaces = 0u;
+    for(char c : texts[0]) {
+        newlines += c == '\n';
+        tabs += c == '\t';
+        spaces += c == ' ';
+    }
+    CHECK(newlines == 10000u * 9u);
+    CHECK(tabs == 10000u * 8u);
+    CHECK(spaces == 10000u * 80u);
+    CHECK(texts[0].compare(0, 2, "\tw") == 0);
+
+    // poems too long to share a batch, one batch each, on either thread;
+    // and empty poems, which are only the line between them
+    for(unsigned t = 1u; t <= 2u; t++) {
+        int fd = open(NAME, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        REQUIRE(fd >= 0);
+        BulkStats stats = writePoems(dict, fd, 3u, 2u, 70000u, 246u, t);
+        close(fd);
+        texts[t] = readBack(NAME);
+        CHECK(stats.threads == t);
+        CHECK(stats.words == 3u * 140000u);
+        CHECK(stats.bytes == texts[t].size());
+        CHECK(stats.writes >= 6u);
+    }
+    CHECK(texts[1] == texts[2]);
+
+    // they go out a chunk at a time, but read as if made in one go
+    std::vector<std::string_view> whole(140000u);
+    Xoshiro256ss g(246u);
+    dict.sampleN(g, whole.data(), whole.size());
+    std::string expected;
+    appendPoem(expected, whole.data(), 2u, 70000u);
+    expected += '\n';
+    CHECK(texts[1].compare(0u, expected.size(), expected) == 0);
+    int fd = open(NAME, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    REQUIRE(fd >= 0);
+    BulkStats blank = writePoems(dict, fd, 300000u, 0u, 5u, 246u, 2u);
+    close(fd);
+    CHECK(blank.poems == 300000u);
+    CHECK(blank.words == 0u);
+    CHECK(blank.writes >= 3u);
+    CHECK(readBack(NAME) == std::string(300000u, '\n'));
+
+    // other sources
+    MarkovChain chain(1u, 246u);
+    chain.train("the cat sat on the mat and the dog sat on the cat");
+    WeightedDictionary weighted(246u);
+    weighted.add("only", 1.0);
+    weighted.add("never", 0.0);
+    weighted.build();
+    fd = open(NAME, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    REQUIRE(fd >= 0);
+    CHECK(writePoems(chain, fd, 10u, 2u, 3u, 246u, 2u).words == 60u);
+    CHECK(writePoems(weighted, fd, 1u, 1u, 2u, 246u).bytes == 13u);
+    close(fd);
+    std::string text = readBack(NAME);
+    CHECK(text.find("never") == std::string::npos);
+    CHECK(text.substr(text.size() - 13u) == "\tonly only \n\n");
+
+    // a chain's text runs on from chunk to chunk
+    fd = open(NAME, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    REQUIRE(fd >= 0);
+    CHECK(writePoems(chain, fd, 1u, 1u, 140000u, 246u).writes >= 2u);
+    close(fd);
+    g = Xoshiro256ss(246u);
+    chain.sampleN(g, whole.data(), whole.size());
+    expected.clear();
+    appendPoem(expected, whole.data(), 1u, 140000u);
+    CHECK(readBack(NAME) == expected + '\n');
+
+    // check exception handling for a closed file and an empty source
+    bool flag = true;
+    try {
+        writePoems(dict, fd, 10u, 2u, 3u, 246u);    // should throw
+        flag = false;                               // should never happen
+    } catch(std::runtime_error re) {
+        CHECK(flag);
+    }
+    Dictionary empty(246u);
+    fd = open(NAME, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    REQUIRE(fd >= 0);
+    flag = true;
+    try {
+        writePoems(empty, fd, 10u, 2u, 3u, 246u, 2u);   // should throw
+        flag = false;                                   // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    close(fd);
+    remove(NAME);
+}
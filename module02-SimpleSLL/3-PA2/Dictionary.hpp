@@ -0,0 +1,632 @@
+#pragma once
+
+#include <doctest.h>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <istream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Rng.hpp"
+
+/*-----------------------------------------------------------------------------
+ * declarations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Determine if a character separates words.
+ *
+ * The characters are those std::isspace() finds in the C locale, without
+ * the function call.
+ *
+ * @param c The character.
+ *
+ * @return true for space, tab, newline, vertical tab, form feed and
+ * carriage return, false otherwise.
+ */
+inline bool isWordBreak(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * @brief Skip a UTF-8 byte order mark.
+ *
+ * Files saved by some Windows editors, dictionary.txt among them, start
+ * with the bytes EF BB BF, which would otherwise end up in the first word.
+ *
+ * @param p Pointer to the start of the text.
+ * @param pEnd Pointer to the end of the text.
+ *
+ * @return Pointer to the text after the mark, or p if there is none.
+ */
+inline const char *skipBom(const char *p, const char *pEnd) {
+    if(pEnd - p >= 3 && p[0] == '\xEF' && p[1] == '\xBB' && p[2] == '\xBF') {
+        return p + 3;
+    }
+    return p;
+}
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief CMP 246 Module 2 random-access word list.
+ *
+ * Dictionary keeps every word in one character arena, one after another
+ * with nothing in between, and a contiguous array of offsets into the
+ * arena: word i runs from offset i up to offset i + 1. That is 4 bytes per
+ * word on top of the characters, so a loaded word list takes about the
+ * size of its file. Getting the word at an index, and so getting a random
+ * word, takes constant time, where SimpleSLL::getRandom() walks half the
+ * list on average. sampleN() draws many random words in one call, with the
+ * random numbers generated a block at a time.
+ *
+ * Words are handed out as string_views into the arena, which stay valid
+ * until the next word is added, or the dictionary is destroyed.
+ */
+class Dictionary {
+public:
+    /**
+     * @brief Dictionary iterator.
+     *
+     * This class allows Dictionary users to go through the words in order,
+     * with a range-based for loop.
+     */
+    class Iterator {
+    public:
+        /**
+         * @brief Iterator dereferencing operator.
+         *
+         * @return The word the iterator refers to.
+         */
+        std::string_view operator*() const { return (*pDict)[idx]; }
+
+        /**
+         * @brief Iterator equality operator.
+         */
+        bool operator==(const Iterator &other) const {
+            return idx == other.idx;
+        }
+
+        /**
+         * @brief Iterator inequality operator.
+         */
+        bool operator!=(const Iterator &other) const {
+            return idx != other.idx;
+        }
+
+        /**
+         * @brief Iterator increment operator; moves to the next word.
+         */
+        Iterator &operator++() {
+            idx++;
+            return *this;
+        }
+
+        // Make Dictionary a friend class, so it can access the private
+        // constructor
+        friend class Dictionary;
+
+    private:
+        /**
+         * Private constructor, used by Dictionary::begin() and end().
+         */
+        Iterator(const Dictionary *pD, size_t i) : pDict(pD), idx(i) { }
+
+        /**
+         * The dictionary, and the index of the word.
+         */
+        const Dictionary *pDict;
+        size_t idx;
+    };
+
+    /**
+     * @brief Default constructor.
+     *
+     * Make an empty dictionary, with the random number generator seeded
+     * from the time.
+     */
+    Dictionary() : starts(1u, 0u), prng(uint64_t(time(0))) { }
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * Make an empty dictionary, with a fixed seed, so the random words are
+     * the same on every run.
+     *
+     * @param seed Seed for the random number generator.
+     */
+    explicit Dictionary(uint64_t seed) : starts(1u, 0u), prng(seed) { }
+
+    /**
+     * @brief Add a word at the end.
+     *
+     * @param word The word. It may not point into this dictionary.
+     *
+     * @throws std::length_error if the arena would reach 4 GB.
+     */
+    void add(std::string_view word);
+
+    /**
+     * @brief Element access, checked.
+     *
+     * @param idx Index of the word.
+     *
+     * @throws std::out_of_range if idx is past the last word.
+     *
+     * @return The word at index idx.
+     */
+    std::string_view at(size_t idx) const;
+
+    /**
+     * @brief Iterators over the words, in order.
+     */
+    Iterator begin() const { return Iterator(this, 0u); }
+    Iterator end() const { return Iterator(this, size()); }
+
+    /**
+     * @brief Memory held for the index.
+     *
+     * @return Bytes allocated for the word offsets.
+     */
+    size_t indexBytes() const { return starts.capacity() * sizeof(uint32_t); }
+
+    /**
+     * @brief Determine if the dictionary is empty.
+     *
+     * @return true if the dictionary holds no words, false otherwise.
+     */
+    bool isEmpty() const { return starts.size() == 1u; }
+
+    /**
+     * @brief Get a random word.
+     *
+     * Every word is equally likely, whatever its length.
+     *
+     * @throws std::out_of_range if the dictionary is empty.
+     *
+     * @return A word chosen at random.
+     */
+    std::string_view getRandom() const;
+
+    /**
+     * @brief Read whitespace separated words.
+     *
+     * Read the whole stream in one block, and add every word in it, as the
+     * >> operator would split them. A UTF-8 byte order mark at the start
+     * is skipped.
+     *
+     * @param in Stream to read.
+     *
+     * @throws std::length_error if the arena would reach 4 GB.
+     *
+     * @return Number of words added.
+     */
+    size_t load(std::istream &in);
+
+    /**
+     * @brief Read whitespace separated words from a file.
+     *
+     * The file is mapped into memory, not read, and scanned once, copying
+     * each word to the arena and recording its offset. A UTF-8 byte order
+     * mark at the start is skipped.
+     *
+     * @param fileName Name of the file.
+     *
+     * @throws std::runtime_error if the file cannot be opened or mapped.
+     * @throws std::length_error if the arena would reach 4 GB.
+     *
+     * @return Number of words added.
+     */
+    size_t loadFile(const std::string &fileName);
+
+    /**
+     * @brief Reserve room.
+     *
+     * @param numWords Number of words to make room for.
+     * @param numChars Number of characters to make room for.
+     */
+    void reserve(size_t numWords, size_t numChars);
+
+    /**
+     * @brief Get random words.
+     *
+     * Draw k words at random, independently, so a word may come up more
+     * than once, and write them to pOut.
+     *
+     * @param pOut Pointer to room for k words.
+     * @param k Number of words to draw.
+     *
+     * @throws std::out_of_range if the dictionary is empty and k is not zero.
+     */
+    void sampleN(std::string_view *pOut, size_t k) const {
+        sampleN(prng, pOut, k);
+    }
+
+    /**
+     * @brief Get random words, with a generator of the caller's.
+     *
+     * This changes nothing in the dictionary, so threads can share one
+     * dictionary, each with a generator of its own.
+     *
+     * @param g Random number generator.
+     * @param pOut Pointer to room for k words.
+     * @param k Number of words to draw.
+     *
+     * @throws std::out_of_range if the dictionary is empty and k is not zero.
+     */
+    template <class G>
+    void sampleN(G &g, std::string_view *pOut, size_t k) const;
+
+    /**
+     * @brief Get random words.
+     *
+     * @param k Number of words to draw.
+     *
+     * @throws std::out_of_range if the dictionary is empty and k is not zero.
+     *
+     * @return k words drawn at random, independently.
+     */
+    std::vector<std::string_view> sampleN(size_t k) const {
+        std::vector<std::string_view> out(k);
+        sampleN(out.data(), k);
+        return out;
+    }
+
+    /**
+     * @brief Get dictionary size.
+     *
+     * @return The number of words in the dictionary.
+     */
+    size_t size() const { return starts.size() - 1u; }
+
+    /**
+     * @brief Element access, unchecked.
+     *
+     * @param idx Index of the word, less than size().
+     *
+     * @return The word at index idx.
+     */
+    std::string_view operator[](size_t idx) const {
+        return std::string_view(text.data() + starts[idx],
+            starts[idx + 1u] - starts[idx]);
+    }
+
+    /**
+     * @brief Memory held for the characters.
+     *
+     * @return Bytes allocated for the arena.
+     */
+    size_t textBytes() const { return text.capacity(); }
+
+private:
+    /**
+     * Helper function to add every word from p up to pEnd.
+     */
+    size_t addWords(const char *p, const char *pEnd);
+
+    /**
+     * Every word, one after another.
+     */
+    std::string text;
+
+    /**
+     * Offset of each word in text, and of the end of the last word.
+     */
+    std::vector<uint32_t> starts;
+
+    /**
+     * xoshiro256** PRNG. Mutable, since drawing a random word changes the
+     * generator but not the dictionary.
+     */
+    mutable Xoshiro256ss prng;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+inline void Dictionary::add(std::string_view word) {
+    if(text.size() + word.size() > 0xFFFFFFFFu) {
+        throw std::length_error("Arena full in Dictionary::add()");
+    }
+    text.append(word.data(), word.size());
+    starts.push_back(uint32_t(text.size()));
+}
+
+/*
+ * One pass: copy each word to the end of the arena, and record where it
+ * ends. The arena is sized for the whole text first, so it never moves.
+ */
+inline size_t Dictionary::addWords(const char *p, const char *pEnd) {
+    p = skipBom(p, pEnd);
+    if(text.size() + size_t(pEnd - p) > 0xFFFFFFFFu) {
+        throw std::length_error("Arena full in Dictionary::addWords()");
+    }
+    size_t before = size();
+    text.reserve(text.size() + size_t(pEnd - p));
+    while(p < pEnd) {
+        while(p < pEnd && isWordBreak(*p)) {
+            p++;
+        }
+        const char *pWord = p;
+        while(p < pEnd && !isWordBreak(*p)) {
+            p++;
+        }
+        if(p > pWord) {
+            text.append(pWord, size_t(p - pWord));
+            starts.push_back(uint32_t(text.size()));
+        }
+    }
+    return size() - before;
+}
+
+inline std::string_view Dictionary::at(size_t idx) const {
+    if(idx >= size()) {
+        throw std::out_of_range("Index out of range in Dictionary::at()");
+    }
+    return (*this)[idx];
+}
+
+/*
+ * One bounded random index, then one array access.
+ */
+inline std::string_view Dictionary::getRandom() const {
+    if(isEmpty()) {
+        throw std::out_of_range("Empty dictionary in Dictionary::getRandom()");
+    }
+    return (*this)[size_t(uniformBelow(prng, size()))];
+}
+
+/*
+ * Read the stream in one block, then split it.
+ */
+inline size_t Dictionary::load(std::istream &in) {
+    std::string block((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+    return addWords(block.data(), block.data() + block.size());
+}
+
+/*
+ * Map the file, split it, and trim the arena to what the words took.
+ */
+inline size_t Dictionary::loadFile(const std::string &fileName) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw std::runtime_error("unable to open " + fileName +
+            " in Dictionary::loadFile()");
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("unable to read " + fileName +
+            " in Dictionary::loadFile()");
+    }
+    size_t length = size_t(info.st_size);
+    if(length == 0u) {
+        ::close(fd);
+        return 0u;
+    }
+    void *pMap = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(pMap == MAP_FAILED) {
+        throw std::runtime_error("unable to map " + fileName +
+            " in Dictionary::loadFile()");
+    }
+    madvise(pMap, length, MADV_SEQUENTIAL);
+    const char *p = static_cast<const char *>(pMap);
+    size_t count;
+    try {
+        count = addWords(p, p + length);
+    } catch(...) {
+        munmap(pMap, length);
+        throw;
+    }
+    munmap(pMap, length);
+    text.shrink_to_fit();
+    starts.shrink_to_fit();
+    return count;
+}
+
+inline void Dictionary::reserve(size_t numWords, size_t numChars) {
+    text.reserve(text.size() + numChars);
+    starts.reserve(starts.size() + numWords);
+}
+
+/*
+ * Draw the random bits a block at a time, and turn each into an index with
+ * Lemire's multiply and shift; the rare products that would bias the
+ * result are drawn again with uniformBelow().
+ */
+template <class G>
+void Dictionary::sampleN(G &g, std::string_view *pOut, size_t k) const {
+    if(k == 0u) {
+        return;
+    }
+    if(isEmpty()) {
+        throw std::out_of_range("Empty dictionary in Dictionary::sampleN()");
+    }
+    const uint64_t n = size();
+    const uint64_t threshold = (0u - n) % n;
+    const size_t BLOCK = 256u;
+    uint64_t bits[BLOCK];
+    for(size_t done = 0u; done < k; done += BLOCK) {
+        size_t m = k - done < BLOCK ? k - done : BLOCK;
+        for(size_t i = 0u; i < m; i++) {
+            bits[i] = g();
+        }
+        for(size_t i = 0u; i < m; i++) {
+            unsigned __int128 product = (unsigned __int128)bits[i] * n;
+            uint64_t idx = uint64_t(product >> 64);
+            if(uint64_t(product) < threshold) {
+                idx = uniformBelow(g, n);
+            }
+            pOut[done + i] = (*this)[idx];
+        }
+    }
+}
+
+// doctest unit tests for the Dictionary class
+TEST_CASE("testing Dictionary") {
+    Dictionary dict(246u);
+    CHECK(dict.isEmpty());
+
+    // check exception handling for an empty dictionary
+    bool flag = true;
+    try {
+        dict.getRandom();   // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+
+    // many words, so the arena moves while they are added
+    for(int i = 0; i < 1000; i++) {
+        dict.add(std::to_string(i));
+    }
+    CHECK(dict.size() == 1000u);
+    CHECK(dict[0] == "0");
+    CHECK(dict[999] == "999");
+    CHECK(dict.at(500) == "500");
+    flag = true;
+    try {
+        dict.at(1000);      // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+
+    // copies have arenas of their own
+    Dictionary copy(dict);
+    Dictionary assigned(1u);
+    assigned = dict;
+    dict.add("extra");
+    CHECK(copy.size() == 1000u);
+    CHECK(copy[123] == "123");
+    CHECK(assigned[999] == "999");
+    CHECK(copy[123].data() != dict[123].data());
+
+    // loading splits like >> does, and skips a byte order mark
+    std::istringstream in("\xEF\xBB\xBF" "alpha\tbeta\r\ngamma\n\n  delta");
+    Dictionary loaded(246u);
+    CHECK(loaded.load(in) == 4u);
+    CHECK(loaded[0] == "alpha");
+    CHECK(loaded[1] == "beta");
+    CHECK(loaded[3] == "delta");
+    size_t total = 0u, count = 0u;
+    for(std::string_view w : loaded) {
+        total += w.size();
+        count++;
+    }
+    CHECK(total == 19u);
+    CHECK(count == 4u);
+    CHECK(loaded.indexBytes() >= 5u * sizeof(uint32_t));
+
+    // only a mark at the very start is skipped
+    std::istringstream marks(" \xEF\xBB\xBFword");
+    Dictionary marked(246u);
+    CHECK(marked.load(marks) == 1u);
+    CHECK(marked[0].size() == 7u);
+}
+
+TEST_CASE("testing Dictionary::loadFile") {
+    const char *NAME = "DictionaryTests.tmp";
+    FILE *f = fopen(NAME, "wb");
+    REQUIRE(f != nullptr);
+    fputs("\xEF\xBB\xBF" "a\r\nA\r\nAA\r\nAachen's\r\n", f);
+    fclose(f);
+
+    Dictionary dict(246u);
+    CHECK(dict.loadFile(NAME) == 4u);
+    CHECK(dict[0] == "a");
+    CHECK(dict[2] == "AA");
+    CHECK(dict[3] == "Aachen's");
+
+    // the arena holds the characters of the words, and nothing else
+    CHECK(dict.textBytes() < 20u);
+
+    // an empty file has no words
+    f = fopen(NAME, "wb");
+    REQUIRE(f != nullptr);
+    fclose(f);
+    CHECK(dict.loadFile(NAME) == 0u);
+    CHECK(dict.size() == 4u);
+    remove(NAME);
+
+    // check exception handling for a missing file
+    bool flag = true;
+    try {
+        dict.loadFile(NAME);    // should throw an exception
+        flag = false;           // should never happen
+    } catch(std::runtime_error re) {
+        CHECK(flag);
+    }
+}
+
+TEST_CASE("testing Dictionary::getRandom and Dictionary::sampleN") {
+    Dictionary dict(246u);
+    const char *WORDS[] = { "A", "B", "C", "D", "E" };
+    for(const char *w : WORDS) {
+        dict.add(w);
+    }
+
+    // every word should come up, about equally often, and nothing else
+    int counts[5] = { 0, 0, 0, 0, 0 };
+    for(int i = 0; i < 5000; i++) {
+        std::string_view w = dict.getRandom();
+        REQUIRE(w.size() == 1u);
+        REQUIRE(w[0] >= 'A');
+        REQUIRE(w[0] <= 'E');
+        counts[w[0] - 'A']++;
+    }
+    std::vector<std::string_view> sample = dict.sampleN(5000u);
+    CHECK(sample.size() == 5000u);
+    for(std::string_view w : sample) {
+        REQUIRE(w.size() == 1u);
+        REQUIRE(w[0] >= 'A');
+        REQUIRE(w[0] <= 'E');
+        counts[w[0] - 'A']++;
+    }
+    for(int c : counts) {
+        CHECK(c > 1800);
+        CHECK(c < 2200);
+    }
+
+    // the same seed gives the same words
+    Dictionary again(246u), other(246u);
+    for(const char *w : WORDS) {
+        again.add(w);
+        other.add(w);
+    }
+    std::vector<std::string_view> a = again.sampleN(300u);
+    std::vector<std::string_view> b = other.sampleN(300u);
+    CHECK(a == b);
+    CHECK(dict.sampleN(0u).empty());
+    Xoshiro256ss g(246u);
+    std::vector<std::string_view> c(300u);
+    Dictionary shared(1u);
+    for(const char *w : WORDS) {
+        shared.add(w);
+    }
+    shared.sampleN(g, c.data(), c.size());
+    CHECK(c == a);
+
+    // check exception handling for an empty dictionary
+    Dictionary empty(246u);
+    bool flag = true;
+    try {
+        empty.sampleN(3u);  // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+}
@@ -0,0 +1,107 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Dictionary.hpp"
+#include "SimpleSLL.hpp"
+#include <sys/stat.h>
+
+/**
+ * Helper function to time f(), which draws words words, and print the speed.
+ */
+template <class F>
+void report(const char *name, size_t words, F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << name << words / d.count() / 1e6 << " million words/s"
+        << std::endl;
+}
+
+/**
+ * @brief Benchmark for random words from the dictionary.
+ *
+ * This program loads dictionary.txt into a SimpleSLL, word by word with
+ * the >> operator, and into Dictionaries, from a stream and from a mapped
+ * file, reporting the time and memory each takes. It then draws random
+ * words from each: a few thousand from SimpleSLL::getRandom(),
+ * which walks the list, and ten million from Dictionary::getRandom() and
+ * Dictionary::sampleN().
+ */
+int main() {
+    using namespace std;
+
+    auto start = chrono::steady_clock::now();
+    SimpleSLL<string> list;
+    ifstream listFile("dictionary.txt");
+    string w;
+    while(listFile >> w) {
+        list.add(w);
+    }
+    chrono::duration<double> d = chrono::steady_clock::now() - start;
+    cout << "SimpleSLL loaded " << list.size() << " words in " << d.count()
+        << " s" << endl;
+
+    cout << "  first word of " << list.get(0).size() << " bytes" << endl;
+
+    start = chrono::steady_clock::now();
+    Dictionary streamed(246u);
+    ifstream dictFile("dictionary.txt");
+    streamed.load(dictFile);
+    d = chrono::steady_clock::now() - start;
+    cout << "Dictionary::load loaded " << streamed.size() << " words in "
+        << d.count() << " s" << endl;
+
+    // SimpleSLL holds a node of a string and a pointer per word, and a heap
+    // block for each string too long to keep inside
+    size_t listBytes = 0u;
+    for(string_view word : streamed) {
+        listBytes += sizeof(string) + sizeof(void *) +
+            (word.size() < sizeof(string) ? 0u : word.size() + 1u);
+    }
+    cout << "  SimpleSLL holds about " << listBytes / 1e6 << " MB" << endl;
+
+    start = chrono::steady_clock::now();
+    Dictionary dict(246u);
+    try {
+        dict.loadFile("dictionary.txt");
+    } catch(runtime_error re) {
+        cout << re.what() << endl;
+        return EXIT_FAILURE;
+    }
+    d = chrono::steady_clock::now() - start;
+    struct stat info;
+    stat("dictionary.txt", &info);
+    cout << "Dictionary::loadFile loaded " << dict.size() << " words in "
+        << d.count() << " s" << endl;
+    cout << "  " << (dict.textBytes() + dict.indexBytes()) / 1e6
+        << " MB for a file of " << info.st_size / 1e6 << " MB, first word of "
+        << dict[0].size() << " bytes" << endl;
+
+    const size_t FEW = 2000u, MANY = 10000000u;
+    size_t sink = 0u;
+    cout << "random words:" << endl;
+    report("SimpleSLL::getRandom  ", FEW, [&]() {
+        for(size_t i = 0u; i < FEW; i++) {
+            sink += list.getRandom().size();
+        }
+    });
+    report("Dictionary::getRandom ", MANY, [&]() {
+        for(size_t i = 0u; i < MANY; i++) {
+            sink += dict.getRandom().size();
+        }
+    });
+    vector<string_view> out(1024u);
+    report("Dictionary::sampleN   ", MANY, [&]() {
+        for(size_t i = 0u; i < MANY; i += out.size()) {
+            dict.sampleN(out.data(), out.size());
+            sink += out[0].size();
+        }
+    });
+    cout << "(" << sink << ")" << endl;
+    return EXIT_SUCCESS;
+}
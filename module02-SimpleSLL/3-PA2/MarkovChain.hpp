@@ -0,0 +1,1025 @@
+#pragma once
+
+#include <doctest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <istream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Dictionary.hpp"
+#include "Rng.hpp"
+#include "WeightedDictionary.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief CMP 246 Module 2 word-level Markov chain text generator.
+ *
+ * A chain of order k is trained on a corpus of whitespace separated words.
+ * Its states are the runs of k words seen in the corpus, each followed by
+ * the words seen after it, with their counts; generating text walks from
+ * state to state, drawing each next word by its count.
+ *
+ * The model is laid out as flat arrays, in compressed sparse row form:
+ * - every distinct word is interned once, as an id into a Dictionary;
+ * - the states are sorted by their k word ids, with offsets into the
+ *   transition arrays;
+ * - each transition is one 16-byte record of an alias bucket, the next
+ *   word id and the state it leads to, found once when training; the
+ *   counts are kept apart, since generating never reads them.
+ * A generated word is then one random number, the state's offsets and one
+ * or two transition records, with no hashing or searching.
+ *
+ * Training splits the corpus into one chunk per thread. Each thread
+ * interns the words of its chunk, then finds where the words of one shard
+ * of the vocabulary first appear, and sorts and counts the n-grams of its
+ * chunk. The sorted runs are merged in parallel, one range of first words
+ * at a time, and the threads then build the alias tables and the links
+ * between states. Word ids follow first appearance in the corpus, so the
+ * model is the same whatever the number of threads.
+ */
+class MarkovChain {
+public:
+    /**
+     * Highest order supported.
+     */
+    static constexpr unsigned MAX_ORDER = 3u;
+
+    /**
+     * State that follows the end of the corpus.
+     */
+    static constexpr uint32_t NO_STATE = 0xFFFFFFFFu;
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * Make an untrained chain, with the random number generator seeded
+     * from the time.
+     *
+     * @param order Number of words in each state.
+     *
+     * @throws std::invalid_argument if order is 0 or more than MAX_ORDER.
+     */
+    explicit MarkovChain(unsigned order = 2u);
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * Make an untrained chain, with a fixed seed, so the text is the same
+     * on every run.
+     *
+     * @param order Number of words in each state.
+     * @param seed Seed for the random number generator.
+     *
+     * @throws std::invalid_argument if order is 0 or more than MAX_ORDER.
+     */
+    MarkovChain(unsigned order, uint64_t seed);
+
+    /**
+     * @brief Memory held by the model.
+     *
+     * @return Bytes allocated for the words, states and transitions.
+     */
+    size_t bytes() const;
+
+    /**
+     * @brief Word ids of a state.
+     *
+     * @param state The state, less than states().
+     *
+     * @return Pointer to the order() word ids of the state.
+     */
+    const uint32_t *context(uint32_t state) const {
+        return contexts.data() + size_t(state) * chainOrder;
+    }
+
+    /**
+     * @brief Find a state.
+     *
+     * @param pContext Pointer to order() word ids.
+     *
+     * @return The state with those words, or NO_STATE if there is none.
+     */
+    uint32_t findState(const uint32_t *pContext) const;
+
+    /**
+     * @brief Generate text.
+     *
+     * Walk the chain from state, writing k words to pOut. When the walk
+     * reaches the end of the corpus, it goes on from a random state. This
+     * changes nothing in the chain, so threads can share one chain, each
+     * with a generator of its own.
+     *
+     * @param g Random number generator.
+     * @param state State to start from, or NO_STATE to start from a random
+     * state.
+     * @param pOut Pointer to room for k words.
+     * @param k Number of words to generate.
+     *
+     * @throws std::out_of_range if the chain has no states and k is not
+     * zero.
+     *
+     * @return The state after the last word, to go on from.
+     */
+    template <class G>
+    uint32_t generate(G &g, uint32_t state, std::string_view *pOut,
+        size_t k) const;
+
+    /**
+     * @brief Get the order.
+     *
+     * @return The number of words in each state.
+     */
+    unsigned order() const { return chainOrder; }
+
+    /**
+     * @brief Get a random state.
+     *
+     * @param g Random number generator.
+     *
+     * @throws std::out_of_range if the chain has no states.
+     *
+     * @return A state chosen at random.
+     */
+    template <class G> uint32_t randomState(G &g) const;
+
+    /**
+     * @brief Generate text, going on from where the last call stopped.
+     *
+     * This has the same form as Dictionary::sampleN(), so RandomPoet can
+     * draw its lines from either.
+     *
+     * @param pOut Pointer to room for k words.
+     * @param k Number of words to generate.
+     *
+     * @throws std::out_of_range if the chain has no states and k is not
+     * zero.
+     */
+    void sampleN(std::string_view *pOut, size_t k) const {
+        cursor = generate(prng, cursor, pOut, k);
+    }
+
+    /**
+     * @brief Generate text from a random state, with a generator of the
+     * caller's.
+     *
+     * @param g Random number generator.
+     * @param pOut Pointer to room for k words.
+     * @param k Number of words to generate.
+     *
+     * @throws std::out_of_range if the chain has no states and k is not
+     * zero.
+     */
+    template <class G>
+    void sampleN(G &g, std::string_view *pOut, size_t k) const {
+        generate(g, NO_STATE, pOut, k);
+    }
+
+    /**
+     * @brief Get the number of states.
+     *
+     * @return The number of distinct runs of order() words followed by
+     * another word.
+     */
+    size_t states() const {
+        return offsets.empty() ? 0u : offsets.size() - 1u;
+    }
+
+    /**
+     * @brief Number of words seen after a state.
+     *
+     * @param state The state, less than states().
+     *
+     * @return The number of distinct words seen after the state.
+     */
+    uint32_t successors(uint32_t state) const {
+        return offsets[state + 1u] - offsets[state];
+    }
+
+    /**
+     * @brief A word seen after a state.
+     *
+     * @param state The state, less than states().
+     * @param j Which word, less than successors(state); they are in order
+     * of word id.
+     *
+     * @return The id of the word.
+     */
+    uint32_t successor(uint32_t state, uint32_t j) const {
+        return links[offsets[state] + j].word;
+    }
+
+    /**
+     * @brief How often a word was seen after a state.
+     *
+     * @param state The state, less than states().
+     * @param j Which word, less than successors(state).
+     *
+     * @return The number of times the word followed the state.
+     */
+    uint32_t successorCount(uint32_t state, uint32_t j) const {
+        return counts[offsets[state] + j];
+    }
+
+    /**
+     * @brief The state after a word seen after a state.
+     *
+     * @param state The state, less than states().
+     * @param j Which word, less than successors(state).
+     *
+     * @return The state made of the last order() - 1 words of state and
+     * the word, or NO_STATE if that run of words ends the corpus.
+     */
+    uint32_t successorState(uint32_t state, uint32_t j) const {
+        return links[offsets[state] + j].state;
+    }
+
+    /**
+     * @brief Get the number of words in the corpus.
+     *
+     * @return The number of words the chain was trained on.
+     */
+    size_t tokens() const { return numTokens; }
+
+    /**
+     * @brief Train the chain on the text of a stream.
+     *
+     * @param in Stream to read, all at once.
+     * @param numThreads Number of worker threads, or 0 for one per hardware
+     * core.
+     *
+     * @throws std::length_error if the corpus has 2^32 or more distinct
+     * words or transitions.
+     *
+     * @return The number of words in the corpus.
+     */
+    size_t train(std::istream &in, unsigned numThreads = 0u);
+
+    /**
+     * @brief Train the chain on a corpus, replacing what it knew.
+     *
+     * @param corpus Whitespace separated words.
+     * @param numThreads Number of worker threads, or 0 for one per hardware
+     * core.
+     *
+     * @throws std::length_error if the corpus has 2^32 or more distinct
+     * words or transitions.
+     *
+     * @return The number of words in the corpus.
+     */
+    size_t train(std::string_view corpus, unsigned numThreads = 0u);
+
+    /**
+     * @brief Get the number of transitions.
+     *
+     * @return The number of distinct runs of order() + 1 words.
+     */
+    size_t transitions() const { return links.size(); }
+
+    /**
+     * @brief Get the number of distinct words.
+     *
+     * @return The size of the vocabulary.
+     */
+    size_t vocabularySize() const { return vocabulary.size(); }
+
+    /**
+     * @brief Word access, unchecked.
+     *
+     * @param id Id of the word, less than vocabularySize().
+     *
+     * @return The word.
+     */
+    std::string_view word(uint32_t id) const { return vocabulary[id]; }
+
+private:
+    /**
+     * One n-gram: order() + 1 word ids, padded with zeros, and its count.
+     */
+    struct Gram {
+        uint32_t id[MAX_ORDER + 1u];
+        uint32_t count;
+    };
+
+    /**
+     * One transition: its alias bucket, the word, and the state after it.
+     */
+    struct Transition {
+        uint32_t threshold;
+        uint32_t alias;
+        uint32_t word;
+        uint32_t state;
+    };
+
+    /**
+     * Helper function to check that a chain order is supported.
+     */
+    static unsigned checkOrder(unsigned order);
+
+    /**
+     * Helper function to run job(j) for every j below jobs on numThreads
+     * threads, handing out the jobs from an atomic counter.
+     */
+    template <class F>
+    static void forEachJob(size_t jobs, unsigned numThreads, F job);
+
+    /**
+     * Helper function to order n-grams by their first n word ids.
+     */
+    static bool gramLess(const Gram &a, const Gram &b, unsigned n);
+
+    /**
+     * Helper function for the first state whose first n word ids are not
+     * less than those at pContext.
+     */
+    size_t lowerBound(const uint32_t *pContext, unsigned n) const;
+
+    /**
+     * Number of words in each state.
+     */
+    unsigned chainOrder;
+
+    /**
+     * Every distinct word, indexed by id.
+     */
+    Dictionary vocabulary;
+
+    /**
+     * Number of words in the corpus.
+     */
+    size_t numTokens;
+
+    /**
+     * Word ids of each state, order() per state, in sorted order.
+     */
+    std::vector<uint32_t> contexts;
+
+    /**
+     * Index of each state's first transition, and one past the last.
+     */
+    std::vector<uint32_t> offsets;
+
+    /**
+     * Every transition, state by state, with one alias table per state.
+     */
+    std::vector<Transition> links;
+
+    /**
+     * Count of each transition.
+     */
+    std::vector<uint32_t> counts;
+
+    /**
+     * xoshiro256** PRNG and the state sampleN() goes on from. Mutable,
+     * since generating text changes them but not the chain.
+     */
+    mutable Xoshiro256ss prng;
+    mutable uint32_t cursor;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Run the jobs in place when one thread would do.
+ */
+template <class F>
+void MarkovChain::forEachJob(size_t jobs, unsigned numThreads, F job) {
+    numThreads = size_t(numThreads) > jobs ? unsigned(jobs) : numThreads;
+    if(numThreads <= 1u) {
+        for(size_t j = 0u; j < jobs; j++) {
+            job(j);
+        }
+        return;
+    }
+    std::atomic<size_t> next(0u);
+    std::vector<std::thread> workers;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        workers.push_back(std::thread([&]() {
+            for(size_t j = next++; j < jobs; j = next++) {
+                job(j);
+            }
+        }));
+    }
+    for(unsigned t = 0u; t < numThreads; t++) {
+        workers[t].join();
+    }
+}
+
+inline bool MarkovChain::gramLess(const Gram &a, const Gram &b, unsigned n) {
+    for(unsigned i = 0u; i < n; i++) {
+        if(a.id[i] != b.id[i]) {
+            return a.id[i] < b.id[i];
+        }
+    }
+    return false;
+}
+
+inline unsigned MarkovChain::checkOrder(unsigned order) {
+    if(order == 0u || order > MAX_ORDER) {
+        throw std::invalid_argument("bad order in MarkovChain::MarkovChain()");
+    }
+    return order;
+}
+
+inline MarkovChain::MarkovChain(unsigned order) :
+    chainOrder(checkOrder(order)), numTokens(0u), prng(uint64_t(time(0))),
+    cursor(NO_STATE) { }
+
+inline MarkovChain::MarkovChain(unsigned order, uint64_t seed) :
+    chainOrder(checkOrder(order)), vocabulary(seed), numTokens(0u),
+    prng(seed), cursor(NO_STATE) { }
+
+inline size_t MarkovChain::bytes() const {
+    return vocabulary.textBytes() + vocabulary.indexBytes() +
+        (contexts.capacity() + offsets.capacity() + counts.capacity()) *
+        sizeof(uint32_t) + links.capacity() * sizeof(Transition);
+}
+
+inline uint32_t MarkovChain::findState(const uint32_t *pContext) const {
+    size_t s = lowerBound(pContext, chainOrder);
+    if(s == states() ||
+        !std::equal(pContext, pContext + chainOrder, context(uint32_t(s)))) {
+        return NO_STATE;
+    }
+    return uint32_t(s);
+}
+
+/*
+ * Binary search of the sorted contexts.
+ */
+inline size_t MarkovChain::lowerBound(const uint32_t *pContext,
+    unsigned n) const {
+    size_t lo = 0u, hi = states();
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2u;
+        const uint32_t *pMid = context(uint32_t(mid));
+        unsigned i = 0u;
+        while(i < n && pMid[i] == pContext[i]) {
+            i++;
+        }
+        if(i < n && pMid[i] < pContext[i]) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*
+ * One alias draw over the state's transition records per word.
+ */
+template <class G>
+uint32_t MarkovChain::generate(G &g, uint32_t state, std::string_view *pOut,
+    size_t k) const {
+    if(k == 0u) {
+        return state;
+    }
+    if(state >= states()) {
+        state = randomState(g);
+    }
+    for(size_t i = 0u; i < k; i++) {
+        const Transition *pFirst = links.data() + offsets[state];
+        const Transition &t = pFirst[pickAlias(pFirst,
+            offsets[state + 1u] - offsets[state], g())];
+        pOut[i] = vocabulary[t.word];
+        state = t.state;
+        if(state == NO_STATE) {
+            state = uint32_t(uniformBelow(g, states()));
+        }
+    }
+    return state;
+}
+
+template <class G>
+uint32_t MarkovChain::randomState(G &g) const {
+    if(states() == 0u) {
+        throw std::out_of_range("Untrained chain in MarkovChain::randomState()");
+    }
+    return uint32_t(uniformBelow(g, states()));
+}
+
+inline size_t MarkovChain::train(std::istream &in, unsigned numThreads) {
+    std::string corpus((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+    return train(std::string_view(corpus), numThreads);
+}
+
+/*
+ * Intern and count per chunk, merge per range of first words, then link the
+ * states per chunk.
+ */
+inline size_t MarkovChain::train(std::string_view corpus,
+    unsigned numThreads) {
+    if(numThreads == 0u) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    numThreads = numThreads == 0u ? 1u : numThreads;
+    const unsigned k = chainOrder;
+    corpus.remove_prefix(size_t(skipBom(corpus.data(),
+        corpus.data() + corpus.size()) - corpus.data()));
+
+    // split the corpus at whitespace, one chunk per thread
+    const size_t numChunks = numThreads;
+    std::vector<size_t> bounds(numChunks + 1u);
+    bounds[numChunks] = corpus.size();
+    for(size_t c = 1u; c < numChunks; c++) {
+        size_t b = std::max(corpus.size() * c / numChunks, bounds[c - 1u]);
+        while(b < corpus.size() && !isWordBreak(corpus[b])) {
+            b++;
+        }
+        bounds[c] = b;
+    }
+
+    // tokenize each chunk, with ids local to the chunk, and sort its words
+    // into shards by hash
+    struct Chunk {
+        std::vector<uint32_t> ids;
+        std::vector<std::string_view> words;
+        std::vector<std::vector<uint32_t>> byShard;
+        std::vector<uint64_t> first;
+        std::vector<uint32_t> toGlobal;
+    };
+    const size_t numShards = numChunks;
+    std::vector<Chunk> chunks(numChunks);
+    forEachJob(numChunks, numThreads, [&](size_t c) {
+        Chunk &chunk = chunks[c];
+        std::unordered_map<std::string_view, uint32_t> local;
+        size_t i = bounds[c], end = bounds[c + 1u];
+        while(i < end) {
+            while(i < end && isWordBreak(corpus[i])) {
+                i++;
+            }
+            size_t start = i;
+            while(i < end && !isWordBreak(corpus[i])) {
+                i++;
+            }
+            if(i > start) {
+                std::string_view w = corpus.substr(start, i - start);
+                auto found = local.emplace(w, uint32_t(chunk.words.size()));
+                if(found.second) {
+                    chunk.words.push_back(w);
+                }
+                chunk.ids.push_back(found.first->second);
+            }
+        }
+        chunk.byShard.resize(numShards);
+        std::hash<std::string_view> hash;
+        for(size_t j = 0u; j < chunk.words.size(); j++) {
+            chunk.byShard[hash(chunk.words[j]) % numShards].push_back(
+                uint32_t(j));
+        }
+        chunk.first.resize(chunk.words.size());
+        chunk.toGlobal.resize(chunk.words.size());
+    });
+
+    // find where each word first appears in the corpus, as chunk and local
+    // id, one shard of the words per job; the chunks are visited in order
+    forEachJob(numShards, numThreads, [&](size_t s) {
+        std::unordered_map<std::string_view, uint64_t> seen;
+        for(size_t c = 0u; c < numChunks; c++) {
+            Chunk &chunk = chunks[c];
+            for(uint32_t j : chunk.byShard[s]) {
+                uint64_t here = (uint64_t(c) << 32) | j;
+                chunk.first[j] = seen.emplace(chunk.words[j],
+                    here).first->second;
+            }
+        }
+    });
+
+    // a word's id is its rank among the first appearances, which does not
+    // depend on the number of chunks: number the words new to each chunk,
+    // then look up the others where they first appeared
+    std::vector<size_t> firstWord(numChunks + 1u, 0u);
+    forEachJob(numChunks, numThreads, [&](size_t c) {
+        Chunk &chunk = chunks[c];
+        std::vector<std::vector<uint32_t>>().swap(chunk.byShard);
+        size_t fresh = 0u;
+        for(size_t j = 0u; j < chunk.first.size(); j++) {
+            fresh += chunk.first[j] == ((uint64_t(c) << 32) | j);
+        }
+        firstWord[c + 1u] = fresh;
+    });
+    std::vector<size_t> firstToken(numChunks + 1u, 0u);
+    for(size_t c = 0u; c < numChunks; c++) {
+        firstWord[c + 1u] += firstWord[c];
+        firstToken[c + 1u] = firstToken[c] + chunks[c].ids.size();
+    }
+    if(firstWord[numChunks] > NO_STATE) {
+        throw std::length_error("too many words in MarkovChain::train()");
+    }
+    std::vector<std::string_view> globalWords(firstWord[numChunks]);
+    forEachJob(numChunks, numThreads, [&](size_t c) {
+        Chunk &chunk = chunks[c];
+        uint32_t next = uint32_t(firstWord[c]);
+        for(size_t j = 0u; j < chunk.first.size(); j++) {
+            if(chunk.first[j] == ((uint64_t(c) << 32) | j)) {
+                globalWords[next] = chunk.words[j];
+                chunk.toGlobal[j] = next++;
+            }
+        }
+    });
+    numTokens = firstToken[numChunks];
+    std::vector<uint32_t> tokens(numTokens);
+    forEachJob(numChunks, numThreads, [&](size_t c) {
+        Chunk &chunk = chunks[c];
+        for(size_t j = 0u; j < chunk.first.size(); j++) {
+            size_t home = size_t(chunk.first[j] >> 32);
+            if(home != c) {
+                chunk.toGlobal[j] =
+                    chunks[home].toGlobal[uint32_t(chunk.first[j])];
+            }
+        }
+        for(size_t i = 0u; i < chunk.ids.size(); i++) {
+            tokens[firstToken[c] + i] = chunk.toGlobal[chunk.ids[i]];
+        }
+        std::vector<uint32_t>().swap(chunk.ids);
+    });
+
+    Dictionary words(0u);
+    size_t numChars = 0u;
+    for(std::string_view w : globalWords) {
+        numChars += w.size();
+    }
+    words.reserve(globalWords.size(), numChars);
+    for(std::string_view w : globalWords) {
+        words.add(w);
+    }
+
+    // sort and count the n-grams starting in each range of positions
+    const size_t numGrams = numTokens > k ? numTokens - k : 0u;
+    std::vector<std::vector<Gram>> runs(numChunks);
+    forEachJob(numChunks, numThreads, [&](size_t c) {
+        size_t lo = numGrams * c / numChunks;
+        size_t hi = numGrams * (c + 1u) / numChunks;
+        std::vector<Gram> &run = runs[c];
+        run.resize(hi - lo);
+        for(size_t p = lo; p < hi; p++) {
+            Gram &gram = run[p - lo];
+            for(unsigned i = 0u; i <= MAX_ORDER; i++) {
+                gram.id[i] = i <= k ? tokens[p + i] : 0u;
+            }
+            gram.count = 1u;
+        }
+        std::sort(run.begin(), run.end(), [k](const Gram &a, const Gram &b) {
+            return gramLess(a, b, k + 1u);
+        });
+        size_t out = 0u;
+        for(size_t i = 0u; i < run.size(); i++) {
+            if(out > 0u && !gramLess(run[out - 1u], run[i], k + 1u)) {
+                run[out - 1u].count++;
+            } else {
+                run[out++] = run[i];
+            }
+        }
+        run.resize(out);
+    });
+    std::vector<uint32_t>().swap(tokens);
+
+    // merge the runs in parallel over ranges of first word ids, split at
+    // samples of the runs. A state's grams all share its first word, so
+    // each range makes whole states and transitions, and the ranges are
+    // then put side by side
+    const size_t numParts = numChunks == 1u ? 1u : 4u * numChunks;
+    const size_t SAMPLES = 64u;
+    std::vector<uint32_t> samples;
+    for(const std::vector<Gram> &run : runs) {
+        for(size_t i = 0u; i < SAMPLES && i < run.size(); i++) {
+            samples.push_back(run[run.size() * i / SAMPLES].id[0]);
+        }
+    }
+    std::sort(samples.begin(), samples.end());
+    std::vector<uint64_t> splits(numParts + 1u, 0u);
+    splits[numParts] = uint64_t(1u) << 32;
+    for(size_t p = 1u; p < numParts && !samples.empty(); p++) {
+        splits[p] = samples[samples.size() * p / numParts];
+    }
+    struct Part {
+        std::vector<uint32_t> contexts, offsets, words, counts;
+    };
+    std::vector<Part> parts(numParts);
+    forEachJob(numParts, numThreads, [&](size_t p) {
+        // each run's grams in the range, and a heap of the runs by their
+        // next gram, earliest on top
+        std::vector<const Gram *> heads(numChunks), ends(numChunks);
+        std::vector<size_t> heap;
+        auto below = [](const Gram &g, uint64_t v) { return g.id[0] < v; };
+        for(size_t c = 0u; c < numChunks; c++) {
+            const Gram *pRun = runs[c].data();
+            const Gram *pEnd = pRun + runs[c].size();
+            heads[c] = std::lower_bound(pRun, pEnd, splits[p], below);
+            ends[c] = std::lower_bound(heads[c], pEnd, splits[p + 1u], below);
+            if(heads[c] != ends[c]) {
+                heap.push_back(c);
+            }
+        }
+        auto later = [&](size_t a, size_t b) {
+            return gramLess(*heads[b], *heads[a], k + 1u);
+        };
+        std::make_heap(heap.begin(), heap.end(), later);
+
+        Part &part = parts[p];
+        while(!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            size_t c = heap.back();
+            const Gram &gram = *heads[c]++;
+            if(heads[c] != ends[c]) {
+                std::push_heap(heap.begin(), heap.end(), later);
+            } else {
+                heap.pop_back();
+            }
+            if(!part.words.empty() && part.words.back() == gram.id[k] &&
+                std::equal(gram.id, gram.id + k, part.contexts.end() - k)) {
+                part.counts.back() += gram.count;
+                continue;
+            }
+            if(part.words.empty() ||
+                !std::equal(gram.id, gram.id + k, part.contexts.end() - k)) {
+                part.contexts.insert(part.contexts.end(), gram.id,
+                    gram.id + k);
+                part.offsets.push_back(uint32_t(part.words.size()));
+            }
+            part.words.push_back(gram.id[k]);
+            part.counts.push_back(gram.count);
+        }
+    });
+    runs.clear();
+
+    std::vector<size_t> firstState(numParts + 1u, 0u);
+    std::vector<size_t> firstLink(numParts + 1u, 0u);
+    for(size_t p = 0u; p < numParts; p++) {
+        firstState[p + 1u] = firstState[p] + parts[p].offsets.size();
+        firstLink[p + 1u] = firstLink[p] + parts[p].words.size();
+    }
+    if(firstLink[numParts] > NO_STATE) {
+        throw std::length_error(
+            "too many transitions in MarkovChain::train()");
+    }
+    std::vector<uint32_t> newContexts(firstState[numParts] * k);
+    std::vector<uint32_t> newOffsets(firstState[numParts] + 1u);
+    std::vector<uint32_t> newWords(firstLink[numParts]);
+    std::vector<uint32_t> newCounts(firstLink[numParts]);
+    newOffsets[firstState[numParts]] = uint32_t(firstLink[numParts]);
+    forEachJob(numParts, numThreads, [&](size_t p) {
+        Part &part = parts[p];
+        std::copy(part.contexts.begin(), part.contexts.end(),
+            newContexts.begin() + firstState[p] * k);
+        for(size_t s = 0u; s < part.offsets.size(); s++) {
+            newOffsets[firstState[p] + s] =
+                uint32_t(firstLink[p] + part.offsets[s]);
+        }
+        std::copy(part.words.begin(), part.words.end(),
+            newWords.begin() + firstLink[p]);
+        std::copy(part.counts.begin(), part.counts.end(),
+            newCounts.begin() + firstLink[p]);
+        part = Part();
+    });
+
+    vocabulary = words;
+    contexts.swap(newContexts);
+    offsets.swap(newOffsets);
+    counts.swap(newCounts);
+    if(newWords.empty()) {
+        offsets.clear();
+    }
+    std::vector<Transition>(newWords.size()).swap(links);
+    for(size_t t = 0u; t < newWords.size(); t++) {
+        links[t].word = newWords[t];
+    }
+    std::vector<uint32_t>().swap(newWords);
+    cursor = NO_STATE;
+
+    // the states are in order of their first word, so the states starting
+    // with word w are those from byFirst[w] up to byFirst[w + 1]
+    const size_t numStates = states();
+    std::vector<uint32_t> byFirst(vocabulary.size() + 1u);
+    for(size_t w = 0u, s = 0u; w < byFirst.size(); w++) {
+        while(s < numStates && contexts[s * k] < w) {
+            s++;
+        }
+        byFirst[w] = uint32_t(s);
+    }
+
+    // build the alias tables and link the states, per range of states
+    forEachJob(numChunks, numThreads, [&](size_t c) {
+        AliasBuilder builder;
+        // first state from a up to b whose word i is not less than v, where
+        // the states from a up to b agree on the words before i
+        auto search = [&](size_t a, size_t b, unsigned i, uint32_t v) {
+            while(a < b) {
+                size_t mid = a + (b - a) / 2u;
+                if(contexts[mid * k + i] < v) {
+                    a = mid + 1u;
+                } else {
+                    b = mid;
+                }
+            }
+            return a;
+        };
+        size_t lo = numStates * c / numChunks;
+        size_t hi = numStates * (c + 1u) / numChunks;
+        for(size_t s = lo; s < hi; s++) {
+            uint32_t first = offsets[s], last = offsets[s + 1u];
+            builder.build(counts.data() + first, last - first,
+                links.data() + first);
+
+            // the states after s start with its last k - 1 words, and are
+            // in order of their last word, as the transitions are
+            const uint32_t *pContext = context(uint32_t(s));
+            size_t from = 0u, to = numStates;
+            if(k > 1u) {
+                from = byFirst[pContext[1]];
+                to = byFirst[pContext[1] + 1u];
+            }
+            for(unsigned i = 1u; i + 1u < k; i++) {
+                size_t mid = search(from, to, i, pContext[i + 1u]);
+                to = search(mid, to, i, pContext[i + 1u] + 1u);
+                from = mid;
+            }
+            for(uint32_t t = first; t < last; t++) {
+                from = search(from, to, k - 1u, links[t].word);
+                bool found = from < to &&
+                    contexts[from * k + k - 1u] == links[t].word;
+                links[t].state = found ? uint32_t(from) : NO_STATE;
+            }
+        }
+    });
+    return numTokens;
+}
+
+// doctest unit tests for the MarkovChain class
+TEST_CASE("testing MarkovChain") {
+    MarkovChain chain(1u, 246u);
+    CHECK(chain.train("\xEF\xBB\xBF" "a b c\r\na b d") == 6u);
+    CHECK(chain.order() == 1u);
+    CHECK(chain.tokens() == 6u);
+    CHECK(chain.vocabularySize() == 4u);
+    CHECK(chain.word(0) == "a");
+    CHECK(chain.word(3) == "d");
+
+    // d ends the corpus, so it is not a state
+    CHECK(chain.states() == 3u);
+    CHECK(chain.transitions() == 4u);
+    uint32_t b = 1u;
+    uint32_t sb = chain.findState(&b);
+    CHECK(chain.context(sb)[0] == b);
+    CHECK(chain.successors(sb) == 2u);
+    CHECK(chain.word(chain.successor(sb, 0)) == "c");
+    CHECK(chain.word(chain.successor(sb, 1)) == "d");
+    CHECK(chain.successorCount(sb, 1) == 1u);
+    uint32_t d = 3u;
+    CHECK(chain.findState(&d) == MarkovChain::NO_STATE);
+    uint32_t a = 0u;
+    CHECK(chain.successorCount(chain.findState(&a), 0) == 2u);
+
+    // a is always followed by b, and the walk gets past the end of corpus
+    std::vector<std::string_view> out(1000u);
+    chain.sampleN(out.data(), out.size());
+    size_t ds = 0u;
+    for(size_t i = 0u; i + 1u < out.size(); i++) {
+        if(out[i] == "a") {
+            REQUIRE(out[i + 1u] == "b");
+        }
+        if(out[i] == "b") {
+            REQUIRE((out[i + 1u] == "c" || out[i + 1u] == "d"));
+        }
+        ds += out[i] == "d";
+    }
+    CHECK(ds > 50u);
+    CHECK(chain.bytes() > 0u);
+}
+
+TEST_CASE("testing MarkovChain order and counts") {
+    // every state of order 2 has one successor, so the text cycles
+    MarkovChain cycle(2u, 246u);
+    cycle.train("x y z x y z x y z x y z x y z");
+    CHECK(cycle.states() == 3u);
+    CHECK(cycle.transitions() == 3u);
+    std::vector<std::string_view> out(300u);
+    cycle.sampleN(out.data(), out.size());
+    for(size_t i = 0u; i + 3u < out.size(); i++) {
+        REQUIRE(out[i] == out[i + 3u]);
+    }
+
+    // next words come up by count
+    MarkovChain counted(1u, 246u);
+    std::string corpus;
+    for(int i = 0; i < 100; i++) {
+        corpus += "p q p q p r ";
+    }
+    counted.train(corpus);
+    uint32_t p = 0u;
+    uint32_t sp = counted.findState(&p);
+    CHECK(counted.successorCount(sp, 0) == 200u);
+    CHECK(counted.successorCount(sp, 1) == 100u);
+    Xoshiro256ss g(246u);
+    std::vector<std::string_view> words(30000u);
+    counted.generate(g, sp, words.data(), words.size());
+    size_t qs = 0u, rs = 0u;
+    for(size_t i = 0u; i + 1u < words.size(); i++) {
+        if(words[i] == "p") {
+            qs += words[i + 1u] == "q";
+            rs += words[i + 1u] == "r";
+        }
+    }
+    CHECK(double(qs) / (qs + rs) == doctest::Approx(2.0 / 3.0).epsilon(0.05));
+}
+
+TEST_CASE("testing MarkovChain parallel training") {
+    // the model does not depend on the number of threads
+    Xoshiro256ss g(246u);
+    std::string corpus;
+    for(int i = 0; i < 20000; i++) {
+        corpus += "w" + std::to_string(uniformBelow(g, 40u) *
+            uniformBelow(g, 40u) / 40u);
+        corpus += i % 17 == 0 ? "\n" : " ";
+    }
+    for(unsigned order = 1u; order <= MarkovChain::MAX_ORDER; order++) {
+        MarkovChain one(order, 246u), four(order, 246u), many(order, 246u);
+        CHECK(one.train(corpus, 1u) == 20000u);
+        CHECK(four.train(corpus, 4u) == 20000u);
+        CHECK(many.train(corpus, 13u) == 20000u);
+        CHECK(one.vocabularySize() == four.vocabularySize());
+        CHECK(one.states() == four.states());
+        CHECK(one.transitions() == four.transitions());
+
+        // every word, state and transition is the same, even with more
+        // threads than distinct first words in some merge ranges
+        REQUIRE(many.vocabularySize() == one.vocabularySize());
+        REQUIRE(many.states() == one.states());
+        for(uint32_t w = 0u; w < one.vocabularySize(); w++) {
+            REQUIRE(many.word(w) == one.word(w));
+        }
+        for(uint32_t s = 0u; s < one.states(); s++) {
+            REQUIRE(std::equal(one.context(s), one.context(s) + order,
+                many.context(s)));
+            REQUIRE(many.successors(s) == one.successors(s));
+            for(uint32_t j = 0u; j < one.successors(s); j++) {
+                REQUIRE(many.successor(s, j) == one.successor(s, j));
+                REQUIRE(many.successorCount(s, j) == one.successorCount(s, j));
+                REQUIRE(many.successorState(s, j) == one.successorState(s, j));
+            }
+        }
+        std::vector<std::string_view> a(2000u), b(2000u);
+        one.sampleN(a.data(), a.size());
+        four.sampleN(b.data(), b.size());
+        CHECK(a == b);
+
+        // the counts add up to the number of n-grams, and each transition
+        // leads to the state of its last words
+        size_t total = 0u;
+        uint32_t next[MarkovChain::MAX_ORDER];
+        for(uint32_t s = 0u; s < four.states(); s++) {
+            const uint32_t *pContext = four.context(s);
+            std::copy(pContext + 1, pContext + order, next);
+            for(uint32_t j = 0u; j < four.successors(s); j++) {
+                total += four.successorCount(s, j);
+                next[order - 1u] = four.successor(s, j);
+                REQUIRE(four.successorState(s, j) == four.findState(next));
+            }
+        }
+        CHECK(total == 20000u - order);
+    }
+}
+
+TEST_CASE("testing MarkovChain exceptions") {
+    // check exception handling for bad orders
+    bool flag = true;
+    try {
+        MarkovChain chain(0u);  // should throw an exception
+        flag = false;           // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        MarkovChain chain(MarkovChain::MAX_ORDER + 1u); // should throw
+        flag = false;                                    // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+
+    // check exception handling for a chain with no states
+    MarkovChain chain(2u, 246u);
+    CHECK(chain.train("too short") == 2u);
+    CHECK(chain.states() == 0u);
+    std::string_view out[3];
+    flag = true;
+    try {
+        chain.sampleN(out, 3u); // should throw an exception
+        flag = false;           // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+}
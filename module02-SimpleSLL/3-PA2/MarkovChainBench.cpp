@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "Dictionary.hpp"
+#include "MarkovChain.hpp"
+#include "WeightedDictionary.hpp"
+
+/**
+ * Helper function to time f() and return the seconds taken.
+ */
+template <class F>
+double timed(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+}
+
+/**
+ * @brief Benchmark for MarkovChain.
+ *
+ * This program makes a corpus of a given number of words, five million by
+ * default, drawn from dictionary.txt with Zipf weights, trains chains of
+ * every order on it with 1, 2, 4, ... threads up to one per core, or with
+ * the given thread counts, and reports the training speed at each thread
+ * count, the size of the model, and the speed of generating text.
+ *
+ * Usage: MarkovChainBench [words [threads...]]
+ */
+int main(int argc, char *argv[]) {
+    using namespace std;
+
+    size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 5000000u;
+    Dictionary dict(246u);
+    try {
+        dict.loadFile("dictionary.txt");
+    } catch(runtime_error re) {
+        cout << re.what() << endl;
+        return EXIT_FAILURE;
+    }
+    vector<double> weights(dict.size());
+    for(size_t i = 0u; i < weights.size(); i++) {
+        weights[i] = 1.0 / (i % 5000u + 1u);
+    }
+    AliasTable zipf(weights);
+    Xoshiro256ss g(246u);
+    string corpus;
+    for(size_t i = 0u; i < n; i++) {
+        string_view w = dict[zipf.draw(g)];
+        corpus.append(w.data(), w.size());
+        corpus += i % 12u == 11u ? '\n' : ' ';
+    }
+    unsigned cores = thread::hardware_concurrency();
+    cores = cores == 0u ? 1u : cores;
+    cout << "corpus of " << n << " words, " << corpus.size() / 1e6 << " MB; "
+        << cores << " cores" << endl;
+
+    vector<unsigned> threads;
+    for(int i = 2; i < argc; i++) {
+        threads.push_back(strtoul(argv[i], nullptr, 10));
+    }
+    if(threads.empty()) {
+        for(unsigned t = 1u; t < cores; t *= 2u) {
+            threads.push_back(t);
+        }
+        threads.push_back(cores);
+    }
+
+    const size_t MANY = 20000000u;
+    vector<string_view> out(4096u);
+    size_t sink = 0u;
+    for(unsigned order = 1u; order <= MarkovChain::MAX_ORDER; order++) {
+        MarkovChain chain(order, 246u);
+        vector<double> train;
+        for(unsigned t : threads) {
+            train.push_back(timed([&]() { chain.train(corpus, t); }));
+        }
+        double gen = timed([&]() {
+            uint32_t state = MarkovChain::NO_STATE;
+            for(size_t i = 0u; i < MANY; i += out.size()) {
+                state = chain.generate(g, state, out.data(), out.size());
+                sink += out[0].size();
+            }
+        });
+        cout << "order " << order << ": " << chain.states() << " states, "
+            << chain.transitions() << " transitions, " << chain.bytes() / 1e6
+            << " MB" << endl;
+        cout << "  training, million words/s:";
+        for(size_t i = 0u; i < threads.size(); i++) {
+            cout << " " << n / train[i] / 1e6 << " (" << threads[i] << ")";
+        }
+        cout << endl;
+        cout << "  generating " << MANY / gen / 1e6 << " million words/s"
+            << endl;
+    }
+    cout << "(" << sink << ")" << endl;
+    return EXIT_SUCCESS;
+}
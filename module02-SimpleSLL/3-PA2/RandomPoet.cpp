@@ -1,30 +1,198 @@
+#include <cerrno>
+#include <climits>
+#include <cstdint>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <string>
-#include "SimpleSLL.h"
+#include <string_view>
+#include <vector>
+#include <unistd.h>
+#include "BulkPoems.hpp"
+#include "Dictionary.hpp"
+#include "MarkovChain.hpp"
+#include "WeightedDictionary.hpp"
 
 /**
- * Program to produce random poetry, using a linked list of dictionary words.
+ * Helper function to print how to run the program, and fail.
+ */
+int usage() {
+    std::cerr << "Usage: RandomPoet [-b poems lines words seed] [-t threads]" <<
+        " [weights | -m corpus [order]]" << std::endl;
+    return EXIT_FAILURE;
+}
+
+/**
+ * Helper function to read a count from the command line: only decimal
+ * digits, no sign, and no more than max.
+ */
+bool parseCount(const char *pArg, uint64_t max, uint64_t &value) {
+    if(*pArg < '0' || *pArg > '9') {
+        return false;
+    }
+    char *pEnd = nullptr;
+    errno = 0;
+    unsigned long long v = std::strtoull(pArg, &pEnd, 10);
+    if(*pEnd != '\0' || errno == ERANGE || v > max) {
+        return false;
+    }
+    value = v;
+    return true;
+}
+
+/**
+ * Helper function to make a poem of lines lines of words words each, drawn
+ * from dictionary in one call.
+ */
+template <class D>
+std::string makePoem(const D &dictionary, unsigned lines, unsigned words) {
+    std::vector<std::string_view> all(size_t(lines) * words);
+    dictionary.sampleN(all.data(), all.size());
+    std::string poem;
+    appendPoem(poem, all.data(), lines, words);
+    return poem;
+}
+
+/**
+ * Helper function to write poems poems of lines lines of words words each,
+ * drawn from source, to standard output, and report the speed on standard
+ * error.
+ */
+template <class S>
+int bulkPoems(const S &source, uint64_t poems, unsigned lines,
+    unsigned words, uint64_t seed, unsigned numThreads) {
+    try {
+        BulkStats stats = writePoems(source, STDOUT_FILENO, poems, lines,
+            words, seed, numThreads);
+        std::cerr << "wrote " << stats.poems << " poems, " << stats.words <<
+            " words, " << stats.bytes / 1e6 << " MB in " << stats.seconds <<
+            " s with " << stats.threads << " threads and " << stats.writes <<
+            " writes: " << stats.wordsPerSecond() / 1e6 <<
+            " million words/s, " << stats.bytes / stats.seconds / 1e6 <<
+            " MB/s" << std::endl;
+    } catch(std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Program to produce random poetry, using a random-access dictionary.
+ *
+ * With no arguments, every word of dictionary.txt is equally likely. With
+ * the name of a file of words and weights, one word, a tab and a weight
+ * per line, words come up in proportion to their weights. With -m and the
+ * name of a text file, the poem is generated by a Markov chain trained on
+ * the text, of order 2 unless another is given.
+ *
+ * With -b, the program asks nothing, and writes the given number of poems
+ * to standard output as fast as it can, with one thread per core unless -t
+ * gives another number; the poems are the same for the same seed.
+ *
+ * Usage: RandomPoet [-b poems lines words seed] [-t threads]
+ *                   [weights | -m corpus [order]]
  *
  * TODO: complete Doxygen tags for the main program.
  * @author <your name here>
  * @date <date code was authored>
  */
-int main() {
-    // welcome message
-    std::cout << "Welcome to the random poetry generator!\n" <<
+int main(int argc, char *argv[]) {
+    // bulk mode options
+    bool bulk = false;
+    uint64_t poems = 0u, seed = 0u, bulkLines = 0u, bulkWords = 0u,
+        threads = 0u;
+    int a = 1;
+    while(a < argc) {
+        std::string option(argv[a]);
+        if(option == "-b") {
+            if(a + 4 >= argc ||
+                !parseCount(argv[a + 1], UINT64_MAX, poems) ||
+                !parseCount(argv[a + 2], UINT_MAX, bulkLines) ||
+                !parseCount(argv[a + 3], UINT_MAX, bulkWords) ||
+                !parseCount(argv[a + 4], UINT64_MAX, seed)) {
+                return usage();
+            }
+            bulk = true;
+            a += 5;
+        } else if(option == "-t") {
+            if(a + 1 >= argc || !parseCount(argv[a + 1], UINT_MAX, threads)) {
+                return usage();
+            }
+            a += 2;
+        } else {
+            break;
+        }
+    }
+    argc -= a - 1;
+    argv += a - 1;
+
+    // welcome message, out of the way of the poems in bulk mode
+    (bulk ? std::cerr : std::cout) <<
+        "Welcome to the random poetry generator!\n" <<
         "Please wait while the dictionary is loaded." << std::endl;
     
-    // load dictionary
-    SimpleSLL<string> dictionary;
-    std::ifstream inFile("dictionary.txt");
-    std::string w;
-    while(inFile >> w) {
-        dictionary.add(w);
-    }
-    inFile.close();
+    // load dictionary, or words and weights, or train a chain
+    Dictionary dictionary;
+    WeightedDictionary weighted;
+    bool useChain = argc > 2 && std::string(argv[1]) == "-m";
+    bool useWeights = argc > 1 && !useChain;
+    uint64_t order = 2u;
+    if(argc > 3 && !parseCount(argv[3], UINT_MAX, order)) {
+        return usage();
+    }
+    if(useChain && (order == 0u || order > MarkovChain::MAX_ORDER)) {
+        std::cerr << "order must be from 1 to " << MarkovChain::MAX_ORDER <<
+            std::endl;
+        return EXIT_FAILURE;
+    }
+    MarkovChain chain(useChain ? unsigned(order) : 1u);
+    if(useChain) {
+        std::ifstream inFile(argv[2], std::ios::binary);
+        if(!inFile) {
+            std::cerr << "unable to open " << argv[2] << std::endl;
+            return EXIT_FAILURE;
+        }
+        chain.train(inFile);
+        inFile.close();
+        if(chain.states() == 0u) {
+            std::cerr << argv[2] << ": too few words for order " << order <<
+                std::endl;
+            return EXIT_FAILURE;
+        }
+    } else if(useWeights) {
+        std::ifstream inFile(argv[1], std::ios::binary);
+        if(!inFile) {
+            std::cerr << "unable to open " << argv[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+        try {
+            weighted.load(inFile);
+        } catch(std::invalid_argument ia) {
+            std::cerr << argv[1] << ": " << ia.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        inFile.close();
+    } else {
+        try {
+            dictionary.loadFile("dictionary.txt");
+        } catch(std::runtime_error re) {
+            std::cerr << re.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
     
+    if(bulk) {
+        unsigned lines = unsigned(bulkLines), words = unsigned(bulkWords);
+        return useChain ?
+            bulkPoems(chain, poems, lines, words, seed, unsigned(threads)) :
+            useWeights ?
+            bulkPoems(weighted, poems, lines, words, seed, unsigned(threads)) :
+            bulkPoems(dictionary, poems, lines, words, seed,
+            unsigned(threads));
+    }
+
     // lines, words, prompt variables
     unsigned lines = 0, words = 0, prompt = 0;
     
@@ -38,15 +206,10 @@ int main() {
         
         std::cout << "\nHere's your poem, man!\n\n";
         
-        for(unsigned i = 0u; i < lines; i++) {
-            std::cout << "\t";
-            for(unsigned j = 0u; j < words; j++) {
-                // TODO: get a random word from the dictionary and print it,
-                // followed by a space
-                std::cout << dictionary.getRandom() << " ";
-            }
-            std::cout << std::endl;
-        }
+        // draw the poem's words in one call, and print the poem at once
+        std::cout << (useChain ? makePoem(chain, lines, words) :
+            useWeights ? makePoem(weighted, lines, words) :
+            makePoem(dictionary, lines, words)) << std::flush;
         
         std::cout << "\nWould you like to make another poem? " << 
             "Enter 1 for yes, 0 for no: ";
@@ -55,4 +218,4 @@ int main() {
     } while(prompt == 1);
     
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -4,8 +4,7 @@
 #include <ctime>
 #include <iostream>
 #include <stdexcept>
-// TODO: add include for the Mersenne Twister PRNG
-#include <random>
+#include "Rng.hpp"
 
 /*-----------------------------------------------------------------------------
  * class definition
@@ -71,7 +70,7 @@ public:
      *
      * Made an initially empty list.
      */
-    SimpleSLL() : pHead(0), n(0) { }
+    SimpleSLL() : pHead(0), n(0), prng(time(0)) { }
 
     /**
      * @brief Destructor. 
@@ -120,8 +119,15 @@ public:
      */
     T get (size_t idx) const;
 
-    // TODO: Write Doxygen comments for the getRandom() method. Use the other
-    // Doxygen comment blocks as a reference.
+    /**
+     * @brief Get a random value.
+     *
+     * Get the value at a uniformly chosen random index in the list.
+     *
+     * @throws std::out_of_range if the list is empty.
+     *
+     * @return Value at a random location in the list.
+     */
     T getRandom() const;
 
     /**
@@ -187,9 +193,10 @@ private:
     size_t n;
 
     /**
-     * 64-bit Mersenne Twister PRNG.
+     * xoshiro256** PRNG. Mutable, since drawing a random element changes
+     * the generator but not the list.
      */
-    std::mt19937_64 prng(time(0));
+    mutable Xoshiro256ss prng;
 };
 
 //-----------------------------------------------------------------------------
@@ -374,21 +381,48 @@ TEST_CASE("testing SimpleSLL<T>::get") {
  */
 template <class T>
 T SimpleSLL<T>::getRandom() const {
-    // TODO: create a std::uniform_int_distribution that will return a number
-    // between 0 and the size of the list minus one, inclusive. 
-    //
-    // See the code in module01-Intro/6-MonteCarlo/MontePi.cpp
-    // for similar code.
-    std::uniform_int_distribution<> dist(0, n - 1);
-
-    // TODO: use the distribution you just created to get a random index into
-    // the list. Use the prng class field that has already been created.
-    size_t idx = dist(prng);
-
-    // TODO: return the element at the index you just created
+    if(n == 0u) {
+        throw std::out_of_range("Empty list in SimpleSLL::getRandom()");
+    }
+
+    // unbiased random index in [0, n), without a distribution object
+    size_t idx = size_t(uniformBelow(prng, n));
+
+    // return the element at the random index
     return get(idx);
 }
 
+// doctest unit test for the getRandom method
+TEST_CASE("testing SimpleSLL<T>::getRandom") {
+    SimpleSLL<char> list;
+
+    // check exception handling for an empty list
+    bool flag = true;
+    try {
+        list.getRandom();   // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+
+    // populate the list
+    for(char c = 'A'; c <= 'E'; c++) {
+        list.add(c);
+    }
+
+    // every element should come up, and nothing else
+    bool seen[5] = { false, false, false, false, false };
+    for(int i = 0; i < 500; i++) {
+        char c = list.getRandom();
+        REQUIRE(c >= 'A');
+        REQUIRE(c <= 'E');
+        seen[c - 'A'] = true;
+    }
+    for(int i = 0; i < 5; i++) {
+        CHECK(seen[i]);
+    }
+}
+
 /*
  * Remove node at location idx. 
  */
@@ -0,0 +1,951 @@
+#pragma once
+
+#include <doctest.h>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Dictionary.hpp"
+#include "Rng.hpp"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define WEIGHTED_DICTIONARY_X86 1
+#endif
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief One bucket of an alias table: keep the bucket's own index if a
+ * random fraction is below threshold / 2^32, and take alias otherwise.
+ * Both halves sit side by side, so a draw touches one cache line.
+ */
+struct AliasBucket {
+    /** Chance of keeping the bucket's own index, times 2^32. */
+    uint32_t threshold;
+
+    /** Index taken otherwise. */
+    uint32_t alias;
+};
+
+/**
+ * @brief Builder of alias buckets with Vose's method.
+ *
+ * The builder keeps its work space from one build to the next, so building
+ * many small tables, as a Markov chain does, allocates almost nothing.
+ */
+class AliasBuilder {
+public:
+    /**
+     * @brief Build alias buckets.
+     *
+     * Index i is drawn with probability pWeights[i] over the sum of the
+     * weights.
+     *
+     * @param pWeights Weight of each index.
+     * @param n Number of weights.
+     * @param pOut Pointer to room for n buckets: AliasBuckets, or any
+     * struct with threshold and alias members laid out the same way.
+     *
+     * @throws std::invalid_argument if a weight is negative or not finite,
+     * if they add up to zero, or if there are 2^32 or more of them.
+     */
+    template <class T, class B>
+    void build(const T *pWeights, size_t n, B *pOut);
+
+private:
+    /**
+     * Weights scaled to average 1.
+     */
+    std::vector<double> scaled;
+
+    /**
+     * Indices with scaled weight below 1, and at least 1.
+     */
+    std::vector<uint32_t> small, large;
+};
+
+/**
+ * @brief Draw an index from alias buckets.
+ *
+ * The high half of the product of bits and n picks the bucket, and the top
+ * 32 bits of the low half are compared with its threshold. Since n fits in
+ * 32 bits, both come from t = hi * n + (lo * n >> 32), where hi and lo are
+ * the halves of bits: the bucket is the high half of t, and the fraction
+ * its low half. Two 32 by 32 bit products take the place of a 128-bit one,
+ * which vector units have.
+ *
+ * @param pBuckets Pointer to the buckets, AliasBuckets or any struct with
+ * threshold and alias members.
+ * @param n Number of buckets, at least 1.
+ * @param bits 64 random bits.
+ *
+ * @return An index less than n.
+ */
+template <class B>
+uint32_t pickAlias(const B *pBuckets, uint32_t n, uint64_t bits) {
+    uint64_t t = (bits >> 32) * n + ((bits & 0xFFFFFFFFu) * n >> 32);
+    uint32_t idx = uint32_t(t >> 32);
+    uint32_t fraction = uint32_t(t);
+    return fraction < pBuckets[idx].threshold ? idx : pBuckets[idx].alias;
+}
+
+/**
+ * @brief Draw many indices from alias buckets, one at a time.
+ *
+ * Portable kernel; sets pOut[i] to pickAlias(pBuckets, n, pBits[i]).
+ *
+ * @param pBuckets Pointer to the buckets.
+ * @param n Number of buckets, at least 1.
+ * @param pBits Pointer to m random numbers.
+ * @param pOut Pointer to room for m indices.
+ * @param m Number of indices to draw.
+ */
+inline void pickAliasScalar(const AliasBucket *pBuckets, uint32_t n,
+    const uint64_t *pBits, uint32_t *pOut, size_t m) {
+    for(size_t i = 0u; i < m; i++) {
+        pOut[i] = pickAlias(pBuckets, n, pBits[i]);
+    }
+}
+
+#ifdef WEIGHTED_DICTIONARY_X86
+/**
+ * @brief AVX2 version of pickAliasScalar(), four draws at a time.
+ *
+ * Each bucket is gathered as one 64-bit lane, threshold in the low half
+ * and alias in the high half. Must only be called if the processor
+ * supports AVX2.
+ */
+__attribute__((target("avx2")))
+inline void pickAliasAvx2(const AliasBucket *pBuckets, uint32_t n,
+    const uint64_t *pBits, uint32_t *pOut, size_t m) {
+    static_assert(sizeof(AliasBucket) == 8u, "a bucket is one 64-bit lane");
+    const __m256i vn = _mm256_set1_epi64x(n);
+    const __m256i low = _mm256_set1_epi64x(0xFFFFFFFF);
+    const __m256i evens = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    const long long *pLanes = (const long long *)pBuckets;
+    size_t i = 0u;
+    for(; i + 4u <= m; i += 4u) {
+        __m256i bits = _mm256_loadu_si256((const __m256i *)(pBits + i));
+        __m256i t = _mm256_add_epi64(
+            _mm256_mul_epu32(_mm256_srli_epi64(bits, 32), vn),
+            _mm256_srli_epi64(_mm256_mul_epu32(bits, vn), 32));
+        __m256i idx = _mm256_srli_epi64(t, 32);
+        __m256i bucket = _mm256_i64gather_epi64(pLanes, idx, 8);
+        __m256i keep = _mm256_cmpgt_epi64(_mm256_and_si256(bucket, low),
+            _mm256_and_si256(t, low));
+        __m256i picked = _mm256_blendv_epi8(_mm256_srli_epi64(bucket, 32),
+            idx, keep);
+        _mm_storeu_si128((__m128i *)(pOut + i), _mm256_castsi256_si128(
+            _mm256_permutevar8x32_epi32(picked, evens)));
+    }
+
+    pickAliasScalar(pBuckets, n, pBits + i, pOut + i, m - i);
+}
+
+// GCC 12 wrongly warns that the AVX-512 intrinsics read an uninitialized
+// register
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+/**
+ * @brief AVX-512 version of pickAliasScalar(), eight draws at a time.
+ *
+ * Must only be called if the processor supports AVX-512F.
+ */
+__attribute__((target("avx512f")))
+inline void pickAliasAvx512(const AliasBucket *pBuckets, uint32_t n,
+    const uint64_t *pBits, uint32_t *pOut, size_t m) {
+    const __m512i vn = _mm512_set1_epi64(n);
+    const __m512i low = _mm512_set1_epi64(0xFFFFFFFF);
+    size_t i = 0u;
+    for(; i + 8u <= m; i += 8u) {
+        __m512i bits = _mm512_loadu_si512(pBits + i);
+        __m512i t = _mm512_add_epi64(
+            _mm512_mul_epu32(_mm512_srli_epi64(bits, 32), vn),
+            _mm512_srli_epi64(_mm512_mul_epu32(bits, vn), 32));
+        __m512i idx = _mm512_srli_epi64(t, 32);
+        __m512i bucket = _mm512_i64gather_epi64(idx, pBuckets, 8);
+        __mmask8 keep = _mm512_cmplt_epu64_mask(_mm512_and_si512(t, low),
+            _mm512_and_si512(bucket, low));
+        __m512i picked = _mm512_mask_blend_epi64(keep,
+            _mm512_srli_epi64(bucket, 32), idx);
+        _mm256_storeu_si256((__m256i *)(pOut + i),
+            _mm512_cvtepi64_epi32(picked));
+    }
+
+    pickAliasScalar(pBuckets, n, pBits + i, pOut + i, m - i);
+}
+
+#pragma GCC diagnostic pop
+#endif
+
+/**
+ * @brief Draw many indices from alias buckets.
+ *
+ * Sets pOut[i] to pickAlias(pBuckets, n, pBits[i]), with the widest kernel
+ * the processor supports. The choice is made once and cached.
+ *
+ * @param pBuckets Pointer to the buckets.
+ * @param n Number of buckets, at least 1.
+ * @param pBits Pointer to m random numbers.
+ * @param pOut Pointer to room for m indices.
+ * @param m Number of indices to draw.
+ */
+inline void pickAliasN(const AliasBucket *pBuckets, uint32_t n,
+    const uint64_t *pBits, uint32_t *pOut, size_t m) {
+#ifdef WEIGHTED_DICTIONARY_X86
+    static const int level = __builtin_cpu_supports("avx512f") ? 2 :
+        __builtin_cpu_supports("avx2") ? 1 : 0;
+    if(level == 2) {
+        pickAliasAvx512(pBuckets, n, pBits, pOut, m);
+        return;
+    }
+    if(level == 1) {
+        pickAliasAvx2(pBuckets, n, pBits, pOut, m);
+        return;
+    }
+#endif
+    pickAliasScalar(pBuckets, n, pBits, pOut, m);
+}
+
+/**
+ * @brief Walker's alias table, for drawing indices with given weights.
+ *
+ * Building the table takes O(n) time, with Vose's method. Every index gets a
+ * bucket of equal probability holding a threshold and an alias: a draw
+ * picks a bucket uniformly, then keeps its index if a second uniform number
+ * is below the threshold, and takes the alias otherwise, so a draw takes
+ * O(1) time whatever the weights.
+ *
+ * Both numbers come from one 64-bit random number: the high half of its
+ * product with n picks the bucket, and the top 32 bits of the low half are
+ * compared with the threshold. The probabilities are exact to within
+ * n / 2^64 plus one part in 2^32 per bucket.
+ */
+class AliasTable {
+public:
+    /**
+     * @brief Default constructor; an empty table.
+     */
+    AliasTable() { }
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * @param weights Weight of each index.
+     *
+     * @throws std::invalid_argument as build() does.
+     */
+    explicit AliasTable(const std::vector<double> &weights) {
+        build(weights.data(), weights.size());
+    }
+
+    /**
+     * @brief Build the table.
+     *
+     * Index i is drawn with probability pWeights[i] over the sum of the
+     * weights.
+     *
+     * @param pWeights Weight of each index.
+     * @param n Number of weights.
+     *
+     * @throws std::invalid_argument if a weight is negative or not finite,
+     * if they add up to zero, or if there are 2^32 or more of them.
+     */
+    void build(const double *pWeights, size_t n);
+
+    /**
+     * @brief Memory held by the table.
+     *
+     * @return Bytes allocated for the buckets.
+     */
+    size_t bytes() const { return buckets.capacity() * sizeof(AliasBucket); }
+
+    /**
+     * @brief Draw one index.
+     *
+     * @param g Random number generator.
+     *
+     * @throws std::out_of_range if the table is empty.
+     *
+     * @return An index drawn with its weight.
+     */
+    template <class G> uint32_t draw(G &g) const;
+
+    /**
+     * @brief Draw many indices.
+     *
+     * The random numbers are made a block at a time, and each block is
+     * turned into indices by pickAliasN(), eight or four at a time with
+     * AVX-512 or AVX2 gathers where the processor has them. It draws the
+     * same indices as k calls to draw().
+     *
+     * @param g Random number generator.
+     * @param pOut Pointer to room for k indices.
+     * @param k Number of indices to draw.
+     *
+     * @throws std::out_of_range if the table is empty and k is not zero.
+     */
+    template <class G> void drawN(G &g, uint32_t *pOut, size_t k) const;
+
+    /**
+     * @brief Probability of an index, as the table draws it.
+     *
+     * This takes O(n) time; it is for testing.
+     *
+     * @param idx The index.
+     *
+     * @return The probability of drawing idx.
+     */
+    double probability(size_t idx) const;
+
+    /**
+     * @brief Get table size.
+     *
+     * @return The number of indices.
+     */
+    size_t size() const { return buckets.size(); }
+
+    /**
+     * Number of random numbers drawN() makes at a time.
+     */
+    static constexpr size_t BLOCK = 256u;
+
+private:
+    /**
+     * Helper function to turn one random number into an index.
+     */
+    uint32_t pick(uint64_t bits) const {
+        return pickAlias(buckets.data(), uint32_t(buckets.size()), bits);
+    }
+
+    /**
+     * The buckets, one per index.
+     */
+    std::vector<AliasBucket> buckets;
+};
+
+/**
+ * @brief Memory used by a WeightedDictionary, in bytes.
+ */
+struct SamplerFootprint {
+    /** Number of words. */
+    size_t words;
+
+    /** The characters of the words. */
+    size_t textBytes;
+
+    /** The offsets of the words in the arena, one uint32_t per word. */
+    size_t indexBytes;
+
+    /** The weights, kept for rebuilding the table. */
+    size_t weightBytes;
+
+    /** The alias table. */
+    size_t tableBytes;
+
+    /**
+     * @brief Total memory.
+     *
+     * @return Bytes used, all told.
+     */
+    size_t total() const {
+        return textBytes + indexBytes + weightBytes + tableBytes;
+    }
+
+    /**
+     * @brief Memory per word.
+     *
+     * @return Bytes used per word, all told.
+     */
+    double bytesPerWord() const {
+        return words == 0u ? 0.0 : double(total()) / words;
+    }
+};
+
+/**
+ * @brief CMP 246 Module 2 word list for drawing words by frequency.
+ *
+ * WeightedDictionary is a Dictionary with a weight per word and an alias
+ * table over the weights, so a word comes up in proportion to its weight,
+ * in O(1) time per word. Words are read from a file with one word, a tab
+ * and a weight per line, or added one at a time with add() followed by
+ * build().
+ */
+class WeightedDictionary {
+public:
+    /**
+     * @brief Default constructor.
+     *
+     * Make an empty dictionary, with the random number generator seeded
+     * from the time.
+     */
+    WeightedDictionary() : prng(uint64_t(time(0))) { }
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * Make an empty dictionary, with a fixed seed, so the random words are
+     * the same on every run.
+     *
+     * @param seed Seed for the random number generator.
+     */
+    explicit WeightedDictionary(uint64_t seed) : words(seed), prng(seed) { }
+
+    /**
+     * @brief Add a word at the end.
+     *
+     * The word is not drawn until the next build().
+     *
+     * @param word The word. It may not point into this dictionary.
+     * @param weight Its weight, relative to the others.
+     *
+     * @throws std::invalid_argument if weight is negative or not finite.
+     */
+    void add(std::string_view word, double weight);
+
+    /**
+     * @brief Build the alias table over every word added so far.
+     *
+     * @throws std::invalid_argument if the weights add up to zero.
+     */
+    void build() { table.build(weights.data(), weights.size()); }
+
+    /**
+     * @brief Get the memory used.
+     *
+     * @return Bytes allocated for each part of the dictionary.
+     */
+    SamplerFootprint footprint() const;
+
+    /**
+     * @brief Get a random word, by weight.
+     *
+     * @throws std::out_of_range if the dictionary is empty, or words were
+     * added since the last build().
+     *
+     * @return A word chosen at random.
+     */
+    std::string_view getRandom() const;
+
+    /**
+     * @brief Read words and weights.
+     *
+     * Read the whole stream in one block. Every line holds a word, a tab
+     * and a weight; blank lines are skipped, and CRLF line ends are allowed.
+     * Every line is checked before any word is added, so if the block is
+     * rejected the dictionary is left as it was. The table is built when
+     * the reading is done.
+     *
+     * @param in Stream to read.
+     *
+     * @throws std::invalid_argument if a line has no tab, an empty word or
+     * a bad weight, or the weights, old and new, add up to zero.
+     *
+     * @return Number of words added.
+     */
+    size_t load(std::istream &in);
+
+    /**
+     * @brief Get random words, by weight.
+     *
+     * Draw k words at random, independently, and write them to pOut.
+     *
+     * @param pOut Pointer to room for k words.
+     * @param k Number of words to draw.
+     *
+     * @throws std::out_of_range as getRandom() does, if k is not zero.
+     */
+    void sampleN(std::string_view *pOut, size_t k) const {
+        sampleN(prng, pOut, k);
+    }
+
+    /**
+     * @brief Get random words, by weight, with a generator of the caller's.
+     *
+     * This changes nothing in the dictionary, so threads can share one
+     * dictionary, each with a generator of its own.
+     *
+     * @param g Random number generator.
+     * @param pOut Pointer to room for k words.
+     * @param k Number of words to draw.
+     *
+     * @throws std::out_of_range as getRandom() does, if k is not zero.
+     */
+    template <class G>
+    void sampleN(G &g, std::string_view *pOut, size_t k) const;
+
+    /**
+     * @brief Get dictionary size.
+     *
+     * @return The number of words in the dictionary.
+     */
+    size_t size() const { return words.size(); }
+
+    /**
+     * @brief Element access, unchecked.
+     *
+     * @param idx Index of the word, less than size().
+     *
+     * @return The word at index idx.
+     */
+    std::string_view operator[](size_t idx) const { return words[idx]; }
+
+    /**
+     * @brief Weight access, unchecked.
+     *
+     * @param idx Index of the word, less than size().
+     *
+     * @return The weight of the word at index idx.
+     */
+    double weight(size_t idx) const { return weights[idx]; }
+
+private:
+    /**
+     * Helper function to check that the table covers every word.
+     */
+    void checkBuilt(const char *pWhere) const;
+
+    /**
+     * The words.
+     */
+    Dictionary words;
+
+    /**
+     * Weight of each word.
+     */
+    std::vector<double> weights;
+
+    /**
+     * Alias table over the weights.
+     */
+    AliasTable table;
+
+    /**
+     * xoshiro256** PRNG. Mutable, since drawing a random word changes the
+     * generator but not the dictionary.
+     */
+    mutable Xoshiro256ss prng;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Vose's method: scale the weights to average 1, then repeatedly fill up a
+ * small bucket with the excess of a large one.
+ */
+template <class T, class B>
+void AliasBuilder::build(const T *pWeights, size_t n, B *pOut) {
+    if(uint64_t(n) > 0xFFFFFFFFull) {
+        throw std::invalid_argument("too many weights in AliasBuilder::build()");
+    }
+    double sum = 0.0;
+    for(size_t i = 0u; i < n; i++) {
+        double w = double(pWeights[i]);
+        if(!(w >= 0.0) || !std::isfinite(w)) {
+            throw std::invalid_argument("bad weight in AliasBuilder::build()");
+        }
+        sum += w;
+    }
+    if(!(sum > 0.0) || !std::isfinite(sum)) {
+        throw std::invalid_argument("no weight in AliasBuilder::build()");
+    }
+
+    scaled.resize(n);
+    small.clear();
+    large.clear();
+    for(size_t i = 0u; i < n; i++) {
+        scaled[i] = double(pWeights[i]) * (double(n) / sum);
+        (scaled[i] < 1.0 ? small : large).push_back(uint32_t(i));
+    }
+
+    const double SCALE = 4294967296.0;
+    while(!small.empty() && !large.empty()) {
+        uint32_t s = small.back(), l = large.back();
+        small.pop_back();
+        double t = std::floor(scaled[s] * SCALE + 0.5);
+        pOut[s].threshold = t >= SCALE - 1.0 ? 0xFFFFFFFFu : uint32_t(t);
+        pOut[s].alias = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if(scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // what is left has probability 1, up to rounding; alias to itself
+    for(uint32_t i : small) {
+        pOut[i].threshold = 0xFFFFFFFFu;
+        pOut[i].alias = i;
+    }
+    for(uint32_t i : large) {
+        pOut[i].threshold = 0xFFFFFFFFu;
+        pOut[i].alias = i;
+    }
+}
+
+/*
+ * Build into a new vector, so a bad weight leaves the old table.
+ */
+inline void AliasTable::build(const double *pWeights, size_t n) {
+    std::vector<AliasBucket> built(n);
+    AliasBuilder builder;
+    builder.build(pWeights, n, built.data());
+    buckets.swap(built);
+}
+
+template <class G>
+uint32_t AliasTable::draw(G &g) const {
+    if(buckets.empty()) {
+        throw std::out_of_range("Empty table in AliasTable::draw()");
+    }
+    return pick(g());
+}
+
+/*
+ * Random numbers a block at a time, then one vector pass per block.
+ */
+template <class G>
+void AliasTable::drawN(G &g, uint32_t *pOut, size_t k) const {
+    if(k == 0u) {
+        return;
+    }
+    if(buckets.empty()) {
+        throw std::out_of_range("Empty table in AliasTable::drawN()");
+    }
+    uint64_t bits[BLOCK];
+    for(size_t done = 0u; done < k; done += BLOCK) {
+        size_t m = k - done < BLOCK ? k - done : BLOCK;
+        for(size_t i = 0u; i < m; i++) {
+            bits[i] = g();
+        }
+        pickAliasN(buckets.data(), uint32_t(buckets.size()), bits,
+            pOut + done, m);
+    }
+}
+
+/*
+ * The bucket's own share, plus the shares of the buckets aliased to idx.
+ */
+inline double AliasTable::probability(size_t idx) const {
+    const double SCALE = 4294967296.0;
+    double p = 0.0;
+    for(size_t i = 0u; i < buckets.size(); i++) {
+        if(i == idx) {
+            p += buckets[i].threshold / SCALE;
+        }
+        if(buckets[i].alias == idx) {
+            p += 1.0 - buckets[i].threshold / SCALE;
+        }
+    }
+    return p / buckets.size();
+}
+
+inline void WeightedDictionary::add(std::string_view word, double weight) {
+    if(!(weight >= 0.0) || !std::isfinite(weight)) {
+        throw std::invalid_argument("bad weight in WeightedDictionary::add()");
+    }
+    words.add(word);
+    weights.push_back(weight);
+}
+
+inline void WeightedDictionary::checkBuilt(const char *pWhere) const {
+    if(words.isEmpty()) {
+        throw std::out_of_range(std::string("Empty dictionary in ") + pWhere);
+    }
+    if(table.size() != words.size()) {
+        throw std::out_of_range(std::string("Table out of date in ") + pWhere);
+    }
+}
+
+inline SamplerFootprint WeightedDictionary::footprint() const {
+    SamplerFootprint fp;
+    fp.words = words.size();
+    fp.textBytes = words.textBytes();
+    fp.indexBytes = words.indexBytes();
+    fp.weightBytes = weights.capacity() * sizeof(double);
+    fp.tableBytes = table.bytes();
+    return fp;
+}
+
+inline std::string_view WeightedDictionary::getRandom() const {
+    checkBuilt("WeightedDictionary::getRandom()");
+    return words[table.draw(prng)];
+}
+
+/*
+ * Split the block into lines, and each line at its tab, checking them all;
+ * then add the words in one go.
+ */
+inline size_t WeightedDictionary::load(std::istream &in) {
+    std::string block((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+    size_t lineNumber = 0u, chars = 0u;
+    const char *pEnd = block.data() + block.size();
+    const char *p = skipBom(block.data(), pEnd);
+
+    // one word per line at most
+    size_t numLines = size_t(std::count(p, pEnd, '\n')) + 1u;
+    std::vector<std::string_view> newWords;
+    std::vector<double> newWeights;
+    newWords.reserve(numLines);
+    newWeights.reserve(numLines);
+    while(p < pEnd) {
+        lineNumber++;
+        const char *pLineEnd = p;
+        while(pLineEnd < pEnd && *pLineEnd != '\n') {
+            pLineEnd++;
+        }
+        const char *pNext = pLineEnd + (pLineEnd < pEnd);
+        if(pLineEnd > p && pLineEnd[-1] == '\r') {
+            pLineEnd--;
+        }
+        if(pLineEnd > p) {
+            const char *pTab = p;
+            while(pTab < pLineEnd && *pTab != '\t') {
+                pTab++;
+            }
+            double w = 0.0;
+            std::from_chars_result r = std::from_chars(pTab + 1, pLineEnd, w);
+            if(pTab == p || pTab == pLineEnd || r.ec != std::errc() ||
+                r.ptr != pLineEnd || !(w >= 0.0) || !std::isfinite(w)) {
+                throw std::invalid_argument("bad line " +
+                    std::to_string(lineNumber) +
+                    " in WeightedDictionary::load()");
+            }
+            newWords.push_back(std::string_view(p, size_t(pTab - p)));
+            newWeights.push_back(w);
+            chars += size_t(pTab - p);
+        }
+        p = pNext;
+    }
+
+    // the table needs some weight to draw by
+    double sum = 0.0;
+    for(double w : weights) {
+        sum += w;
+    }
+    for(double w : newWeights) {
+        sum += w;
+    }
+    if(!(sum > 0.0) || !std::isfinite(sum)) {
+        throw std::invalid_argument("no weight in WeightedDictionary::load()");
+    }
+
+    words.reserve(newWords.size(), chars);
+    weights.insert(weights.end(), newWeights.begin(), newWeights.end());
+    for(std::string_view word : newWords) {
+        words.add(word);
+    }
+    build();
+    return newWords.size();
+}
+
+/*
+ * Draw indices a block at a time, then look the words up.
+ */
+template <class G>
+void WeightedDictionary::sampleN(G &g, std::string_view *pOut,
+    size_t k) const {
+    if(k == 0u) {
+        return;
+    }
+    checkBuilt("WeightedDictionary::sampleN()");
+    uint32_t idx[AliasTable::BLOCK];
+    for(size_t done = 0u; done < k; done += AliasTable::BLOCK) {
+        size_t m = k - done < AliasTable::BLOCK ? k - done : AliasTable::BLOCK;
+        table.drawN(g, idx, m);
+        for(size_t i = 0u; i < m; i++) {
+            pOut[done + i] = words[idx[i]];
+        }
+    }
+}
+
+// doctest unit tests for the AliasTable class
+TEST_CASE("testing AliasTable") {
+    std::vector<double> weights = { 1.0, 0.0, 2.0, 7.0, 0.5, 3.5 };
+    AliasTable table(weights);
+    CHECK(table.size() == 6u);
+    CHECK(table.bytes() == 6u * 8u);
+
+    // the table holds the weights exactly, up to 2^-32
+    double total = 0.0;
+    for(size_t i = 0u; i < weights.size(); i++) {
+        CHECK(table.probability(i) ==
+            doctest::Approx(weights[i] / 14.0).epsilon(1e-8));
+        total += table.probability(i);
+    }
+    CHECK(total == doctest::Approx(1.0));
+
+    // draws come up in proportion, and never with zero weight
+    Xoshiro256ss g(246u);
+    const size_t N = 140000u;
+    std::vector<uint32_t> out(N);
+    table.drawN(g, out.data(), N);
+    size_t counts[6] = { 0u, 0u, 0u, 0u, 0u, 0u };
+    for(uint32_t idx : out) {
+        REQUIRE(idx < 6u);
+        counts[idx]++;
+    }
+    for(int i = 0; i < 1000; i++) {
+        counts[table.draw(g)]++;
+    }
+    CHECK(counts[1] == 0u);
+    for(size_t i = 0u; i < weights.size(); i++) {
+        double expected = weights[i] / 14.0 * (N + 1000u);
+        CHECK(std::fabs(counts[i] - expected) <=
+            5.0 * std::sqrt(expected) + 1.0);
+    }
+
+    // pickAlias() splits the 128-bit product exactly, and every kernel
+    // draws the same indices as draw(), tails included
+    std::vector<double> many(100003u);
+    for(size_t i = 0u; i < many.size(); i++) {
+        many[i] = double(i % 17u);
+    }
+    AliasTable big(many);
+    for(int i = 0; i < 10000; i++) {
+        uint64_t bits = g();
+        uint32_t n = uint32_t(bits >> 40) | 1u;
+        unsigned __int128 m = (unsigned __int128)bits * n;
+        uint64_t t = (bits >> 32) * n + ((bits & 0xFFFFFFFFu) * n >> 32);
+        REQUIRE(uint32_t(t >> 32) == uint32_t(m >> 64));
+        REQUIRE(uint32_t(t) == uint32_t(uint64_t(m) >> 32));
+    }
+    for(const AliasTable *pTable : { &table, &big }) {
+        Xoshiro256ss g1(7u), g2(7u);
+        std::vector<uint32_t> batch(1003u);
+        pTable->drawN(g1, batch.data(), batch.size());
+        for(uint32_t idx : batch) {
+            REQUIRE(idx == pTable->draw(g2));
+        }
+    }
+
+    // one weight, and many equal weights, are always kept
+    AliasTable one(std::vector<double>(1u, 3.0));
+    CHECK(one.draw(g) == 0u);
+    AliasTable flat(std::vector<double>(1000u, 0.25));
+    for(size_t i = 0u; i < 1000u; i++) {
+        REQUIRE(flat.probability(i) == doctest::Approx(0.001));
+    }
+
+    // check exception handling
+    bool flag = true;
+    try {
+        AliasTable bad(std::vector<double>(3u, 0.0));  // should throw
+        flag = false;                                   // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        AliasTable bad(std::vector<double>{ 1.0, -1.0 }); // should throw
+        flag = false;                                      // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        AliasTable empty;
+        empty.draw(g);      // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+}
+
+// doctest unit tests for the WeightedDictionary class
+TEST_CASE("testing WeightedDictionary") {
+    std::istringstream in("\xEF\xBB\xBF"
+        "the\t60\r\nof\t30\r\n\r\nzymurgy\t0\r\ncat\t10");
+    WeightedDictionary dict(246u);
+    CHECK(dict.load(in) == 4u);
+    CHECK(dict.size() == 4u);
+    CHECK(dict[0] == "the");
+    CHECK(dict[2] == "zymurgy");
+    CHECK(dict.weight(3) == 10.0);
+
+    // words come up by weight
+    std::vector<std::string_view> out(10000u);
+    dict.sampleN(out.data(), out.size());
+    size_t the = 0u, cat = 0u;
+    for(std::string_view w : out) {
+        REQUIRE(w != "zymurgy");
+        the += w == "the";
+        cat += w == "cat";
+    }
+    CHECK(the > 5800u);
+    CHECK(the < 6200u);
+    CHECK(cat > 900u);
+    CHECK(cat < 1100u);
+
+    // a generator of the caller's gives the same words as the same seed
+    WeightedDictionary same(246u);
+    same.add("the", 60.0);
+    same.add("of", 30.0);
+    same.add("zymurgy", 0.0);
+    same.add("cat", 10.0);
+    same.build();
+    Xoshiro256ss g(246u);
+    std::vector<std::string_view> again(10000u);
+    same.sampleN(g, again.data(), again.size());
+    CHECK(again == out);
+
+    // the footprint adds up
+    SamplerFootprint fp = dict.footprint();
+    CHECK(fp.words == 4u);
+    CHECK(fp.tableBytes == 32u);
+    CHECK(fp.total() == fp.textBytes + fp.indexBytes + fp.weightBytes + 32u);
+    CHECK(fp.bytesPerWord() > 8.0);
+
+    // check exception handling
+    bool flag = true;
+    try {
+        same.add("new", 1.0);
+        same.getRandom();   // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    const char *BAD[] = { "word 1\n", "\t1\n", "word\t\n", "word\t-2\n",
+        "word\t1x\n", "ok\t1\nword\tnan\n", "ok\t0\nnone\t0\n" };
+    for(const char *text : BAD) {
+        std::istringstream bad(text);
+        WeightedDictionary wd(246u);
+        flag = true;
+        try {
+            wd.load(bad);   // should throw an exception
+            flag = false;   // should never happen
+        } catch(std::invalid_argument ia) {
+            CHECK(flag);
+        }
+        CHECK(wd.size() == 0u);
+    }
+
+    // a rejected block leaves the words loaded before it, and their table
+    std::istringstream good("a\t1\nb\t3\n"), bad("ok\t1\nword\tnan\n");
+    WeightedDictionary kept(246u);
+    CHECK(kept.load(good) == 2u);
+    flag = true;
+    try {
+        kept.load(bad);     // should throw an exception
+        flag = false;       // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+    REQUIRE(kept.size() == 2u);
+    CHECK(kept[1] == "b");
+    CHECK(kept.getRandom().size() == 1u);
+}
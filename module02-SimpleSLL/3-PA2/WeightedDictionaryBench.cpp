@@ -0,0 +1,106 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "WeightedDictionary.hpp"
+
+/**
+ * Helper function to time f(), which draws words words, and print the speed.
+ */
+template <class F>
+void report(const char *name, size_t words, F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << name << words / d.count() / 1e6 << " million words/s"
+        << std::endl;
+}
+
+/**
+ * @brief Benchmark for WeightedDictionary.
+ *
+ * This program writes a word list of a given size, two million words by
+ * default, with Zipf weights, as a word-tab-weight file, loads it, and
+ * reports the time to load and build, the memory used, and the speed of
+ * drawing words, and indices from the alias table alone, one at a time and
+ * in batches.
+ *
+ * Usage: WeightedDictionaryBench [words]
+ */
+int main(int argc, char *argv[]) {
+    using namespace std;
+
+    size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000000u;
+    const char *FILE_NAME = "WeightedDictionaryBench.tsv";
+    {
+        ofstream out(FILE_NAME, ios::binary);
+        string text;
+        for(size_t i = 0u; i < n; i++) {
+            text += "word" + to_string(i) + '\t' + to_string(1.0 / (i + 1u)) +
+                '\n';
+        }
+        out << text;
+    }
+
+    auto start = chrono::steady_clock::now();
+    WeightedDictionary dict(246u);
+    ifstream in(FILE_NAME, ios::binary);
+    dict.load(in);
+    chrono::duration<double> d = chrono::steady_clock::now() - start;
+    cout << "loaded and built " << dict.size() << " words in " << d.count()
+        << " s" << endl;
+    start = chrono::steady_clock::now();
+    dict.build();
+    d = chrono::steady_clock::now() - start;
+    cout << "alias table alone built in " << d.count() << " s" << endl;
+    remove(FILE_NAME);
+
+    SamplerFootprint fp = dict.footprint();
+    cout << "memory: " << fp.total() / 1e6 << " MB, " << fp.bytesPerWord()
+        << " bytes/word (text " << fp.textBytes / 1e6 << " MB, index "
+        << fp.indexBytes / 1e6 << " MB, weights " << fp.weightBytes / 1e6
+        << " MB, table " << fp.tableBytes / 1e6 << " MB)" << endl;
+
+    const size_t MANY = 20000000u;
+    size_t sink = 0u;
+    cout << "random words:" << endl;
+    report("getRandom       ", MANY, [&]() {
+        for(size_t i = 0u; i < MANY; i++) {
+            sink += dict.getRandom().size();
+        }
+    });
+    vector<string_view> out(1024u);
+    report("sampleN         ", MANY, [&]() {
+        for(size_t i = 0u; i < MANY; i += out.size()) {
+            dict.sampleN(out.data(), out.size());
+            sink += out[0].size();
+        }
+    });
+
+    // the alias table alone, without looking up the words
+    vector<double> weights(n);
+    for(size_t i = 0u; i < n; i++) {
+        weights[i] = 1.0 / (i + 1u);
+    }
+    AliasTable table(weights);
+    Xoshiro256ss g(246u);
+    vector<uint32_t> idx(1024u);
+    cout << "random indices:" << endl;
+    report("draw            ", MANY, [&]() {
+        for(size_t i = 0u; i < MANY; i++) {
+            sink += table.draw(g);
+        }
+    });
+    report("drawN           ", MANY, [&]() {
+        for(size_t i = 0u; i < MANY; i += idx.size()) {
+            table.drawN(g, idx.data(), idx.size());
+            sink += idx[0];
+        }
+    });
+    cout << "(" << sink << ")" << endl;
+    return EXIT_SUCCESS;
+}
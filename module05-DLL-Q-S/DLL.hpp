@@ -282,6 +282,19 @@ public:
      */
     T getLast() const;
 
+    /**
+     * @brief Insert a value before an element.
+     *
+     * Add a value in front of the node an Iterator is positioned on, or at
+     * the back of the list if the Iterator is end(). Unlike index-based
+     * operations, this takes constant time, so a sorted list can be kept
+     * by walking to the insertion point with an Iterator.
+     *
+     * @param it Iterator positioned on a node of this list, or end().
+     * @param d Value to add to the list.
+     */
+    void insertBefore(Iterator it, const T &d);
+
     /**
      * @brief Determine if the list is empty.
      *
@@ -952,6 +965,58 @@ TEST_CASE("testing DLL<T>::getLast") {
     }
 }
 
+/*
+ * Insert a node in front of the iterator position.
+ */
+template <class T>
+void DLL<T>::insertBefore(Iterator it, const T &d) {
+    Node *pNext = it.pCurr;
+    if(pNext == 0) {
+        // end of the list case
+        addLast(d);
+    } else if(pNext == pHead) {
+        // front of the list case
+        addFirst(d);
+    } else {
+        // middle of the list case
+        Node *pN = new Node(d, pNext->pPrev, pNext);
+        pNext->pPrev->pNext = pN;
+        pNext->pPrev = pN;
+        n++;
+    }
+}
+
+// doctest unit test for insertBefore
+TEST_CASE("testing DLL<T>::insertBefore") {
+    DLL<int> list;
+
+    // at the end, in an empty list
+    list.insertBefore(list.end(), 2);
+    CHECK(list.size() == 1u);
+    CHECK(list.getFirst() == 2);
+
+    // at the front, the back, and in the middle
+    list.insertBefore(list.front(), 0);
+    list.insertBefore(list.end(), 4);
+    DLL<int>::Iterator it = list.back();
+    list.insertBefore(it, 3);
+    it = list.front();
+    ++it;
+    list.insertBefore(it, 1);
+    CHECK(list.size() == 5u);
+    for(int i = 0; i < 5; i++) {
+        CHECK(list.get(i) == i);
+    }
+
+    // the links are right in both directions
+    it = list.back();
+    for(int i = 4; i >= 0; i--) {
+        CHECK(*it == i);
+        --it;
+    }
+    CHECK(it == list.end());
+}
+
 /*
  * Remove node at location idx. 
  */
@@ -1360,4 +1425,4 @@ TEST_CASE("testing DLL<T> stream insertion") {
 
     // did the output match?
     CHECK(oss.str() == "[4, 3, 2, 1, 0]");
-}
\ No newline at end of file
+}
\ No newline at end of file
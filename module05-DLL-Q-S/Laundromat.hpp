@@ -0,0 +1,698 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <doctest.h>
+#include "Laundry.h"
+#include "PriorityQueue.hpp"
+#include "Rng.hpp"
+
+/*-----------------------------------------------------------------------------
+ * event list
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Kinds of simulation events.
+ *
+ * Events at the same time are handled in this order, so a dryer freed at
+ * the same moment a wash finishes is available to it.
+ */
+enum EventKind {
+    EVENT_DRY_DONE,
+    EVENT_WASH_DONE
+};
+
+/**
+ * @brief One pending simulation event: a machine finishing a load.
+ *
+ * The finish time and the kind share one 64-bit sort key. A non-negative
+ * double has a zero sign bit, and its remaining bits order the same way as
+ * the numbers they represent, so shifting them left one place and putting
+ * the kind in the lowest bit gives a key that orders events by time, then
+ * by kind, with one integer comparison.
+ */
+struct Event {
+    /** Sort key: finish time bits and kind. */
+    uint64_t key;
+
+    /** Time at which the load arrived, in minutes. */
+    double arrival;
+
+    /** Drying time of the load, in minutes. */
+    float dryTime;
+
+    /**
+     * @brief Make an event.
+     *
+     * @param time Time at which the machine finishes, in minutes; must not
+     * be negative.
+     * @param kind What finishes: EVENT_DRY_DONE or EVENT_WASH_DONE.
+     * @param arrival Time at which the load arrived, in minutes.
+     * @param dryTime Drying time of the load, in minutes.
+     *
+     * @return The event.
+     */
+    static Event make(double time, unsigned kind, double arrival,
+        float dryTime) {
+        uint64_t bits;
+        std::memcpy(&bits, &time, sizeof(bits));
+        Event e = { (bits << 1) | kind, arrival, dryTime };
+        return e;
+    }
+
+    /**
+     * @brief Get the finish time.
+     *
+     * @return Time at which the machine finishes, in minutes.
+     */
+    double time() const {
+        uint64_t bits = key >> 1;
+        double t;
+        std::memcpy(&t, &bits, sizeof(t));
+        return t;
+    }
+
+    /**
+     * @brief Get the kind.
+     *
+     * @return EVENT_DRY_DONE or EVENT_WASH_DONE.
+     */
+    unsigned kind() const { return unsigned(key & 1u); }
+
+    /**
+     * @brief Event order: earlier times first, then by kind.
+     */
+    bool operator<(const Event &other) const { return key < other.key; }
+};
+
+/**
+ * @brief CMP 246 Module 5 event list for the laundromat simulation.
+ *
+ * The pending events are kept in a PriorityQueue, so top() is always the
+ * earliest event, and replaceTop() handles a machine that finishes one
+ * load and starts the next with a single pass down the heap. The heap is
+ * binary: only about one event per machine is pending at once, so the heap
+ * is shallow either way, and two children take the fewest compares per
+ * level.
+ */
+typedef PriorityQueue<Event, std::less<Event>, 2> EventList;
+
+// doctest unit tests for the event list
+TEST_CASE("testing EventList") {
+    EventList events;
+    CHECK(events.empty());
+
+    // events come out in time order, whatever order they went in
+    Xoshiro256ss prng(246u);
+    for(int i = 0; i < 1000; i++) {
+        Event e = Event::make(double(uniformBelow(prng, 100u)),
+            unsigned(uniformBelow(prng, 2u)), 0.0, 0.0f);
+        events.push(e);
+    }
+    CHECK(events.size() == 1000u);
+    Event prev = events.top();
+    events.pop();
+    for(int i = 1; i < 500; i++) {
+        CHECK(!(events.top() < prev));
+        prev = events.top();
+        events.pop();
+    }
+    CHECK(events.size() == 500u);
+
+    // replacing the top with a later event keeps the order
+    for(int i = 0; i < 100; i++) {
+        const Event &top = events.top();
+        events.replaceTop(Event::make(top.time() + 1000.0, top.kind(), 0.0,
+            0.0f));
+    }
+    prev = events.top();
+    events.pop();
+    while(!events.empty()) {
+        CHECK(!(events.top() < prev));
+        prev = events.top();
+        events.pop();
+    }
+    CHECK(prev.time() >= 1000.0);
+}
+
+/*-----------------------------------------------------------------------------
+ * load sources
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief CMP 246 Module 5 source of randomly arriving loads.
+ *
+ * Loads arrive as a Poisson process, so the times between arrivals are
+ * independent and exponentially distributed. Each load's mass is uniform
+ * between 1 and 10 kg; it washes for 20 minutes plus 2.5 minutes per kg,
+ * and dries for 30 minutes plus 4 minutes per kg.
+ */
+class PoissonLoads {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * @param arrivalsPerHour Average number of loads arriving per hour.
+     * @param count Number of loads to generate.
+     * @param seed Seed for the random numbers.
+     */
+    PoissonLoads(double arrivalsPerHour, uint64_t count, uint64_t seed) :
+        meanGap(60.0 / arrivalsPerHour), remaining(count), clock(0.0),
+        prng(seed) { }
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * @param arrivalsPerHour Average number of loads arriving per hour.
+     * @param count Number of loads to generate.
+     * @param stream Generator to draw the random numbers from, such as one
+     * made with Xoshiro256ss::split().
+     */
+    PoissonLoads(double arrivalsPerHour, uint64_t count,
+        const Xoshiro256ss &stream) : meanGap(60.0 / arrivalsPerHour),
+        remaining(count), clock(0.0), prng(stream) { }
+
+    /**
+     * @brief Generate the next load.
+     *
+     * @param time Set to the arrival time of the load, in minutes.
+     * @param load Set to the load.
+     *
+     * @return false if all the loads have been generated.
+     */
+    bool next(double &time, Laundry &load) {
+        if(remaining == 0u) {
+            return false;
+        }
+        remaining--;
+        uint64_t bits = prng();
+        clock -= meanGap * std::log(1.0 - unitReal<double>(bits));
+        float mass = 1.0f + 9.0f * unitReal<float>(prng());
+        time = clock;
+        load = Laundry(mass, 20.0f + 2.5f * mass, 30.0f + 4.0f * mass);
+        return true;
+    }
+
+private:
+    /**
+     * Average time between arrivals, in minutes.
+     */
+    double meanGap;
+
+    /**
+     * Number of loads still to generate.
+     */
+    uint64_t remaining;
+
+    /**
+     * Arrival time of the last load generated.
+     */
+    double clock;
+
+    /**
+     * Random number generator.
+     */
+    Xoshiro256ss prng;
+};
+
+/**
+ * @brief CMP 246 Module 5 source of loads arriving at given times.
+ */
+class ScheduledLoads {
+public:
+    /**
+     * @brief Add a load to the schedule. Loads must be added in order of
+     * arrival.
+     *
+     * @param time Arrival time of the load, in minutes.
+     * @param load The load.
+     */
+    void add(double time, const Laundry &load) {
+        loads.push_back(std::make_pair(time, load));
+    }
+
+    /**
+     * @brief Get the next load.
+     *
+     * @param time Set to the arrival time of the load, in minutes.
+     * @param load Set to the load.
+     *
+     * @return false if all the loads have been delivered.
+     */
+    bool next(double &time, Laundry &load) {
+        if(pos == loads.size()) {
+            return false;
+        }
+        time = loads[pos].first;
+        load = loads[pos].second;
+        pos++;
+        return true;
+    }
+
+private:
+    /**
+     * The loads, in order of arrival.
+     */
+    std::vector<std::pair<double, Laundry> > loads;
+
+    /**
+     * Index of the next load to deliver.
+     */
+    size_t pos = 0u;
+};
+
+/*-----------------------------------------------------------------------------
+ * scheduling policies
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Orders in which waiting loads get a washer.
+ *
+ * Serving short jobs first lowers the mean wait, at the price of longer
+ * waits for long jobs. Loads that tie under a policy are served first come,
+ * first served.
+ */
+enum QueuePolicy {
+    POLICY_FIRST_COME,
+    POLICY_LIGHTEST,
+    POLICY_SHORTEST_WASH,
+    POLICY_SHORTEST_TOTAL
+};
+
+/**
+ * @brief A load waiting for a washer.
+ */
+struct WaitingLoad {
+    /** Time at which the load arrived, in minutes. */
+    double arrival;
+
+    /** The load. */
+    Laundry load;
+};
+
+/**
+ * @brief Load order for POLICY_LIGHTEST, by Laundry's own operator<.
+ */
+struct LightestFirst {
+    bool operator()(const Laundry &a, const Laundry &b) const {
+        return a < b;
+    }
+};
+
+/**
+ * @brief Load order for POLICY_SHORTEST_WASH.
+ */
+struct ShortestWashFirst {
+    bool operator()(const Laundry &a, const Laundry &b) const {
+        return a.getWashTime() < b.getWashTime();
+    }
+};
+
+/**
+ * @brief Load order for POLICY_SHORTEST_TOTAL: washing plus drying time.
+ */
+struct ShortestTotalFirst {
+    bool operator()(const Laundry &a, const Laundry &b) const {
+        return a.getWashTime() + a.getDryTime() <
+            b.getWashTime() + b.getDryTime();
+    }
+};
+
+/**
+ * @brief Order of waiting loads: by a load order, then by arrival.
+ *
+ * @tparam P Load order, such as ShortestWashFirst.
+ */
+template <class P> struct WaitingOrder {
+    bool operator()(const WaitingLoad &a, const WaitingLoad &b) const {
+        P before;
+        return before(a.load, b.load) ||
+            (!before(b.load, a.load) && a.arrival < b.arrival);
+    }
+};
+
+/**
+ * @brief CMP 246 Module 5 first come, first served queue of waiting loads.
+ *
+ * A plain FIFO queue with the interface of PriorityQueue, so the simulation
+ * can take either; for first come, first served a FIFO queue is all that is
+ * needed, and each operation takes constant time.
+ */
+class FirstComeQueue {
+public:
+    bool empty() const { return loads.empty(); }
+    void pop() { loads.pop_front(); }
+    void push(const WaitingLoad &w) { loads.push_back(w); }
+    size_t size() const { return loads.size(); }
+    const WaitingLoad &top() const { return loads.front(); }
+
+private:
+    /**
+     * The loads, in order of arrival.
+     */
+    std::deque<WaitingLoad> loads;
+};
+
+/*-----------------------------------------------------------------------------
+ * simulation
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Results of one laundromat simulation. Times are in minutes.
+ */
+struct LaundromatStats {
+    /** Number of loads washed and dried. */
+    uint64_t loads;
+
+    /** Time at which the last load finished drying. */
+    double endTime;
+
+    /** Fraction of washer time spent washing, up to endTime. */
+    double washerUtilization;
+
+    /** Fraction of dryer time spent drying, up to endTime. */
+    double dryerUtilization;
+
+    /** Mean time from arrival until a washer is free. */
+    double meanWashWait;
+
+    /** Longest time from arrival until a washer is free. */
+    double maxWashWait;
+
+    /** Mean time from the end of washing until a dryer is free. */
+    double meanDryWait;
+
+    /** Longest time from the end of washing until a dryer is free. */
+    double maxDryWait;
+
+    /** Mean time from arrival until the end of drying. */
+    double meanTimeInSystem;
+
+    /** Most loads ever waiting for a washer. */
+    size_t maxWashQueue;
+
+    /** Most loads ever waiting for a dryer. */
+    size_t maxDryQueue;
+
+    /** Wall-clock time taken by the simulation, in seconds. */
+    double seconds;
+
+    /**
+     * @brief Simulation speed.
+     *
+     * @return Loads simulated per second of wall-clock time.
+     */
+    double loadsPerSecond() const { return loads / seconds; }
+};
+
+/**
+ * @brief Simulate a laundromat.
+ *
+ * Loads arrive from source and queue, in the order given by policy, for one
+ * of the washers; each washed load then queues, first come first served,
+ * for one of the dryers. The machines finishing loads are kept in an
+ * EventList. Only the next arrival is drawn from the source at any time,
+ * and it is compared with the earliest event rather than added to the list,
+ * so the list never holds more than washers + dryers events and the memory
+ * used does not grow with the number of loads, only with the queues.
+ *
+ * @param washers Number of washers.
+ * @param dryers Number of dryers.
+ * @param source Source of loads, with a method bool next(double &time,
+ * Laundry &load) that delivers the loads in order of arrival.
+ * @param policy Order in which waiting loads get a washer.
+ *
+ * @throws std::invalid_argument if there are no washers or no dryers.
+ *
+ * @return Utilization and waiting time statistics.
+ */
+template <class Source>
+LaundromatStats simulateLaundromat(unsigned washers, unsigned dryers,
+    Source &source, QueuePolicy policy = POLICY_FIRST_COME);
+
+/**
+ * @brief Simulate a laundromat with a given queue for the washers.
+ *
+ * Like simulateLaundromat(), with the waiting loads kept in washQueue,
+ * which may be any empty queue of WaitingLoad with the interface of
+ * PriorityQueue, such as PriorityQueue<WaitingLoad, WaitingOrder<P> >.
+ *
+ * @param washers Number of washers.
+ * @param dryers Number of dryers.
+ * @param source Source of loads.
+ * @param washQueue Empty queue for loads waiting for a washer.
+ *
+ * @throws std::invalid_argument if there are no washers or no dryers.
+ *
+ * @return Utilization and waiting time statistics.
+ */
+template <class Source, class Queue>
+LaundromatStats simulateWithQueue(unsigned washers, unsigned dryers,
+    Source &source, Queue &washQueue);
+
+/**
+ * Helper struct for a washed load waiting for a dryer.
+ */
+struct WashedLoad {
+    /** Time at which the load arrived. */
+    double arrival;
+
+    /** Time at which the load finished washing. */
+    double ready;
+
+    /** Drying time of the load. */
+    float dryTime;
+};
+
+/*
+ * Alternate between the next arrival and the earliest machine event.
+ */
+template <class Source, class Queue>
+LaundromatStats simulateWithQueue(unsigned washers, unsigned dryers,
+    Source &source, Queue &washQueue) {
+    if(washers == 0u || dryers == 0u) {
+        throw std::invalid_argument(
+            "need a washer and a dryer in simulateLaundromat()");
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    LaundromatStats stats = { };
+    EventList events;
+    std::deque<WashedLoad> dryQueue;
+    unsigned freeWashers = washers, freeDryers = dryers;
+    double washBusy = 0.0, dryBusy = 0.0;
+    double washWaits = 0.0, dryWaits = 0.0, timeInSystem = 0.0;
+    double now = 0.0;
+
+    double arrival = 0.0;
+    Laundry load;
+    bool more = source.next(arrival, load);
+    while(more || !events.empty()) {
+        if(more && (events.empty() || arrival < events.top().time())) {
+            // a load arrives, and washes now or waits
+            now = arrival;
+            if(freeWashers > 0u) {
+                freeWashers--;
+                events.push(Event::make(now + load.getWashTime(),
+                    EVENT_WASH_DONE, now, load.getDryTime()));
+                washBusy += load.getWashTime();
+            } else {
+                WaitingLoad w = { now, load };
+                washQueue.push(w);
+                if(washQueue.size() > stats.maxWashQueue) {
+                    stats.maxWashQueue = washQueue.size();
+                }
+            }
+            more = source.next(arrival, load);
+            continue;
+        }
+
+        Event e = events.top();
+        now = e.time();
+        bool replaced = false;
+        if(e.kind() == EVENT_WASH_DONE) {
+            // the load dries now or waits
+            if(freeDryers > 0u) {
+                freeDryers--;
+                events.replaceTop(Event::make(now + e.dryTime, EVENT_DRY_DONE,
+                    e.arrival, e.dryTime));
+                replaced = true;
+                dryBusy += e.dryTime;
+            } else {
+                WashedLoad w = { e.arrival, now, e.dryTime };
+                dryQueue.push_back(w);
+                if(dryQueue.size() > stats.maxDryQueue) {
+                    stats.maxDryQueue = dryQueue.size();
+                }
+            }
+
+            // the washer takes the next waiting load, if any
+            if(washQueue.empty()) {
+                freeWashers++;
+            } else {
+                const WaitingLoad &next = washQueue.top();
+                double wait = now - next.arrival;
+                washWaits += wait;
+                stats.maxWashWait = wait > stats.maxWashWait ?
+                    wait : stats.maxWashWait;
+                Event w = Event::make(now + next.load.getWashTime(),
+                    EVENT_WASH_DONE, next.arrival, next.load.getDryTime());
+                washBusy += next.load.getWashTime();
+                washQueue.pop();
+                if(replaced) {
+                    events.push(w);
+                } else {
+                    events.replaceTop(w);
+                    replaced = true;
+                }
+            }
+        } else {
+            // the load is done, and the dryer takes the next waiting load
+            stats.loads++;
+            timeInSystem += now - e.arrival;
+            if(dryQueue.empty()) {
+                freeDryers++;
+            } else {
+                const WashedLoad &next = dryQueue.front();
+                double wait = now - next.ready;
+                dryWaits += wait;
+                stats.maxDryWait = wait > stats.maxDryWait ?
+                    wait : stats.maxDryWait;
+                Event d = Event::make(now + next.dryTime, EVENT_DRY_DONE,
+                    next.arrival, next.dryTime);
+                dryBusy += next.dryTime;
+                dryQueue.pop_front();
+                events.replaceTop(d);
+                replaced = true;
+            }
+        }
+        if(!replaced) {
+            events.pop();
+        }
+    }
+
+    // loads that never waited count as waits of zero
+    stats.endTime = now;
+    if(stats.loads > 0u) {
+        stats.washerUtilization = washBusy / (washers * now);
+        stats.dryerUtilization = dryBusy / (dryers * now);
+        stats.meanWashWait = washWaits / stats.loads;
+        stats.meanDryWait = dryWaits / stats.loads;
+        stats.meanTimeInSystem = timeInSystem / stats.loads;
+    }
+    auto stop = std::chrono::steady_clock::now();
+    stats.seconds = std::chrono::duration<double>(stop - start).count();
+    return stats;
+}
+
+/*
+ * Pick the queue for the policy.
+ */
+template <class Source>
+LaundromatStats simulateLaundromat(unsigned washers, unsigned dryers,
+    Source &source, QueuePolicy policy) {
+    switch(policy) {
+    case POLICY_LIGHTEST: {
+        PriorityQueue<WaitingLoad, WaitingOrder<LightestFirst> > queue;
+        return simulateWithQueue(washers, dryers, source, queue);
+    }
+    case POLICY_SHORTEST_WASH: {
+        PriorityQueue<WaitingLoad, WaitingOrder<ShortestWashFirst> > queue;
+        return simulateWithQueue(washers, dryers, source, queue);
+    }
+    case POLICY_SHORTEST_TOTAL: {
+        PriorityQueue<WaitingLoad, WaitingOrder<ShortestTotalFirst> > queue;
+        return simulateWithQueue(washers, dryers, source, queue);
+    }
+    default: {
+        FirstComeQueue queue;
+        return simulateWithQueue(washers, dryers, source, queue);
+    }
+    }
+}
+
+// doctest unit tests for the simulation
+TEST_CASE("testing simulateLaundromat") {
+    // three loads worked out by hand: one washer and one dryer, and the
+    // dryer frees up at 30 just as the third load finishes washing
+    ScheduledLoads loads;
+    loads.add(0.0, Laundry(5.0f, 10.0f, 20.0f));
+    loads.add(0.0, Laundry(5.0f, 10.0f, 20.0f));
+    loads.add(5.0, Laundry(5.0f, 10.0f, 5.0f));
+    LaundromatStats stats = simulateLaundromat(1u, 1u, loads);
+    CHECK(stats.loads == 3u);
+    CHECK(stats.endTime == 55.0);
+    CHECK(stats.washerUtilization == doctest::Approx(30.0 / 55.0));
+    CHECK(stats.dryerUtilization == doctest::Approx(45.0 / 55.0));
+    CHECK(stats.meanWashWait == doctest::Approx(25.0 / 3.0));
+    CHECK(stats.maxWashWait == 15.0);
+    CHECK(stats.meanDryWait == doctest::Approx(10.0));
+    CHECK(stats.maxDryWait == 20.0);
+    CHECK(stats.meanTimeInSystem == doctest::Approx(130.0 / 3.0));
+    CHECK(stats.maxWashQueue == 2u);
+    CHECK(stats.maxDryQueue == 1u);
+
+    // with plenty of machines nobody waits, and the utilization is the
+    // offered load: 6 loads per hour, each washing for 33.75 minutes on
+    // average, spread over 20 washers
+    PoissonLoads random(6.0, 200000u, 246u);
+    stats = simulateLaundromat(20u, 30u, random);
+    CHECK(stats.loads == 200000u);
+    CHECK(stats.maxWashWait == 0.0);
+    CHECK(stats.maxDryWait == 0.0);
+    CHECK(stats.washerUtilization ==
+        doctest::Approx(6.0 * 33.75 / 60.0 / 20.0).epsilon(0.01));
+    CHECK(stats.meanTimeInSystem == doctest::Approx(33.75 + 52.0)
+        .epsilon(0.01));
+
+    // a laundromat needs machines
+    bool flag = true;
+    try {
+        simulateLaundromat(0u, 1u, loads);  // should throw an exception
+        flag = false;                       // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+}
+
+TEST_CASE("testing simulateLaundromat queue policies") {
+    // three loads, one washer: the second and third wait for the first, and
+    // the policy decides which of them goes next
+    ScheduledLoads loads[4];
+    for(int p = 0; p < 4; p++) {
+        loads[p].add(0.0, Laundry(5.0f, 30.0f, 10.0f));
+        loads[p].add(1.0, Laundry(9.0f, 10.0f, 10.0f));
+        loads[p].add(2.0, Laundry(1.0f, 20.0f, 40.0f));
+    }
+
+    // first come: waits of 0, 29, and 38
+    LaundromatStats stats = simulateLaundromat(1u, 1u, loads[0]);
+    CHECK(stats.meanWashWait == doctest::Approx(67.0 / 3.0));
+    CHECK(stats.maxWashWait == 38.0);
+
+    // lightest first: the third load goes before the second, for waits of
+    // 0, 49, and 28
+    stats = simulateLaundromat(1u, 1u, loads[1], POLICY_LIGHTEST);
+    CHECK(stats.meanWashWait == doctest::Approx(77.0 / 3.0));
+    CHECK(stats.maxWashWait == 49.0);
+
+    // the second load has both the shortest wash and the shortest total
+    stats = simulateLaundromat(1u, 1u, loads[2], POLICY_SHORTEST_WASH);
+    CHECK(stats.meanWashWait == doctest::Approx(67.0 / 3.0));
+    stats = simulateLaundromat(1u, 1u, loads[3], POLICY_SHORTEST_TOTAL);
+    CHECK(stats.meanWashWait == doctest::Approx(67.0 / 3.0));
+
+    // on a busy laundromat, shortest wash first cuts the mean wash wait
+    PoissonLoads fifo(36.0, 100000u, 246u), sjf(36.0, 100000u, 246u);
+    LaundromatStats a = simulateLaundromat(21u, 40u, fifo);
+    LaundromatStats b = simulateLaundromat(21u, 40u, sjf, POLICY_SHORTEST_WASH);
+    CHECK(b.loads == a.loads);
+    CHECK(b.meanWashWait < a.meanWashWait);
+    CHECK(b.maxWashWait > a.maxWashWait);
+}
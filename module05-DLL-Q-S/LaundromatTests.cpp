@@ -0,0 +1,4 @@
+// phantom C++ file for Laundromat unit testing. This file only includes the
+// Laundromat header; doctest generates the testing program based on unit
+// tests written alongside the code in the header file
+#include "Laundromat.hpp"
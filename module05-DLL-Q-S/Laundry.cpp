@@ -2,31 +2,12 @@
 
 #include <cstdio>
 
-bool Laundry::operator<(const Laundry &other) {
-    return mass < other.mass;
-}
-
-bool Laundry::operator<=(const Laundry &other) {
-    return mass <= other.mass;
-}
-
-bool Laundry::operator==(const Laundry &other) {
-    return mass == other.mass;
-}
-
-bool Laundry::operator>=(const Laundry &other) {
-    return mass >= other.mass;
-}
-
-bool Laundry::operator>(const Laundry &other) {
-    return mass > other.mass;
-}
-
 std::ostream &operator<<(std::ostream &out, const Laundry &laundry) {
-    char str[17];
-    sprintf(str, "(%.2f/%.2f/%.2f)", laundry.getMass(), 
+    // "%.2f" of the largest float takes 42 characters, and a sign 1 more
+    char str[3 * 43 + 5];
+    snprintf(str, sizeof(str), "(%.2f/%.2f/%.2f)", laundry.getMass(),
         laundry.getWashTime(), laundry.getDryTime());
     out << str;
 
     return out;
-}
\ No newline at end of file
+}
\ No newline at end of file
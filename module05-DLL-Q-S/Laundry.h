@@ -9,15 +9,15 @@ public:
     float getMass() const { return mass; }
     float getWashTime() const { return washTime; }
     float getDryTime() const { return dryTime; }
-    bool operator<(const Laundry& other);
-    bool operator<=(const Laundry& other);
-    bool operator==(const Laundry& other);
-    bool operator>=(const Laundry& other);
-    bool operator>(const Laundry& other);
+    bool operator<(const Laundry& other) const { return mass < other.mass; }
+    bool operator<=(const Laundry& other) const { return mass <= other.mass; }
+    bool operator==(const Laundry& other) const { return mass == other.mass; }
+    bool operator>=(const Laundry& other) const { return mass >= other.mass; }
+    bool operator>(const Laundry& other) const { return mass > other.mass; }
 private:
     float mass;
     float washTime;
     float dryTime;
 };
 
-std::ostream &operator<<(std::ostream &out, const Laundry& laundry);
\ No newline at end of file
+std::ostream &operator<<(std::ostream &out, const Laundry& laundry);
\ No newline at end of file
@@ -0,0 +1,1108 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <doctest.h>
+#include "Laundry.h"
+
+/*-----------------------------------------------------------------------------
+ * number formatting and parsing
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Maximum number of characters formatFixed() writes for one number.
+ */
+const size_t FORMAT_MAX = 32u;
+
+/**
+ * @brief Format a number with a fixed number of decimals, like printf's
+ * "%.*f".
+ *
+ * Numbers below 1e18 once scaled by 10^decimals are converted with integer
+ * arithmetic, rounding halves away from zero, so a number exactly halfway
+ * between two outputs may differ from printf in the last digit. Larger
+ * numbers, infinities and NaNs are formatted by snprintf with "%.*e".
+ * No terminating null character is written.
+ *
+ * @param v Number to format.
+ * @param decimals Number of digits after the decimal point, 0 to 9.
+ * @param pOut Pointer to the output, with room for FORMAT_MAX characters.
+ *
+ * @throws std::invalid_argument if decimals is more than 9.
+ *
+ * @return Pointer one past the last character written.
+ */
+inline char *formatFixed(double v, unsigned decimals, char *pOut) {
+    static const double POW10[10] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+        1e7, 1e8, 1e9 };
+    if(decimals > 9u) {
+        throw std::invalid_argument("too many decimals in formatFixed()");
+    }
+    double scaled = std::fabs(v) * POW10[decimals];
+    if(!(scaled < 1e18)) {
+        return pOut + snprintf(pOut, FORMAT_MAX, "%.*e", int(decimals), v);
+    }
+
+    uint64_t n = uint64_t(scaled + 0.5);
+    char digits[20];
+    unsigned k = 0u;
+    do {
+        digits[k++] = char('0' + n % 10u);
+        n /= 10u;
+    } while(n != 0u || k <= decimals);
+    if(std::signbit(v)) {
+        *pOut++ = '-';
+    }
+    while(k > decimals) {
+        *pOut++ = digits[--k];
+    }
+    if(decimals > 0u) {
+        *pOut++ = '.';
+        while(k > 0u) {
+            *pOut++ = digits[--k];
+        }
+    }
+    return pOut;
+}
+
+/**
+ * @brief Parse a decimal number, such as -12.5 or 3e-2.
+ *
+ * Up to 19 significant digits are used; with at most 15 of them and a
+ * power of ten up to 22, the result is correctly rounded, and otherwise it
+ * is within a few units in the last place. Unlike strtod, the text need
+ * not be null terminated, and the locale is never consulted.
+ *
+ * @param p Pointer to the first character of the number.
+ * @param pEnd Pointer one past the last character that may be read.
+ * @param value Set to the number.
+ *
+ * @return Pointer one past the number, or nullptr if p does not point to a
+ * number.
+ */
+inline const char *parseDecimal(const char *p, const char *pEnd,
+    double &value) {
+    static const double POW10[23] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+        1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+        1e19, 1e20, 1e21, 1e22 };
+    bool negative = false;
+    if(p < pEnd && (*p == '-' || *p == '+')) {
+        negative = *p++ == '-';
+    }
+
+    uint64_t mantissa = 0u;
+    int exponent = 0, digits = 0, significant = 0;
+    for(; p < pEnd && unsigned(*p - '0') < 10u; p++, digits++) {
+        if(significant < 19) {
+            mantissa = mantissa * 10u + unsigned(*p - '0');
+            significant += mantissa != 0u;
+        } else {
+            exponent++;
+        }
+    }
+    if(p < pEnd && *p == '.') {
+        for(p++; p < pEnd && unsigned(*p - '0') < 10u; p++, digits++) {
+            if(significant < 19) {
+                mantissa = mantissa * 10u + unsigned(*p - '0');
+                significant += mantissa != 0u;
+                exponent--;
+            }
+        }
+    }
+    if(digits == 0) {
+        return nullptr;
+    }
+
+    if(p < pEnd && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        bool negExp = false;
+        if(q < pEnd && (*q == '-' || *q == '+')) {
+            negExp = *q++ == '-';
+        }
+        if(q < pEnd && unsigned(*q - '0') < 10u) {
+            int e = 0;
+            for(; q < pEnd && unsigned(*q - '0') < 10u; q++) {
+                e = e < 10000 ? e * 10 + (*q - '0') : e;
+            }
+            exponent += negExp ? -e : e;
+            p = q;
+        }
+    }
+
+    double m = double(mantissa);
+    if(mantissa == 0u) {
+        value = 0.0;
+    } else if(exponent >= 0 && exponent <= 22) {
+        value = m * POW10[exponent];
+    } else if(exponent < 0 && exponent >= -22) {
+        value = m / POW10[-exponent];
+    } else {
+        value = m * std::pow(10.0, exponent);
+    }
+    value = negative ? -value : value;
+    return p;
+}
+
+// doctest unit tests for formatFixed and parseDecimal
+TEST_CASE("testing formatFixed") {
+    char buf[FORMAT_MAX + 1];
+    CHECK(std::string(buf, formatFixed(1.0, 2u, buf)) == "1.00");
+    CHECK(std::string(buf, formatFixed(3.14159, 2u, buf)) == "3.14");
+    CHECK(std::string(buf, formatFixed(2.999, 2u, buf)) == "3.00");
+    CHECK(std::string(buf, formatFixed(-0.05, 1u, buf)) == "-0.1");
+    CHECK(std::string(buf, formatFixed(1234.5678, 4u, buf)) == "1234.5678");
+    CHECK(std::string(buf, formatFixed(0.004, 2u, buf)) == "0.00");
+    CHECK(std::string(buf, formatFixed(7.6, 0u, buf)) == "8");
+
+    // agrees with printf away from halfway cases
+    char ref[FORMAT_MAX];
+    double vals[] = { 0.0, 1.0 / 3.0, 65.4321, 1e6 + 0.17, 99999.994 };
+    for(double v : vals) {
+        snprintf(ref, sizeof(ref), "%.2f", v);
+        CHECK(std::string(buf, formatFixed(v, 2u, buf)) == ref);
+    }
+
+    // huge and strange numbers fall back to snprintf
+    CHECK(std::string(buf, formatFixed(3.4e38, 2u, buf)) == "3.40e+38");
+    CHECK(std::string(buf, formatFixed(-1e300, 9u, buf)).size() < FORMAT_MAX);
+    CHECK(std::string(buf, formatFixed(NAN, 2u, buf)) == "nan");
+
+    // check exception handling
+    bool flag = true;
+    try {
+        formatFixed(1.0, 10u, buf);  // should throw an exception
+        flag = false;                // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+}
+
+TEST_CASE("testing parseDecimal") {
+    double v = -1.0;
+    std::string text = "12.5,-0.25,+3,1e3,2.5E-2,.5,7.";
+    const char *p = text.data(), *pEnd = text.data() + text.size();
+    double expected[] = { 12.5, -0.25, 3.0, 1000.0, 0.025, 0.5, 7.0 };
+    for(double e : expected) {
+        p = parseDecimal(p, pEnd, v);
+        REQUIRE(p != nullptr);
+        CHECK(v == e);
+        p += p < pEnd;
+    }
+    CHECK(p == pEnd);
+
+    // correctly rounded for short numbers, like strtod
+    std::string pi = "3.141592653589793";
+    parseDecimal(pi.data(), pi.data() + pi.size(), v);
+    CHECK(v == strtod(pi.c_str(), nullptr));
+    std::string tiny = "0.000000000000000000000000000001";
+    parseDecimal(tiny.data(), tiny.data() + tiny.size(), v);
+    CHECK(v == doctest::Approx(1e-30));
+
+    // the number may end anywhere, and need not be terminated
+    CHECK(parseDecimal(pi.data(), pi.data() + 4, v) == pi.data() + 4);
+    CHECK(v == 3.14);
+
+    // not numbers
+    std::string bad = "-x";
+    CHECK(parseDecimal(bad.data(), bad.data() + bad.size(), v) == nullptr);
+    CHECK(parseDecimal(bad.data(), bad.data(), v) == nullptr);
+    std::string dot = ".e5";
+    CHECK(parseDecimal(dot.data(), dot.data() + dot.size(), v) == nullptr);
+}
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief CMP 246 Module 5 batch of timed laundry loads, stored by column.
+ *
+ * Where an array of Laundry keeps the mass, washing time and drying time
+ * of each load together, a batch keeps all the arrival times in one
+ * array, all the masses in another, and so on, so a loop over one field
+ * of every load reads contiguous memory and vectorizes. The columns are
+ * allocated once, when the batch is made, and a batch is then cleared and
+ * refilled as often as needed, without allocating again.
+ */
+class LaundryBatch {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * @param capacity Maximum number of loads in the batch.
+     */
+    explicit LaundryBatch(size_t capacity = 4096u) : arrivalCol(capacity),
+        massCol(capacity), washCol(capacity), dryCol(capacity), count(0u) { }
+
+    /**
+     * @brief Get batch capacity.
+     *
+     * @return The maximum number of loads in the batch.
+     */
+    size_t capacity() const { return arrivalCol.size(); }
+
+    /**
+     * @brief Get batch size.
+     *
+     * @return The number of loads in the batch.
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @brief Check if the batch is empty.
+     */
+    bool empty() const { return count == 0u; }
+
+    /**
+     * @brief Check if the batch is full.
+     */
+    bool full() const { return count == arrivalCol.size(); }
+
+    /**
+     * @brief Remove every load, keeping the storage.
+     */
+    void clear() { count = 0u; }
+
+    /**
+     * @brief Add a load to the end of the batch.
+     *
+     * @param arrival Arrival time of the load, in minutes.
+     * @param mass Mass of the load.
+     * @param washTime Washing time of the load.
+     * @param dryTime Drying time of the load.
+     *
+     * @throws std::out_of_range if the batch is full.
+     */
+    void push(double arrival, float mass, float washTime, float dryTime) {
+        if(full()) {
+            throw std::out_of_range("Full batch in LaundryBatch::push()");
+        }
+        arrivalCol[count] = arrival;
+        massCol[count] = mass;
+        washCol[count] = washTime;
+        dryCol[count] = dryTime;
+        count++;
+    }
+
+    /**
+     * @brief Add a load to the end of the batch.
+     *
+     * @param arrival Arrival time of the load, in minutes.
+     * @param load The load.
+     *
+     * @throws std::out_of_range if the batch is full.
+     */
+    void push(double arrival, const Laundry &load) {
+        push(arrival, load.getMass(), load.getWashTime(), load.getDryTime());
+    }
+
+    /**
+     * @brief Accessor for one load.
+     *
+     * @param idx Index of the load, less than size(); it is not checked.
+     *
+     * @return The load.
+     */
+    Laundry get(size_t idx) const {
+        return Laundry(massCol[idx], washCol[idx], dryCol[idx]);
+    }
+
+    /**
+     * @brief Accessors for the columns, each with size() elements.
+     */
+    const double *arrivals() const { return arrivalCol.data(); }
+    const float *masses() const { return massCol.data(); }
+    const float *washTimes() const { return washCol.data(); }
+    const float *dryTimes() const { return dryCol.data(); }
+
+private:
+    /**
+     * Arrival times, in minutes.
+     */
+    std::vector<double> arrivalCol;
+
+    /**
+     * Masses.
+     */
+    std::vector<float> massCol;
+
+    /**
+     * Washing times.
+     */
+    std::vector<float> washCol;
+
+    /**
+     * Drying times.
+     */
+    std::vector<float> dryCol;
+
+    /**
+     * Number of loads in the batch.
+     */
+    size_t count;
+};
+
+/**
+ * @brief Maximum number of characters formatBatch() writes for one load.
+ */
+const size_t CSV_RECORD_MAX = 4u * FORMAT_MAX + 4u;
+
+/**
+ * @brief Format loads of a batch as lines of comma separated values.
+ *
+ * Each load becomes a line of its arrival time, with four decimals, and
+ * its mass, washing time and drying time, with two, as in
+ * "12.3456,5.00,32.50,50.00". The whole range is formatted into one
+ * buffer, ready for a single write.
+ *
+ * @param batch Batch holding the loads.
+ * @param first Index of the first load to format.
+ * @param n Number of loads to format.
+ * @param pOut Pointer to the output, with room for n * CSV_RECORD_MAX
+ * characters.
+ *
+ * @throws std::out_of_range if the loads are not all in the batch.
+ *
+ * @return Pointer one past the last character written.
+ */
+inline char *formatBatch(const LaundryBatch &batch, size_t first, size_t n,
+    char *pOut) {
+    if(first > batch.size() || n > batch.size() - first) {
+        throw std::out_of_range("Loads out of range in formatBatch()");
+    }
+    const double *arrivals = batch.arrivals();
+    const float *masses = batch.masses();
+    const float *washTimes = batch.washTimes();
+    const float *dryTimes = batch.dryTimes();
+    for(size_t i = first; i < first + n; i++) {
+        pOut = formatFixed(arrivals[i], 4u, pOut);
+        *pOut++ = ',';
+        pOut = formatFixed(masses[i], 2u, pOut);
+        *pOut++ = ',';
+        pOut = formatFixed(washTimes[i], 2u, pOut);
+        *pOut++ = ',';
+        pOut = formatFixed(dryTimes[i], 2u, pOut);
+        *pOut++ = '\n';
+    }
+    return pOut;
+}
+
+/**
+ * @brief Formats of laundry trace files.
+ *
+ * A CSV trace starts with the line "arrival,mass,wash,dry" and has one
+ * line per load, as written by formatBatch(). A binary trace starts with
+ * the eight bytes of TRACE_MAGIC, followed by 20 bytes per load: the
+ * arrival time as a double, then the mass, washing time and drying time as
+ * floats, in the byte order of the machine that wrote it.
+ */
+enum TraceFormat {
+    TRACE_CSV,
+    TRACE_BINARY
+};
+
+/**
+ * @brief First bytes of a binary trace.
+ */
+const char TRACE_MAGIC[8] = { 'L', 'T', 'R', 'A', 'C', 'E', '1', '\n' };
+
+/**
+ * @brief Size of one load in a binary trace.
+ */
+const size_t TRACE_RECORD_SIZE = sizeof(double) + 3u * sizeof(float);
+
+/**
+ * @brief CMP 246 Module 5 streaming reader for laundry trace files.
+ *
+ * The reader reads a trace a block at a time into a buffer it allocates
+ * once, and parses loads straight from the buffer into a LaundryBatch,
+ * so a trace of any size is read in constant memory, with no allocation
+ * per load. The format is recognized from the start of the file. In CSV
+ * traces, blank lines and lines starting with '#' are skipped, and the
+ * first line may be a header.
+ */
+class TraceReader {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * Open the named trace, and read its first block.
+     *
+     * @param fileName Name of the trace.
+     * @param blockSize Number of bytes to read at a time; no line of a CSV
+     * trace may be longer.
+     *
+     * @throws std::runtime_error if the file cannot be opened or read.
+     */
+    explicit TraceReader(const std::string &fileName,
+        size_t blockSize = 1u << 20);
+
+    /**
+     * @brief Destructor. Close the trace.
+     */
+    ~TraceReader() { ::close(fd); }
+
+    /**
+     * @brief Accessor for the format of the trace.
+     */
+    TraceFormat format() const { return fmt; }
+
+    /**
+     * @brief Read the next loads of the trace.
+     *
+     * Empty the batch, and fill it with the next loads, as many as fit.
+     *
+     * @param batch Batch to fill.
+     *
+     * @throws std::runtime_error if the trace cannot be read, or a record
+     * is malformed; the message gives its line for CSV traces.
+     *
+     * @return Number of loads read, zero at the end of the trace.
+     */
+    size_t next(LaundryBatch &batch);
+
+    /**
+     * @brief Number of loads read so far.
+     */
+    uint64_t records() const { return numRecords; }
+
+    /**
+     * @brief Number of bytes read from the file so far.
+     */
+    uint64_t bytes() const { return numBytes; }
+
+private:
+    // open files can't be copied
+    TraceReader(const TraceReader &);
+    TraceReader &operator=(const TraceReader &);
+
+    /** Move the unread bytes to the front of the buffer and read more. */
+    bool refill();
+
+    /** Read CSV loads into the batch. */
+    void nextCsv(LaundryBatch &batch);
+
+    /** Read binary loads into the batch. */
+    void nextBinary(LaundryBatch &batch);
+
+    /** Name of the trace, for error messages. */
+    std::string name;
+
+    /** File descriptor of the trace. */
+    int fd;
+
+    /** Format of the trace. */
+    TraceFormat fmt;
+
+    /** Block buffer. */
+    std::vector<char> buf;
+
+    /** Index of the first unread byte in the buffer. */
+    size_t pos;
+
+    /** Index one past the last byte in the buffer. */
+    size_t end;
+
+    /** True once the whole file has been read into the buffer. */
+    bool atEof;
+
+    /** Number of CSV lines read so far. */
+    uint64_t line;
+
+    /** Number of loads read so far. */
+    uint64_t numRecords;
+
+    /** Number of bytes read so far. */
+    uint64_t numBytes;
+};
+
+/**
+ * @brief CMP 246 Module 5 buffered writer for laundry trace files.
+ *
+ * Loads are formatted a batch at a time into a buffer, which is written
+ * to the file in large blocks.
+ */
+class TraceWriter {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * Create the named trace, replacing any file of that name, and write
+     * its header.
+     *
+     * @param fileName Name of the trace.
+     * @param format Format of the trace.
+     *
+     * @throws std::runtime_error if the file cannot be created.
+     */
+    TraceWriter(const std::string &fileName, TraceFormat format);
+
+    /**
+     * @brief Destructor. Write what is left in the buffer and close the
+     * trace, ignoring errors; call close() to see them.
+     */
+    ~TraceWriter();
+
+    /**
+     * @brief Write every load of a batch.
+     *
+     * @param batch The loads.
+     *
+     * @throws std::runtime_error if the trace cannot be written.
+     */
+    void write(const LaundryBatch &batch);
+
+    /**
+     * @brief Write what is left in the buffer and close the trace.
+     *
+     * @throws std::runtime_error if the trace cannot be written.
+     */
+    void close();
+
+    /**
+     * @brief Number of bytes written so far, counting the buffer.
+     */
+    uint64_t bytes() const { return numBytes + used; }
+
+private:
+    // open files can't be copied
+    TraceWriter(const TraceWriter &);
+    TraceWriter &operator=(const TraceWriter &);
+
+    /** Write the buffer to the file. */
+    void flush();
+
+    /** Make room for n more bytes in the buffer. */
+    void reserve(size_t n);
+
+    /** Name of the trace, for error messages. */
+    std::string name;
+
+    /** File descriptor of the trace, or -1 once closed. */
+    int fd;
+
+    /** Format of the trace. */
+    TraceFormat fmt;
+
+    /** Output buffer. */
+    std::vector<char> buf;
+
+    /** Number of bytes in the buffer. */
+    size_t used;
+
+    /** Number of bytes written to the file. */
+    uint64_t numBytes;
+};
+
+/**
+ * @brief CMP 246 Module 5 source of loads read from a trace.
+ *
+ * TraceLoads reads a trace a batch at a time and hands out its loads one
+ * by one, in the form simulateLaundromat() takes.
+ */
+class TraceLoads {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * @param reader Reader of the trace; it must outlive this source.
+     * @param batchSize Number of loads to read at a time.
+     */
+    explicit TraceLoads(TraceReader &reader, size_t batchSize = 4096u) :
+        reader(reader), batch(batchSize), pos(0u), clock(0.0) { }
+
+    /**
+     * @brief Get the next load.
+     *
+     * @param time Set to the arrival time of the load, in minutes.
+     * @param load Set to the load.
+     *
+     * @throws std::runtime_error if the trace cannot be read, or its loads
+     * are not in order of arrival.
+     *
+     * @return false if all the loads have been delivered.
+     */
+    bool next(double &time, Laundry &load) {
+        if(pos == batch.size()) {
+            if(reader.next(batch) == 0u) {
+                return false;
+            }
+            pos = 0u;
+        }
+        time = batch.arrivals()[pos];
+        if(time < clock) {
+            throw std::runtime_error("Load out of order in TraceLoads::next()");
+        }
+        clock = time;
+        load = batch.get(pos++);
+        return true;
+    }
+
+private:
+    /**
+     * Reader of the trace.
+     */
+    TraceReader &reader;
+
+    /**
+     * Loads read but not yet delivered.
+     */
+    LaundryBatch batch;
+
+    /**
+     * Index of the next load to deliver.
+     */
+    size_t pos;
+
+    /**
+     * Arrival time of the last load delivered.
+     */
+    double clock;
+};
+
+/*-----------------------------------------------------------------------------
+ * function implementations
+ *---------------------------------------------------------------------------*/
+
+/*
+ * Open the trace and recognize its format from the first block.
+ */
+inline TraceReader::TraceReader(const std::string &fileName,
+    size_t blockSize) : name(fileName), fd(-1), fmt(TRACE_CSV),
+    buf(blockSize < 64u ? 64u : blockSize), pos(0u), end(0u), atEof(false),
+    line(0u), numRecords(0u), numBytes(0u) {
+    fd = open(fileName.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw std::runtime_error("unable to open " + fileName +
+            " in TraceReader::TraceReader()");
+    }
+    try {
+        refill();
+    } catch(...) {
+        ::close(fd);
+        throw;
+    }
+    if(end >= sizeof(TRACE_MAGIC) &&
+        memcmp(buf.data(), TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0) {
+        fmt = TRACE_BINARY;
+        pos = sizeof(TRACE_MAGIC);
+    }
+}
+
+/*
+ * Keep the unread bytes, which are part of one record, and fill the rest
+ * of the buffer.
+ */
+inline bool TraceReader::refill() {
+    if(atEof) {
+        return false;
+    }
+    size_t left = end - pos;
+    memmove(buf.data(), buf.data() + pos, left);
+    pos = 0u;
+    end = left;
+    size_t before = end;
+    while(end < buf.size()) {
+        ssize_t n = read(fd, buf.data() + end, buf.size() - end);
+        if(n < 0) {
+            throw std::runtime_error("unable to read " + name +
+                " in TraceReader::next()");
+        }
+        if(n == 0) {
+            atEof = true;
+            break;
+        }
+        end += size_t(n);
+    }
+    numBytes += end - before;
+    return end > before;
+}
+
+/*
+ * Read a batch in the trace's format.
+ */
+inline size_t TraceReader::next(LaundryBatch &batch) {
+    batch.clear();
+    if(fmt == TRACE_BINARY) {
+        nextBinary(batch);
+    } else {
+        nextCsv(batch);
+    }
+    numRecords += batch.size();
+    return batch.size();
+}
+
+/*
+ * Parse whole lines from the buffer, refilling it when a line is cut off.
+ */
+inline void TraceReader::nextCsv(LaundryBatch &batch) {
+    while(!batch.full()) {
+        const char *pLine = buf.data() + pos, *pBufEnd = buf.data() + end;
+        const char *pEol = static_cast<const char *>(
+            memchr(pLine, '\n', size_t(pBufEnd - pLine)));
+        if(pEol == nullptr && !atEof) {
+            if(pos == 0u && end == buf.size()) {
+                throw std::runtime_error("line " + std::to_string(line + 1u) +
+                    " too long in " + name + " in TraceReader::next()");
+            }
+            refill();
+            continue;
+        }
+        if(pLine == pBufEnd) {
+            return;
+        }
+        const char *pNext = pEol != nullptr ? pEol + 1 : pBufEnd;
+        const char *pLineEnd = pEol != nullptr ? pEol : pBufEnd;
+        pos = size_t(pNext - buf.data());
+        line++;
+
+        while(pLine < pLineEnd && (*pLine == ' ' || *pLine == '\t')) {
+            pLine++;
+        }
+        if(pLine == pLineEnd || *pLine == '\r' || *pLine == '#' ||
+            (line == 1u && unsigned(*pLine - '0') >= 10u && *pLine != '-' &&
+            *pLine != '+' && *pLine != '.')) {
+            continue;
+        }
+
+        // four numbers separated by commas and optional blanks
+        double fields[4];
+        const char *p = pLine;
+        for(int f = 0; f < 4 && p != nullptr; f++) {
+            while(p < pLineEnd && (*p == ' ' || *p == '\t')) {
+                p++;
+            }
+            p = parseDecimal(p, pLineEnd, fields[f]);
+            while(p != nullptr && p < pLineEnd && (*p == ' ' || *p == '\t')) {
+                p++;
+            }
+            if(p != nullptr && f < 3) {
+                p = (p < pLineEnd && *p == ',') ? p + 1 : nullptr;
+            }
+        }
+        if(p != nullptr && p < pLineEnd && *p == '\r') {
+            p++;
+        }
+        if(p != pLineEnd) {
+            throw std::runtime_error("malformed load on line " +
+                std::to_string(line) + " of " + name +
+                " in TraceReader::next()");
+        }
+        batch.push(fields[0], float(fields[1]), float(fields[2]),
+            float(fields[3]));
+    }
+}
+
+/*
+ * Copy whole records out of the buffer, refilling it when one is cut off.
+ */
+inline void TraceReader::nextBinary(LaundryBatch &batch) {
+    while(!batch.full()) {
+        if(end - pos < TRACE_RECORD_SIZE) {
+            if(!refill()) {
+                if(end != pos) {
+                    throw std::runtime_error("truncated load at the end of " +
+                        name + " in TraceReader::next()");
+                }
+                return;
+            }
+            continue;
+        }
+        size_t n = (end - pos) / TRACE_RECORD_SIZE;
+        size_t room = batch.capacity() - batch.size();
+        n = n < room ? n : room;
+        const char *p = buf.data() + pos;
+        for(size_t i = 0u; i < n; i++, p += TRACE_RECORD_SIZE) {
+            double arrival;
+            float fields[3];
+            memcpy(&arrival, p, sizeof(double));
+            memcpy(fields, p + sizeof(double), sizeof(fields));
+            batch.push(arrival, fields[0], fields[1], fields[2]);
+        }
+        pos += n * TRACE_RECORD_SIZE;
+    }
+}
+
+/*
+ * Create the trace and buffer its header.
+ */
+inline TraceWriter::TraceWriter(const std::string &fileName,
+    TraceFormat format) : name(fileName), fd(-1), fmt(format),
+    buf(1u << 20), used(0u), numBytes(0u) {
+    fd = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) {
+        throw std::runtime_error("unable to create " + fileName +
+            " in TraceWriter::TraceWriter()");
+    }
+    if(fmt == TRACE_BINARY) {
+        memcpy(buf.data(), TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        used = sizeof(TRACE_MAGIC);
+    } else {
+        const char HEADER[] = "arrival,mass,wash,dry\n";
+        memcpy(buf.data(), HEADER, sizeof(HEADER) - 1u);
+        used = sizeof(HEADER) - 1u;
+    }
+}
+
+/*
+ * Close the trace, ignoring errors, since destructors must not throw.
+ */
+inline TraceWriter::~TraceWriter() {
+    try {
+        close();
+    } catch(...) {
+    }
+}
+
+/*
+ * Write the whole buffer, however many write() calls it takes.
+ */
+inline void TraceWriter::flush() {
+    size_t done = 0u;
+    while(done < used) {
+        ssize_t n = ::write(fd, buf.data() + done, used - done);
+        if(n < 0) {
+            throw std::runtime_error("unable to write " + name +
+                " in TraceWriter::write()");
+        }
+        done += size_t(n);
+    }
+    numBytes += used;
+    used = 0u;
+}
+
+/*
+ * Flush when the buffer can't take n more bytes, and grow it for batches
+ * bigger than the whole buffer.
+ */
+inline void TraceWriter::reserve(size_t n) {
+    if(buf.size() - used < n) {
+        flush();
+        if(buf.size() < n) {
+            buf.resize(n);
+        }
+    }
+}
+
+/*
+ * Format or copy the batch into the buffer, a chunk of loads at a time.
+ */
+inline void TraceWriter::write(const LaundryBatch &batch) {
+    if(fd < 0) {
+        throw std::runtime_error("closed trace " + name +
+            " in TraceWriter::write()");
+    }
+    const size_t CHUNK = 1024u;
+    for(size_t first = 0u; first < batch.size(); first += CHUNK) {
+        size_t n = batch.size() - first < CHUNK ? batch.size() - first : CHUNK;
+        if(fmt == TRACE_CSV) {
+            reserve(n * CSV_RECORD_MAX);
+            char *pEnd = formatBatch(batch, first, n, buf.data() + used);
+            used = size_t(pEnd - buf.data());
+        } else {
+            reserve(n * TRACE_RECORD_SIZE);
+            char *p = buf.data() + used;
+            for(size_t i = first; i < first + n; i++) {
+                float fields[3] = { batch.masses()[i], batch.washTimes()[i],
+                    batch.dryTimes()[i] };
+                memcpy(p, &batch.arrivals()[i], sizeof(double));
+                memcpy(p + sizeof(double), fields, sizeof(fields));
+                p += TRACE_RECORD_SIZE;
+            }
+            used += n * TRACE_RECORD_SIZE;
+        }
+    }
+}
+
+/*
+ * Flush and close; a second close does nothing.
+ */
+inline void TraceWriter::close() {
+    if(fd < 0) {
+        return;
+    }
+    int closing = fd;
+    try {
+        flush();
+    } catch(...) {
+        fd = -1;
+        ::close(closing);
+        throw;
+    }
+    fd = -1;
+    if(::close(closing) != 0) {
+        throw std::runtime_error("unable to close " + name +
+            " in TraceWriter::close()");
+    }
+}
+
+// doctest unit tests for the batches and traces
+TEST_CASE("testing LaundryBatch") {
+    LaundryBatch batch(3u);
+    CHECK(batch.capacity() == 3u);
+    CHECK(batch.empty());
+    batch.push(1.5, Laundry(2.0f, 25.0f, 38.0f));
+    batch.push(2.5, 3.0f, 27.5f, 42.0f);
+    CHECK(batch.size() == 2u);
+    CHECK(batch.arrivals()[1] == 2.5);
+    CHECK(batch.masses()[0] == 2.0f);
+    CHECK(batch.washTimes()[1] == 27.5f);
+    CHECK(batch.get(1).getDryTime() == 42.0f);
+    batch.push(3.0, Laundry());
+    CHECK(batch.full());
+
+    // check exception handling
+    bool flag = true;
+    try {
+        batch.push(4.0, Laundry());  // should throw an exception
+        flag = false;                // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+
+    // clearing keeps the storage
+    batch.clear();
+    CHECK(batch.empty());
+    CHECK(batch.capacity() == 3u);
+
+    // formatting
+    batch.push(12.34567, Laundry(5.0f, 32.5f, 50.0f));
+    batch.push(100.0, Laundry(10.0f, 45.0f, 70.0f));
+    std::vector<char> out(2u * CSV_RECORD_MAX);
+    char *pEnd = formatBatch(batch, 0u, 2u, out.data());
+    CHECK(std::string(out.data(), pEnd) ==
+        "12.3457,5.00,32.50,50.00\n100.0000,10.00,45.00,70.00\n");
+    pEnd = formatBatch(batch, 1u, 1u, out.data());
+    CHECK(std::string(out.data(), pEnd) == "100.0000,10.00,45.00,70.00\n");
+    flag = true;
+    try {
+        formatBatch(batch, 1u, 2u, out.data());  // should throw an exception
+        flag = false;                             // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+}
+
+TEST_CASE("testing TraceReader and TraceWriter") {
+    const char *NAME = "LaundryBatchTests.trace";
+    TraceFormat formats[] = { TRACE_CSV, TRACE_BINARY };
+    for(TraceFormat format : formats) {
+        // 10000 loads, written in uneven batches
+        LaundryBatch out(777u);
+        {
+            TraceWriter writer(NAME, format);
+            for(int i = 0; i < 10000; i++) {
+                float mass = 1.0f + float(i % 10);
+                out.push(i * 0.25, Laundry(mass, 20.0f + 2.5f * mass,
+                    30.0f + 4.0f * mass));
+                if(out.full()) {
+                    writer.write(out);
+                    out.clear();
+                }
+            }
+            writer.write(out);
+            writer.close();
+            CHECK(writer.bytes() > 10000u * 20u);
+        }
+
+        // read back in small blocks, so records straddle the blocks
+        TraceReader reader(NAME, 100u);
+        CHECK(reader.format() == format);
+        LaundryBatch in(1000u);
+        size_t total = 0u;
+        double massSum = 0.0;
+        while(reader.next(in) > 0u) {
+            for(size_t i = 0u; i < in.size(); i++, total++) {
+                CHECK(in.arrivals()[i] == total * 0.25);
+                massSum += in.masses()[i];
+            }
+        }
+        CHECK(total == 10000u);
+        CHECK(reader.records() == 10000u);
+        CHECK(massSum == doctest::Approx(10000.0 * 5.5));
+        CHECK(reader.next(in) == 0u);
+
+        // the same loads as a source for the simulation
+        TraceReader again(NAME);
+        TraceLoads loads(again, 64u);
+        double time;
+        Laundry load;
+        size_t n = 0u;
+        while(loads.next(time, load)) {
+            n++;
+        }
+        CHECK(n == 10000u);
+        CHECK(time == 9999 * 0.25);
+        CHECK(load.getWashTime() == 20.0f + 2.5f * 10.0f);
+    }
+
+    // hand-written CSV with comments, blanks and CRLF line endings
+    FILE *f = fopen(NAME, "w");
+    REQUIRE(f != nullptr);
+    fputs("arrival,mass,wash,dry\r\n# comment\r\n\r\n"
+        "1.5, 2, 25, 38\r\n 3 ,4.25,30.5,47\n5e1,1,22.5,34", f);
+    fclose(f);
+    {
+        TraceReader reader(NAME);
+        LaundryBatch in;
+        CHECK(reader.next(in) == 3u);
+        CHECK(in.arrivals()[0] == 1.5);
+        CHECK(in.masses()[1] == 4.25f);
+        CHECK(in.washTimes()[1] == 30.5f);
+        CHECK(in.arrivals()[2] == 50.0);
+        CHECK(in.dryTimes()[2] == 34.0f);
+    }
+
+    // check exception handling for malformed and out of order loads
+    f = fopen(NAME, "w");
+    REQUIRE(f != nullptr);
+    fputs("1,2,3,4\n1,2,3\n", f);
+    fclose(f);
+    {
+        TraceReader reader(NAME);
+        LaundryBatch in;
+        bool flag = true;
+        try {
+            reader.next(in);    // should throw an exception
+            flag = false;       // should never happen
+        } catch(std::runtime_error re) {
+            CHECK(flag);
+            CHECK(std::string(re.what()).find("line 2") != std::string::npos);
+        }
+    }
+    f = fopen(NAME, "w");
+    REQUIRE(f != nullptr);
+    fputs("2,2,3,4\n1,2,3,4\n", f);
+    fclose(f);
+    {
+        TraceReader reader(NAME);
+        TraceLoads loads(reader);
+        double time;
+        Laundry load;
+        CHECK(loads.next(time, load));
+        bool flag = true;
+        try {
+            loads.next(time, load);  // should throw an exception
+            flag = false;            // should never happen
+        } catch(std::runtime_error re) {
+            CHECK(flag);
+        }
+    }
+    std::remove(NAME);
+
+    bool flag = true;
+    try {
+        TraceReader missing("no-such-file.trace");  // should throw an exception
+        flag = false;                               // should never happen
+    } catch(std::runtime_error re) {
+        CHECK(flag);
+    }
+}
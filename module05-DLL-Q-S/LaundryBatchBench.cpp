@@ -0,0 +1,108 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "Laundromat.hpp"
+#include "LaundryBatch.hpp"
+
+/**
+ * Helper function to time f() and print the speed, for loads loads and
+ * bytes bytes.
+ */
+template <class F>
+void report(const char *name, size_t loads, size_t bytes, F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << name << loads / d.count() / 1e6 << " million loads/s, "
+        << bytes / d.count() / 1e6 << " MB/s" << std::endl;
+}
+
+/**
+ * @brief Benchmark for LaundryBatch and the trace files.
+ *
+ * This program formats a million random loads as CSV with formatBatch(),
+ * snprintf and an ostringstream, then reads them back from a CSV trace
+ * with TraceReader and with an ifstream, and from a binary trace with
+ * TraceReader.
+ */
+int main() {
+    using namespace std;
+
+    const size_t N = 1000000u;
+    const char *CSV = "LaundryBatchBench.csv", *BIN = "LaundryBatchBench.bin";
+    PoissonLoads source(30.0, N, 246u);
+    LaundryBatch batch(N);
+    double time;
+    Laundry load;
+    while(source.next(time, load)) {
+        batch.push(time, load);
+    }
+    double sink = 0.0;
+
+    cout << "formatting " << N << " loads:" << endl;
+    vector<char> text(N * CSV_RECORD_MAX);
+    size_t bytes = size_t(formatBatch(batch, 0u, N, text.data()) -
+        text.data());
+    report("formatBatch          ", N, bytes, [&]() {
+        sink += double(formatBatch(batch, 0u, N, text.data()) - text.data());
+    });
+    report("snprintf             ", N, bytes, [&]() {
+        char *p = text.data();
+        for(size_t i = 0u; i < N; i++) {
+            p += snprintf(p, CSV_RECORD_MAX, "%.4f,%.2f,%.2f,%.2f\n",
+                batch.arrivals()[i], batch.masses()[i], batch.washTimes()[i],
+                batch.dryTimes()[i]);
+        }
+        sink += double(p - text.data());
+    });
+    report("ostringstream        ", N, bytes, [&]() {
+        ostringstream out;
+        for(size_t i = 0u; i < N; i++) {
+            out << fixed << setprecision(4) << batch.arrivals()[i] << ','
+                << setprecision(2) << batch.masses()[i] << ','
+                << batch.washTimes()[i] << ',' << batch.dryTimes()[i] << '\n';
+        }
+        sink += double(out.str().size());
+    });
+
+    {
+        TraceWriter csv(CSV, TRACE_CSV), bin(BIN, TRACE_BINARY);
+        csv.write(batch);
+        bin.write(batch);
+    }
+    cout << "reading " << N << " loads:" << endl;
+    LaundryBatch in;
+    report("TraceReader, CSV     ", N, bytes, [&]() {
+        TraceReader reader(CSV);
+        while(reader.next(in) > 0u) {
+            sink += in.masses()[0];
+        }
+    });
+    report("ifstream, CSV        ", N, bytes, [&]() {
+        ifstream file(CSV);
+        string header;
+        getline(file, header);
+        double a;
+        float m, w, d;
+        char c1, c2, c3;
+        while(file >> a >> c1 >> m >> c2 >> w >> c3 >> d) {
+            sink += m;
+        }
+    });
+    report("TraceReader, binary  ", N, N * TRACE_RECORD_SIZE, [&]() {
+        TraceReader reader(BIN);
+        while(reader.next(in) > 0u) {
+            sink += in.masses()[0];
+        }
+    });
+    remove(CSV);
+    remove(BIN);
+    cout << "checksum " << sink << endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "Laundromat.hpp"
+#include "Pipeline.hpp"
+
+/**
+ * @brief Laundromat pipeline.
+ *
+ * Usage: LaundryPipeline [loads [washers [dryers [arrivalsPerHour
+ * [fast|msPerMinute]]]]]
+ *
+ * Runs randomly arriving loads through a washer and dryer pipeline, with a
+ * thread per washer and per dryer, and reports the counters of each stage.
+ * By default 2000 loads arrive at 30 per hour at a laundromat with 20
+ * washers and 30 dryers, in real time with a simulated minute taking half
+ * a millisecond, and the waits are compared with those of the
+ * discrete-event simulation of the same loads. With "fast", the loads go
+ * through as fast as possible, which measures the runtime itself.
+ */
+int main(int argc, char *argv[]) {
+    using namespace std;
+
+    uint64_t numLoads = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000u;
+    unsigned washers = argc > 2 ? unsigned(atoi(argv[2])) : 20u;
+    unsigned dryers = argc > 3 ? unsigned(atoi(argv[3])) : 30u;
+    double rate = argc > 4 ? atof(argv[4]) : 30.0;
+    bool fast = argc > 5 && strcmp(argv[5], "fast") == 0;
+    double msPerMinute = argc > 5 && !fast ? atof(argv[5]) : 0.5;
+    double timeScale = msPerMinute / 1000.0;
+
+    PipelineStats stats;
+    try {
+        Pipeline<Laundry> pipeline = laundromatPipeline(washers, dryers);
+        PoissonLoads loads(rate, numLoads, 246u);
+        stats = pipeline.run(loads,
+            fast ? PIPELINE_FAST : PIPELINE_REAL_TIME, timeScale);
+    } catch(invalid_argument ia) {
+        cout << ia.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    cout << stats.items << " loads at " << rate << " per hour, " << washers
+        << " washers, " << dryers << " dryers, ";
+    if(fast) {
+        cout << "as fast as possible" << endl;
+    } else {
+        cout << msPerMinute << " ms per minute" << endl;
+    }
+    for(size_t s = 0u; s < stats.stages.size(); s++) {
+        const StageStats &st = stats.stages[s];
+        cout << "  " << st.name << ": " << st.workers << " workers, "
+            << st.throughput << " loads/s, " << st.utilization
+            << " utilization" << endl;
+        cout << "    wait " << st.meanWait * 1e3 << " ms mean, latency "
+            << st.meanLatency * 1e3 << " ms mean, " << st.maxLatency * 1e3
+            << " ms max" << endl;
+        cout << "    queue " << st.maxQueue << " loads max, blocked "
+            << st.blockedSeconds * 1e3 << " ms" << endl;
+    }
+    cout << "  end to end: " << stats.meanLatency * 1e3 << " ms mean, "
+        << stats.maxLatency * 1e3 << " ms max; source blocked "
+        << stats.sourceBlockedSeconds * 1e3 << " ms" << endl;
+    cout << "  speed: " << stats.itemsPerSecond() << " loads/s in "
+        << stats.seconds << " s" << endl;
+
+    if(!fast) {
+        PoissonLoads loads(rate, numLoads, 246u);
+        LaundromatStats sim = simulateLaundromat(washers, dryers, loads);
+        cout << "  wash wait " << stats.stages[0].meanWait / timeScale
+            << " min, simulated " << sim.meanWashWait << " min" << endl;
+        cout << "  dry wait  " << stats.stages[1].meanWait / timeScale
+            << " min, simulated " << sim.meanDryWait << " min" << endl;
+        cout << "  washer utilization " << stats.stages[0].utilization
+            << ", simulated " << sim.washerUtilization << endl;
+    }
+
+    return EXIT_SUCCESS;
+}
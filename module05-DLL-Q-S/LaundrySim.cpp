@@ -1,15 +1,126 @@
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include "DLL.hpp"
 #include "Laundry.h"
+#include "Laundromat.hpp"
+#include "Replications.hpp"
 
-int main() {
+/**
+ * Helper function to look up a queue policy by name.
+ */
+bool parsePolicy(const char *name, QueuePolicy &policy) {
+    const char *NAMES[] = { "fifo", "lightest", "wash", "total" };
+    for(int p = 0; p < 4; p++) {
+        if(strcmp(name, NAMES[p]) == 0) {
+            policy = QueuePolicy(p);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Helper function to print one interval.
+ */
+void printInterval(const char *name, const Interval &iv) {
+    std::cout << "    " << name << iv.mean << " +/- " << iv.halfWidth
+        << std::endl;
+}
+
+/**
+ * @brief Laundromat simulation.
+ *
+ * Usage: LaundrySim [loads [washers [dryers [arrivalsPerHour
+ * [replications [fifo|lightest|wash|total]]]]]]
+ *
+ * Simulates loads arriving at random at a laundromat, and reports how busy
+ * the machines were, how long the loads waited, and how fast the
+ * simulation ran. By default 10 million loads arrive at 30 per hour at a
+ * laundromat with 20 washers and 30 dryers, and get washers first come,
+ * first served; the last argument picks lightest load, shortest wash, or
+ * shortest wash plus dry first instead.
+ *
+ * With more than one replication, each run simulates the given number of
+ * loads, for laundromats with up to two washers fewer or more than given,
+ * and the statistics are reported as 95% confidence intervals over the
+ * replications, which run in parallel on every core.
+ */
+int main(int argc, char *argv[]) {
     using namespace std;
 
+    uint64_t numLoads = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000u;
+    unsigned washers = argc > 2 ? unsigned(atoi(argv[2])) : 20u;
+    unsigned dryers = argc > 3 ? unsigned(atoi(argv[3])) : 30u;
+    double rate = argc > 4 ? atof(argv[4]) : 30.0;
+    unsigned replications = argc > 5 ? unsigned(atoi(argv[5])) : 1u;
+    QueuePolicy policy = POLICY_FIRST_COME;
+    if(argc > 6 && !parsePolicy(argv[6], policy)) {
+        cout << "unknown policy " << argv[6] << endl;
+        return EXIT_FAILURE;
+    }
+
     Laundry la(1, 2, 3.3);
+    cout << "Sample load: " << la << endl;
+
+    if(replications > 1u) {
+        vector<Scenario> scenarios;
+        for(unsigned w = washers > 2u ? washers - 2u : 1u; w <= washers + 2u;
+            w++) {
+            Scenario sc = { w, dryers, rate, numLoads, policy };
+            scenarios.push_back(sc);
+        }
+        ReplicationResults results;
+        try {
+            results = runReplications(scenarios, replications, 246u);
+        } catch(invalid_argument ia) {
+            cout << ia.what() << endl;
+            return EXIT_FAILURE;
+        }
+
+        for(size_t s = 0u; s < results.scenarios.size(); s++) {
+            const ScenarioSummary &sum = results.scenarios[s];
+            cout << sum.replications << " x " << sum.scenario.loads
+                << " loads at " << rate << " per hour, "
+                << sum.scenario.washers << " washers, " << dryers << " dryers"
+                << endl;
+            printInterval("washer utilization ", sum.washerUtilization);
+            printInterval("dryer utilization  ", sum.dryerUtilization);
+            printInterval("wash wait (min)    ", sum.meanWashWait);
+            printInterval("dry wait (min)     ", sum.meanDryWait);
+            printInterval("time in system     ", sum.meanTimeInSystem);
+        }
+        cout << "speed: " << results.loadsPerSecond() / 1e6
+            << " million loads/s on " << results.threads << " threads"
+            << endl;
+        return EXIT_SUCCESS;
+    }
+
+    PoissonLoads loads(rate, numLoads, 246u);
+    LaundromatStats stats;
+    try {
+        stats = simulateLaundromat(washers, dryers, loads, policy);
+    } catch(invalid_argument ia) {
+        cout << ia.what() << endl;
+        return EXIT_FAILURE;
+    }
 
-    cout << la << endl;
+    cout << stats.loads << " loads at " << rate << " per hour, " << washers
+        << " washers, " << dryers << " dryers" << endl;
+    cout << "  simulated time     " << stats.endTime / 60.0 << " hours" << endl;
+    cout << "  washer utilization " << stats.washerUtilization << endl;
+    cout << "  dryer utilization  " << stats.dryerUtilization << endl;
+    cout << "  wash wait          " << stats.meanWashWait << " min mean, "
+        << stats.maxWashWait << " min max, " << stats.maxWashQueue
+        << " loads max queue" << endl;
+    cout << "  dry wait           " << stats.meanDryWait << " min mean, "
+        << stats.maxDryWait << " min max, " << stats.maxDryQueue
+        << " loads max queue" << endl;
+    cout << "  time in system     " << stats.meanTimeInSystem << " min mean"
+        << endl;
+    cout << "  speed              " << stats.loadsPerSecond() / 1e6
+        << " million loads/s" << endl;
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
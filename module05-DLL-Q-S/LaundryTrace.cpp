@@ -0,0 +1,133 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "Laundromat.hpp"
+#include "LaundryBatch.hpp"
+
+/**
+ * Helper function for the time elapsed since start, in seconds.
+ */
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+}
+
+/**
+ * Helper function to write a trace of random loads.
+ */
+int writeTrace(const char *fileName, uint64_t numLoads, double rate,
+    TraceFormat format) {
+    using namespace std;
+
+    auto start = chrono::steady_clock::now();
+    PoissonLoads loads(rate, numLoads, 246u);
+    LaundryBatch batch;
+    double time;
+    Laundry load;
+    uint64_t bytes;
+    try {
+        TraceWriter writer(fileName, format);
+        while(loads.next(time, load)) {
+            batch.push(time, load);
+            if(batch.full()) {
+                writer.write(batch);
+                batch.clear();
+            }
+        }
+        writer.write(batch);
+        writer.close();
+        bytes = writer.bytes();
+    } catch(runtime_error re) {
+        cout << re.what() << endl;
+        return EXIT_FAILURE;
+    }
+    double seconds = secondsSince(start);
+
+    cout << "wrote " << numLoads << " loads, " << bytes / 1e6 << " MB, in "
+        << seconds << " s: " << numLoads / seconds / 1e6
+        << " million loads/s, " << bytes / seconds / 1e6 << " MB/s" << endl;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Helper function to simulate the loads of a trace.
+ */
+int runTrace(const char *fileName, unsigned washers, unsigned dryers) {
+    using namespace std;
+
+    auto start = chrono::steady_clock::now();
+    LaundromatStats stats;
+    uint64_t bytes;
+    try {
+        TraceReader reader(fileName);
+        TraceLoads loads(reader);
+        stats = simulateLaundromat(washers, dryers, loads);
+        bytes = reader.bytes();
+    } catch(runtime_error re) {
+        cout << re.what() << endl;
+        return EXIT_FAILURE;
+    } catch(invalid_argument ia) {
+        cout << ia.what() << endl;
+        return EXIT_FAILURE;
+    }
+    double seconds = secondsSince(start);
+
+    cout << stats.loads << " loads from " << fileName << ", " << washers
+        << " washers, " << dryers << " dryers" << endl;
+    cout << "  simulated time     " << stats.endTime / 60.0 << " hours" << endl;
+    cout << "  washer utilization " << stats.washerUtilization << endl;
+    cout << "  dryer utilization  " << stats.dryerUtilization << endl;
+    cout << "  wash wait          " << stats.meanWashWait << " min mean" << endl;
+    cout << "  dry wait           " << stats.meanDryWait << " min mean" << endl;
+    cout << "  time in system     " << stats.meanTimeInSystem << " min mean"
+        << endl;
+    cout << "  speed              " << stats.loads / seconds / 1e6
+        << " million loads/s, " << bytes / seconds / 1e6
+        << " MB/s, reading included" << endl;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Laundromat trace tool.
+ *
+ * Usage: LaundryTrace write file [loads [arrivalsPerHour [csv|binary]]]
+ *        LaundryTrace run file [washers [dryers]]
+ *
+ * The first form writes a trace of randomly arriving loads, by default 10
+ * million loads at 30 per hour, as CSV. The second simulates the loads of
+ * a trace in either format, streamed from the file a batch at a time, at a
+ * laundromat with 20 washers and 30 dryers by default.
+ */
+int main(int argc, char *argv[]) {
+    using namespace std;
+
+    if(argc < 3) {
+        cout << "usage: LaundryTrace write file [loads [arrivalsPerHour "
+            "[csv|binary]]]" << endl;
+        cout << "       LaundryTrace run file [washers [dryers]]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    if(strcmp(argv[1], "write") == 0) {
+        uint64_t numLoads = argc > 3 ? strtoull(argv[3], nullptr, 10) :
+            10000000u;
+        double rate = argc > 4 ? atof(argv[4]) : 30.0;
+        TraceFormat format = TRACE_CSV;
+        if(argc > 5 && strcmp(argv[5], "binary") == 0) {
+            format = TRACE_BINARY;
+        } else if(argc > 5 && strcmp(argv[5], "csv") != 0) {
+            cout << "unknown format " << argv[5] << endl;
+            return EXIT_FAILURE;
+        }
+        return writeTrace(argv[2], numLoads, rate, format);
+    }
+    if(strcmp(argv[1], "run") == 0) {
+        unsigned washers = argc > 3 ? unsigned(atoi(argv[3])) : 20u;
+        unsigned dryers = argc > 4 ? unsigned(atoi(argv[4])) : 30u;
+        return runTrace(argv[2], washers, dryers);
+    }
+
+    cout << "unknown command " << argv[1] << endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,879 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <doctest.h>
+#include "Laundry.h"
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief CMP 246 Module 5 bounded blocking queue.
+ *
+ * A first in, first out queue of at most capacity() elements, shared by
+ * threads. push() waits while the queue is full and pop() waits while it
+ * is empty, so a producer can never run more than capacity() elements
+ * ahead of its consumers: this is backpressure. Once the queue is closed,
+ * nothing more can be added, and pop() fails as soon as the elements
+ * already in the queue are gone. The elements are kept in a ring buffer
+ * allocated once, by the constructor.
+ *
+ * @tparam T Element type.
+ */
+template <class T> class BoundedQueue {
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * @param capacity Maximum number of elements in the queue.
+     *
+     * @throws std::invalid_argument if capacity is zero.
+     */
+    explicit BoundedQueue(size_t capacity);
+
+    /**
+     * @brief Get queue capacity.
+     *
+     * @return The maximum number of elements in the queue.
+     */
+    size_t capacity() const { return ring.size(); }
+
+    /**
+     * @brief Close the queue, and wake every thread waiting on it.
+     */
+    void close();
+
+    /**
+     * @brief Determine if the queue is closed.
+     */
+    bool closed() const;
+
+    /**
+     * @brief Get the most elements the queue has held at once.
+     */
+    size_t highWater() const;
+
+    /**
+     * @brief Remove the first element, waiting while the queue is empty.
+     *
+     * @param d Set to the element removed.
+     *
+     * @return false if the queue is closed and empty.
+     */
+    bool pop(T &d);
+
+    /**
+     * @brief Add an element at the end, waiting while the queue is full.
+     *
+     * @param d Element to add.
+     *
+     * @return false if the queue is closed.
+     */
+    bool push(const T &d);
+
+    /**
+     * @brief Get queue size.
+     *
+     * @return The number of elements in the queue.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Remove the first element, if there is one, without waiting.
+     *
+     * @param d Set to the element removed.
+     *
+     * @return false if the queue is empty.
+     */
+    bool tryPop(T &d);
+
+    /**
+     * @brief Add an element at the end, if there is room, without waiting.
+     *
+     * @param d Element to add.
+     *
+     * @return false if the queue is full or closed.
+     */
+    bool tryPush(const T &d);
+
+private:
+    /**
+     * Protects everything below.
+     */
+    mutable std::mutex m;
+
+    /**
+     * Signaled when an element is removed, or the queue is closed.
+     */
+    std::condition_variable notFull;
+
+    /**
+     * Signaled when an element is added, or the queue is closed.
+     */
+    std::condition_variable notEmpty;
+
+    /**
+     * Ring buffer of elements.
+     */
+    std::vector<T> ring;
+
+    /**
+     * Index of the first element in the ring buffer.
+     */
+    size_t head;
+
+    /**
+     * Number of elements in the queue.
+     */
+    size_t count;
+
+    /**
+     * Largest number of elements in the queue so far.
+     */
+    size_t maxCount;
+
+    /**
+     * True once the queue is closed.
+     */
+    bool isClosed;
+};
+
+/**
+ * @brief How a pipeline paces its work.
+ *
+ * In real time, items enter the pipeline at their arrival times and each
+ * stage takes as long to serve an item as the item's service time, both
+ * scaled to wall-clock time. As fast as possible, nothing waits but for
+ * other items, so the run measures the cost of the work and of the
+ * runtime itself.
+ */
+enum PipelineMode {
+    PIPELINE_REAL_TIME,
+    PIPELINE_FAST
+};
+
+/**
+ * @brief Counters of one pipeline stage, for a whole run. Times are
+ * wall-clock seconds.
+ */
+struct StageStats {
+    /** Name of the stage. */
+    std::string name;
+
+    /** Number of worker threads. */
+    unsigned workers;
+
+    /** Number of items served. */
+    uint64_t items;
+
+    /** Items served per second of the run. */
+    double throughput;
+
+    /** Fraction of worker time spent serving items. */
+    double utilization;
+
+    /** Mean time from entering the stage's queue to the start of service. */
+    double meanWait;
+
+    /** Mean time from entering the stage's queue to the end of service. */
+    double meanLatency;
+
+    /** Longest time from entering the stage's queue to the end of service. */
+    double maxLatency;
+
+    /** Total time workers waited for room in the next stage's queue. */
+    double blockedSeconds;
+
+    /** Most items the stage's queue held at once. */
+    size_t maxQueue;
+};
+
+/**
+ * @brief Counters of a whole pipeline run.
+ */
+struct PipelineStats {
+    /** Counters of each stage, in order. */
+    std::vector<StageStats> stages;
+
+    /** Number of items through the whole pipeline. */
+    uint64_t items;
+
+    /** Wall-clock time taken, in seconds. */
+    double seconds;
+
+    /** Time the source waited for room in the first queue, in seconds. */
+    double sourceBlockedSeconds;
+
+    /** Mean time from entering the pipeline to leaving it, in seconds. */
+    double meanLatency;
+
+    /** Longest time from entering the pipeline to leaving it, in seconds. */
+    double maxLatency;
+
+    /**
+     * @brief Pipeline throughput.
+     *
+     * @return Items through the whole pipeline per second.
+     */
+    double itemsPerSecond() const { return items / seconds; }
+};
+
+/**
+ * @brief CMP 246 Module 5 staged pipeline runtime.
+ *
+ * A pipeline is a sequence of stages, each served by its own pool of worker
+ * threads, with a BoundedQueue in front of every stage. run() feeds items
+ * from a source into the first queue; a worker takes an item from its
+ * stage's queue, serves it, and passes it on to the next stage's queue,
+ * waiting if that queue is full, so a slow stage holds back the stages
+ * before it instead of letting its queue grow without bound. Each worker
+ * keeps its own counters, and adds them to its stage's only once, when it
+ * finishes, so counting costs no locking.
+ *
+ * A stage's work is a function that may change the item, and returns how
+ * long serving it takes, in the same units as the arrival times: in
+ * real-time mode, the worker is busy for that long, scaled to wall-clock
+ * time. A laundromat, for example, is a pipeline of Laundry with a washing
+ * stage served by the washers and a drying stage served by the dryers,
+ * each taking the load's washing or drying time; see laundromatPipeline().
+ *
+ * @tparam T Item type.
+ */
+template <class T> class Pipeline {
+public:
+    /**
+     * @brief Work function of a stage: serve an item, and return the
+     * service time.
+     */
+    typedef std::function<double(T &)> Work;
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * Create a pipeline with no stages.
+     *
+     * @param queueCapacity Capacity of the queue in front of each stage.
+     *
+     * @throws std::invalid_argument if queueCapacity is zero.
+     */
+    explicit Pipeline(size_t queueCapacity = 64u);
+
+    /**
+     * @brief Add a stage at the end of the pipeline.
+     *
+     * @param name Name of the stage, for the counters.
+     * @param workers Number of worker threads serving the stage.
+     * @param work Work function of the stage. It is called from several
+     * threads at once if there are several workers.
+     *
+     * @throws std::invalid_argument if workers is zero.
+     */
+    void addStage(const std::string &name, unsigned workers, const Work &work);
+
+    /**
+     * @brief Run items through the pipeline.
+     *
+     * Feed every item of the source through every stage, and wait until
+     * the last one is done. If a work function throws, the pipeline stops
+     * taking items, and the exception is rethrown once every worker has
+     * stopped.
+     *
+     * @param source Source of items, with a method bool next(double &time,
+     * T &item) that delivers the items in order of arrival; PoissonLoads and
+     * TraceLoads are sources of Laundry.
+     * @param mode Real time, or as fast as possible.
+     * @param timeScale Wall-clock seconds per unit of arrival and service
+     * time, in real-time mode; the default runs a minute in a millisecond.
+     *
+     * @throws std::invalid_argument if the pipeline has no stages.
+     *
+     * @return Counters of the run.
+     */
+    template <class Source>
+    PipelineStats run(Source &source, PipelineMode mode,
+        double timeScale = 0.001) const;
+
+    /**
+     * @brief Get the number of stages.
+     */
+    size_t stages() const { return stageDefs.size(); }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * An item on its way through the pipeline.
+     */
+    struct Job {
+        /** The item. */
+        T item;
+
+        /** When the item entered the pipeline. */
+        Clock::time_point admitted;
+
+        /** When the item entered the current stage's queue. */
+        Clock::time_point queued;
+    };
+
+    /**
+     * Definition of a stage.
+     */
+    struct StageDef {
+        std::string name;
+        unsigned workers;
+        Work work;
+    };
+
+    /**
+     * Counters of one worker, or of a stage once its workers are done.
+     */
+    struct Counters {
+        uint64_t items;
+        double busy, wait, latency, maxLatency, blocked;
+        double endToEnd, maxEndToEnd;
+    };
+
+    /**
+     * Helper function for a duration in seconds.
+     */
+    static double seconds(Clock::duration d) {
+        return std::chrono::duration<double>(d).count();
+    }
+
+    /**
+     * Capacity of the queue in front of each stage.
+     */
+    size_t queueCapacity;
+
+    /**
+     * The stages, in order.
+     */
+    std::vector<StageDef> stageDefs;
+};
+
+/**
+ * @brief Make a laundromat pipeline: a washing stage served by the washers,
+ * then a drying stage served by the dryers.
+ *
+ * @param washers Number of washers.
+ * @param dryers Number of dryers.
+ * @param queueCapacity Capacity of the queue in front of each stage.
+ *
+ * @throws std::invalid_argument if there are no washers or no dryers, or
+ * queueCapacity is zero.
+ *
+ * @return The pipeline.
+ */
+inline Pipeline<Laundry> laundromatPipeline(unsigned washers, unsigned dryers,
+    size_t queueCapacity = 64u) {
+    Pipeline<Laundry> pipeline(queueCapacity);
+    pipeline.addStage("wash", washers,
+        [](Laundry &load) { return double(load.getWashTime()); });
+    pipeline.addStage("dry", dryers,
+        [](Laundry &load) { return double(load.getDryTime()); });
+    return pipeline;
+}
+
+/*-----------------------------------------------------------------------------
+ * BoundedQueue implementation
+ *---------------------------------------------------------------------------*/
+
+/*
+ * Allocate the ring buffer.
+ */
+template <class T>
+BoundedQueue<T>::BoundedQueue(size_t capacity) : ring(capacity), head(0u),
+    count(0u), maxCount(0u), isClosed(false) {
+    if(capacity == 0u) {
+        throw std::invalid_argument(
+            "Zero capacity in BoundedQueue::BoundedQueue()");
+    }
+}
+
+/*
+ * Wake everybody, so waiting producers fail and consumers drain the queue.
+ */
+template <class T>
+void BoundedQueue<T>::close() {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        isClosed = true;
+    }
+    notFull.notify_all();
+    notEmpty.notify_all();
+}
+
+template <class T>
+bool BoundedQueue<T>::closed() const {
+    std::lock_guard<std::mutex> lock(m);
+    return isClosed;
+}
+
+template <class T>
+size_t BoundedQueue<T>::highWater() const {
+    std::lock_guard<std::mutex> lock(m);
+    return maxCount;
+}
+
+/*
+ * Wait for an element, then take it from the head of the ring.
+ */
+template <class T>
+bool BoundedQueue<T>::pop(T &d) {
+    {
+        std::unique_lock<std::mutex> lock(m);
+        notEmpty.wait(lock, [this]() { return count > 0u || isClosed; });
+        if(count == 0u) {
+            return false;
+        }
+        d = ring[head];
+        head = head + 1u == ring.size() ? 0u : head + 1u;
+        count--;
+    }
+    notFull.notify_one();
+    return true;
+}
+
+/*
+ * Wait for room, then add the element after the tail of the ring.
+ */
+template <class T>
+bool BoundedQueue<T>::push(const T &d) {
+    {
+        std::unique_lock<std::mutex> lock(m);
+        notFull.wait(lock, [this]() {
+            return count < ring.size() || isClosed;
+        });
+        if(isClosed) {
+            return false;
+        }
+        size_t tail = head + count;
+        ring[tail < ring.size() ? tail : tail - ring.size()] = d;
+        count++;
+        maxCount = count > maxCount ? count : maxCount;
+    }
+    notEmpty.notify_one();
+    return true;
+}
+
+template <class T>
+size_t BoundedQueue<T>::size() const {
+    std::lock_guard<std::mutex> lock(m);
+    return count;
+}
+
+template <class T>
+bool BoundedQueue<T>::tryPop(T &d) {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if(count == 0u) {
+            return false;
+        }
+        d = ring[head];
+        head = head + 1u == ring.size() ? 0u : head + 1u;
+        count--;
+    }
+    notFull.notify_one();
+    return true;
+}
+
+template <class T>
+bool BoundedQueue<T>::tryPush(const T &d) {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if(isClosed || count == ring.size()) {
+            return false;
+        }
+        size_t tail = head + count;
+        ring[tail < ring.size() ? tail : tail - ring.size()] = d;
+        count++;
+        maxCount = count > maxCount ? count : maxCount;
+    }
+    notEmpty.notify_one();
+    return true;
+}
+
+// doctest unit tests for the BoundedQueue class
+TEST_CASE("testing BoundedQueue") {
+    BoundedQueue<int> q(3u);
+    CHECK(q.capacity() == 3u);
+    CHECK(q.tryPush(1));
+    CHECK(q.push(2));
+    CHECK(q.tryPush(3));
+    CHECK(!q.tryPush(4));
+    CHECK(q.size() == 3u);
+    int d = 0;
+    CHECK(q.pop(d));
+    CHECK(d == 1);
+    CHECK(q.push(4));
+    CHECK(q.tryPop(d));
+    CHECK(d == 2);
+    CHECK(q.highWater() == 3u);
+
+    // closing keeps the elements but refuses new ones
+    q.close();
+    CHECK(q.closed());
+    CHECK(!q.push(5));
+    CHECK(q.pop(d));
+    CHECK(d == 3);
+    CHECK(q.pop(d));
+    CHECK(d == 4);
+    CHECK(!q.pop(d));
+    CHECK(!q.tryPop(d));
+
+    // a producer and a consumer, with the producer held back
+    BoundedQueue<long> small(4u);
+    long total = 0;
+    std::thread consumer([&]() {
+        long x;
+        while(small.pop(x)) {
+            total += x;
+        }
+    });
+    for(long i = 1; i <= 100000; i++) {
+        small.push(i);
+    }
+    small.close();
+    consumer.join();
+    CHECK(total == 100000L * 100001L / 2);
+    CHECK(small.highWater() <= 4u);
+
+    // check exception handling
+    bool flag = true;
+    try {
+        BoundedQueue<int> none(0u);  // should throw an exception
+        flag = false;                // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Pipeline implementation
+ *---------------------------------------------------------------------------*/
+
+template <class T>
+Pipeline<T>::Pipeline(size_t queueCapacity) : queueCapacity(queueCapacity) {
+    if(queueCapacity == 0u) {
+        throw std::invalid_argument("Zero capacity in Pipeline::Pipeline()");
+    }
+}
+
+template <class T>
+void Pipeline<T>::addStage(const std::string &name, unsigned workers,
+    const Work &work) {
+    if(workers == 0u) {
+        throw std::invalid_argument("No workers in Pipeline::addStage()");
+    }
+    StageDef def = { name, workers, work };
+    stageDefs.push_back(def);
+}
+
+/*
+ * The calling thread is the source; the last worker of each stage to
+ * finish closes the next stage's queue, so the stages shut down in order.
+ */
+template <class T>
+template <class Source>
+PipelineStats Pipeline<T>::run(Source &source, PipelineMode mode,
+    double timeScale) const {
+    size_t numStages = stageDefs.size();
+    if(numStages == 0u) {
+        throw std::invalid_argument("No stages in Pipeline::run()");
+    }
+    bool realTime = mode == PIPELINE_REAL_TIME;
+
+    std::vector<std::unique_ptr<BoundedQueue<Job> > > queues(numStages);
+    for(size_t s = 0u; s < numStages; s++) {
+        queues[s].reset(new BoundedQueue<Job>(queueCapacity));
+    }
+    std::vector<Counters> totals(numStages, Counters());
+    std::vector<unsigned> running(numStages);
+    std::mutex totalsLock;
+    std::exception_ptr failure;
+    std::atomic<bool> failed(false);
+
+    // stop everything, keeping the first exception
+    auto fail = [&]() {
+        std::lock_guard<std::mutex> lock(totalsLock);
+        if(!failed) {
+            failure = std::current_exception();
+            failed = true;
+        }
+        for(size_t s = 0u; s < numStages; s++) {
+            queues[s]->close();
+        }
+    };
+
+    Clock::time_point start = Clock::now();
+    std::vector<std::thread> workers;
+    for(size_t s = 0u; s < numStages; s++) {
+        running[s] = stageDefs[s].workers;
+        for(unsigned w = 0u; w < stageDefs[s].workers; w++) {
+            workers.push_back(std::thread([&, s]() {
+                Counters c = Counters();
+                BoundedQueue<Job> *in = queues[s].get();
+                BoundedQueue<Job> *out = s + 1u < numStages ?
+                    queues[s + 1u].get() : nullptr;
+                try {
+                    Job job;
+                    while(!failed && in->pop(job)) {
+                        Clock::time_point begin = Clock::now();
+                        double service = stageDefs[s].work(job.item);
+                        if(realTime && service > 0.0) {
+                            std::this_thread::sleep_until(begin +
+                                std::chrono::duration_cast<Clock::duration>(
+                                std::chrono::duration<double>(
+                                service * timeScale)));
+                        }
+                        Clock::time_point done = Clock::now();
+                        double latency = seconds(done - job.queued);
+                        c.items++;
+                        c.busy += seconds(done - begin);
+                        c.wait += seconds(begin - job.queued);
+                        c.latency += latency;
+                        c.maxLatency = std::max(c.maxLatency, latency);
+                        if(out != nullptr) {
+                            job.queued = done;
+                            out->push(job);
+                            c.blocked += seconds(Clock::now() - done);
+                        } else {
+                            double e2e = seconds(done - job.admitted);
+                            c.endToEnd += e2e;
+                            c.maxEndToEnd = std::max(c.maxEndToEnd, e2e);
+                        }
+                    }
+                } catch(...) {
+                    fail();
+                }
+
+                std::lock_guard<std::mutex> lock(totalsLock);
+                Counters &t = totals[s];
+                t.items += c.items;
+                t.busy += c.busy;
+                t.wait += c.wait;
+                t.latency += c.latency;
+                t.maxLatency = std::max(t.maxLatency, c.maxLatency);
+                t.blocked += c.blocked;
+                t.endToEnd += c.endToEnd;
+                t.maxEndToEnd = std::max(t.maxEndToEnd, c.maxEndToEnd);
+                if(--running[s] == 0u && out != nullptr) {
+                    out->close();
+                }
+            }));
+        }
+    }
+
+    // feed the first queue, at the arrival times in real time
+    double sourceBlocked = 0.0;
+    try {
+        double time;
+        Job job;
+        while(!failed && source.next(time, job.item)) {
+            if(realTime) {
+                std::this_thread::sleep_until(start +
+                    std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(time * timeScale)));
+            }
+            job.admitted = job.queued = Clock::now();
+            queues[0]->push(job);
+            sourceBlocked += seconds(Clock::now() - job.admitted);
+        }
+    } catch(...) {
+        fail();
+    }
+    queues[0]->close();
+    for(size_t t = 0u; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    Clock::time_point stop = Clock::now();
+
+    PipelineStats stats;
+    stats.seconds = seconds(stop - start);
+    stats.sourceBlockedSeconds = sourceBlocked;
+    for(size_t s = 0u; s < numStages; s++) {
+        const Counters &t = totals[s];
+        double n = t.items > 0u ? double(t.items) : 1.0;
+        StageStats st;
+        st.name = stageDefs[s].name;
+        st.workers = stageDefs[s].workers;
+        st.items = t.items;
+        st.throughput = t.items / stats.seconds;
+        st.utilization = t.busy / (st.workers * stats.seconds);
+        st.meanWait = t.wait / n;
+        st.meanLatency = t.latency / n;
+        st.maxLatency = t.maxLatency;
+        st.blockedSeconds = t.blocked;
+        st.maxQueue = queues[s]->highWater();
+        stats.stages.push_back(st);
+    }
+    const Counters &last = totals[numStages - 1u];
+    stats.items = last.items;
+    stats.meanLatency = last.endToEnd / (last.items > 0u ? last.items : 1u);
+    stats.maxLatency = last.maxEndToEnd;
+
+    if(failure) {
+        std::rethrow_exception(failure);
+    }
+    return stats;
+}
+
+namespace {
+
+/**
+ * Helper source for the Pipeline tests: count items arriving at equal
+ * intervals.
+ */
+class SpacedItems {
+public:
+    SpacedItems(int count, double gap) : n(0), count(count), gap(gap) { }
+
+    bool next(double &time, int &item) {
+        if(n == count) {
+            return false;
+        }
+        time = n * gap;
+        item = ++n;
+        return true;
+    }
+
+private:
+    int n, count;
+    double gap;
+};
+
+/**
+ * Helper source for the Pipeline tests: count items, all arriving at time
+ * 0, with the number handed out so far shared with other threads.
+ */
+class CountedItems {
+public:
+    CountedItems(int count, std::atomic<int> &handedOut) : count(count),
+        handedOut(handedOut) { }
+
+    bool next(double &time, int &item) {
+        int n = handedOut.load();
+        if(n == count) {
+            return false;
+        }
+        time = 0.0;
+        item = n + 1;
+        handedOut.store(n + 1);
+        return true;
+    }
+
+private:
+    int count;
+    std::atomic<int> &handedOut;
+};
+
+} // anonymous
+
+// doctest unit tests for the Pipeline class
+TEST_CASE("testing Pipeline") {
+    // three stages as fast as possible; every item goes through each
+    std::atomic<long> total(0);
+    Pipeline<int> pipeline(8u);
+    pipeline.addStage("double", 2u, [](int &x) { x *= 2; return 0.0; });
+    pipeline.addStage("increment", 3u, [](int &x) { x += 1; return 0.0; });
+    pipeline.addStage("sum", 1u, [&](int &x) { total += x; return 0.0; });
+    CHECK(pipeline.stages() == 3u);
+    SpacedItems source(10000, 1.0);
+    PipelineStats stats = pipeline.run(source, PIPELINE_FAST);
+    CHECK(total == 10000L * 10001L + 10000L);
+    CHECK(stats.items == 10000u);
+    REQUIRE(stats.stages.size() == 3u);
+    CHECK(stats.stages[0].name == "double");
+    CHECK(stats.stages[1].workers == 3u);
+    for(const StageStats &st : stats.stages) {
+        CHECK(st.items == 10000u);
+        CHECK(st.maxQueue <= 8u);
+        CHECK(st.meanLatency >= st.meanWait);
+    }
+    CHECK(stats.itemsPerSecond() > 0.0);
+
+    // in real time, a slow last stage fills the queues and holds back the
+    // rest: items arrive every 0.1 ms but take 2 ms to serve
+    Pipeline<int> slow(2u);
+    slow.addStage("fast", 1u, [](int &) { return 0.1; });
+    slow.addStage("slow", 1u, [](int &) { return 2.0; });
+    SpacedItems burst(20, 0.1);
+    stats = slow.run(burst, PIPELINE_REAL_TIME, 0.001);
+    CHECK(stats.items == 20u);
+    CHECK(stats.seconds >= 20 * 0.002);
+    CHECK(stats.stages[0].maxQueue <= 2u);
+    CHECK(stats.stages[1].maxQueue <= 2u);
+    CHECK(stats.stages[0].blockedSeconds >= 0.0);
+    CHECK(stats.sourceBlockedSeconds >= 0.0);
+    CHECK(stats.stages[1].utilization <= 1.0);
+    CHECK(stats.maxLatency >= stats.meanLatency);
+
+    // backpressure, without depending on timing: the last stage holds item
+    // 1 until the source has handed out item 7. By then item 4 is in the
+    // first stage, both queues are full (items 5 and 6, and 2 and 3), and
+    // the source cannot hand out item 8 until the hold ends
+    std::atomic<int> handedOut(0), atRelease(0);
+    CountedItems counted(20, handedOut);
+    Pipeline<int> held(2u);
+    held.addStage("pass", 1u, [](int &) { return 0.0; });
+    held.addStage("hold", 1u, [&](int &x) {
+        if(x == 1) {
+            while(handedOut < 7) {
+                std::this_thread::yield();
+            }
+            atRelease = handedOut.load();
+        }
+        return 0.0;
+    });
+    stats = held.run(counted, PIPELINE_FAST);
+    CHECK(stats.items == 20u);
+    CHECK(atRelease == 7);
+    CHECK(stats.stages[0].maxQueue == 2u);
+    CHECK(stats.stages[1].maxQueue == 2u);
+
+    // check exception handling in the work and in the pipeline
+    Pipeline<int> broken;
+    broken.addStage("ok", 1u, [](int &) { return 0.0; });
+    broken.addStage("bad", 2u, [](int &x) {
+        if(x == 500) {
+            throw std::runtime_error("bad item");
+        }
+        return 0.0;
+    });
+    SpacedItems many(100000, 1.0);
+    bool flag = true;
+    try {
+        broken.run(many, PIPELINE_FAST);  // should throw an exception
+        flag = false;                     // should never happen
+    } catch(std::runtime_error re) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        Pipeline<int> empty;
+        empty.run(many, PIPELINE_FAST);  // should throw an exception
+        flag = false;                    // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        pipeline.addStage("none", 0u, [](int &) { return 0.0; });
+        flag = false;   // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+}
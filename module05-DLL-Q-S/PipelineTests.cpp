@@ -0,0 +1,4 @@
+// phantom C++ file for Pipeline unit testing. This file only includes the
+// Pipeline header; doctest generates the testing program based on unit
+// tests written alongside the code in the header file
+#include "Pipeline.hpp"
@@ -0,0 +1,791 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <doctest.h>
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief CMP 246 Module 5 generic priority queue.
+ *
+ * PriorityQueue keeps its elements in a d-ary heap stored in a vector: the
+ * children of element i are the D consecutive elements D * i + 1 to
+ * D * i + D, and no element comes before its parent. top() is an element
+ * that no other comes before, according to Compare: with the default
+ * std::less, the smallest element. (This is the opposite of
+ * std::priority_queue, whose top is the largest.)
+ *
+ * A wider heap is shallower, so adding an element takes fewer steps, and
+ * removing one visits fewer levels; each level compares D children, but
+ * they sit next to each other in memory, usually in one or two cache lines.
+ * D = 4 is a good choice for most element types.
+ *
+ * @tparam T Element type.
+ * @tparam Compare Function object type; Compare()(a, b) is true if a comes
+ * before b.
+ * @tparam D Number of children of each element, at least 2.
+ */
+template <class T, class Compare = std::less<T>, unsigned D = 4>
+class PriorityQueue {
+    static_assert(D >= 2u, "a heap needs at least two children per element");
+
+public:
+    /**
+     * @brief Default constructor.
+     *
+     * Create an empty queue.
+     *
+     * @param cmp Comparison function object.
+     */
+    explicit PriorityQueue(const Compare &cmp = Compare()) : cmp(cmp) { }
+
+    /**
+     * @brief Clear the queue.
+     */
+    void clear() { heap.clear(); }
+
+    /**
+     * @brief Determine if the queue is empty.
+     *
+     * @return true if the queue is empty, false otherwise.
+     */
+    bool empty() const { return heap.empty(); }
+
+    /**
+     * @brief Remove the first element.
+     *
+     * @throws std::out_of_range if the queue is empty.
+     */
+    void pop();
+
+    /**
+     * @brief Add an element.
+     *
+     * @param d Element to add.
+     */
+    void push(const T &d);
+
+    /**
+     * @brief Remove the first element and add another.
+     *
+     * Equivalent to pop() then push(d), with a single pass down the heap.
+     *
+     * @param d Element to add.
+     *
+     * @throws std::out_of_range if the queue is empty.
+     */
+    void replaceTop(const T &d);
+
+    /**
+     * @brief Reserve memory.
+     *
+     * @param n Number of elements to make room for.
+     */
+    void reserve(size_t n) { heap.reserve(n); }
+
+    /**
+     * @brief Get the number of elements.
+     *
+     * @return The number of elements in the queue.
+     */
+    size_t size() const { return heap.size(); }
+
+    /**
+     * @brief Get the first element.
+     *
+     * @throws std::out_of_range if the queue is empty.
+     *
+     * @return Reference to an element that no other comes before.
+     */
+    const T &top() const;
+
+private:
+    /**
+     * Helper method to fill the hole at index i with d, moving earlier
+     * children up as needed.
+     */
+    void siftDown(size_t i, const T &d);
+
+    /**
+     * The heap.
+     */
+    std::vector<T> heap;
+
+    /**
+     * Comparison function object.
+     */
+    Compare cmp;
+};
+
+/**
+ * @brief CMP 246 Module 5 generic indexed priority queue.
+ *
+ * IndexedPriorityQueue is a d-ary heap like PriorityQueue, except that each
+ * element is added with a handle, a number below the capacity given to the
+ * constructor, and can later be found, changed, or removed by that handle
+ * in O(log n) time. Changing an element to come earlier is the decrease-key
+ * operation of Dijkstra's and Prim's algorithms. A vector indexed by handle
+ * holds the position of each element in the heap, and the heap holds each
+ * element next to its handle, so comparisons never look elsewhere.
+ *
+ * @tparam T Element type.
+ * @tparam Compare Function object type; Compare()(a, b) is true if a comes
+ * before b.
+ * @tparam D Number of children of each element, at least 2.
+ */
+template <class T, class Compare = std::less<T>, unsigned D = 4>
+class IndexedPriorityQueue {
+    static_assert(D >= 2u, "a heap needs at least two children per element");
+
+public:
+    /**
+     * @brief Initializing constructor.
+     *
+     * Create an empty queue.
+     *
+     * @param capacity Handles must be less than this.
+     * @param cmp Comparison function object.
+     */
+    explicit IndexedPriorityQueue(size_t capacity,
+        const Compare &cmp = Compare()) : pos(capacity, NONE), cmp(cmp) { }
+
+    /**
+     * @brief Get the capacity.
+     *
+     * @return One more than the largest handle.
+     */
+    size_t capacity() const { return pos.size(); }
+
+    /**
+     * @brief Determine if there is an element with a handle.
+     *
+     * @param h Handle to look for.
+     *
+     * @return true if the queue has an element with handle h.
+     */
+    bool contains(size_t h) const { return h < pos.size() && pos[h] != NONE; }
+
+    /**
+     * @brief Change an element to one that comes no later.
+     *
+     * Like update(), but only moves the element toward the top.
+     *
+     * @param h Handle of the element.
+     * @param d New value for the element.
+     *
+     * @throws std::out_of_range if there is no element with handle h.
+     * @throws std::invalid_argument if d comes after the current value.
+     */
+    void decreaseKey(size_t h, const T &d);
+
+    /**
+     * @brief Determine if the queue is empty.
+     *
+     * @return true if the queue is empty, false otherwise.
+     */
+    bool empty() const { return heap.empty(); }
+
+    /**
+     * @brief Get an element by handle.
+     *
+     * @param h Handle of the element.
+     *
+     * @throws std::out_of_range if there is no element with handle h.
+     *
+     * @return Reference to the element.
+     */
+    const T &get(size_t h) const;
+
+    /**
+     * @brief Remove the first element.
+     *
+     * @throws std::out_of_range if the queue is empty.
+     */
+    void pop();
+
+    /**
+     * @brief Add an element.
+     *
+     * @param h Handle for the element.
+     * @param d Element to add.
+     *
+     * @throws std::out_of_range if h is not less than capacity().
+     * @throws std::invalid_argument if there already is an element with
+     * handle h.
+     */
+    void push(size_t h, const T &d);
+
+    /**
+     * @brief Remove an element by handle.
+     *
+     * @param h Handle of the element.
+     *
+     * @throws std::out_of_range if there is no element with handle h.
+     */
+    void remove(size_t h);
+
+    /**
+     * @brief Get the number of elements.
+     *
+     * @return The number of elements in the queue.
+     */
+    size_t size() const { return heap.size(); }
+
+    /**
+     * @brief Get the first element.
+     *
+     * @throws std::out_of_range if the queue is empty.
+     *
+     * @return Reference to an element that no other comes before.
+     */
+    const T &top() const;
+
+    /**
+     * @brief Get the handle of the first element.
+     *
+     * @throws std::out_of_range if the queue is empty.
+     *
+     * @return Handle of top().
+     */
+    size_t topHandle() const;
+
+    /**
+     * @brief Change an element.
+     *
+     * The element moves toward the top or the bottom of the heap as needed.
+     *
+     * @param h Handle of the element.
+     * @param d New value for the element.
+     *
+     * @throws std::out_of_range if there is no element with handle h.
+     */
+    void update(size_t h, const T &d);
+
+private:
+    /**
+     * Position of an absent handle.
+     */
+    static const size_t NONE = ~size_t(0);
+
+    /**
+     * An element and its handle.
+     */
+    struct Entry {
+        T value;
+        size_t handle;
+    };
+
+    /**
+     * Helper method to fill the hole at index i with e, moving parents
+     * down as needed.
+     */
+    void siftUp(size_t i, const Entry &e);
+
+    /**
+     * Helper method to fill the hole at index i with e, moving earlier
+     * children up as needed.
+     */
+    void siftDown(size_t i, const Entry &e);
+
+    /**
+     * Helper method to remove the entry at index i.
+     */
+    void removeAt(size_t i);
+
+    /**
+     * The heap of elements and handles.
+     */
+    std::vector<Entry> heap;
+
+    /**
+     * Position of each handle in the heap, or NONE.
+     */
+    std::vector<size_t> pos;
+
+    /**
+     * Comparison function object.
+     */
+    Compare cmp;
+};
+
+/*-----------------------------------------------------------------------------
+ * PriorityQueue method implementations
+ *---------------------------------------------------------------------------*/
+
+/*
+ * Fill the hole at the root with the last element.
+ */
+template <class T, class Compare, unsigned D>
+inline void PriorityQueue<T, Compare, D>::pop() {
+    if(heap.empty()) {
+        throw std::out_of_range("Empty queue in PriorityQueue::pop()");
+    }
+
+    T last = std::move(heap.back());
+    heap.pop_back();
+    if(!heap.empty()) {
+        siftDown(0u, last);
+    }
+}
+
+/*
+ * Move the hole up from the new last element to the place for d. d may be
+ * an element of the heap, as in push(top()), so it is copied before the
+ * vector grows.
+ */
+template <class T, class Compare, unsigned D>
+inline void PriorityQueue<T, Compare, D>::push(const T &d) {
+    T value(d);
+    size_t i = heap.size();
+    heap.push_back(value);
+    while(i > 0u) {
+        size_t parent = (i - 1u) / D;
+        if(!cmp(value, heap[parent])) {
+            break;
+        }
+        heap[i] = std::move(heap[parent]);
+        i = parent;
+    }
+    heap[i] = std::move(value);
+}
+
+/*
+ * Fill the hole at the root with the new element.
+ */
+template <class T, class Compare, unsigned D>
+inline void PriorityQueue<T, Compare, D>::replaceTop(const T &d) {
+    if(heap.empty()) {
+        throw std::out_of_range("Empty queue in PriorityQueue::replaceTop()");
+    }
+
+    siftDown(0u, d);
+}
+
+/*
+ * Move the hole down, one level per pass, to the place for d. Parents with
+ * all D children take a loop of fixed length, which the compiler unrolls.
+ */
+template <class T, class Compare, unsigned D>
+inline void PriorityQueue<T, Compare, D>::siftDown(size_t i, const T &d) {
+    size_t n = heap.size();
+    size_t first = D * i + 1u;
+    while(first + D <= n) {
+        // the earliest of the children, picked without a branch
+        size_t best = first;
+        for(unsigned c = 1u; c < D; c++) {
+            best += (first + c - best) * cmp(heap[first + c], heap[best]);
+        }
+        if(!cmp(heap[best], d)) {
+            heap[i] = d;
+            return;
+        }
+        heap[i] = std::move(heap[best]);
+        i = best;
+        first = D * i + 1u;
+    }
+
+    // a last parent with fewer than D children
+    if(first < n) {
+        size_t best = first;
+        for(size_t c = first + 1u; c < n; c++) {
+            best = cmp(heap[c], heap[best]) ? c : best;
+        }
+        if(cmp(heap[best], d)) {
+            heap[i] = std::move(heap[best]);
+            i = best;
+        }
+    }
+    heap[i] = d;
+}
+
+/*
+ * Get the root.
+ */
+template <class T, class Compare, unsigned D>
+inline const T &PriorityQueue<T, Compare, D>::top() const {
+    if(heap.empty()) {
+        throw std::out_of_range("Empty queue in PriorityQueue::top()");
+    }
+
+    return heap[0];
+}
+
+// doctest unit tests for PriorityQueue
+TEST_CASE("testing PriorityQueue") {
+    PriorityQueue<int> queue;
+    CHECK(queue.empty());
+
+    // elements come out smallest first, for any arity
+    int values[] = { 5, 3, 8, 1, 9, 2, 7, 3, 6, 0, 4 };
+    for(int v : values) {
+        queue.push(v);
+    }
+    CHECK(queue.size() == 11u);
+    int expected[] = { 0, 1, 2, 3, 3, 4, 5, 6, 7, 8, 9 };
+    for(int e : expected) {
+        CHECK(queue.top() == e);
+        queue.pop();
+    }
+    CHECK(queue.empty());
+
+    PriorityQueue<unsigned, std::greater<unsigned>, 2> binary;
+    PriorityQueue<unsigned, std::less<unsigned>, 7> wide;
+    unsigned state = 246u;
+    for(int i = 0; i < 1000; i++) {
+        state = state * 1103515245u + 12345u;
+        binary.push(state >> 8);
+        wide.push(state >> 8);
+    }
+    unsigned prevB = binary.top(), prevW = wide.top();
+    for(int i = 0; i < 1000; i++) {
+        CHECK(binary.top() <= prevB);
+        CHECK(wide.top() >= prevW);
+        prevB = binary.top();
+        prevW = wide.top();
+        if(i % 3 == 0 && i < 900) {
+            // replacing the top with a later element keeps the order
+            wide.replaceTop(wide.top() + 1000u);
+        } else {
+            wide.pop();
+        }
+        binary.pop();
+    }
+
+    // pushing an element of the queue itself, while the vector grows
+    PriorityQueue<std::string> words;
+    words.push("mango");
+    for(int i = 0; i < 20; i++) {
+        words.push(words.top());
+    }
+    words.push("apple");
+    REQUIRE(words.size() == 22u);
+    CHECK(words.top() == "apple");
+    words.pop();
+    for(int i = 0; i < 21; i++) {
+        CHECK(words.top() == "mango");
+        words.pop();
+    }
+
+    // check exception handling
+    bool flag = true;
+    try {
+        queue.pop();    // should throw an exception
+        flag = false;   // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        queue.top();    // should throw an exception
+        flag = false;   // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * IndexedPriorityQueue method implementations
+ *---------------------------------------------------------------------------*/
+
+template <class T, class Compare, unsigned D>
+const size_t IndexedPriorityQueue<T, Compare, D>::NONE;
+
+/*
+ * Move an element up only.
+ */
+template <class T, class Compare, unsigned D>
+void IndexedPriorityQueue<T, Compare, D>::decreaseKey(size_t h, const T &d) {
+    if(!contains(h)) {
+        throw std::out_of_range(
+            "No such handle in IndexedPriorityQueue::decreaseKey()");
+    }
+    size_t i = pos[h];
+    if(cmp(heap[i].value, d)) {
+        throw std::invalid_argument(
+            "Later value in IndexedPriorityQueue::decreaseKey()");
+    }
+
+    Entry e = { d, h };
+    siftUp(i, e);
+}
+
+/*
+ * Look up an element.
+ */
+template <class T, class Compare, unsigned D>
+const T &IndexedPriorityQueue<T, Compare, D>::get(size_t h) const {
+    if(!contains(h)) {
+        throw std::out_of_range("No such handle in IndexedPriorityQueue::get()");
+    }
+
+    return heap[pos[h]].value;
+}
+
+/*
+ * Remove the root.
+ */
+template <class T, class Compare, unsigned D>
+void IndexedPriorityQueue<T, Compare, D>::pop() {
+    if(heap.empty()) {
+        throw std::out_of_range("Empty queue in IndexedPriorityQueue::pop()");
+    }
+
+    removeAt(0u);
+}
+
+/*
+ * Add an element at the bottom and move it up.
+ */
+template <class T, class Compare, unsigned D>
+void IndexedPriorityQueue<T, Compare, D>::push(size_t h, const T &d) {
+    if(h >= pos.size()) {
+        throw std::out_of_range(
+            "Handle out of range in IndexedPriorityQueue::push()");
+    }
+    if(pos[h] != NONE) {
+        throw std::invalid_argument(
+            "Handle in use in IndexedPriorityQueue::push()");
+    }
+
+    Entry e = { d, h };
+    heap.push_back(e);
+    siftUp(heap.size() - 1u, e);
+}
+
+/*
+ * Remove an element by handle.
+ */
+template <class T, class Compare, unsigned D>
+void IndexedPriorityQueue<T, Compare, D>::remove(size_t h) {
+    if(!contains(h)) {
+        throw std::out_of_range(
+            "No such handle in IndexedPriorityQueue::remove()");
+    }
+
+    removeAt(pos[h]);
+}
+
+/*
+ * Fill the hole at index i with the last entry, which may need to move
+ * either way.
+ */
+template <class T, class Compare, unsigned D>
+void IndexedPriorityQueue<T, Compare, D>::removeAt(size_t i) {
+    pos[heap[i].handle] = NONE;
+    Entry last = heap.back();
+    heap.pop_back();
+    if(i == heap.size()) {
+        return;
+    }
+    if(i > 0u && cmp(last.value, heap[(i - 1u) / D].value)) {
+        siftUp(i, last);
+    } else {
+        siftDown(i, last);
+    }
+}
+
+/*
+ * Move the hole down, one level per pass, to the place for e.
+ */
+template <class T, class Compare, unsigned D>
+void IndexedPriorityQueue<T, Compare, D>::siftDown(size_t i, const Entry &e) {
+    size_t n = heap.size();
+    for(;;) {
+        size_t first = D * i + 1u;
+        if(first >= n) {
+            break;
+        }
+
+        // the earliest of the children
+        size_t last = (n - first < D) ? n : first + D;
+        size_t best = first;
+        for(size_t c = first + 1u; c < last; c++) {
+            best = cmp(heap[c].value, heap[best].value) ? c : best;
+        }
+        if(!cmp(heap[best].value, e.value)) {
+            break;
+        }
+        heap[i] = heap[best];
+        pos[heap[i].handle] = i;
+        i = best;
+    }
+    heap[i] = e;
+    pos[e.handle] = i;
+}
+
+/*
+ * Move the hole up to the place for e.
+ */
+template <class T, class Compare, unsigned D>
+void IndexedPriorityQueue<T, Compare, D>::siftUp(size_t i, const Entry &e) {
+    while(i > 0u) {
+        size_t parent = (i - 1u) / D;
+        if(!cmp(e.value, heap[parent].value)) {
+            break;
+        }
+        heap[i] = heap[parent];
+        pos[heap[i].handle] = i;
+        i = parent;
+    }
+    heap[i] = e;
+    pos[e.handle] = i;
+}
+
+/*
+ * Get the root.
+ */
+template <class T, class Compare, unsigned D>
+const T &IndexedPriorityQueue<T, Compare, D>::top() const {
+    if(heap.empty()) {
+        throw std::out_of_range("Empty queue in IndexedPriorityQueue::top()");
+    }
+
+    return heap[0].value;
+}
+
+/*
+ * Get the root's handle.
+ */
+template <class T, class Compare, unsigned D>
+size_t IndexedPriorityQueue<T, Compare, D>::topHandle() const {
+    if(heap.empty()) {
+        throw std::out_of_range(
+            "Empty queue in IndexedPriorityQueue::topHandle()");
+    }
+
+    return heap[0].handle;
+}
+
+/*
+ * Change an element, moving it whichever way it needs to go.
+ */
+template <class T, class Compare, unsigned D>
+void IndexedPriorityQueue<T, Compare, D>::update(size_t h, const T &d) {
+    if(!contains(h)) {
+        throw std::out_of_range(
+            "No such handle in IndexedPriorityQueue::update()");
+    }
+
+    size_t i = pos[h];
+    Entry e = { d, h };
+    if(cmp(d, heap[i].value)) {
+        siftUp(i, e);
+    } else {
+        siftDown(i, e);
+    }
+}
+
+// doctest unit tests for IndexedPriorityQueue
+TEST_CASE("testing IndexedPriorityQueue") {
+    IndexedPriorityQueue<double> queue(10u);
+    CHECK(queue.capacity() == 10u);
+    for(size_t h = 0u; h < 10u; h++) {
+        queue.push(h, 100.0 - h);
+    }
+    CHECK(queue.size() == 10u);
+    CHECK(queue.topHandle() == 9u);
+    CHECK(queue.top() == 91.0);
+
+    // decrease-key moves an element to the top
+    queue.decreaseKey(3u, 50.0);
+    CHECK(queue.topHandle() == 3u);
+    CHECK(queue.get(3u) == 50.0);
+
+    // update can move an element either way
+    queue.update(3u, 200.0);
+    CHECK(queue.topHandle() == 9u);
+    queue.update(0u, 1.0);
+    CHECK(queue.topHandle() == 0u);
+
+    // remove takes an element out of the middle
+    queue.remove(5u);
+    CHECK(!queue.contains(5u));
+    CHECK(queue.size() == 9u);
+
+    // everything else comes out in order
+    size_t order[] = { 0u, 9u, 8u, 7u, 6u, 4u, 2u, 1u, 3u };
+    for(size_t h : order) {
+        CHECK(queue.topHandle() == h);
+        queue.pop();
+        CHECK(!queue.contains(h));
+    }
+    CHECK(queue.empty());
+
+    // handles can be reused once their element is gone
+    queue.push(0u, 7.0);
+    CHECK(queue.top() == 7.0);
+
+    // check exception handling
+    bool flag = true;
+    try {
+        queue.push(0u, 1.0);    // should throw an exception
+        flag = false;           // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        queue.push(10u, 1.0);   // should throw an exception
+        flag = false;           // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        queue.decreaseKey(0u, 8.0);     // should throw an exception
+        flag = false;                   // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        queue.get(1u);  // should throw an exception
+        flag = false;   // should never happen
+    } catch(std::out_of_range oor) {
+        CHECK(flag);
+    }
+}
+
+TEST_CASE("testing IndexedPriorityQueue against PriorityQueue") {
+    // random pushes, updates, and removes agree with a plain queue rebuilt
+    // from the surviving values
+    IndexedPriorityQueue<unsigned, std::less<unsigned>, 3> queue(200u);
+    std::vector<unsigned> values(200u, 0u);
+    unsigned state = 12345u;
+    for(int step = 0; step < 5000; step++) {
+        state = state * 1103515245u + 12345u;
+        size_t h = (state >> 8) % 200u;
+        unsigned v = (state >> 16) % 1000u;
+        if(!queue.contains(h)) {
+            queue.push(h, v);
+        } else if(step % 5 == 0) {
+            queue.remove(h);
+        } else {
+            queue.update(h, v);
+        }
+        if(queue.contains(h)) {
+            values[h] = v;
+        }
+    }
+
+    PriorityQueue<unsigned> plain;
+    for(size_t h = 0u; h < 200u; h++) {
+        if(queue.contains(h)) {
+            CHECK(queue.get(h) == values[h]);
+            plain.push(values[h]);
+        }
+    }
+    CHECK(plain.size() == queue.size());
+    while(!queue.empty()) {
+        CHECK(queue.top() == plain.top());
+        queue.pop();
+        plain.pop();
+    }
+}
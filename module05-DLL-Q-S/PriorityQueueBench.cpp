@@ -0,0 +1,177 @@
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <vector>
+#include "DLL.hpp"
+#include "Laundry.h"
+#include "PriorityQueue.hpp"
+#include "Rng.hpp"
+
+/**
+ * Helper function to make n random loads, with masses from 1 to 10 kg.
+ */
+std::vector<Laundry> randomLoads(size_t n, Xoshiro256ss &prng) {
+    std::vector<Laundry> loads(n);
+    for(size_t i = 0u; i < n; i++) {
+        float mass = 1.0f + 9.0f * unitReal<float>(prng());
+        loads[i] = Laundry(mass, 20.0f + 2.5f * mass, 30.0f + 4.0f * mass);
+    }
+    return loads;
+}
+
+/**
+ * Helper function to time f() and return the time per operation in ns,
+ * for ops operations.
+ */
+template <class F>
+double nsPerOp(size_t ops, F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / ops;
+}
+
+/**
+ * Helper function to add every load to a queue and take them all out
+ * again, lightest first; the masses are added to sink.
+ */
+template <class Q>
+void fillAndDrain(Q &queue, const std::vector<Laundry> &loads, double &sink) {
+    for(size_t i = 0u; i < loads.size(); i++) {
+        queue.push(loads[i]);
+    }
+    while(!queue.empty()) {
+        sink += queue.top().getMass();
+        queue.pop();
+    }
+}
+
+/**
+ * Helper function for the same with a sorted list: each load is inserted
+ * in front of the first heavier one, and the lightest is at the front.
+ */
+void fillAndDrain(DLL<Laundry> &list, const std::vector<Laundry> &loads,
+    double &sink) {
+    for(size_t i = 0u; i < loads.size(); i++) {
+        DLL<Laundry>::Iterator it = list.front();
+        while(it != list.end() && *it <= loads[i]) {
+            ++it;
+        }
+        list.insertBefore(it, loads[i]);
+    }
+    while(!list.isEmpty()) {
+        sink += list.removeFirst().getMass();
+    }
+}
+
+/**
+ * Helper function for the hold model: with the queue full, repeatedly
+ * take out the first load and put in a slightly heavier one, as a
+ * simulation does with its events.
+ */
+template <class Q>
+void hold(Q &queue, const std::vector<Laundry> &loads, size_t ops,
+    double &sink) {
+    for(size_t i = 0u; i < ops; i++) {
+        Laundry first = queue.top();
+        sink += first.getMass();
+        const Laundry &step = loads[i % loads.size()];
+        queue.pop();
+        queue.push(Laundry(first.getMass() + step.getMass(),
+            step.getWashTime(), step.getDryTime()));
+    }
+}
+
+/**
+ * Helper function for the hold model with replaceTop().
+ */
+template <class T, class C, unsigned D>
+void hold(PriorityQueue<T, C, D> &queue, const std::vector<Laundry> &loads,
+    size_t ops, double &sink) {
+    for(size_t i = 0u; i < ops; i++) {
+        Laundry first = queue.top();
+        sink += first.getMass();
+        const Laundry &step = loads[i % loads.size()];
+        queue.replaceTop(Laundry(first.getMass() + step.getMass(),
+            step.getWashTime(), step.getDryTime()));
+    }
+}
+
+/**
+ * Helper function to run both workloads on one kind of queue and print
+ * the times.
+ */
+template <class Q>
+void benchQueue(const char *name, const std::vector<Laundry> &loads,
+    double &sink) {
+    Q queue;
+    double fill = nsPerOp(loads.size(), [&]() {
+        fillAndDrain(queue, loads, sink);
+    });
+    for(size_t i = 0u; i < loads.size(); i++) {
+        queue.push(loads[i]);
+    }
+    size_t ops = 4000000u;
+    double steady = nsPerOp(ops, [&]() { hold(queue, loads, ops, sink); });
+    std::cout << "  " << name << fill << " ns/load to fill and drain, "
+        << steady << " ns/op to hold" << std::endl;
+}
+
+/**
+ * @brief Benchmark for PriorityQueue.
+ *
+ * This program times d-ary PriorityQueues of Laundry, ordered lightest
+ * first, against std::priority_queue and a sorted DLL, for queues of
+ * several sizes: filling the queue and draining it again, and holding it
+ * at a fixed size while loads are taken out and put back in. It also times
+ * decrease-key on an IndexedPriorityQueue.
+ */
+int main() {
+    typedef std::priority_queue<Laundry, std::vector<Laundry>,
+        std::greater<Laundry> > StdQueue;
+    Xoshiro256ss prng(246u);
+    const size_t sizes[] = { 1000u, 100000u, 1000000u };
+    double sink = 0.0;
+
+    for(size_t s = 0u; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        std::vector<Laundry> loads = randomLoads(n, prng);
+        std::cout << n << " loads:" << std::endl;
+        benchQueue<PriorityQueue<Laundry, std::less<Laundry>, 2> >(
+            "PriorityQueue, D = 2  ", loads, sink);
+        benchQueue<PriorityQueue<Laundry, std::less<Laundry>, 4> >(
+            "PriorityQueue, D = 4  ", loads, sink);
+        benchQueue<PriorityQueue<Laundry, std::less<Laundry>, 8> >(
+            "PriorityQueue, D = 8  ", loads, sink);
+        benchQueue<StdQueue>("std::priority_queue   ", loads, sink);
+        if(n <= 10000u) {
+            // quadratic, so small queues only
+            DLL<Laundry> list;
+            double fill = nsPerOp(n, [&]() {
+                fillAndDrain(list, loads, sink);
+            });
+            std::cout << "  sorted DLL            " << fill
+                << " ns/load to fill and drain" << std::endl;
+        }
+
+        // decrease-key on random loads, each made a little lighter
+        IndexedPriorityQueue<float> indexed(n);
+        for(size_t i = 0u; i < n; i++) {
+            indexed.push(i, loads[i].getMass());
+        }
+        size_t ops = 4000000u;
+        double dk = nsPerOp(ops, [&]() {
+            for(size_t i = 0u; i < ops; i++) {
+                size_t h = size_t(uniformBelow(prng, n));
+                indexed.decreaseKey(h, indexed.get(h) * 0.999f);
+            }
+        });
+        sink += indexed.top();
+        std::cout << "  indexed decreaseKey   " << dk << " ns/op" << std::endl;
+    }
+    std::cout << "checksum " << sink << std::endl;
+
+    return EXIT_SUCCESS;
+}
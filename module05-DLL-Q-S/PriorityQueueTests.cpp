@@ -0,0 +1,4 @@
+// phantom C++ file for PriorityQueue unit testing. This file only includes the
+// PriorityQueue header; doctest generates the testing program based on unit
+// tests written alongside the code in the header file
+#include "PriorityQueue.hpp"
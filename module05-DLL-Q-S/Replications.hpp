@@ -0,0 +1,324 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <doctest.h>
+#include "Laundromat.hpp"
+#include "Rng.hpp"
+
+/*-----------------------------------------------------------------------------
+ * declarations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Parameters of one laundromat simulation.
+ */
+struct Scenario {
+    /** Number of washers. */
+    unsigned washers;
+
+    /** Number of dryers. */
+    unsigned dryers;
+
+    /** Average number of loads arriving per hour. */
+    double arrivalsPerHour;
+
+    /** Number of loads per replication. */
+    uint64_t loads;
+
+    /** Order in which waiting loads get a washer. */
+    QueuePolicy policy;
+};
+
+/**
+ * @brief Mean of a statistic over several replications, with the half
+ * width of its 95% confidence interval.
+ */
+struct Interval {
+    /** Mean over the replications. */
+    double mean;
+
+    /** The true value is within mean +/- halfWidth with 95% confidence. */
+    double halfWidth;
+};
+
+/**
+ * @brief Statistics of one scenario over all its replications.
+ */
+struct ScenarioSummary {
+    /** The scenario. */
+    Scenario scenario;
+
+    /** Number of replications. */
+    unsigned replications;
+
+    /** Fraction of washer time spent washing. */
+    Interval washerUtilization;
+
+    /** Fraction of dryer time spent drying. */
+    Interval dryerUtilization;
+
+    /** Mean time from arrival until a washer is free, in minutes. */
+    Interval meanWashWait;
+
+    /** Mean time from washing until a dryer is free, in minutes. */
+    Interval meanDryWait;
+
+    /** Mean time from arrival until the end of drying, in minutes. */
+    Interval meanTimeInSystem;
+};
+
+/**
+ * @brief Results of a set of replications.
+ */
+struct ReplicationResults {
+    /** One summary per scenario, in the order the scenarios were given. */
+    std::vector<ScenarioSummary> scenarios;
+
+    /** Results of every replication, scenario by scenario. */
+    std::vector<LaundromatStats> runs;
+
+    /** Total number of loads simulated. */
+    uint64_t loads;
+
+    /** Number of threads used. */
+    unsigned threads;
+
+    /** Wall-clock time taken, in seconds. */
+    double seconds;
+
+    /**
+     * @brief Simulation speed.
+     *
+     * @return Loads simulated per second of wall-clock time, over all
+     * threads.
+     */
+    double loadsPerSecond() const { return loads / seconds; }
+};
+
+/**
+ * @brief Run independent replications of laundromat simulations in
+ * parallel.
+ *
+ * Each scenario is simulated replications times, with PoissonLoads. Every
+ * replication has its own random number stream, split off one generator
+ * seeded with seed, so the replications are independent and the results
+ * do not depend on the number of threads or on the order in which the
+ * replications run.
+ *
+ * The replications run on a pool of worker threads. Each worker takes the
+ * next replication from a shared atomic counter, runs it, and writes its
+ * results to a slot of its own, so the workers share no other mutable
+ * state and never wait for each other until the end. The longest
+ * replications are handed out first, so that scenarios of different sizes
+ * still keep every thread busy until close to the end.
+ *
+ * @param scenarios Scenarios to simulate.
+ * @param replications Number of replications of each scenario.
+ * @param seed Seed for the random numbers.
+ * @param numThreads Number of worker threads, or 0 for one per hardware
+ * core.
+ *
+ * @throws std::invalid_argument if replications is less than 2, or a
+ * scenario has no washers or no dryers.
+ *
+ * @return A summary per scenario, and the results of every replication.
+ */
+ReplicationResults runReplications(const std::vector<Scenario> &scenarios,
+    unsigned replications, uint64_t seed, unsigned numThreads = 0u);
+
+/*-----------------------------------------------------------------------------
+ * function implementations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Helper function for the 97.5th percentile of Student's t distribution
+ * with df degrees of freedom: exact to six digits from a table up to 30,
+ * and from the Cornish-Fisher expansion beyond.
+ */
+inline double studentT95(unsigned df) {
+    static const double TABLE[30] = { 12.706205, 4.302653, 3.182446,
+        2.776445, 2.570582, 2.446912, 2.364624, 2.306004, 2.262157, 2.228139,
+        2.200985, 2.178813, 2.160369, 2.144787, 2.131450, 2.119905, 2.109816,
+        2.100922, 2.093024, 2.085963, 2.079614, 2.073873, 2.068658, 2.063899,
+        2.059539, 2.055529, 2.051831, 2.048407, 2.045230, 2.042272 };
+    if(df == 0u) {
+        throw std::invalid_argument("no degrees of freedom in studentT95()");
+    }
+    if(df <= 30u) {
+        return TABLE[df - 1u];
+    }
+    const double z = 1.959964;
+    double z3 = z * z * z, z5 = z3 * z * z;
+    return z + (z3 + z) / (4.0 * df) +
+        (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * df * df);
+}
+
+/**
+ * Helper function for the mean and confidence interval of one statistic
+ * over n runs, picked out of each run by get.
+ */
+template <class G>
+Interval summarize(const LaundromatStats *runs, unsigned n, G get) {
+    double sum = 0.0;
+    for(unsigned r = 0u; r < n; r++) {
+        sum += get(runs[r]);
+    }
+    double mean = sum / n;
+    double sumSq = 0.0;
+    for(unsigned r = 0u; r < n; r++) {
+        double d = get(runs[r]) - mean;
+        sumSq += d * d;
+    }
+    Interval result = { mean,
+        studentT95(n - 1u) * std::sqrt(sumSq / (n - 1u) / n) };
+    return result;
+}
+
+/*
+ * Hand out the replications from an atomic counter, longest first.
+ */
+inline ReplicationResults runReplications(
+    const std::vector<Scenario> &scenarios, unsigned replications,
+    uint64_t seed, unsigned numThreads) {
+    if(replications < 2u) {
+        throw std::invalid_argument(
+            "need two replications in runReplications()");
+    }
+    for(size_t s = 0u; s < scenarios.size(); s++) {
+        if(scenarios[s].washers == 0u || scenarios[s].dryers == 0u) {
+            throw std::invalid_argument(
+                "need a washer and a dryer in runReplications()");
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    // one stream per replication, in a fixed order
+    size_t jobs = scenarios.size() * replications;
+    std::vector<Xoshiro256ss> streams;
+    streams.reserve(jobs);
+    Xoshiro256ss parent(seed);
+    for(size_t j = 0u; j < jobs; j++) {
+        streams.push_back(parent.split());
+    }
+    std::vector<size_t> order(jobs);
+    for(size_t j = 0u; j < jobs; j++) {
+        order[j] = j;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return scenarios[a / replications].loads >
+            scenarios[b / replications].loads;
+    });
+
+    if(numThreads == 0u) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    numThreads = numThreads == 0u ? 1u : numThreads;
+    numThreads = size_t(numThreads) > jobs ? unsigned(jobs) : numThreads;
+
+    ReplicationResults results;
+    results.runs.resize(jobs);
+    std::atomic<size_t> next(0u);
+    std::vector<std::thread> workers;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        workers.push_back(std::thread([&]() {
+            for(size_t i = next++; i < jobs; i = next++) {
+                size_t j = order[i];
+                const Scenario &sc = scenarios[j / replications];
+                PoissonLoads loads(sc.arrivalsPerHour, sc.loads, streams[j]);
+                results.runs[j] = simulateLaundromat(sc.washers, sc.dryers,
+                    loads, sc.policy);
+            }
+        }));
+    }
+    for(unsigned t = 0u; t < numThreads; t++) {
+        workers[t].join();
+    }
+
+    results.loads = 0u;
+    for(size_t s = 0u; s < scenarios.size(); s++) {
+        const LaundromatStats *runs = results.runs.data() + s * replications;
+        ScenarioSummary sum;
+        sum.scenario = scenarios[s];
+        sum.replications = replications;
+        sum.washerUtilization = summarize(runs, replications,
+            [](const LaundromatStats &st) { return st.washerUtilization; });
+        sum.dryerUtilization = summarize(runs, replications,
+            [](const LaundromatStats &st) { return st.dryerUtilization; });
+        sum.meanWashWait = summarize(runs, replications,
+            [](const LaundromatStats &st) { return st.meanWashWait; });
+        sum.meanDryWait = summarize(runs, replications,
+            [](const LaundromatStats &st) { return st.meanDryWait; });
+        sum.meanTimeInSystem = summarize(runs, replications,
+            [](const LaundromatStats &st) { return st.meanTimeInSystem; });
+        results.scenarios.push_back(sum);
+        results.loads += scenarios[s].loads * replications;
+    }
+    results.threads = numThreads;
+    auto stop = std::chrono::steady_clock::now();
+    results.seconds = std::chrono::duration<double>(stop - start).count();
+    return results;
+}
+
+// doctest unit tests for the replications
+TEST_CASE("testing studentT95") {
+    CHECK(studentT95(1u) == doctest::Approx(12.706205));
+    CHECK(studentT95(15u) == doctest::Approx(2.131450));
+    CHECK(studentT95(31u) == doctest::Approx(2.039513).epsilon(1e-4));
+    CHECK(studentT95(120u) == doctest::Approx(1.979930).epsilon(1e-5));
+    CHECK(studentT95(1000000u) == doctest::Approx(1.959964));
+}
+
+TEST_CASE("testing runReplications") {
+    std::vector<Scenario> scenarios;
+    Scenario busy = { 2u, 3u, 3.0, 2000u, POLICY_FIRST_COME };
+    Scenario quiet = { 20u, 30u, 4.0, 500u, POLICY_SHORTEST_TOTAL };
+    scenarios.push_back(busy);
+    scenarios.push_back(quiet);
+
+    // the results don't depend on the number of threads
+    ReplicationResults one = runReplications(scenarios, 8u, 246u, 1u);
+    ReplicationResults three = runReplications(scenarios, 8u, 246u, 3u);
+    CHECK(one.runs.size() == 16u);
+    CHECK(one.loads == 8u * 2500u);
+    CHECK(three.threads == 3u);
+    for(size_t j = 0u; j < one.runs.size(); j++) {
+        CHECK(one.runs[j].meanTimeInSystem == three.runs[j].meanTimeInSystem);
+    }
+
+    // the replications are independent of each other
+    CHECK(one.runs[0].meanTimeInSystem != one.runs[1].meanTimeInSystem);
+
+    // the summaries are in scenario order, and a quiet laundromat has no
+    // waits; the busy one has its washers 84% utilized
+    CHECK(one.scenarios.size() == 2u);
+    CHECK(one.scenarios[0].scenario.washers == 2u);
+    CHECK(one.scenarios[0].meanWashWait.mean > 0.0);
+    CHECK(one.scenarios[0].meanWashWait.halfWidth > 0.0);
+    CHECK(one.scenarios[0].washerUtilization.mean ==
+        doctest::Approx(3.0 * 33.75 / 60.0 / 2.0).epsilon(0.05));
+    CHECK(one.scenarios[1].meanWashWait.mean == 0.0);
+    CHECK(one.scenarios[1].meanWashWait.halfWidth == 0.0);
+
+    // the means are the means of the runs
+    double sum = 0.0;
+    for(size_t r = 0u; r < 8u; r++) {
+        sum += one.runs[r].dryerUtilization;
+    }
+    CHECK(one.scenarios[0].dryerUtilization.mean == doctest::Approx(sum / 8));
+
+    // check exception handling
+    bool flag = true;
+    try {
+        runReplications(scenarios, 1u, 246u);  // should throw an exception
+        flag = false;                           // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+}
@@ -0,0 +1,4 @@
+// phantom C++ file for Replications unit testing. This file only includes the
+// Replications header; doctest generates the testing program based on unit
+// tests written alongside the code in the header file
+#include "Replications.hpp"
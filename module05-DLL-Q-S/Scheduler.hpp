@@ -0,0 +1,913 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <doctest.h>
+#include "Laundry.h"
+
+/*-----------------------------------------------------------------------------
+ * declarations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Where and when one load is washed and dried.
+ */
+struct Assignment {
+    /** Index of the washer. */
+    unsigned washer;
+
+    /** Time the load starts washing. */
+    double washStart;
+
+    /** Index of the dryer. */
+    unsigned dryer;
+
+    /** Time the load starts drying. */
+    double dryStart;
+};
+
+/**
+ * @brief Schedule of a batch of loads on a laundromat's washers and dryers.
+ *
+ * Every load is there from time 0, washes on one washer, then dries on one
+ * dryer. The makespan is the time the last load finishes drying.
+ */
+struct Schedule {
+    /** Indexes of the loads, in the order they get washers and dryers. */
+    std::vector<size_t> order;
+
+    /** Assignment of each load, indexed like the loads. */
+    std::vector<Assignment> loads;
+
+    /** Time the last load finishes drying. */
+    double makespan;
+
+    /** True if no permutation schedule has a smaller makespan. */
+    bool optimal;
+
+    /** Number of search nodes visited, for branch and bound. */
+    uint64_t nodes;
+};
+
+/**
+ * @brief Schedule loads in a given order.
+ *
+ * This is the decoder the other schedulers share: the loads are taken in
+ * order, and each one washes on the washer that is free first, then dries
+ * on the dryer that is free first, as soon as both it and the dryer are
+ * ready. Every load takes the machines in the same order, so this is a
+ * permutation schedule; with one washer and one dryer, the best
+ * permutation schedule is the best schedule.
+ *
+ * @param loads The loads.
+ * @param order Indexes of the loads, each exactly once.
+ * @param washers Number of washers.
+ * @param dryers Number of dryers.
+ *
+ * @throws std::invalid_argument if there are no washers or no dryers, or
+ * order is not an ordering of the loads.
+ *
+ * @return The schedule; it is marked optimal only if its makespan equals
+ * makespanLowerBound().
+ */
+Schedule scheduleInOrder(const std::vector<Laundry> &loads,
+    const std::vector<size_t> &order, unsigned washers, unsigned dryers);
+
+/**
+ * @brief Lower bound on the makespan of any schedule.
+ *
+ * The largest of: the longest load's washing plus drying time; the
+ * washing time of all the loads shared among the washers, plus the
+ * shortest drying time; and the shortest washing time, plus the drying
+ * time of all the loads shared among the dryers.
+ *
+ * @param loads The loads.
+ * @param washers Number of washers.
+ * @param dryers Number of dryers.
+ *
+ * @throws std::invalid_argument if there are no washers or no dryers.
+ *
+ * @return The lower bound; 0 if there are no loads.
+ */
+double makespanLowerBound(const std::vector<Laundry> &loads, unsigned washers,
+    unsigned dryers);
+
+/**
+ * @brief Schedule loads in the order of Johnson's rule.
+ *
+ * Loads that wash faster than they dry go first, shortest wash first, then
+ * the rest, longest dry first, so the dryers start early and the washers
+ * finish with loads that dry fast. With one washer and one dryer this is
+ * optimal, and takes O(n log n) time. With more machines, the times are
+ * compared per machine (washing time over washers, drying time over
+ * dryers), which is a good heuristic.
+ *
+ * @param loads The loads.
+ * @param washers Number of washers.
+ * @param dryers Number of dryers.
+ *
+ * @throws std::invalid_argument if there are no washers or no dryers.
+ *
+ * @return The schedule.
+ */
+Schedule johnsonSchedule(const std::vector<Laundry> &loads, unsigned washers,
+    unsigned dryers);
+
+/**
+ * @brief Schedule loads longest processing time first: by washing plus
+ * drying time, longest first, so the short loads fill the gaps at the end.
+ *
+ * @param loads The loads.
+ * @param washers Number of washers.
+ * @param dryers Number of dryers.
+ *
+ * @throws std::invalid_argument if there are no washers or no dryers.
+ *
+ * @return The schedule.
+ */
+Schedule lptSchedule(const std::vector<Laundry> &loads, unsigned washers,
+    unsigned dryers);
+
+/**
+ * @brief Find a best permutation schedule by parallel branch and bound.
+ *
+ * The search starts from the better of johnsonSchedule() and lptSchedule(),
+ * improved by moving loads one at a time, and extends orders a load at a
+ * time, in Johnson order. It drops every partial order whose lower bound
+ * is no better than the best schedule so far, or that leaves the machines
+ * free no earlier than another order of the same loads already did. Loads
+ * with the same times are interchangeable, so only one order of them is
+ * tried. The partial orders of two loads are handed out to the threads
+ * from an atomic counter, and the threads share the best makespan, so a
+ * good schedule found by one prunes the search of the others.
+ *
+ * The search takes exponential time in the worst case: it is meant for
+ * batches of a dozen loads or so. If it visits maxNodes nodes
+ * first, it stops, and returns the best schedule found, not marked
+ * optimal. The makespan of a finished search does not depend on the number
+ * of threads, but which of several best schedules is returned may.
+ *
+ * @param loads The loads.
+ * @param washers Number of washers.
+ * @param dryers Number of dryers.
+ * @param numThreads Number of threads, or 0 for one per hardware core.
+ * @param maxNodes Most nodes to visit.
+ *
+ * @throws std::invalid_argument if there are no washers or no dryers, or
+ * more than 64 loads.
+ *
+ * @return The schedule.
+ */
+Schedule branchAndBoundSchedule(const std::vector<Laundry> &loads,
+    unsigned washers, unsigned dryers, unsigned numThreads = 0u,
+    uint64_t maxNodes = 100000000u);
+
+/*-----------------------------------------------------------------------------
+ * function implementations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Helper function to check the number of machines.
+ */
+inline void checkMachines(unsigned washers, unsigned dryers,
+    const char *where) {
+    if(washers == 0u || dryers == 0u) {
+        throw std::invalid_argument(
+            std::string("need a washer and a dryer in ") + where);
+    }
+}
+
+/**
+ * Helper function for the index of the machine that is free first.
+ */
+inline unsigned firstFree(const std::vector<double> &free) {
+    unsigned best = 0u;
+    for(unsigned m = 1u; m < free.size(); m++) {
+        best = free[m] < free[best] ? m : best;
+    }
+    return best;
+}
+
+/*
+ * Greedy dispatch to the machine free first, at each stage.
+ */
+inline Schedule scheduleInOrder(const std::vector<Laundry> &loads,
+    const std::vector<size_t> &order, unsigned washers, unsigned dryers) {
+    checkMachines(washers, dryers, "scheduleInOrder()");
+    std::vector<bool> seen(loads.size(), false);
+    bool valid = order.size() == loads.size();
+    for(size_t i = 0u; valid && i < order.size(); i++) {
+        valid = order[i] < loads.size() && !seen[order[i]];
+        if(valid) {
+            seen[order[i]] = true;
+        }
+    }
+    if(!valid) {
+        throw std::invalid_argument("not an ordering in scheduleInOrder()");
+    }
+
+    Schedule s;
+    s.order = order;
+    s.loads.resize(loads.size());
+    s.makespan = 0.0;
+    s.nodes = 0u;
+    std::vector<double> washFree(washers, 0.0), dryFree(dryers, 0.0);
+    for(size_t i = 0u; i < order.size(); i++) {
+        const Laundry &load = loads[order[i]];
+        Assignment &a = s.loads[order[i]];
+        a.washer = firstFree(washFree);
+        a.washStart = washFree[a.washer];
+        double washed = a.washStart + load.getWashTime();
+        washFree[a.washer] = washed;
+        a.dryer = firstFree(dryFree);
+        a.dryStart = std::max(washed, dryFree[a.dryer]);
+        dryFree[a.dryer] = a.dryStart + load.getDryTime();
+        s.makespan = std::max(s.makespan, dryFree[a.dryer]);
+    }
+    s.optimal = s.makespan <= makespanLowerBound(loads, washers, dryers);
+    return s;
+}
+
+/*
+ * Three bounds: one load alone, the washers' work, the dryers' work.
+ */
+inline double makespanLowerBound(const std::vector<Laundry> &loads,
+    unsigned washers, unsigned dryers) {
+    checkMachines(washers, dryers, "makespanLowerBound()");
+    if(loads.empty()) {
+        return 0.0;
+    }
+    double washSum = 0.0, drySum = 0.0, longest = 0.0;
+    double minWash = loads[0].getWashTime(), minDry = loads[0].getDryTime();
+    for(size_t i = 0u; i < loads.size(); i++) {
+        double w = loads[i].getWashTime(), d = loads[i].getDryTime();
+        washSum += w;
+        drySum += d;
+        longest = std::max(longest, w + d);
+        minWash = std::min(minWash, w);
+        minDry = std::min(minDry, d);
+    }
+    return std::max(longest, std::max(washSum / washers + minDry,
+        minWash + drySum / dryers));
+}
+
+/**
+ * Helper function for the Johnson order of the loads, with times per
+ * machine.
+ */
+inline std::vector<size_t> johnsonOrder(const std::vector<Laundry> &loads,
+    unsigned washers, unsigned dryers) {
+    std::vector<size_t> order(loads.size());
+    for(size_t i = 0u; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        double wa = double(loads[a].getWashTime()) / washers;
+        double da = double(loads[a].getDryTime()) / dryers;
+        double wb = double(loads[b].getWashTime()) / washers;
+        double db = double(loads[b].getDryTime()) / dryers;
+        bool firstA = wa <= da, firstB = wb <= db;
+        if(firstA != firstB) {
+            return firstA;
+        }
+        // ties broken by the other time, so identical loads end up next
+        // to each other
+        if(firstA) {
+            return wa < wb || (wa == wb && da > db);
+        }
+        return da > db || (da == db && wa < wb);
+    });
+    return order;
+}
+
+inline Schedule johnsonSchedule(const std::vector<Laundry> &loads,
+    unsigned washers, unsigned dryers) {
+    checkMachines(washers, dryers, "johnsonSchedule()");
+    Schedule s = scheduleInOrder(loads, johnsonOrder(loads, washers, dryers),
+        washers, dryers);
+    s.optimal = s.optimal || (washers == 1u && dryers == 1u);
+    return s;
+}
+
+inline Schedule lptSchedule(const std::vector<Laundry> &loads,
+    unsigned washers, unsigned dryers) {
+    checkMachines(washers, dryers, "lptSchedule()");
+    std::vector<size_t> order(loads.size());
+    for(size_t i = 0u; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return loads[a].getWashTime() + loads[a].getDryTime() >
+            loads[b].getWashTime() + loads[b].getDryTime();
+    });
+    return scheduleInOrder(loads, order, washers, dryers);
+}
+
+/**
+ * Helper function to improve a schedule by local search: move one load to
+ * another place in the order, as long as that shortens the makespan. A
+ * better first schedule lets branch and bound prune more from the start.
+ */
+inline Schedule improveOrder(const std::vector<Laundry> &loads,
+    Schedule best, unsigned washers, unsigned dryers) {
+    bool improved = true;
+    while(improved && !best.optimal) {
+        improved = false;
+        for(size_t i = 0u; i < best.order.size() && !improved; i++) {
+            for(size_t j = 0u; j < best.order.size() && !improved; j++) {
+                if(i == j) {
+                    continue;
+                }
+                std::vector<size_t> order = best.order;
+                size_t moved = order[i];
+                order.erase(order.begin() + i);
+                order.insert(order.begin() + j, moved);
+                Schedule s = scheduleInOrder(loads, order, washers, dryers);
+                if(s.makespan < best.makespan) {
+                    best = s;
+                    improved = true;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * Helper class for one thread of the branch and bound search: it keeps
+ * the machines' free times for the current partial order, and undoes each
+ * step on the way back up.
+ */
+class ScheduleSearch {
+public:
+    /**
+     * State changed by one step, to undo it.
+     */
+    struct Undo {
+        unsigned washer;
+        double washFree;
+        unsigned dryer;
+        double dryFree;
+        double makespan;
+    };
+
+    ScheduleSearch(const std::vector<Laundry> &loads,
+        const std::vector<size_t> &seq, unsigned washers, unsigned dryers,
+        std::atomic<double> &best, std::atomic<uint64_t> &budget) :
+        loads(loads), seq(seq), washFree(washers, 0.0),
+        dryFree(dryers, 0.0), best(best), budget(budget), used(0u),
+        makespan(0.0), bestMakespan(0.0), nodes(0u), localNodes(0u),
+        stopped(false), byWash(seq.size()), byDry(seq.size()),
+        remembered(0u) {
+        for(size_t k = 0u; k < seq.size(); k++) {
+            byWash[k] = byDry[k] = k;
+        }
+        std::sort(byWash.begin(), byWash.end(), [&](size_t a, size_t b) {
+            return loads[seq[a]].getWashTime() > loads[seq[b]].getWashTime();
+        });
+        std::sort(byDry.begin(), byDry.end(), [&](size_t a, size_t b) {
+            return loads[seq[a]].getDryTime() > loads[seq[b]].getDryTime();
+        });
+    }
+
+    /**
+     * True if the load at position k of seq may go next: it is not placed
+     * yet, and an identical load before it in seq is. Identical loads are
+     * interchangeable, so only one order of them is tried.
+     */
+    bool mayPlace(size_t k) const {
+        if((used >> k & 1u) != 0u) {
+            return false;
+        }
+        return k == 0u || (used >> (k - 1u) & 1u) != 0u ||
+            loads[seq[k]].getWashTime() != loads[seq[k - 1u]].getWashTime() ||
+            loads[seq[k]].getDryTime() != loads[seq[k - 1u]].getDryTime();
+    }
+
+    /**
+     * Place the load at position k of seq next, saving the old state in u,
+     * if that can lead to a better schedule than the best so far; false,
+     * with nothing changed, if not.
+     */
+    bool place(size_t k, Undo &u) {
+        const Laundry &load = loads[seq[k]];
+        unsigned w = firstFree(washFree), d = firstFree(dryFree);
+        u.washer = w;
+        u.washFree = washFree[w];
+        u.dryer = d;
+        u.dryFree = dryFree[d];
+        u.makespan = makespan;
+        double washed = washFree[w] + load.getWashTime();
+        dryFree[d] = std::max(washed, dryFree[d]) + load.getDryTime();
+        washFree[w] = washed;
+        makespan = std::max(makespan, dryFree[d]);
+        used |= uint64_t(1u) << k;
+        order.push_back(seq[k]);
+        if(bound() < best.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        unplace(k, u);
+        return false;
+    }
+
+    /**
+     * Undo place(k, u).
+     */
+    void unplace(size_t k, const Undo &u) {
+        washFree[u.washer] = u.washFree;
+        dryFree[u.dryer] = u.dryFree;
+        makespan = u.makespan;
+        used &= ~(uint64_t(1u) << k);
+        order.pop_back();
+    }
+
+    /**
+     * Depth-first search from the current partial order.
+     */
+    void search() {
+        if(++localNodes == 1024u) {
+            charge();
+        }
+        if(stopped) {
+            return;
+        }
+        if(order.size() == seq.size()) {
+            offer();
+            return;
+        }
+        if(dominated()) {
+            return;
+        }
+        Undo u;
+        for(size_t k = 0u; k < seq.size() && !stopped; k++) {
+            if(mayPlace(k) && place(k, u)) {
+                search();
+                unplace(k, u);
+            }
+        }
+    }
+
+    /**
+     * True if another partial order of the same loads has already left
+     * every machine free no later, so nothing can follow this one that
+     * could not follow that one at least as well. Otherwise remember this
+     * one instead of those it beats, up to fixed limits.
+     */
+    bool dominated() {
+        state.assign(washFree.begin(), washFree.end());
+        std::sort(state.begin(), state.end());
+        size_t w = state.size();
+        state.insert(state.end(), dryFree.begin(), dryFree.end());
+        std::sort(state.begin() + w, state.end());
+
+        std::vector<double> &seen = memo[used];
+        size_t n = state.size(), kept = 0u;
+        for(size_t i = 0u; i < seen.size(); i += n) {
+            bool better = true, worse = true;
+            for(size_t m = 0u; m < n; m++) {
+                better = better && seen[i + m] <= state[m];
+                worse = worse && seen[i + m] >= state[m];
+            }
+            if(better) {
+                return true;
+            }
+            if(!worse) {
+                std::copy(seen.begin() + i, seen.begin() + i + n,
+                    seen.begin() + kept);
+                kept += n;
+            }
+        }
+        remembered -= (seen.size() - kept) / n;
+        seen.resize(kept);
+        if(remembered < MEMO_STATES && seen.size() < MEMO_PER_SET * n) {
+            seen.insert(seen.end(), state.begin(), state.end());
+            remembered++;
+        }
+        return false;
+    }
+
+    /**
+     * Lower bound on the makespan of every completion of the partial order,
+     * the largest of: the makespan so far; the longest load left, started
+     * on the washer free first; for the loads left that dry at least d,
+     * the earliest the washers can get through their washing, plus d; and
+     * for the loads left that wash at least w, the earliest the dryers can
+     * get through their drying, none of which can start before w after the
+     * first washer is free. Work is split among machines as finely as
+     * needed, so these are bounds, not schedules.
+     */
+    double bound() {
+        if(order.size() == seq.size()) {
+            return makespan;
+        }
+        double earliest = washFree[firstFree(washFree)];
+        double lb = makespan;
+        double washSum = 0.0;
+        for(size_t i = 0u; i < byDry.size(); i++) {
+            size_t k = byDry[i];
+            if((used >> k & 1u) == 0u) {
+                double w = loads[seq[k]].getWashTime();
+                double d = loads[seq[k]].getDryTime();
+                lb = std::max(lb, earliest + w + d);
+                washSum += w;
+                scratch = washFree;
+                lb = std::max(lb, fillUp(scratch, washSum) + d);
+            }
+        }
+        double drySum = 0.0;
+        for(size_t i = 0u; i < byWash.size(); i++) {
+            size_t k = byWash[i];
+            if((used >> k & 1u) == 0u) {
+                double ready = earliest + loads[seq[k]].getWashTime();
+                drySum += loads[seq[k]].getDryTime();
+                scratch = dryFree;
+                for(size_t m = 0u; m < scratch.size(); m++) {
+                    scratch[m] = std::max(scratch[m], ready);
+                }
+                lb = std::max(lb, fillUp(scratch, drySum));
+            }
+        }
+        return lb;
+    }
+
+    /**
+     * Earliest time machines free at the given times can get through work
+     * units of work between them, splitting it as finely as needed; the
+     * free times are sorted as a side effect.
+     */
+    static double fillUp(std::vector<double> &free, double work) {
+        std::sort(free.begin(), free.end());
+        double sum = 0.0;
+        for(size_t k = 0u; k < free.size(); k++) {
+            sum += free[k];
+            double level = (sum + work) / (k + 1u);
+            if(k + 1u == free.size() || level <= free[k + 1u]) {
+                return level;
+            }
+        }
+        return free.back();
+    }
+
+    /**
+     * Take the nodes visited since the last call from the shared budget,
+     * and stop once it runs out.
+     */
+    void charge() {
+        nodes += localNodes;
+        uint64_t left = budget.load();
+        while(!stopped) {
+            if(left < localNodes) {
+                budget.store(0u);
+                stopped = true;
+            } else if(budget.compare_exchange_weak(left, left - localNodes)) {
+                break;
+            }
+        }
+        localNodes = 0u;
+    }
+
+    /**
+     * Keep a complete order if it beats the best so far.
+     */
+    void offer() {
+        double b = best.load();
+        while(makespan < b) {
+            if(best.compare_exchange_weak(b, makespan)) {
+                bestOrder = order;
+                bestMakespan = makespan;
+                break;
+            }
+        }
+    }
+
+    /** The loads. */
+    const std::vector<Laundry> &loads;
+
+    /** Indexes of the loads, in the order children are tried. */
+    const std::vector<size_t> &seq;
+
+    /** Time each washer and dryer is free, after the partial order. */
+    std::vector<double> washFree, dryFree;
+
+    /** Best makespan found by any thread. */
+    std::atomic<double> &best;
+
+    /** Nodes left to visit, over all threads. */
+    std::atomic<uint64_t> &budget;
+
+    /** Bit k is set if the load at position k of seq is placed. */
+    uint64_t used;
+
+    /** Makespan of the partial order. */
+    double makespan;
+
+    /** The partial order, and the best complete order this thread found. */
+    std::vector<size_t> order, bestOrder;
+
+    /** Makespan of bestOrder. */
+    double bestMakespan;
+
+    /** Nodes visited and charged, and visited since the last charge. */
+    uint64_t nodes, localNodes;
+
+    /** True once the budget has run out. */
+    bool stopped;
+
+    /** Positions in seq, by washing time and by drying time, longest first. */
+    std::vector<size_t> byWash, byDry;
+
+    /** Room for sorting free times in bound() and dominated(). */
+    std::vector<double> scratch, state;
+
+    /** Sorted free times of the partial orders remembered, by set. */
+    std::unordered_map<uint64_t, std::vector<double> > memo;
+
+    /** Number of partial orders in memo. */
+    size_t remembered;
+
+    /** Most partial orders to remember per thread, and per set of loads;
+     * longer lists cost more to scan than they save. */
+    static constexpr size_t MEMO_STATES = 1u << 20, MEMO_PER_SET = 32u;
+};
+
+/*
+ * Hand out the two-load prefixes from an atomic counter; each thread keeps
+ * the best order it found, and the best of those wins.
+ */
+inline Schedule branchAndBoundSchedule(const std::vector<Laundry> &loads,
+    unsigned washers, unsigned dryers, unsigned numThreads,
+    uint64_t maxNodes) {
+    checkMachines(washers, dryers, "branchAndBoundSchedule()");
+    if(loads.size() > 64u) {
+        throw std::invalid_argument(
+            "too many loads in branchAndBoundSchedule()");
+    }
+    Schedule start = johnsonSchedule(loads, washers, dryers);
+    Schedule lpt = lptSchedule(loads, washers, dryers);
+    start = lpt.makespan < start.makespan ? lpt : start;
+    if(!start.optimal) {
+        start = improveOrder(loads, start, washers, dryers);
+    }
+    if(start.optimal || loads.size() < 2u) {
+        start.optimal = true;
+        return start;
+    }
+
+    std::vector<size_t> seq = johnsonOrder(loads, washers, dryers);
+    std::atomic<double> best(start.makespan);
+    std::atomic<uint64_t> budget(maxNodes);
+    ScheduleSearch root(loads, seq, washers, dryers, best, budget);
+    std::vector<std::pair<size_t, size_t> > prefixes;
+    ScheduleSearch::Undo ua, ub;
+    for(size_t a = 0u; a < seq.size(); a++) {
+        if(root.mayPlace(a) && root.place(a, ua)) {
+            for(size_t b = 0u; b < seq.size(); b++) {
+                if(root.mayPlace(b) && root.place(b, ub)) {
+                    prefixes.push_back(std::make_pair(a, b));
+                    root.unplace(b, ub);
+                }
+            }
+            root.unplace(a, ua);
+        }
+    }
+    if(numThreads == 0u) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    numThreads = numThreads > prefixes.size() ? unsigned(prefixes.size()) :
+        numThreads;
+    numThreads = numThreads == 0u ? 1u : numThreads;
+
+    std::atomic<size_t> next(0u);
+    std::vector<std::unique_ptr<ScheduleSearch> > searches;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        searches.push_back(std::unique_ptr<ScheduleSearch>(
+            new ScheduleSearch(loads, seq, washers, dryers, best, budget)));
+    }
+    std::vector<std::thread> workers;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        workers.push_back(std::thread([&, t]() {
+            ScheduleSearch &s = *searches[t];
+            ScheduleSearch::Undo ua, ub;
+            for(size_t i = next++; i < prefixes.size() && !s.stopped;
+                i = next++) {
+                if(s.place(prefixes[i].first, ua)) {
+                    if(s.place(prefixes[i].second, ub)) {
+                        s.search();
+                        s.unplace(prefixes[i].second, ub);
+                    }
+                    s.unplace(prefixes[i].first, ua);
+                }
+            }
+            s.charge();
+        }));
+    }
+    for(unsigned t = 0u; t < numThreads; t++) {
+        workers[t].join();
+    }
+
+    bool finished = true;
+    uint64_t nodes = 0u;
+    const std::vector<size_t> *bestOrder = &start.order;
+    double bestMakespan = start.makespan;
+    for(unsigned t = 0u; t < numThreads; t++) {
+        const ScheduleSearch &s = *searches[t];
+        finished = finished && !s.stopped;
+        nodes += s.nodes;
+        if(!s.bestOrder.empty() && s.bestMakespan < bestMakespan) {
+            bestOrder = &s.bestOrder;
+            bestMakespan = s.bestMakespan;
+        }
+    }
+
+    Schedule result = scheduleInOrder(loads, *bestOrder, washers, dryers);
+    result.optimal = result.optimal || finished;
+    result.nodes = nodes;
+    return result;
+}
+
+namespace {
+
+/**
+ * Helper function for the Scheduler tests: random loads, with washing and
+ * drying times independent of each other and of the mass.
+ */
+inline std::vector<Laundry> randomLaundry(size_t n, unsigned seed) {
+    std::vector<Laundry> loads;
+    unsigned x = seed;
+    for(size_t i = 0u; i < n; i++) {
+        x = x * 1103515245u + 12345u;
+        float wash = 20.0f + float(x >> 16 & 31u);
+        x = x * 1103515245u + 12345u;
+        float dry = 15.0f + float(x >> 16 & 63u);
+        loads.push_back(Laundry(5.0f, wash, dry));
+    }
+    return loads;
+}
+
+/**
+ * Helper function for the Scheduler tests: check that no machine runs two
+ * loads at once, and no load dries before it is washed.
+ */
+inline bool feasible(const std::vector<Laundry> &loads, const Schedule &s,
+    unsigned washers, unsigned dryers) {
+    double makespan = 0.0;
+    for(size_t i = 0u; i < loads.size(); i++) {
+        const Assignment &a = s.loads[i];
+        double washed = a.washStart + loads[i].getWashTime();
+        if(a.washer >= washers || a.dryer >= dryers || a.washStart < 0.0 ||
+            a.dryStart < washed) {
+            return false;
+        }
+        makespan = std::max(makespan, a.dryStart + loads[i].getDryTime());
+        for(size_t j = 0u; j < i; j++) {
+            const Assignment &b = s.loads[j];
+            if(a.washer == b.washer &&
+                a.washStart < b.washStart + loads[j].getWashTime() &&
+                b.washStart < washed) {
+                return false;
+            }
+            if(a.dryer == b.dryer &&
+                a.dryStart < b.dryStart + loads[j].getDryTime() &&
+                b.dryStart < a.dryStart + loads[i].getDryTime()) {
+                return false;
+            }
+        }
+    }
+    return makespan == s.makespan;
+}
+
+/**
+ * Helper function for the Scheduler tests: the best makespan over every
+ * order, by brute force.
+ */
+inline double bestByBruteForce(const std::vector<Laundry> &loads,
+    unsigned washers, unsigned dryers) {
+    std::vector<size_t> order(loads.size());
+    for(size_t i = 0u; i < order.size(); i++) {
+        order[i] = i;
+    }
+    double best = 1e300;
+    do {
+        best = std::min(best,
+            scheduleInOrder(loads, order, washers, dryers).makespan);
+    } while(std::next_permutation(order.begin(), order.end()));
+    return best;
+}
+
+} // anonymous
+
+// doctest unit tests for the schedulers
+TEST_CASE("testing scheduleInOrder") {
+    std::vector<Laundry> loads;
+    loads.push_back(Laundry(1.0f, 10.0f, 5.0f));
+    loads.push_back(Laundry(2.0f, 3.0f, 8.0f));
+    std::vector<size_t> order(2u);
+    order[0] = 1u;
+    order[1] = 0u;
+
+    // one washer and one dryer: 0-3 wash, 3-11 dry; 3-13 wash, 13-18 dry
+    Schedule s = scheduleInOrder(loads, order, 1u, 1u);
+    CHECK(s.makespan == 18.0);
+    CHECK(s.loads[0].washStart == 3.0);
+    CHECK(s.loads[0].dryStart == 13.0);
+    CHECK(s.loads[1].dryStart == 3.0);
+    CHECK(feasible(loads, s, 1u, 1u));
+
+    // the other way round takes 23, and two of each machine takes 15
+    order[0] = 0u;
+    order[1] = 1u;
+    CHECK(scheduleInOrder(loads, order, 1u, 1u).makespan == 23.0);
+    s = scheduleInOrder(loads, order, 2u, 2u);
+    CHECK(s.makespan == 15.0);
+    CHECK(s.loads[1].washer == 1u);
+    CHECK(s.optimal);
+    CHECK(makespanLowerBound(loads, 1u, 1u) == 13.0 + 5.0);
+
+    // check exception handling
+    bool flag = true;
+    try {
+        order[1] = 0u;
+        scheduleInOrder(loads, order, 1u, 1u);  // should throw an exception
+        flag = false;                           // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+    flag = true;
+    try {
+        johnsonSchedule(loads, 0u, 1u);  // should throw an exception
+        flag = false;                    // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+}
+
+TEST_CASE("testing johnsonSchedule and lptSchedule") {
+    // Johnson's rule is optimal for one washer and one dryer
+    for(unsigned seed = 1u; seed <= 20u; seed++) {
+        std::vector<Laundry> loads = randomLaundry(7u, seed);
+        Schedule j = johnsonSchedule(loads, 1u, 1u);
+        CHECK(j.optimal);
+        CHECK(feasible(loads, j, 1u, 1u));
+        CHECK(j.makespan == bestByBruteForce(loads, 1u, 1u));
+        CHECK(lptSchedule(loads, 1u, 1u).makespan >= j.makespan);
+    }
+
+    // with more machines, both are feasible and above the lower bound
+    std::vector<Laundry> many = randomLaundry(1000u, 246u);
+    Schedule j = johnsonSchedule(many, 3u, 4u);
+    Schedule l = lptSchedule(many, 3u, 4u);
+    double lb = makespanLowerBound(many, 3u, 4u);
+    CHECK(feasible(many, j, 3u, 4u));
+    CHECK(feasible(many, l, 3u, 4u));
+    CHECK(j.makespan >= lb);
+    CHECK(l.makespan >= lb);
+    CHECK(j.makespan < 1.05 * lb);
+}
+
+TEST_CASE("testing branchAndBoundSchedule") {
+    // the same best makespan as brute force, whatever the threads
+    for(unsigned seed = 1u; seed <= 10u; seed++) {
+        std::vector<Laundry> loads = randomLaundry(7u, seed);
+        double best = bestByBruteForce(loads, 2u, 3u);
+        Schedule one = branchAndBoundSchedule(loads, 2u, 3u, 1u);
+        Schedule four = branchAndBoundSchedule(loads, 2u, 3u, 4u);
+        CHECK(one.optimal);
+        CHECK(one.makespan == best);
+        CHECK(four.makespan == best);
+        CHECK(feasible(loads, four, 2u, 3u));
+        CHECK(one.makespan <= johnsonSchedule(loads, 2u, 3u).makespan);
+    }
+
+    // identical loads are only ordered once
+    std::vector<Laundry> same(12u, Laundry(5.0f, 30.0f, 31.0f));
+    same.push_back(Laundry(5.0f, 20.0f, 50.0f));
+    Schedule s = branchAndBoundSchedule(same, 2u, 2u, 2u);
+    CHECK(s.optimal);
+    CHECK(s.nodes < 10000u);
+
+    // a search cut short is not known to be optimal
+    std::vector<Laundry> loads = randomLaundry(10u, 246u);
+    Schedule cut = branchAndBoundSchedule(loads, 2u, 3u, 2u, 10u);
+    CHECK(feasible(loads, cut, 2u, 3u));
+    if(!cut.optimal) {
+        CHECK(cut.makespan >= branchAndBoundSchedule(loads, 2u, 3u).makespan);
+    }
+
+    // check exception handling
+    bool flag = true;
+    try {
+        std::vector<Laundry> huge(65u);
+        branchAndBoundSchedule(huge, 1u, 1u);  // should throw an exception
+        flag = false;                          // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+}
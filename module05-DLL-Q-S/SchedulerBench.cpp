@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "Laundry.h"
+#include "Rng.hpp"
+#include "Scheduler.hpp"
+
+/**
+ * Helper function to make n random loads: washing times from 20 to 45
+ * minutes and drying times from 15 to 70, in whole minutes, independent of
+ * each other, as for a laundromat with several kinds of machines.
+ */
+std::vector<Laundry> randomInstance(size_t n, Xoshiro256ss &prng) {
+    std::vector<Laundry> loads;
+    for(size_t i = 0u; i < n; i++) {
+        float wash = 20.0f + float(uniformBelow(prng, 26u));
+        float dry = 15.0f + float(uniformBelow(prng, 56u));
+        loads.push_back(Laundry(1.0f + 9.0f * unitReal<float>(prng()), wash,
+            dry));
+    }
+    return loads;
+}
+
+/**
+ * Helper function to time f(), in seconds.
+ */
+template <class F>
+double timeIt(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+}
+
+/**
+ * @brief Benchmark for the schedulers.
+ *
+ * For small random instances, this program finds the best permutation
+ * schedule by branch and bound, and reports how long that takes and how
+ * far Johnson's rule and LPT are from it. For large instances, which only
+ * the heuristics can schedule, it reports their time and how far they are
+ * from the lower bound.
+ */
+int main() {
+    using namespace std;
+
+    Xoshiro256ss prng(246u);
+    const unsigned MACHINES[][2] = { { 1u, 1u }, { 2u, 3u }, { 3u, 3u } };
+    const unsigned INSTANCES = 10u;
+
+    cout << "small instances, " << INSTANCES << " each, mean over instances:"
+        << endl;
+    for(const unsigned *m : MACHINES) {
+        for(size_t n = 8u; n <= 12u; n += 2u) {
+            double bbTime = 0.0, worstTime = 0.0, johnsonGap = 0.0;
+            double lptGap = 0.0, nodes = 0.0;
+            unsigned solved = 0u;
+            for(unsigned i = 0u; i < INSTANCES; i++) {
+                vector<Laundry> loads = randomInstance(n, prng);
+                Schedule bb;
+                double t = timeIt([&]() {
+                    bb = branchAndBoundSchedule(loads, m[0], m[1]);
+                });
+                bbTime += t;
+                worstTime = t > worstTime ? t : worstTime;
+                solved += bb.optimal;
+                nodes += double(bb.nodes);
+                johnsonGap += johnsonSchedule(loads, m[0], m[1]).makespan /
+                    bb.makespan - 1.0;
+                lptGap += lptSchedule(loads, m[0], m[1]).makespan /
+                    bb.makespan - 1.0;
+            }
+            cout << "  " << m[0] << " x " << m[1] << ", " << n << " loads: "
+                << "branch and bound " << bbTime / INSTANCES * 1e3
+                << " ms (worst " << worstTime * 1e3 << " ms, "
+                << nodes / INSTANCES << " nodes, " << solved << " optimal); "
+                << "Johnson +" << johnsonGap / INSTANCES * 100.0 << "%, "
+                << "LPT +" << lptGap / INSTANCES * 100.0 << "%" << endl;
+        }
+    }
+
+    cout << "large instances, 20 washers and 30 dryers:" << endl;
+    for(size_t n = 10000u; n <= 1000000u; n *= 10u) {
+        vector<Laundry> loads = randomInstance(n, prng);
+        double lb = makespanLowerBound(loads, 20u, 30u);
+        Schedule j, l;
+        double jt = timeIt([&]() { j = johnsonSchedule(loads, 20u, 30u); });
+        double lt = timeIt([&]() { l = lptSchedule(loads, 20u, 30u); });
+        cout << "  " << n << " loads: Johnson " << jt * 1e3 << " ms, +"
+            << (j.makespan / lb - 1.0) * 100.0 << "% over the bound; LPT "
+            << lt * 1e3 << " ms, +" << (l.makespan / lb - 1.0) * 100.0
+            << "%" << endl;
+    }
+
+    return EXIT_SUCCESS;
+}
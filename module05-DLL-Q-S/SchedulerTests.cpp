@@ -0,0 +1,4 @@
+// phantom C++ file for Scheduler unit testing. This file only includes the
+// Scheduler header; doctest generates the testing program based on unit
+// tests written alongside the code in the header file
+#include "Scheduler.hpp"
@@ -0,0 +1,692 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <doctest.h>
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief xoshiro256** pseudo-random number generator.
+ *
+ * A small, fast, general purpose generator with 256 bits of state and a
+ * period of 2^256 - 1, by Blackman and Vigna. The class meets the standard
+ * UniformRandomBitGenerator requirements, so it can be used anywhere a
+ * std::mt19937_64 can, including with the std distributions. Independent
+ * streams for threads are made with split(), which jumps ahead 2^128 steps.
+ */
+class Xoshiro256ss {
+public:
+    /** Type of each random number. */
+    typedef uint64_t result_type;
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * Create a generator whose state is expanded from one 64-bit seed with
+     * SplitMix64, as recommended by the authors.
+     *
+     * @param seed Seed for the generator.
+     */
+    explicit Xoshiro256ss(uint64_t seed = 0u);
+
+    /**
+     * @brief State constructor.
+     *
+     * Create a generator with an exact state, for reproducing published
+     * test vectors.
+     *
+     * @param s0 First word of state.
+     * @param s1 Second word of state.
+     * @param s2 Third word of state.
+     * @param s3 Fourth word of state.
+     *
+     * @throws std::invalid_argument if every word of state is zero.
+     */
+    Xoshiro256ss(uint64_t s0, uint64_t s1, uint64_t s2, uint64_t s3);
+
+    /**
+     * @brief Smallest value the generator returns.
+     *
+     * @return Zero.
+     */
+    static constexpr result_type min() { return 0u; }
+
+    /**
+     * @brief Largest value the generator returns.
+     *
+     * @return 2^64 - 1.
+     */
+    static constexpr result_type max() { return ~result_type(0); }
+
+    /**
+     * @brief Get the next random number.
+     *
+     * @return 64 random bits.
+     */
+    result_type operator()() { return next(); }
+
+    /**
+     * @brief Get the next random number.
+     *
+     * @return 64 random bits.
+     */
+    uint64_t next();
+
+    /**
+     * @brief Fill an array with random numbers.
+     *
+     * @param pOut Pointer to the array to fill.
+     * @param n Number of values to write.
+     */
+    void fill(uint64_t *pOut, size_t n);
+
+    /**
+     * @brief Jump ahead.
+     *
+     * Advance the generator by 2^128 steps, in constant time.
+     */
+    void jump();
+
+    /**
+     * @brief Split off an independent stream.
+     *
+     * Return a copy of this generator, then jump this one ahead 2^128 steps,
+     * so the copy and this generator will not overlap for 2^128 numbers.
+     * Calling split() once per thread gives every thread its own stream.
+     *
+     * @return Generator for the new stream.
+     */
+    Xoshiro256ss split();
+
+private:
+    /** Generator state; never all zero. */
+    uint64_t s[4];
+};
+
+/**
+ * @brief Philox4x32-10 counter-based random number generator.
+ *
+ * Philox, by Salmon et al., turns a 128-bit counter and a 64-bit key into
+ * 128 random bits with ten rounds of multiplication and mixing. There is no
+ * state besides the counter, so random number i of a stream can be computed
+ * directly, any part of a stream can be skipped in constant time, and a
+ * buffer can be filled one independent counter per SIMD lane. The key is
+ * made from the seed, and the upper half of the counter is the stream
+ * number, giving 2^64 independent streams per seed, each 2^66 numbers long.
+ */
+class Philox4x32 {
+public:
+    /** Type of each random number. */
+    typedef uint64_t result_type;
+
+    /**
+     * @brief Initializing constructor.
+     *
+     * Create a generator at the start of one stream.
+     *
+     * @param seed Seed for the generator; the Philox key.
+     * @param stream Stream number; the upper half of the counter.
+     */
+    explicit Philox4x32(uint64_t seed = 0u, uint64_t stream = 0u);
+
+    /**
+     * @brief Smallest value the generator returns.
+     *
+     * @return Zero.
+     */
+    static constexpr result_type min() { return 0u; }
+
+    /**
+     * @brief Largest value the generator returns.
+     *
+     * @return 2^64 - 1.
+     */
+    static constexpr result_type max() { return ~result_type(0); }
+
+    /**
+     * @brief Get the next random number.
+     *
+     * @return 64 random bits.
+     */
+    result_type operator()() { return next(); }
+
+    /**
+     * @brief Get the next random number.
+     *
+     * @return 64 random bits, made from the next two 32-bit words.
+     */
+    uint64_t next();
+
+    /**
+     * @brief Get the next 32-bit random number.
+     *
+     * @return 32 random bits.
+     */
+    uint32_t next32();
+
+    /**
+     * @brief Fill an array with 32-bit random numbers.
+     *
+     * Whole blocks are computed straight from their counters, in a loop
+     * whose iterations are independent of each other and can be vectorized.
+     * The array holds the same values n calls to next32() would return.
+     *
+     * @param pOut Pointer to the array to fill.
+     * @param n Number of values to write.
+     */
+    void fill(uint32_t *pOut, size_t n);
+
+    /**
+     * @brief Skip ahead.
+     *
+     * Skip the next n 32-bit words of the stream, in constant time.
+     *
+     * @param n Number of 32-bit words to skip.
+     */
+    void discard(uint64_t n);
+
+    /**
+     * @brief Compute one Philox4x32-10 block.
+     *
+     * @param ctr 128-bit counter, as four 32-bit words.
+     * @param key 64-bit key, as two 32-bit words.
+     * @param out Array of four words to receive the 128 random bits.
+     */
+    static void block(const uint32_t ctr[4], const uint32_t key[2],
+        uint32_t out[4]);
+
+    /**
+     * @brief Compute many consecutive Philox4x32-10 blocks.
+     *
+     * Compute blocks first through first + n - 1 of a stream, with word w
+     * of block first + i written to pOut[w][i]. The blocks are computed
+     * in chunks of 64 with the round loop outside the lane loop, so each
+     * round runs across many lanes in vector registers. Each copy of
+     * the function is compiled for AVX-512, AVX2, and baseline processors,
+     * and the best one is picked when the program starts.
+     *
+     * @param first Number of the first block, the low half of the counter.
+     * @param stream Stream number, the high half of the counter.
+     * @param key 64-bit key, as two 32-bit words.
+     * @param n Number of blocks to compute.
+     * @param pOut Four arrays of n words each, one per word of the block.
+     */
+    static void blocks(uint64_t first, uint64_t stream, const uint32_t key[2],
+        size_t n, uint32_t *const pOut[4]);
+
+private:
+    /** Compute the block at a block number within this stream. */
+    void blockAt(uint64_t blockNum, uint32_t out[4]) const;
+
+    /** Philox key, from the seed. */
+    uint32_t key[2];
+
+    /** Stream number, the upper half of the counter. */
+    uint64_t stream;
+
+    /** Position in the stream, in 32-bit words. */
+    uint64_t pos;
+
+    /** The block that holds word pos, once computed. */
+    uint32_t buf[4];
+
+    /** Block number held in buf, or all ones if buf is empty. */
+    uint64_t bufBlock;
+};
+
+/*-----------------------------------------------------------------------------
+ * helper declarations
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief SplitMix64 mixing function.
+ *
+ * Hash 64 bits into 64 well mixed bits; used to expand seeds.
+ *
+ * @param z Value to mix.
+ *
+ * @return Mixed value.
+ */
+uint64_t splitMix64(uint64_t z);
+
+/**
+ * @brief Convert random bits to a real number in [0, 1).
+ *
+ * Uses as many of the high bits as the type T has mantissa bits, so every
+ * value returned is exactly representable and evenly spaced.
+ *
+ * @param bits 64 random bits.
+ *
+ * @return Uniform random value in [0, 1).
+ */
+template <class T> T unitReal(uint64_t bits);
+
+/**
+ * @brief Random integer in [0, range).
+ *
+ * Draw an unbiased random integer below range with Lemire's
+ * multiply-and-shift method, which almost never needs a division. Much
+ * faster than std::uniform_int_distribution with the same generator.
+ *
+ * @param g Generator returning 64 random bits per call.
+ * @param range Number of possible values.
+ *
+ * @throws std::invalid_argument if range is zero.
+ *
+ * @return Random integer in [0, range).
+ */
+template <class G> uint64_t uniformBelow(G &g, uint64_t range);
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * SplitMix64 finalizer, with the golden ratio increment folded in.
+ */
+inline uint64_t splitMix64(uint64_t z) {
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/*
+ * Top 24 bits for a float.
+ */
+template <> inline float unitReal<float>(uint64_t bits) {
+    return (bits >> 40) * (1.0f / 16777216.0f);
+}
+
+/*
+ * Top 53 bits for a double.
+ */
+template <> inline double unitReal<double>(uint64_t bits) {
+    return (bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ * All 64 bits for a long double.
+ */
+template <> inline long double unitReal<long double>(uint64_t bits) {
+    return bits * (1.0L / 18446744073709551616.0L);
+}
+
+/*
+ * Lemire's nearly divisionless bounded random integer.
+ */
+template <class G>
+uint64_t uniformBelow(G &g, uint64_t range) {
+    if(range == 0u) {
+        throw std::invalid_argument("empty range in uniformBelow()");
+    }
+
+    unsigned __int128 m = (unsigned __int128)g() * range;
+    uint64_t low = uint64_t(m);
+    if(low < range) {
+        // reject the few products that would bias the result
+        uint64_t threshold = (0u - range) % range;
+        while(low < threshold) {
+            m = (unsigned __int128)g() * range;
+            low = uint64_t(m);
+        }
+    }
+
+    return uint64_t(m >> 64);
+}
+
+/*
+ * Rotate left.
+ */
+inline uint64_t rotl64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/*
+ * Expand the seed into four words of state.
+ */
+inline Xoshiro256ss::Xoshiro256ss(uint64_t seed) {
+    for(int i = 0; i < 4; i++) {
+        s[i] = splitMix64(seed);
+        seed += 0x9E3779B97F4A7C15ull;
+    }
+}
+
+/*
+ * Use an exact state.
+ */
+inline Xoshiro256ss::Xoshiro256ss(uint64_t s0, uint64_t s1, uint64_t s2,
+    uint64_t s3) {
+    if((s0 | s1 | s2 | s3) == 0u) {
+        throw std::invalid_argument("all-zero state in Xoshiro256ss::Xoshiro256ss()");
+    }
+    s[0] = s0;
+    s[1] = s1;
+    s[2] = s2;
+    s[3] = s3;
+}
+
+/*
+ * One step of xoshiro256**.
+ */
+inline uint64_t Xoshiro256ss::next() {
+    uint64_t result = rotl64(s[1] * 5u, 7) * 9u;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl64(s[3], 45);
+
+    return result;
+}
+
+/*
+ * Fill an array, keeping the state in registers.
+ */
+inline void Xoshiro256ss::fill(uint64_t *pOut, size_t n) {
+    Xoshiro256ss g = *this;
+    for(size_t i = 0u; i < n; i++) {
+        pOut[i] = g.next();
+    }
+    *this = g;
+}
+
+/*
+ * Jump ahead 2^128 steps, using the published jump polynomial.
+ */
+inline void Xoshiro256ss::jump() {
+    static const uint64_t JUMP[4] = { 0x180ec6d33cfd0abaull,
+        0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+
+    uint64_t t[4] = { 0u, 0u, 0u, 0u };
+    for(int i = 0; i < 4; i++) {
+        for(int b = 0; b < 64; b++) {
+            if(JUMP[i] & (uint64_t(1) << b)) {
+                t[0] ^= s[0];
+                t[1] ^= s[1];
+                t[2] ^= s[2];
+                t[3] ^= s[3];
+            }
+            next();
+        }
+    }
+
+    s[0] = t[0];
+    s[1] = t[1];
+    s[2] = t[2];
+    s[3] = t[3];
+}
+
+/*
+ * Copy this stream, then move this one 2^128 steps along.
+ */
+inline Xoshiro256ss Xoshiro256ss::split() {
+    Xoshiro256ss copy = *this;
+    jump();
+    return copy;
+}
+
+// doctest unit tests for Xoshiro256ss
+TEST_CASE("testing Xoshiro256ss") {
+    // reference output of the authors' code from state (1, 2, 3, 4)
+    Xoshiro256ss g(1u, 2u, 3u, 4u);
+    CHECK(g.next() == 11520u);
+    CHECK(g.next() == 0u);
+    CHECK(g.next() == 1509978240u);
+    CHECK(g.next() == 1215971899390074240u);
+
+    // fill matches next
+    Xoshiro256ss a(246u), b(246u);
+    uint64_t buf[10];
+    a.fill(buf, 10);
+    for(int i = 0; i < 10; i++) {
+        CHECK(buf[i] == b.next());
+    }
+    CHECK(a.next() == b.next());
+
+    // split streams differ from each other
+    Xoshiro256ss parent(7u);
+    Xoshiro256ss s1 = parent.split();
+    Xoshiro256ss s2 = parent.split();
+    CHECK(s1.next() != s2.next());
+
+    // check exception handling
+    bool flag = true;
+    try {
+        Xoshiro256ss bad(0u, 0u, 0u, 0u);   // should throw an exception
+        flag = false;                       // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+}
+
+/*
+ * Start at the beginning of a stream.
+ */
+inline Philox4x32::Philox4x32(uint64_t seed, uint64_t stream) :
+    stream(stream), pos(0u), bufBlock(~uint64_t(0)) {
+    key[0] = uint32_t(seed);
+    key[1] = uint32_t(seed >> 32);
+}
+
+/*
+ * Ten Philox rounds, bumping the key between rounds.
+ */
+inline void Philox4x32::block(const uint32_t ctr[4], const uint32_t key[2],
+    uint32_t out[4]) {
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    uint32_t k0 = key[0], k1 = key[1];
+
+    for(int r = 0; r < 10; r++) {
+        uint64_t p0 = uint64_t(0xD2511F53u) * c0;
+        uint64_t p1 = uint64_t(0xCD9E8D57u) * c2;
+        uint32_t n0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+        c0 = n0;
+        c1 = uint32_t(p1);
+        c2 = n2;
+        c3 = uint32_t(p0);
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+/*
+ * Chunks of 64 lanes, so the lanes stay in L1 across all ten rounds.
+ */
+__attribute__((target_clones("avx512f", "avx2", "default")))
+void Philox4x32::blocks(uint64_t first, uint64_t stream, const uint32_t key[2],
+    size_t n, uint32_t *const pOut[4]) {
+    const size_t CHUNK = 64u;
+    uint32_t s0 = uint32_t(stream), s1 = uint32_t(stream >> 32);
+
+    for(size_t base = 0u; base < n; base += CHUNK) {
+        size_t lanes = (n - base < CHUNK) ? n - base : CHUNK;
+        uint32_t *__restrict c0 = pOut[0] + base;
+        uint32_t *__restrict c1 = pOut[1] + base;
+        uint32_t *__restrict c2 = pOut[2] + base;
+        uint32_t *__restrict c3 = pOut[3] + base;
+
+        // the output arrays start out holding the counters
+        for(size_t l = 0u; l < lanes; l++) {
+            uint64_t b = first + base + l;
+            c0[l] = uint32_t(b);
+            c1[l] = uint32_t(b >> 32);
+            c2[l] = s0;
+            c3[l] = s1;
+        }
+
+        uint32_t k0 = key[0], k1 = key[1];
+        for(int r = 0; r < 10; r++) {
+            for(size_t l = 0u; l < lanes; l++) {
+                uint64_t p0 = uint64_t(0xD2511F53u) * c0[l];
+                uint64_t p1 = uint64_t(0xCD9E8D57u) * c2[l];
+                uint32_t n0 = uint32_t(p1 >> 32) ^ c1[l] ^ k0;
+                uint32_t n2 = uint32_t(p0 >> 32) ^ c3[l] ^ k1;
+                c1[l] = uint32_t(p1);
+                c3[l] = uint32_t(p0);
+                c0[l] = n0;
+                c2[l] = n2;
+            }
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+    }
+}
+
+/*
+ * Block number blockNum of this stream.
+ */
+inline void Philox4x32::blockAt(uint64_t blockNum, uint32_t out[4]) const {
+    uint32_t ctr[4] = { uint32_t(blockNum), uint32_t(blockNum >> 32),
+        uint32_t(stream), uint32_t(stream >> 32) };
+    block(ctr, key, out);
+}
+
+/*
+ * Next 32-bit word, computing a new block every fourth call.
+ */
+inline uint32_t Philox4x32::next32() {
+    uint64_t b = pos >> 2;
+    if(b != bufBlock) {
+        blockAt(b, buf);
+        bufBlock = b;
+    }
+
+    return buf[pos++ & 3u];
+}
+
+/*
+ * Next two words as one 64-bit number.
+ */
+inline uint64_t Philox4x32::next() {
+    uint64_t lo = next32();
+    return lo | (uint64_t(next32()) << 32);
+}
+
+/*
+ * Fill an array, computing whole blocks directly from their counters.
+ */
+inline void Philox4x32::fill(uint32_t *pOut, size_t n) {
+    size_t i = 0u;
+
+    // finish a partly used block
+    while(i < n && (pos & 3u) != 0u) {
+        pOut[i++] = next32();
+    }
+
+    // whole blocks, computed a chunk at a time in vector lanes
+    const size_t CHUNK = 256u;
+    uint32_t w0[CHUNK], w1[CHUNK], w2[CHUNK], w3[CHUNK];
+    uint32_t *const pWords[4] = { w0, w1, w2, w3 };
+    size_t whole = (n - i) / 4u;
+    while(whole > 0u) {
+        size_t count = (whole < CHUNK) ? whole : CHUNK;
+        blocks(pos >> 2, stream, key, count, pWords);
+        for(size_t b = 0u; b < count; b++) {
+            pOut[i++] = w0[b];
+            pOut[i++] = w1[b];
+            pOut[i++] = w2[b];
+            pOut[i++] = w3[b];
+        }
+        pos += 4u * count;
+        whole -= count;
+    }
+
+    // start of the next block
+    while(i < n) {
+        pOut[i++] = next32();
+    }
+}
+
+/*
+ * Skip ahead by moving the counter.
+ */
+inline void Philox4x32::discard(uint64_t n) {
+    pos += n;
+}
+
+// doctest unit tests for Philox4x32
+TEST_CASE("testing Philox4x32") {
+    // known answer tests from the Random123 distribution
+    uint32_t out[4];
+    uint32_t ctr0[4] = { 0u, 0u, 0u, 0u };
+    uint32_t key0[2] = { 0u, 0u };
+    Philox4x32::block(ctr0, key0, out);
+    CHECK(out[0] == 0x6627e8d5u);
+    CHECK(out[1] == 0xe169c58du);
+    CHECK(out[2] == 0xbc57ac4cu);
+    CHECK(out[3] == 0x9b00dbd8u);
+
+    uint32_t ctrPi[4] = { 0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u };
+    uint32_t keyPi[2] = { 0xa4093822u, 0x299f31d0u };
+    Philox4x32::block(ctrPi, keyPi, out);
+    CHECK(out[0] == 0xd16cfe09u);
+    CHECK(out[1] == 0x94fdccebu);
+    CHECK(out[2] == 0x5001e420u);
+    CHECK(out[3] == 0x24126ea1u);
+
+    // fill matches next32, from any starting position, across chunks
+    Philox4x32 a(99u, 3u), b(99u, 3u);
+    a.next32();
+    b.next32();
+    uint32_t buf[2055];
+    a.fill(buf, 2055);
+    for(int i = 0; i < 2055; i++) {
+        CHECK(buf[i] == b.next32());
+    }
+    CHECK(a.next() == b.next());
+
+    // discard skips exactly
+    Philox4x32 c(5u), d(5u);
+    c.discard(1001u);
+    for(int i = 0; i < 1001; i++) {
+        d.next32();
+    }
+    CHECK(c.next() == d.next());
+
+    // different streams differ
+    Philox4x32 s1(5u, 1u), s2(5u, 2u);
+    CHECK(s1.next() != s2.next());
+}
+
+// doctest unit tests for the helper functions
+TEST_CASE("testing unitReal and uniformBelow") {
+    CHECK(unitReal<float>(~uint64_t(0)) < 1.0f);
+    CHECK(unitReal<double>(~uint64_t(0)) < 1.0);
+    CHECK(unitReal<long double>(0u) == 0.0L);
+
+    // every value in range, every value seen
+    Xoshiro256ss g(1u);
+    bool seen[7] = { false, false, false, false, false, false, false };
+    for(int i = 0; i < 1000; i++) {
+        uint64_t v = uniformBelow(g, 7u);
+        REQUIRE(v < 7u);
+        seen[v] = true;
+    }
+    for(int i = 0; i < 7; i++) {
+        CHECK(seen[i]);
+    }
+    CHECK(uniformBelow(g, 1u) == 0u);
+
+    // check exception handling
+    bool flag = true;
+    try {
+        uniformBelow(g, 0u);    // should throw an exception
+        flag = false;           // should never happen
+    } catch(std::invalid_argument ia) {
+        CHECK(flag);
+    }
+}
@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "Rng.hpp"
+
+/**
+ * @brief Time one way of generating random numbers.
+ *
+ * Calls gen to write n 64-bit random numbers (or the same number of bytes)
+ * into buf, and reports millions of numbers and gigabytes per second.
+ *
+ * @param name Name of the method, for output.
+ * @param buf Buffer to fill.
+ * @param gen Function that fills the buffer.
+ */
+template <class F>
+void timeIt(const std::string &name, std::vector<uint64_t> &buf, F gen) {
+    auto start = std::chrono::steady_clock::now();
+    gen(buf);
+    auto stop = std::chrono::steady_clock::now();
+
+    // fold the output so the work can't be optimized away
+    uint64_t x = 0u;
+    for(size_t i = 0u; i < buf.size(); i++) {
+        x ^= buf[i];
+    }
+
+    double secs = std::chrono::duration<double>(stop - start).count();
+    std::cout << name << ":\t" << (buf.size() / secs / 1.0e6) << " M/s\t" <<
+        (buf.size() * 8.0 / secs / 1.0e9) << " GB/s\t(" << (x & 0xFF) << 
+        ")" << std::endl;
+}
+
+/**
+ * Throughput benchmark for the random number generators. Generates 64 
+ * million 64-bit numbers (or the number given as the first command line
+ * argument) with std::mt19937_64, Xoshiro256ss, and Philox4x32, one at a 
+ * time and with the bulk fill methods, and also times bounded integers
+ * from std::uniform_int_distribution and uniformBelow().
+ */
+int main(int argc, char **argv) {
+    size_t n = 64000000u;
+    if(argc > 1) {
+        n = std::strtoull(argv[1], 0, 10);
+    }
+    std::vector<uint64_t> buf(n);
+
+    timeIt("mt19937_64", buf, [](std::vector<uint64_t> &b) {
+        std::mt19937_64 g(246u);
+        for(size_t i = 0u; i < b.size(); i++) {
+            b[i] = g();
+        }
+    });
+
+    timeIt("xoshiro256**", buf, [](std::vector<uint64_t> &b) {
+        Xoshiro256ss g(246u);
+        for(size_t i = 0u; i < b.size(); i++) {
+            b[i] = g();
+        }
+    });
+
+    timeIt("xoshiro256** fill", buf, [](std::vector<uint64_t> &b) {
+        Xoshiro256ss g(246u);
+        g.fill(b.data(), b.size());
+    });
+
+    timeIt("philox4x32", buf, [](std::vector<uint64_t> &b) {
+        Philox4x32 g(246u);
+        for(size_t i = 0u; i < b.size(); i++) {
+            b[i] = g();
+        }
+    });
+
+    timeIt("philox4x32 fill", buf, [](std::vector<uint64_t> &b) {
+        Philox4x32 g(246u);
+        g.fill(reinterpret_cast<uint32_t *>(b.data()), 2u * b.size());
+    });
+
+    timeIt("mt19937_64 + uniform_int_distribution", buf,
+        [](std::vector<uint64_t> &b) {
+            std::mt19937_64 g(246u);
+            std::uniform_int_distribution<uint64_t> dist(0u, 150000u);
+            for(size_t i = 0u; i < b.size(); i++) {
+                b[i] = dist(g);
+            }
+        });
+
+    timeIt("xoshiro256** + uniformBelow", buf, [](std::vector<uint64_t> &b) {
+        Xoshiro256ss g(246u);
+        for(size_t i = 0u; i < b.size(); i++) {
+            b[i] = uniformBelow(g, 150001u);
+        }
+    });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,4 @@
+// phantom C++ file for Rng unit testing. This file only includes the Rng 
+// header; doctest generates the testing program based on unit tests written 
+// alongside the code in the header file
+#include "Rng.hpp"
\ No newline at end of file